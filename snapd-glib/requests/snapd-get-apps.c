@@ -88,11 +88,12 @@ parse_get_apps_response (SnapdRequest *request, SoupMessage *message, SnapdMaint
     if (result == NULL)
         return FALSE;
 
+    g_autoptr(SnapdStringPool) pool = _snapd_string_pool_new ();
     g_autoptr(GPtrArray) apps = g_ptr_array_new_with_free_func (g_object_unref);
     for (guint i = 0; i < json_array_get_length (result); i++) {
         JsonNode *node = json_array_get_element (result, i);
 
-        SnapdApp *app = _snapd_json_parse_app (node, NULL, error);
+        SnapdApp *app = _snapd_json_parse_app (node, NULL, pool, error);
         if (app == NULL)
             return FALSE;
 
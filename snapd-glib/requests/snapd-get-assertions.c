@@ -7,11 +7,12 @@
  * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
  */
 
-#include <stdlib.h>
+#include <string.h>
 
 #include "snapd-get-assertions.h"
 
-#include "snapd-assertion.h"
+#include "snapd-assertion-private.h"
+#include "snapd-assertion-stream.h"
 #include "snapd-error.h"
 #include "snapd-json.h"
 
@@ -19,7 +20,13 @@ struct _SnapdGetAssertions
 {
     SnapdRequest parent_instance;
     gchar *type;
-    GStrv assertions;
+    GHashTable *filters;
+    gboolean headers_only;
+    GPtrArray *assertions;
+    SnapdAssertionCallback assertion_callback;
+    gpointer assertion_callback_data;
+    SnapdAssertionStream *stream;
+    GError *stream_error;
 };
 
 G_DEFINE_TYPE (SnapdGetAssertions, snapd_get_assertions, snapd_request_get_type ())
@@ -37,7 +44,31 @@ _snapd_get_assertions_new (const gchar *type, GCancellable *cancellable, GAsyncR
     return self;
 }
 
-GStrv
+void
+_snapd_get_assertions_set_assertion_callback (SnapdGetAssertions *self, SnapdAssertionCallback assertion_callback, gpointer assertion_callback_data)
+{
+    self->assertion_callback = assertion_callback;
+    self->assertion_callback_data = assertion_callback_data;
+}
+
+/* Only return assertions with these header values (element-type utf8 utf8) */
+void
+_snapd_get_assertions_set_filters (SnapdGetAssertions *self, GHashTable *filters)
+{
+    g_clear_pointer (&self->filters, g_hash_table_unref);
+    if (filters != NULL)
+        self->filters = g_hash_table_ref (filters);
+}
+
+/* Request only the headers, which snapd returns as JSON */
+void
+_snapd_get_assertions_set_headers_only (SnapdGetAssertions *self, gboolean headers_only)
+{
+    self->headers_only = headers_only;
+}
+
+/* Assertions as views into the response */
+GPtrArray *
 _snapd_get_assertions_get_assertions (SnapdGetAssertions *self)
 {
     return self->assertions;
@@ -48,10 +79,150 @@ generate_get_assertions_request (SnapdRequest *request)
 {
     SnapdGetAssertions *self = SNAPD_GET_ASSERTIONS (request);
 
+    g_autoptr(GPtrArray) query_attributes = g_ptr_array_new_with_free_func (g_free);
+    if (self->filters != NULL) {
+        /* Sort so the same filters always give the same path */
+        g_autoptr(GList) names = g_list_sort (g_hash_table_get_keys (self->filters), (GCompareFunc) strcmp);
+        for (GList *link = names; link != NULL; link = link->next) {
+            const gchar *name = link->data;
+            g_autofree gchar *escaped_name = soup_uri_encode (name, "&=+");
+            g_autofree gchar *escaped_value = soup_uri_encode (g_hash_table_lookup (self->filters, name), "&=+");
+            g_ptr_array_add (query_attributes, g_strdup_printf ("%s=%s", escaped_name, escaped_value));
+        }
+    }
+    if (self->headers_only)
+        g_ptr_array_add (query_attributes, g_strdup ("json=headers"));
+
     g_autofree gchar *escaped = soup_uri_encode (self->type, NULL);
-    g_autofree gchar *path = g_strdup_printf ("http://snapd/v2/assertions/%s", escaped);
+    g_autoptr(GString) path = g_string_new ("http://snapd/v2/assertions/");
+    g_string_append (path, escaped);
+    if (query_attributes->len > 0) {
+        g_string_append_c (path, '?');
+        for (guint i = 0; i < query_attributes->len; i++) {
+            if (i != 0)
+                g_string_append_c (path, '&');
+            g_string_append (path, (gchar *) query_attributes->pdata[i]);
+        }
+    }
+
+    return soup_message_new ("GET", path->str);
+}
+
+static gboolean
+stream_assertion_cb (GBytes *data, gpointer user_data, GError **error)
+{
+    SnapdGetAssertions *self = user_data;
+
+    /* Report from the request context, we may be holding the connection lock */
+    g_autoptr(SnapdAssertion) assertion = _snapd_assertion_new_from_bytes (data);
+    _snapd_request_deliver (SNAPD_REQUEST (self), G_OBJECT (assertion));
+
+    return TRUE;
+}
+
+static void
+get_assertions_deliver_item (SnapdRequest *request, GObject *item)
+{
+    SnapdGetAssertions *self = SNAPD_GET_ASSERTIONS (request);
+
+    g_autoptr(GObject) client = g_async_result_get_source_object (G_ASYNC_RESULT (self));
+    self->assertion_callback (SNAPD_CLIENT (client), SNAPD_ASSERTION (item), self->assertion_callback_data);
+}
+
+static gboolean
+is_assertion_response (SoupMessage *message)
+{
+    const gchar *content_type = soup_message_headers_get_content_type (message->response_headers, NULL);
+    return message->status_code == SOUP_STATUS_OK && g_strcmp0 (content_type, "application/x.ubuntu.assertion") == 0;
+}
+
+static gboolean
+get_assertions_content_received (SnapdRequest *request, const gchar *data, gsize length)
+{
+    SnapdGetAssertions *self = SNAPD_GET_ASSERTIONS (request);
+
+    /* Errors are parsed once the whole response is received */
+    if (self->assertion_callback == NULL || !is_assertion_response (_snapd_request_get_message (request)))
+        return FALSE;
+
+    if (self->stream == NULL)
+        self->stream = _snapd_assertion_stream_new (stream_assertion_cb, self);
+    if (self->stream_error == NULL)
+        _snapd_assertion_stream_feed (self->stream, data, length, &self->stream_error);
+
+    return TRUE;
+}
+
+/* Append a header in the same format snapd uses, with lists and maps indented on the following lines */
+static void
+append_header (GString *text, const gchar *intro, JsonNode *node, guint indent)
+{
+    if (JSON_NODE_HOLDS_ARRAY (node)) {
+        JsonArray *array = json_node_get_array (node);
+        if (json_array_get_length (array) == 0)
+            return;
+        g_string_append_c (text, '\n');
+        g_string_append (text, intro);
+        g_autofree gchar *prefix = g_strdup_printf ("%*s  -", (int) indent, "");
+        for (guint i = 0; i < json_array_get_length (array); i++)
+            append_header (text, prefix, json_array_get_element (array, i), indent + 4);
+    }
+    else if (JSON_NODE_HOLDS_OBJECT (node)) {
+        JsonObject *object = json_node_get_object (node);
+        if (json_object_get_size (object) == 0)
+            return;
+        g_string_append_c (text, '\n');
+        g_string_append (text, intro);
+        g_autoptr(GList) names = json_object_get_members (object);
+        for (GList *link = names; link != NULL; link = link->next) {
+            const gchar *name = link->data;
+            g_autofree gchar *prefix = g_strdup_printf ("%*s  %s:", (int) indent, "", name);
+            append_header (text, prefix, json_object_get_member (object, name), indent + 4);
+        }
+    }
+    else if (JSON_NODE_HOLDS_VALUE (node) && json_node_get_value_type (node) == G_TYPE_STRING) {
+        const gchar *value = json_node_get_string (node);
+        g_string_append_c (text, '\n');
+        g_string_append (text, intro);
+
+        /* Multi-line values start on the line after the name */
+        if (strchr (value, '\n') != NULL) {
+            g_auto(GStrv) lines = g_strsplit (value, "\n", -1);
+            for (int i = 0; lines[i] != NULL; i++)
+                g_string_append_printf (text, "\n%*s%s", (int) indent + 4, "", lines[i]);
+        }
+        else {
+            g_string_append_c (text, ' ');
+            g_string_append (text, value);
+        }
+    }
+}
+
+/* Convert headers returned in JSON to the text format, with the type first */
+static GBytes *
+encode_headers (JsonObject *headers)
+{
+    g_autoptr(GString) text = g_string_new (NULL);
+    if (headers != NULL) {
+        JsonNode *type = json_object_get_member (headers, "type");
+        if (type != NULL)
+            append_header (text, "type:", type, 0);
+        g_autoptr(GList) names = json_object_get_members (headers);
+        for (GList *link = names; link != NULL; link = link->next) {
+            const gchar *name = link->data;
+            if (strcmp (name, "type") == 0)
+                continue;
+            g_autofree gchar *intro = g_strdup_printf ("%s:", name);
+            append_header (text, intro, json_object_get_member (headers, name), 0);
+        }
+    }
+
+    /* Headers terminated by a blank line, with no body or signature */
+    g_string_append (text, "\n\n");
 
-    return soup_message_new ("GET", path);
+    /* Skip the newline before the first header */
+    gsize offset = text->len > 2 ? 1 : 0;
+    return g_bytes_new (text->str + offset, text->len - offset);
 }
 
 static gboolean
@@ -59,20 +230,60 @@ parse_get_assertions_response (SnapdRequest *request, SoupMessage *message, Snap
 {
     SnapdGetAssertions *self = SNAPD_GET_ASSERTIONS (request);
 
+    /* Assertions have already been reported, only the last one is remaining */
+    if (self->stream != NULL) {
+        if (self->stream_error == NULL)
+            _snapd_assertion_stream_finish (self->stream, &self->stream_error);
+        if (self->stream_error != NULL) {
+            g_propagate_error (error, g_steal_pointer (&self->stream_error));
+            return FALSE;
+        }
+        return TRUE;
+    }
+
     const gchar *content_type = soup_message_headers_get_content_type (message->response_headers, NULL);
     if (g_strcmp0 (content_type, "application/json") == 0) {
         g_autoptr(JsonObject) response = _snapd_json_parse_response (message, maintenance, error);
         if (response == NULL)
             return FALSE;
-        g_autoptr(JsonObject) result = _snapd_json_get_sync_result_o (response, error);
+
+        if (!self->headers_only) {
+            g_autoptr(JsonObject) result = _snapd_json_get_sync_result_o (response, error);
+            if (result == NULL)
+                return FALSE;
+
+            g_set_error (error,
+                         SNAPD_ERROR,
+                         SNAPD_ERROR_READ_FAILED,
+                         "Unknown response");
+            return FALSE;
+        }
+
+        g_autoptr(JsonArray) result = _snapd_json_get_sync_result_a (response, error);
         if (result == NULL)
             return FALSE;
+        self->assertions = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+        for (guint i = 0; i < json_array_get_length (result); i++) {
+            JsonNode *node = json_array_get_element (result, i);
+            if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
+                g_set_error (error,
+                             SNAPD_ERROR,
+                             SNAPD_ERROR_READ_FAILED,
+                             "Unexpected assertion type");
+                return FALSE;
+            }
+            JsonObject *headers = _snapd_json_get_object (json_node_get_object (node), "headers");
+            g_ptr_array_add (self->assertions, encode_headers (headers));
+        }
 
-        g_set_error (error,
-                     SNAPD_ERROR,
-                     SNAPD_ERROR_READ_FAILED,
-                     "Unknown response");
-        return FALSE;
+        if (self->assertion_callback != NULL) {
+            for (guint i = 0; i < self->assertions->len; i++) {
+                if (!stream_assertion_cb (self->assertions->pdata[i], self, error))
+                    return FALSE;
+            }
+        }
+
+        return TRUE;
     }
 
     if (message->status_code != SOUP_STATUS_OK) {
@@ -91,37 +302,17 @@ parse_get_assertions_response (SnapdRequest *request, SoupMessage *message, Snap
         return FALSE;
     }
 
-    g_autoptr(GPtrArray) assertions = g_ptr_array_new ();
+    /* Split in one pass, sharing the response data between the assertions */
     g_autoptr(SoupBuffer) buffer = soup_message_body_flatten (message->response_body);
-    gsize offset = 0;
-    while (offset < buffer->length) {
-        /* Headers terminated by double newline */
-        gsize assertion_start = offset;
-        while (offset < buffer->length && !g_str_has_prefix (buffer->data + offset, "\n\n"))
-            offset++;
-        offset += 2;
-
-        /* Make a temporary assertion object to decode body length header */
-        g_autofree gchar *content = g_strndup (buffer->data + assertion_start, offset - assertion_start);
-        g_autoptr(SnapdAssertion) assertion = snapd_assertion_new (content);
-        g_autofree gchar *body_length_header = snapd_assertion_get_header (assertion, "body-length");
-
-        /* Skip over body */
-        gsize body_length = body_length_header != NULL ? strtoul (body_length_header, NULL, 10) : 0;
-        if (body_length > 0)
-            offset += body_length + 2;
-
-        /* Find end of signature */
-        while (offset < buffer->length && !g_str_has_prefix (buffer->data + offset, "\n\n"))
-            offset++;
-        gsize assertion_end = offset;
-        offset += 2;
-
-        g_ptr_array_add (assertions, g_strndup (buffer->data + assertion_start, assertion_end - assertion_start));
-    }
-    g_ptr_array_add (assertions, NULL);
+    g_autoptr(GBytes) data = soup_buffer_get_as_bytes (buffer);
+    self->assertions = _snapd_assertion_split (data);
 
-    self->assertions = g_steal_pointer ((GStrv *)&assertions->pdata);
+    if (self->assertion_callback != NULL) {
+        for (guint i = 0; i < self->assertions->len; i++) {
+            if (!stream_assertion_cb (self->assertions->pdata[i], self, error))
+                return FALSE;
+        }
+    }
 
     return TRUE;
 }
@@ -132,7 +323,10 @@ snapd_get_assertions_finalize (GObject *object)
     SnapdGetAssertions *self = SNAPD_GET_ASSERTIONS (object);
 
     g_clear_pointer (&self->type, g_free);
-    g_clear_pointer (&self->assertions, g_strfreev);
+    g_clear_pointer (&self->filters, g_hash_table_unref);
+    g_clear_pointer (&self->assertions, g_ptr_array_unref);
+    g_clear_pointer (&self->stream, _snapd_assertion_stream_free);
+    g_clear_error (&self->stream_error);
 
     G_OBJECT_CLASS (snapd_get_assertions_parent_class)->finalize (object);
 }
@@ -145,6 +339,8 @@ snapd_get_assertions_class_init (SnapdGetAssertionsClass *klass)
 
    request_class->generate_request = generate_get_assertions_request;
    request_class->parse_response = parse_get_assertions_response;
+   request_class->content_received = get_assertions_content_received;
+   request_class->deliver_item = get_assertions_deliver_item;
    gobject_class->finalize = snapd_get_assertions_finalize;
 }
 
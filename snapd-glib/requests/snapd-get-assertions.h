@@ -12,16 +12,28 @@
 
 #include "snapd-request.h"
 
+#include "snapd-client.h"
+
 G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (SnapdGetAssertions, snapd_get_assertions, SNAPD, GET_ASSERTIONS, SnapdRequest)
 
-SnapdGetAssertions *_snapd_get_assertions_new            (const gchar         *type,
-                                                          GCancellable        *cancellable,
-                                                          GAsyncReadyCallback  callback,
-                                                          gpointer             user_data);
+SnapdGetAssertions *_snapd_get_assertions_new                    (const gchar            *type,
+                                                                  GCancellable           *cancellable,
+                                                                  GAsyncReadyCallback     callback,
+                                                                  gpointer                user_data);
+
+void                _snapd_get_assertions_set_assertion_callback (SnapdGetAssertions     *request,
+                                                                  SnapdAssertionCallback  assertion_callback,
+                                                                  gpointer                assertion_callback_data);
+
+void                _snapd_get_assertions_set_filters            (SnapdGetAssertions     *request,
+                                                                  GHashTable             *filters);
+
+void                _snapd_get_assertions_set_headers_only       (SnapdGetAssertions     *request,
+                                                                  gboolean                headers_only);
 
-GStrv               _snapd_get_assertions_get_assertions (SnapdGetAssertions *request);
+GPtrArray          *_snapd_get_assertions_get_assertions         (SnapdGetAssertions     *request);
 
 G_END_DECLS
 
@@ -82,11 +82,12 @@ parse_get_changes_response (SnapdRequest *request, SoupMessage *message, SnapdMa
     if (result == NULL)
         return FALSE;
 
+    g_autoptr(SnapdStringPool) pool = _snapd_string_pool_new ();
     g_autoptr(GPtrArray) changes = g_ptr_array_new_with_free_func (g_object_unref);
     for (guint i = 0; i < json_array_get_length (result); i++) {
         JsonNode *node = json_array_get_element (result, i);
 
-        SnapdChange *change = _snapd_json_parse_change (node, error);
+        SnapdChange *change = _snapd_json_parse_change (node, pool, error);
         if (change == NULL)
             return FALSE;
 
@@ -10,6 +10,7 @@
 #include "snapd-get-connections.h"
 
 #include "snapd-connection.h"
+#include "snapd-connection-index-private.h"
 #include "snapd-error.h"
 #include "snapd-json.h"
 #include "snapd-plug.h"
@@ -27,6 +28,8 @@ struct _SnapdGetConnections
     GPtrArray *plugs;
     GPtrArray *slots;
     GPtrArray *undesired;
+    gboolean build_index;
+    SnapdConnectionIndex *index;
 };
 
 G_DEFINE_TYPE (SnapdGetConnections, snapd_get_connections, snapd_request_get_type ())
@@ -47,6 +50,12 @@ _snapd_get_connections_new (const gchar *snap, const gchar *interface, const gch
     return self;
 }
 
+void
+_snapd_get_connections_set_build_index (SnapdGetConnections *self, gboolean build_index)
+{
+    self->build_index = build_index;
+}
+
 GPtrArray *
 _snapd_get_connections_get_established (SnapdGetConnections *self)
 {
@@ -71,6 +80,12 @@ _snapd_get_connections_get_undesired (SnapdGetConnections *self)
     return self->undesired;
 }
 
+SnapdConnectionIndex *
+_snapd_get_connections_get_index (SnapdGetConnections *self)
+{
+    return self->index;
+}
+
 static SoupMessage *
 generate_get_connections_request (SnapdRequest *request)
 {
@@ -109,12 +124,13 @@ parse_get_connections_response (SnapdRequest *request, SoupMessage *message, Sna
     if (result == NULL)
         return FALSE;
 
+    g_autoptr(SnapdStringPool) pool = _snapd_string_pool_new ();
     g_autoptr(JsonArray) established = _snapd_json_get_array (result, "established");
     g_autoptr(GPtrArray) established_array = g_ptr_array_new_with_free_func (g_object_unref);
     for (guint i = 0; i < json_array_get_length (established); i++) {
         JsonNode *node = json_array_get_element (established, i);
 
-        g_autoptr(SnapdConnection) connection = _snapd_json_parse_connection (node, error);
+        g_autoptr(SnapdConnection) connection = _snapd_json_parse_connection (node, pool, error);
         if (connection == NULL)
             return FALSE;
 
@@ -126,7 +142,7 @@ parse_get_connections_response (SnapdRequest *request, SoupMessage *message, Sna
     for (guint i = 0; i < json_array_get_length (undesired); i++) {
         JsonNode *node = json_array_get_element (undesired, i);
 
-        SnapdConnection *connection = _snapd_json_parse_connection (node, error);
+        SnapdConnection *connection = _snapd_json_parse_connection (node, pool, error);
         if (connection == NULL)
             return FALSE;
 
@@ -138,7 +154,7 @@ parse_get_connections_response (SnapdRequest *request, SoupMessage *message, Sna
     for (guint i = 0; i < json_array_get_length (plugs); i++) {
         JsonNode *node = json_array_get_element (plugs, i);
 
-        SnapdPlug *plug = _snapd_json_parse_plug (node, error);
+        SnapdPlug *plug = _snapd_json_parse_plug (node, pool, error);
         if (plug == NULL)
             return FALSE;
 
@@ -150,7 +166,7 @@ parse_get_connections_response (SnapdRequest *request, SoupMessage *message, Sna
     for (guint i = 0; i < json_array_get_length (slots); i++) {
         JsonNode *node = json_array_get_element (slots, i);
 
-        SnapdSlot *slot = _snapd_json_parse_slot (node, error);
+        SnapdSlot *slot = _snapd_json_parse_slot (node, pool, error);
         if (slot == NULL)
             return FALSE;
 
@@ -162,6 +178,9 @@ parse_get_connections_response (SnapdRequest *request, SoupMessage *message, Sna
     self->plugs = g_steal_pointer (&plug_array);
     self->slots = g_steal_pointer (&slot_array);
 
+    if (self->build_index)
+        self->index = _snapd_connection_index_new (self->established, self->undesired, self->plugs, self->slots);
+
     return TRUE;
 }
 
@@ -177,6 +196,7 @@ snapd_get_connections_finalize (GObject *object)
     g_clear_pointer (&self->plugs, g_ptr_array_unref);
     g_clear_pointer (&self->slots, g_ptr_array_unref);
     g_clear_pointer (&self->undesired, g_ptr_array_unref);
+    g_clear_object (&self->index);
 
     G_OBJECT_CLASS (snapd_get_connections_parent_class)->finalize (object);
 }
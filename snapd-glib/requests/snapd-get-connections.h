@@ -12,6 +12,8 @@
 
 #include "snapd-request.h"
 
+#include "snapd-connection-index.h"
+
 G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (SnapdGetConnections, snapd_get_connections, SNAPD, GET_CONNECTIONS, SnapdRequest)
@@ -23,6 +25,9 @@ SnapdGetConnections *_snapd_get_connections_new             (const gchar
                                                              GAsyncReadyCallback  callback,
                                                              gpointer             user_data);
 
+void                 _snapd_get_connections_set_build_index (SnapdGetConnections *request,
+                                                             gboolean             build_index);
+
 GPtrArray           *_snapd_get_connections_get_established (SnapdGetConnections *request);
 
 GPtrArray           *_snapd_get_connections_get_plugs       (SnapdGetConnections *request);
@@ -31,6 +36,8 @@ GPtrArray           *_snapd_get_connections_get_slots       (SnapdGetConnections
 
 GPtrArray           *_snapd_get_connections_get_undesired   (SnapdGetConnections *request);
 
+SnapdConnectionIndex *_snapd_get_connections_get_index      (SnapdGetConnections *request);
+
 G_END_DECLS
 
 #endif /* __SNAPD_GET_CONNECTIONS_H__ */
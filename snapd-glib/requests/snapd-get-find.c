@@ -23,6 +23,12 @@ struct _SnapdGetFind
     gchar *scope;
     gchar *suggested_currency;
     GPtrArray *snaps;
+    SnapdSnapCallback snap_callback;
+    gpointer snap_callback_data;
+    gboolean defer_members;
+    SnapdJsonStream *stream;
+    SnapdStringPool *string_pool;
+    GError *stream_error;
 };
 
 G_DEFINE_TYPE (SnapdGetFind, snapd_get_find, snapd_request_get_type ())
@@ -81,6 +87,20 @@ _snapd_get_find_set_scope (SnapdGetFind *self, const gchar *scope)
     self->scope = g_strdup (scope);
 }
 
+void
+_snapd_get_find_set_snap_callback (SnapdGetFind *self, SnapdSnapCallback snap_callback, gpointer snap_callback_data)
+{
+    self->snap_callback = snap_callback;
+    self->snap_callback_data = snap_callback_data;
+}
+
+/* Parse the apps, channels, media and prices of each snap when they are first used */
+void
+_snapd_get_find_set_defer_members (SnapdGetFind *self, gboolean defer_members)
+{
+    self->defer_members = defer_members;
+}
+
 GPtrArray *
 _snapd_get_find_get_snaps (SnapdGetFind *self)
 {
@@ -137,11 +157,67 @@ generate_get_find_request (SnapdRequest *request)
     return soup_message_new ("GET", path->str);
 }
 
+static gboolean
+stream_snap_cb (const gchar *data, gsize length, gpointer user_data, GError **error)
+{
+    SnapdGetFind *self = user_data;
+
+    g_autoptr(SnapdSnap) snap = _snapd_json_parse_snap_data (data, length, self->string_pool, self->defer_members, SNAPD_JSON_PARSER_TOKENIZER, error);
+    if (snap == NULL)
+        return FALSE;
+
+    /* Report from the request context, we may be holding the connection lock */
+    _snapd_request_deliver (SNAPD_REQUEST (self), G_OBJECT (snap));
+
+    return TRUE;
+}
+
+static void
+get_find_deliver_item (SnapdRequest *request, GObject *item)
+{
+    SnapdGetFind *self = SNAPD_GET_FIND (request);
+
+    g_autoptr(GObject) client = g_async_result_get_source_object (G_ASYNC_RESULT (self));
+    self->snap_callback (SNAPD_CLIENT (client), SNAPD_SNAP (item), self->snap_callback_data);
+}
+
+static gboolean
+get_find_content_received (SnapdRequest *request, const gchar *data, gsize length)
+{
+    SnapdGetFind *self = SNAPD_GET_FIND (request);
+
+    if (self->snap_callback == NULL)
+        return FALSE;
+
+    if (self->stream == NULL) {
+        self->stream = _snapd_json_stream_new ("result", stream_snap_cb, self);
+        self->string_pool = _snapd_string_pool_new ();
+    }
+    if (self->stream_error == NULL)
+        _snapd_json_stream_feed (self->stream, data, length, &self->stream_error);
+
+    return TRUE;
+}
+
 static gboolean
 parse_get_find_response (SnapdRequest *request, SoupMessage *message, SnapdMaintenance **maintenance, GError **error)
 {
     SnapdGetFind *self = SNAPD_GET_FIND (request);
 
+    /* Snaps have already been reported, check the rest of the response */
+    if (self->stream_error != NULL) {
+        g_propagate_error (error, g_steal_pointer (&self->stream_error));
+        return FALSE;
+    }
+    g_autoptr(GPtrArray) snaps = g_ptr_array_new_with_free_func (g_object_unref);
+    if (self->stream != NULL) {
+        g_autoptr(GBytes) envelope = _snapd_json_stream_get_envelope (self->stream);
+        soup_message_body_append (message->response_body, SOUP_MEMORY_COPY, g_bytes_get_data (envelope, NULL), g_bytes_get_size (envelope));
+    }
+    /* Parse the snaps directly from the data to avoid building a large JSON tree */
+    else if (!_snapd_json_parse_snaps (message, snaps, self->defer_members, error))
+        return FALSE;
+
     g_autoptr(JsonObject) response = _snapd_json_parse_response (message, maintenance, error);
     if (response == NULL)
         return FALSE;
@@ -149,18 +225,6 @@ parse_get_find_response (SnapdRequest *request, SoupMessage *message, SnapdMaint
     if (result == NULL)
         return FALSE;
 
-    g_autoptr(GPtrArray) snaps = g_ptr_array_new_with_free_func (g_object_unref);
-    for (guint i = 0; i < json_array_get_length (result); i++) {
-        JsonNode *node = json_array_get_element (result, i);
-        SnapdSnap *snap;
-
-        snap = _snapd_json_parse_snap (node, error);
-        if (snap == NULL)
-            return FALSE;
-
-        g_ptr_array_add (snaps, snap);
-    }
-
     self->snaps = g_steal_pointer (&snaps);
     self->suggested_currency = g_strdup (_snapd_json_get_string (response, "suggested-currency", NULL));
 
@@ -180,6 +244,9 @@ snapd_get_find_finalize (GObject *object)
     g_free (self->scope);
     g_free (self->suggested_currency);
     g_clear_pointer (&self->snaps, g_ptr_array_unref);
+    g_clear_pointer (&self->stream, _snapd_json_stream_free);
+    g_clear_pointer (&self->string_pool, _snapd_string_pool_free);
+    g_clear_error (&self->stream_error);
 
     G_OBJECT_CLASS (snapd_get_find_parent_class)->finalize (object);
 }
@@ -192,6 +259,8 @@ snapd_get_find_class_init (SnapdGetFindClass *klass)
 
    request_class->generate_request = generate_get_find_request;
    request_class->parse_response = parse_get_find_response;
+   request_class->content_received = get_find_content_received;
+   request_class->deliver_item = get_find_deliver_item;
    gobject_class->finalize = snapd_get_find_finalize;
 }
 
@@ -12,6 +12,8 @@
 
 #include "snapd-request.h"
 
+#include "snapd-client.h"
+
 G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (SnapdGetFind, snapd_get_find, SNAPD, GET_FIND, SnapdRequest)
@@ -38,6 +40,13 @@ void          _snapd_get_find_set_section            (SnapdGetFind        *reque
 void          _snapd_get_find_set_scope              (SnapdGetFind        *request,
                                                       const gchar         *scope);
 
+void          _snapd_get_find_set_snap_callback      (SnapdGetFind        *request,
+                                                      SnapdSnapCallback    snap_callback,
+                                                      gpointer             snap_callback_data);
+
+void          _snapd_get_find_set_defer_members      (SnapdGetFind        *request,
+                                                      gboolean             defer_members);
+
 GPtrArray    *_snapd_get_find_get_snaps              (SnapdGetFind        *request);
 
 const gchar  *_snapd_get_find_get_suggested_currency (SnapdGetFind        *request);
@@ -16,6 +16,7 @@ struct _SnapdGetIcon
 {
     SnapdRequest parent_instance;
     gchar *name;
+    gchar *revision;
     SnapdIcon *icon;
 };
 
@@ -34,6 +35,32 @@ _snapd_get_icon_new (const gchar *name, GCancellable *cancellable, GAsyncReadyCa
     return self;
 }
 
+const gchar *
+_snapd_get_icon_get_name (SnapdGetIcon *self)
+{
+    return self->name;
+}
+
+/* Revision of the snap the icon is for, used to cache the icon */
+void
+_snapd_get_icon_set_revision (SnapdGetIcon *self, const gchar *revision)
+{
+    g_free (self->revision);
+    self->revision = g_strdup (revision);
+}
+
+const gchar *
+_snapd_get_icon_get_revision (SnapdGetIcon *self)
+{
+    return self->revision;
+}
+
+void
+_snapd_get_icon_set_icon (SnapdGetIcon *self, SnapdIcon *icon)
+{
+    g_set_object (&self->icon, icon);
+}
+
 SnapdIcon *
 _snapd_get_icon_get_icon (SnapdGetIcon *self)
 {
@@ -98,6 +125,7 @@ snapd_get_icon_finalize (GObject *object)
     SnapdGetIcon *self = SNAPD_GET_ICON (object);
 
     g_clear_pointer (&self->name, g_free);
+    g_clear_pointer (&self->revision, g_free);
     g_clear_object (&self->icon);
 
     G_OBJECT_CLASS (snapd_get_icon_parent_class)->finalize (object);
@@ -18,12 +18,22 @@ G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (SnapdGetIcon, snapd_get_icon, SNAPD, GET_ICON, SnapdRequest)
 
-SnapdGetIcon *_snapd_get_icon_new      (const gchar         *name,
-                                        GCancellable        *cancellable,
-                                        GAsyncReadyCallback  callback,
-                                        gpointer             user_data);
+SnapdGetIcon *_snapd_get_icon_new          (const gchar         *name,
+                                            GCancellable        *cancellable,
+                                            GAsyncReadyCallback  callback,
+                                            gpointer             user_data);
 
-SnapdIcon    *_snapd_get_icon_get_icon (SnapdGetIcon *request);
+const gchar  *_snapd_get_icon_get_name     (SnapdGetIcon        *request);
+
+void          _snapd_get_icon_set_revision (SnapdGetIcon        *request,
+                                            const gchar         *revision);
+
+const gchar  *_snapd_get_icon_get_revision (SnapdGetIcon        *request);
+
+void          _snapd_get_icon_set_icon     (SnapdGetIcon        *request,
+                                            SnapdIcon           *icon);
+
+SnapdIcon    *_snapd_get_icon_get_icon     (SnapdGetIcon        *request);
 
 G_END_DECLS
 
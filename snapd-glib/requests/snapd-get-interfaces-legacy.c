@@ -65,12 +65,13 @@ parse_get_interfaces_legacy_response (SnapdRequest *request, SoupMessage *messag
     if (result == NULL)
         return FALSE;
 
+    g_autoptr(SnapdStringPool) pool = _snapd_string_pool_new ();
     g_autoptr(JsonArray) plugs = _snapd_json_get_array (result, "plugs");
     g_autoptr(GPtrArray) plug_array = g_ptr_array_new_with_free_func (g_object_unref);
     for (guint i = 0; i < json_array_get_length (plugs); i++) {
         JsonNode *node = json_array_get_element (plugs, i);
 
-        SnapdPlug *plug = _snapd_json_parse_plug (node, error);
+        SnapdPlug *plug = _snapd_json_parse_plug (node, pool, error);
         if (plug == NULL)
             return FALSE;
 
@@ -81,7 +82,7 @@ parse_get_interfaces_legacy_response (SnapdRequest *request, SoupMessage *messag
     for (guint i = 0; i < json_array_get_length (slots); i++) {
         JsonNode *node = json_array_get_element (slots, i);
 
-        SnapdSlot *slot = _snapd_json_parse_slot (node, error);
+        SnapdSlot *slot = _snapd_json_parse_slot (node, pool, error);
         if (slot == NULL)
             return FALSE;
 
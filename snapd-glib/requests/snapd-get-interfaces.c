@@ -114,12 +114,13 @@ parse_get_interfaces_response (SnapdRequest *request, SoupMessage *message, Snap
     if (result == NULL)
         return FALSE;
 
+    g_autoptr(SnapdStringPool) pool = _snapd_string_pool_new ();
     g_autoptr(GPtrArray) interfaces = g_ptr_array_new_with_free_func (g_object_unref);
     for (guint i = 0; i < json_array_get_length (result); i++) {
         JsonNode *node = json_array_get_element (result, i);
         SnapdInterface *interface;
 
-        interface = _snapd_json_parse_interface (node, error);
+        interface = _snapd_json_parse_interface (node, pool, error);
         if (interface == NULL)
             return FALSE;
 
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#include "snapd-get-notices.h"
+
+#include "snapd-json.h"
+
+struct _SnapdGetNotices
+{
+    SnapdRequest parent_instance;
+    gchar *types;
+    gchar *after;
+    guint timeout;
+    GStrv keys;
+    gchar *last_occurred;
+};
+
+G_DEFINE_TYPE (SnapdGetNotices, snapd_get_notices, snapd_request_get_type ())
+
+SnapdGetNotices *
+_snapd_get_notices_new (const gchar *types, const gchar *after, guint timeout, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    SnapdGetNotices *self = SNAPD_GET_NOTICES (g_object_new (snapd_get_notices_get_type (),
+                                                             "cancellable", cancellable,
+                                                             "ready-callback", callback,
+                                                             "ready-callback-data", user_data,
+                                                             NULL));
+    self->types = g_strdup (types);
+    self->after = g_strdup (after);
+    self->timeout = timeout;
+
+    return self;
+}
+
+GStrv
+_snapd_get_notices_get_keys (SnapdGetNotices *self)
+{
+    return self->keys;
+}
+
+const gchar *
+_snapd_get_notices_get_last_occurred (SnapdGetNotices *self)
+{
+    return self->last_occurred;
+}
+
+static SoupMessage *
+generate_get_notices_request (SnapdRequest *request)
+{
+    SnapdGetNotices *self = SNAPD_GET_NOTICES (request);
+
+    g_autoptr(GPtrArray) query_attributes = g_ptr_array_new_with_free_func (g_free);
+    if (self->types != NULL) {
+        g_autofree gchar *escaped = soup_uri_encode (self->types, NULL);
+        g_ptr_array_add (query_attributes, g_strdup_printf ("types=%s", escaped));
+    }
+    if (self->after != NULL) {
+        g_autofree gchar *escaped = soup_uri_encode (self->after, "+");
+        g_ptr_array_add (query_attributes, g_strdup_printf ("after=%s", escaped));
+    }
+    if (self->timeout > 0)
+        g_ptr_array_add (query_attributes, g_strdup_printf ("timeout=%us", self->timeout));
+
+    g_autoptr(GString) path = g_string_new ("http://snapd/v2/notices");
+    if (query_attributes->len > 0) {
+        g_string_append_c (path, '?');
+        for (guint i = 0; i < query_attributes->len; i++) {
+            if (i != 0)
+                g_string_append_c (path, '&');
+            g_string_append (path, (gchar *) query_attributes->pdata[i]);
+        }
+    }
+
+    return soup_message_new ("GET", path->str);
+}
+
+static gboolean
+parse_get_notices_response (SnapdRequest *request, SoupMessage *message, SnapdMaintenance **maintenance, GError **error)
+{
+    SnapdGetNotices *self = SNAPD_GET_NOTICES (request);
+
+    g_autoptr(JsonObject) response = _snapd_json_parse_response (message, maintenance, error);
+    if (response == NULL)
+        return FALSE;
+    g_autoptr(JsonArray) result = _snapd_json_get_sync_result_a (response, error);
+    if (result == NULL)
+        return FALSE;
+
+    g_autoptr(GPtrArray) keys = g_ptr_array_new ();
+    g_autoptr(GDateTime) last_occurred = NULL;
+    for (guint i = 0; i < json_array_get_length (result); i++) {
+        JsonNode *node = json_array_get_element (result, i);
+
+        if (json_node_get_value_type (node) != JSON_TYPE_OBJECT)
+            continue;
+        JsonObject *object = json_node_get_object (node);
+
+        const gchar *key = _snapd_json_get_string (object, "key", NULL);
+        if (key != NULL)
+            g_ptr_array_add (keys, g_strdup (key));
+
+        /* Keep the time as snapd formatted it, so it can be passed back without losing precision */
+        g_autoptr(GDateTime) occurred = _snapd_json_get_date_time (object, "last-occurred");
+        if (occurred != NULL && (last_occurred == NULL || g_date_time_compare (occurred, last_occurred) > 0)) {
+            g_clear_pointer (&last_occurred, g_date_time_unref);
+            last_occurred = g_date_time_ref (occurred);
+            g_free (self->last_occurred);
+            self->last_occurred = g_strdup (_snapd_json_get_string (object, "last-occurred", NULL));
+        }
+    }
+    g_ptr_array_add (keys, NULL);
+
+    self->keys = (GStrv) g_ptr_array_free (g_steal_pointer (&keys), FALSE);
+
+    return TRUE;
+}
+
+static void
+snapd_get_notices_finalize (GObject *object)
+{
+    SnapdGetNotices *self = SNAPD_GET_NOTICES (object);
+
+    g_clear_pointer (&self->types, g_free);
+    g_clear_pointer (&self->after, g_free);
+    g_clear_pointer (&self->keys, g_strfreev);
+    g_clear_pointer (&self->last_occurred, g_free);
+
+    G_OBJECT_CLASS (snapd_get_notices_parent_class)->finalize (object);
+}
+
+static void
+snapd_get_notices_class_init (SnapdGetNoticesClass *klass)
+{
+   SnapdRequestClass *request_class = SNAPD_REQUEST_CLASS (klass);
+   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+   request_class->generate_request = generate_get_notices_request;
+   request_class->parse_response = parse_get_notices_response;
+   gobject_class->finalize = snapd_get_notices_finalize;
+}
+
+static void
+snapd_get_notices_init (SnapdGetNotices *self)
+{
+}
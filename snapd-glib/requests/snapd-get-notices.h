@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_GET_NOTICES_H__
+#define __SNAPD_GET_NOTICES_H__
+
+#include "snapd-request.h"
+
+G_BEGIN_DECLS
+
+G_DECLARE_FINAL_TYPE (SnapdGetNotices, snapd_get_notices, SNAPD, GET_NOTICES, SnapdRequest)
+
+SnapdGetNotices *_snapd_get_notices_new                (const gchar         *types,
+                                                        const gchar         *after,
+                                                        guint                timeout,
+                                                        GCancellable        *cancellable,
+                                                        GAsyncReadyCallback  callback,
+                                                        gpointer             user_data);
+
+GStrv            _snapd_get_notices_get_keys           (SnapdGetNotices *request);
+
+const gchar     *_snapd_get_notices_get_last_occurred  (SnapdGetNotices *request);
+
+G_END_DECLS
+
+#endif /* __SNAPD_GET_NOTICES_H__ */
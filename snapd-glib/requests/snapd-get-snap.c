@@ -64,7 +64,7 @@ parse_get_snap_response (SnapdRequest *request, SoupMessage *message, SnapdMaint
     if (result == NULL)
         return FALSE;
 
-    g_autoptr(SnapdSnap) snap = _snapd_json_parse_snap (result, error);
+    g_autoptr(SnapdSnap) snap = _snapd_json_parse_snap (result, NULL, error);
     json_node_unref (result);
     if (snap == NULL)
         return FALSE;
@@ -10,6 +10,8 @@
 #include "snapd-get-snaps.h"
 
 #include "snapd-json.h"
+#include "snapd-snap-set-private.h"
+#include "snapd-task-private.h"
 
 struct _SnapdGetSnaps
 {
@@ -17,6 +19,15 @@ struct _SnapdGetSnaps
     gchar *select;
     GStrv names;
     GPtrArray *snaps;
+    GHashTable *revisions;
+    SnapdSnapCallback snap_callback;
+    gpointer snap_callback_data;
+    gboolean defer_members;
+    SnapdSnapSet *snap_set;
+    GArray *fingerprints;
+    SnapdJsonStream *stream;
+    SnapdStringPool *string_pool;
+    GError *stream_error;
 };
 
 G_DEFINE_TYPE (SnapdGetSnaps, snapd_get_snaps, snapd_request_get_type ())
@@ -42,12 +53,53 @@ _snapd_get_snaps_set_select (SnapdGetSnaps *self, const gchar *select)
     self->select = g_strdup (select);
 }
 
+void
+_snapd_get_snaps_set_snap_callback (SnapdGetSnaps *self, SnapdSnapCallback snap_callback, gpointer snap_callback_data)
+{
+    self->snap_callback = snap_callback;
+    self->snap_callback_data = snap_callback_data;
+}
+
+/* Parse the apps, channels, media and prices of each snap when they are first used */
+void
+_snapd_get_snaps_set_defer_members (SnapdGetSnaps *self, gboolean defer_members)
+{
+    self->defer_members = defer_members;
+}
+
+/* Reuse snaps from @snap_set that haven't changed instead of parsing them again */
+void
+_snapd_get_snaps_set_snap_set (SnapdGetSnaps *self, SnapdSnapSet *snap_set)
+{
+    g_set_object (&self->snap_set, snap_set);
+}
+
+SnapdSnapSet *
+_snapd_get_snaps_get_snap_set (SnapdGetSnaps *self)
+{
+    return self->snap_set;
+}
+
+/* Fingerprints of the data each snap was parsed from */
+GArray *
+_snapd_get_snaps_get_fingerprints (SnapdGetSnaps *self)
+{
+    return self->fingerprints;
+}
+
 GPtrArray *
 _snapd_get_snaps_get_snaps (SnapdGetSnaps *self)
 {
     return self->snaps;
 }
 
+/* Revisions of the snaps reported to the snap callback, keyed by name */
+GHashTable *
+_snapd_get_snaps_get_revisions (SnapdGetSnaps *self)
+{
+    return self->revisions;
+}
+
 static SoupMessage *
 generate_get_snaps_request (SnapdRequest *request)
 {
@@ -74,11 +126,89 @@ generate_get_snaps_request (SnapdRequest *request)
     return soup_message_new ("GET", path->str);
 }
 
+static gboolean
+stream_snap_cb (const gchar *data, gsize length, gpointer user_data, GError **error)
+{
+    SnapdGetSnaps *self = user_data;
+
+    g_autoptr(SnapdSnap) snap = NULL;
+    if (self->snap_set != NULL) {
+        guint64 fingerprint = _snapd_fingerprint_add_data (SNAPD_FINGERPRINT_INIT, data, length);
+        g_array_append_val (self->fingerprints, fingerprint);
+        SnapdSnap *unchanged_snap = _snapd_snap_set_lookup_fingerprint (self->snap_set, fingerprint);
+        if (unchanged_snap != NULL)
+            snap = g_object_ref (unchanged_snap);
+    }
+    if (snap == NULL)
+        snap = _snapd_json_parse_snap_data (data, length, self->string_pool, self->defer_members, SNAPD_JSON_PARSER_TOKENIZER, error);
+    if (snap == NULL)
+        return FALSE;
+
+    if (snapd_snap_get_name (snap) != NULL && snapd_snap_get_status (snap) == SNAPD_SNAP_STATUS_ACTIVE)
+        g_hash_table_insert (self->revisions, g_strdup (snapd_snap_get_name (snap)), g_strdup (snapd_snap_get_revision (snap)));
+
+    if (self->snap_set != NULL) {
+        g_ptr_array_add (self->snaps, g_steal_pointer (&snap));
+        return TRUE;
+    }
+
+    /* Report from the request context, we may be holding the connection lock */
+    _snapd_request_deliver (SNAPD_REQUEST (self), G_OBJECT (snap));
+
+    return TRUE;
+}
+
+static void
+get_snaps_deliver_item (SnapdRequest *request, GObject *item)
+{
+    SnapdGetSnaps *self = SNAPD_GET_SNAPS (request);
+
+    g_autoptr(GObject) client = g_async_result_get_source_object (G_ASYNC_RESULT (self));
+    self->snap_callback (SNAPD_CLIENT (client), SNAPD_SNAP (item), self->snap_callback_data);
+}
+
+static gboolean
+get_snaps_content_received (SnapdRequest *request, const gchar *data, gsize length)
+{
+    SnapdGetSnaps *self = SNAPD_GET_SNAPS (request);
+
+    if (self->snap_callback == NULL && self->snap_set == NULL)
+        return FALSE;
+
+    if (self->stream == NULL) {
+        self->stream = _snapd_json_stream_new ("result", stream_snap_cb, self);
+        self->string_pool = _snapd_string_pool_new ();
+        self->revisions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+        if (self->snap_set != NULL) {
+            self->snaps = g_ptr_array_new_with_free_func (g_object_unref);
+            self->fingerprints = g_array_new (FALSE, FALSE, sizeof (guint64));
+        }
+    }
+    if (self->stream_error == NULL)
+        _snapd_json_stream_feed (self->stream, data, length, &self->stream_error);
+
+    return TRUE;
+}
+
 static gboolean
 parse_get_snaps_response (SnapdRequest *request, SoupMessage *message, SnapdMaintenance **maintenance, GError **error)
 {
     SnapdGetSnaps *self = SNAPD_GET_SNAPS (request);
 
+    /* Snaps have already been reported, check the rest of the response */
+    if (self->stream_error != NULL) {
+        g_propagate_error (error, g_steal_pointer (&self->stream_error));
+        return FALSE;
+    }
+    g_autoptr(GPtrArray) snaps = g_ptr_array_new_with_free_func (g_object_unref);
+    if (self->stream != NULL) {
+        g_autoptr(GBytes) envelope = _snapd_json_stream_get_envelope (self->stream);
+        soup_message_body_append (message->response_body, SOUP_MEMORY_COPY, g_bytes_get_data (envelope, NULL), g_bytes_get_size (envelope));
+    }
+    /* Parse the snaps directly from the data to avoid building a large JSON tree */
+    else if (!_snapd_json_parse_snaps (message, snaps, self->defer_members, error))
+        return FALSE;
+
     g_autoptr(JsonObject) response = _snapd_json_parse_response (message, maintenance, error);
     if (response == NULL)
         return FALSE;
@@ -86,19 +216,9 @@ parse_get_snaps_response (SnapdRequest *request, SoupMessage *message, SnapdMain
     if (result == NULL)
         return FALSE;
 
-    g_autoptr(GPtrArray) snaps = g_ptr_array_new_with_free_func (g_object_unref);
-    for (guint i = 0; i < json_array_get_length (result); i++) {
-        JsonNode *node = json_array_get_element (result, i);
-        SnapdSnap *snap;
-
-        snap = _snapd_json_parse_snap (node, error);
-        if (snap == NULL)
-            return FALSE;
-
-        g_ptr_array_add (snaps, snap);
-    }
-
-    self->snaps = g_steal_pointer (&snaps);
+    /* Snaps collected for a snap set have already been parsed */
+    if (self->snaps == NULL)
+        self->snaps = g_steal_pointer (&snaps);
 
     return TRUE;
 }
@@ -111,6 +231,12 @@ snapd_get_snaps_finalize (GObject *object)
     g_clear_pointer (&self->select, g_free);
     g_clear_pointer (&self->names, g_strfreev);
     g_clear_pointer (&self->snaps, g_ptr_array_unref);
+    g_clear_object (&self->snap_set);
+    g_clear_pointer (&self->fingerprints, g_array_unref);
+    g_clear_pointer (&self->revisions, g_hash_table_unref);
+    g_clear_pointer (&self->stream, _snapd_json_stream_free);
+    g_clear_pointer (&self->string_pool, _snapd_string_pool_free);
+    g_clear_error (&self->stream_error);
 
     G_OBJECT_CLASS (snapd_get_snaps_parent_class)->finalize (object);
 }
@@ -123,6 +249,8 @@ snapd_get_snaps_class_init (SnapdGetSnapsClass *klass)
 
    request_class->generate_request = generate_get_snaps_request;
    request_class->parse_response = parse_get_snaps_response;
+   request_class->content_received = get_snaps_content_received;
+   request_class->deliver_item = get_snaps_deliver_item;
    gobject_class->finalize = snapd_get_snaps_finalize;
 }
 
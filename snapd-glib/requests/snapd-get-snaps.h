@@ -12,19 +12,37 @@
 
 #include "snapd-request.h"
 
+#include "snapd-client.h"
+
 G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (SnapdGetSnaps, snapd_get_snaps, SNAPD, GET_SNAPS, SnapdRequest)
 
-SnapdGetSnaps *_snapd_get_snaps_new       (GCancellable        *cancellable,
-                                           GStrv                names,
-                                           GAsyncReadyCallback  callback,
-                                           gpointer             user_data);
+SnapdGetSnaps *_snapd_get_snaps_new               (GCancellable        *cancellable,
+                                                  GStrv                names,
+                                                  GAsyncReadyCallback  callback,
+                                                  gpointer             user_data);
+
+void          _snapd_get_snaps_set_select        (SnapdGetSnaps       *request,
+                                                  const gchar         *select);
+
+void          _snapd_get_snaps_set_snap_callback (SnapdGetSnaps       *request,
+                                                  SnapdSnapCallback    snap_callback,
+                                                  gpointer             snap_callback_data);
+
+void          _snapd_get_snaps_set_defer_members (SnapdGetSnaps       *request,
+                                                  gboolean             defer_members);
+
+void          _snapd_get_snaps_set_snap_set      (SnapdGetSnaps       *request,
+                                                  SnapdSnapSet        *snap_set);
+
+SnapdSnapSet *_snapd_get_snaps_get_snap_set      (SnapdGetSnaps       *request);
+
+GArray       *_snapd_get_snaps_get_fingerprints  (SnapdGetSnaps       *request);
 
-void          _snapd_get_snaps_set_select (SnapdGetSnaps       *request,
-                                           const gchar         *select);
+GPtrArray    *_snapd_get_snaps_get_snaps         (SnapdGetSnaps       *request);
 
-GPtrArray    *_snapd_get_snaps_get_snaps  (SnapdGetSnaps *request);
+GHashTable   *_snapd_get_snaps_get_revisions     (SnapdGetSnaps       *request);
 
 G_END_DECLS
 
@@ -13,10 +13,19 @@
 #include "snapd-json.h"
 
 #include "snapd-error.h"
-#include "snapd-app.h"
-#include "snapd-media.h"
+#include "snapd-app-private.h"
+#include "snapd-change-private.h"
+#include "snapd-channel-private.h"
+#include "snapd-connection-private.h"
+#include "snapd-media-private.h"
+#include "snapd-plug-private.h"
+#include "snapd-plug-ref-private.h"
 #include "snapd-screenshot.h"
-#include "snapd-task.h"
+#include "snapd-slot-private.h"
+#include "snapd-slot-ref-private.h"
+#include "snapd-snap-private.h"
+#include "snapd-string-pool.h"
+#include "snapd-task-private.h"
 
 void
 _snapd_json_set_body (SoupMessage *message, JsonBuilder *builder)
@@ -137,13 +146,9 @@ is_timezone_prefix (gchar c)
     return c == '+' || c == '-' || c == 'Z';
 }
 
-GDateTime *
-_snapd_json_get_date_time (JsonObject *object, const gchar *name)
+static GDateTime *
+parse_date_time (const gchar *value)
 {
-    const gchar *value = _snapd_json_get_string (object, name, NULL);
-    if (value == NULL)
-        return NULL;
-
     /* Example: 2016-05-17T09:36:53+12:00 */
     g_auto(GStrv) tokens = g_strsplit (value, "T", 2);
     gint year = 0, month = 0, day = 0;
@@ -175,6 +180,16 @@ _snapd_json_get_date_time (JsonObject *object, const gchar *name)
     return g_date_time_new (timezone, year, month, day, hour, minute, seconds);
 }
 
+GDateTime *
+_snapd_json_get_date_time (JsonObject *object, const gchar *name)
+{
+    const gchar *value = _snapd_json_get_string (object, name, NULL);
+    if (value == NULL)
+        return NULL;
+
+    return parse_date_time (value);
+}
+
 static void
 parse_error_response (JsonObject *root, GError **error)
 {
@@ -481,7 +496,7 @@ _snapd_json_get_async_result (JsonObject *response, GError **error)
 }
 
 SnapdChange *
-_snapd_json_parse_change (JsonNode *node, GError **error)
+_snapd_json_parse_change (JsonNode *node, SnapdStringPool *pool, GError **error)
 {
     if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
         g_set_error (error,
@@ -506,37 +521,28 @@ _snapd_json_parse_change (JsonNode *node, GError **error)
         }
         JsonObject *object = json_node_get_object (node);
         JsonObject *progress = _snapd_json_get_object (object, "progress");
-        g_autoptr(GDateTime) spawn_time = _snapd_json_get_date_time (object, "spawn-time");
-        g_autoptr(GDateTime) ready_time = _snapd_json_get_date_time (object, "ready-time");
-
-        g_autoptr(SnapdTask) t = g_object_new (SNAPD_TYPE_TASK,
-                                               "id", _snapd_json_get_string (object, "id", NULL),
-                                               "kind", _snapd_json_get_string (object, "kind", NULL),
-                                               "summary", _snapd_json_get_string (object, "summary", NULL),
-                                               "status", _snapd_json_get_string (object, "status", NULL),
-                                               "progress-label", progress != NULL ? _snapd_json_get_string (progress, "label", NULL) : NULL,
-                                               "progress-done", progress != NULL ? _snapd_json_get_int (progress, "done", 0) : 0,
-                                               "progress-total", progress != NULL ? _snapd_json_get_int (progress, "total", 0) : 0,
-                                               "spawn-time", spawn_time,
-                                               "ready-time", ready_time,
-                                               NULL);
-        g_ptr_array_add (tasks, g_steal_pointer (&t));
-    }
-
-    g_autoptr(GDateTime) main_spawn_time = _snapd_json_get_date_time (object, "spawn-time");
-    g_autoptr(GDateTime) main_ready_time = _snapd_json_get_date_time (object, "ready-time");
-
-    return g_object_new (SNAPD_TYPE_CHANGE,
-                         "id", _snapd_json_get_string (object, "id", NULL),
-                         "kind", _snapd_json_get_string (object, "kind", NULL),
-                         "summary", _snapd_json_get_string (object, "summary", NULL),
-                         "status", _snapd_json_get_string (object, "status", NULL),
-                         "tasks", tasks,
-                         "ready", _snapd_json_get_bool (object, "ready", FALSE),
-                         "spawn-time", main_spawn_time,
-                         "ready-time", main_ready_time,
-                         "error", _snapd_json_get_string (object, "err", NULL),
-                         NULL);
+
+        SnapdTask *t = _snapd_task_new (g_strdup (_snapd_json_get_string (object, "id", NULL)),
+                                        _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "kind", NULL)),
+                                        g_strdup (_snapd_json_get_string (object, "summary", NULL)),
+                                        _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "status", NULL)),
+                                        progress != NULL ? g_strdup (_snapd_json_get_string (progress, "label", NULL)) : NULL,
+                                        progress != NULL ? _snapd_json_get_int (progress, "done", 0) : 0,
+                                        progress != NULL ? _snapd_json_get_int (progress, "total", 0) : 0,
+                                        _snapd_json_get_date_time (object, "spawn-time"),
+                                        _snapd_json_get_date_time (object, "ready-time"));
+        g_ptr_array_add (tasks, t);
+    }
+
+    return _snapd_change_new (g_strdup (_snapd_json_get_string (object, "id", NULL)),
+                              _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "kind", NULL)),
+                              g_strdup (_snapd_json_get_string (object, "summary", NULL)),
+                              _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "status", NULL)),
+                              g_steal_pointer (&tasks),
+                              _snapd_json_get_bool (object, "ready", FALSE),
+                              _snapd_json_get_date_time (object, "spawn-time"),
+                              _snapd_json_get_date_time (object, "ready-time"),
+                              g_strdup (_snapd_json_get_string (object, "err", NULL)));
 }
 
 static SnapdConfinement
@@ -632,150 +638,357 @@ _snapd_json_parse_system_information (JsonNode *node, GError **error)
                          NULL);
 }
 
-SnapdSnap *
-_snapd_json_parse_snap (JsonNode *node, GError **error)
+static SnapdSnapType
+parse_snap_type (const gchar *value)
 {
-    if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
-        g_set_error (error,
-                     SNAPD_ERROR,
-                     SNAPD_ERROR_READ_FAILED,
-                     "Unexpected snap type");
-        return NULL;
-    }
-    JsonObject *object = json_node_get_object (node);
+    if (strcmp (value, "app") == 0)
+        return SNAPD_SNAP_TYPE_APP;
+    else if (strcmp (value, "kernel") == 0)
+        return SNAPD_SNAP_TYPE_KERNEL;
+    else if (strcmp (value, "gadget") == 0)
+        return SNAPD_SNAP_TYPE_GADGET;
+    else if (strcmp (value, "os") == 0)
+        return SNAPD_SNAP_TYPE_OS;
+    else if (strcmp (value, "core") == 0)
+        return SNAPD_SNAP_TYPE_CORE;
+    else if (strcmp (value, "base") == 0)
+        return SNAPD_SNAP_TYPE_BASE;
+    else if (strcmp (value, "snapd") == 0)
+        return SNAPD_SNAP_TYPE_SNAPD;
+    else
+        return SNAPD_SNAP_TYPE_UNKNOWN;
+}
+
+static SnapdSnapStatus
+parse_snap_status (const gchar *value)
+{
+    if (strcmp (value, "available") == 0)
+        return SNAPD_SNAP_STATUS_AVAILABLE;
+    else if (strcmp (value, "priced") == 0)
+        return SNAPD_SNAP_STATUS_PRICED;
+    else if (strcmp (value, "installed") == 0)
+        return SNAPD_SNAP_STATUS_INSTALLED;
+    else if (strcmp (value, "active") == 0)
+        return SNAPD_SNAP_STATUS_ACTIVE;
+    else
+        return SNAPD_SNAP_STATUS_UNKNOWN;
+}
 
-    const gchar *name = _snapd_json_get_string (object, "name", NULL);
-
-    SnapdConfinement confinement = parse_confinement (_snapd_json_get_string (object, "confinement", ""));
-
-    const gchar *snap_type_string = _snapd_json_get_string (object, "type", "");
-    SnapdSnapType snap_type = SNAPD_SNAP_TYPE_UNKNOWN;
-    if (strcmp (snap_type_string, "app") == 0)
-        snap_type = SNAPD_SNAP_TYPE_APP;
-    else if (strcmp (snap_type_string, "kernel") == 0)
-        snap_type = SNAPD_SNAP_TYPE_KERNEL;
-    else if (strcmp (snap_type_string, "gadget") == 0)
-        snap_type = SNAPD_SNAP_TYPE_GADGET;
-    else if (strcmp (snap_type_string, "os") == 0)
-        snap_type = SNAPD_SNAP_TYPE_OS;
-    else if (strcmp (snap_type_string, "core") == 0)
-        snap_type = SNAPD_SNAP_TYPE_CORE;
-    else if (strcmp (snap_type_string, "base") == 0)
-        snap_type = SNAPD_SNAP_TYPE_BASE;
-    else if (strcmp (snap_type_string, "snapd") == 0)
-        snap_type = SNAPD_SNAP_TYPE_SNAPD;
-
-    const gchar *snap_status_string = _snapd_json_get_string (object, "status", "");
-    SnapdSnapStatus snap_status = SNAPD_SNAP_STATUS_UNKNOWN;
-    if (strcmp (snap_status_string, "available") == 0)
-        snap_status = SNAPD_SNAP_STATUS_AVAILABLE;
-    else if (strcmp (snap_status_string, "priced") == 0)
-        snap_status = SNAPD_SNAP_STATUS_PRICED;
-    else if (strcmp (snap_status_string, "installed") == 0)
-        snap_status = SNAPD_SNAP_STATUS_INSTALLED;
-    else if (strcmp (snap_status_string, "active") == 0)
-        snap_status = SNAPD_SNAP_STATUS_ACTIVE;
+static SnapdPublisherValidation
+parse_publisher_validation (const gchar *value)
+{
+    if (value == NULL || g_strcmp0 (value, "") == 0)
+        return SNAPD_PUBLISHER_VALIDATION_UNKNOWN;
+    else if (g_strcmp0 (value, "unproven") == 0)
+        return SNAPD_PUBLISHER_VALIDATION_UNPROVEN;
+    else if (g_strcmp0 (value, "verified") == 0)
+        return SNAPD_PUBLISHER_VALIDATION_VERIFIED;
+    /* Any unknown validation is treated as verified for forwards compatibility */
+    else
+        return SNAPD_PUBLISHER_VALIDATION_VERIFIED;
+}
 
-    g_autoptr(JsonArray) apps = _snapd_json_get_array (object, "apps");
-    g_autoptr(GPtrArray) apps_array = g_ptr_array_new_with_free_func (g_object_unref);
+static SnapdDaemonType
+parse_daemon_type (const gchar *value)
+{
+    if (value == NULL)
+        return SNAPD_DAEMON_TYPE_NONE;
+    else if (strcmp (value, "simple") == 0)
+        return SNAPD_DAEMON_TYPE_SIMPLE;
+    else if (strcmp (value, "forking") == 0)
+        return SNAPD_DAEMON_TYPE_FORKING;
+    else if (strcmp (value, "oneshot") == 0)
+        return SNAPD_DAEMON_TYPE_ONESHOT;
+    else if (strcmp (value, "dbus") == 0)
+        return SNAPD_DAEMON_TYPE_DBUS;
+    else if (strcmp (value, "notify") == 0)
+        return SNAPD_DAEMON_TYPE_NOTIFY;
+    else
+        return SNAPD_DAEMON_TYPE_UNKNOWN;
+}
+
+/* Values used to construct a snap */
+typedef struct
+{
+    GPtrArray *apps;
+    gchar *base;
+    gchar *broken;
+    gchar *channel;
+    GPtrArray *channels;
+    GPtrArray *common_ids;
+    SnapdConfinement confinement;
+    gchar *contact;
+    gchar *description;
+    gboolean devmode;
+    gint64 download_size;
+    gchar *icon;
+    gchar *id;
+    GDateTime *install_date;
+    gint64 installed_size;
+    gboolean jailmode;
+    gchar *license;
+    GPtrArray *media;
+    gchar *mounted_from;
+    gchar *name;
+    GPtrArray *prices;
+    gboolean private;
+    gchar *publisher_id;
+    gchar *publisher_username;
+    gchar *publisher_display_name;
+    SnapdPublisherValidation publisher_validation;
+    gchar *revision;
+    SnapdSnapType snap_type;
+    SnapdSnapStatus status;
+    gchar *summary;
+    gchar *title;
+    gchar *tracking_channel;
+    GPtrArray *tracks;
+    gboolean trymode;
+    gchar *version;
+    gchar *website;
+} SnapFields;
+
+static void
+snap_fields_init (SnapFields *fields)
+{
+    memset (fields, 0, sizeof (SnapFields));
+    fields->apps = g_ptr_array_new_with_free_func (g_object_unref);
+    fields->channels = g_ptr_array_new_with_free_func (g_object_unref);
+    fields->common_ids = g_ptr_array_new_with_free_func (g_free);
+    fields->media = g_ptr_array_new_with_free_func (g_object_unref);
+    fields->prices = g_ptr_array_new_with_free_func (g_object_unref);
+    fields->tracks = g_ptr_array_new_with_free_func (g_free);
+}
+
+static void
+snap_fields_clear (SnapFields *fields)
+{
+    g_clear_pointer (&fields->apps, g_ptr_array_unref);
+    g_clear_pointer (&fields->base, _snapd_ref_string_release);
+    g_clear_pointer (&fields->broken, g_free);
+    g_clear_pointer (&fields->channel, _snapd_ref_string_release);
+    g_clear_pointer (&fields->channels, g_ptr_array_unref);
+    g_clear_pointer (&fields->common_ids, g_ptr_array_unref);
+    g_clear_pointer (&fields->contact, g_free);
+    g_clear_pointer (&fields->description, g_free);
+    g_clear_pointer (&fields->icon, g_free);
+    g_clear_pointer (&fields->id, g_free);
+    g_clear_pointer (&fields->install_date, g_date_time_unref);
+    g_clear_pointer (&fields->license, _snapd_ref_string_release);
+    g_clear_pointer (&fields->media, g_ptr_array_unref);
+    g_clear_pointer (&fields->mounted_from, g_free);
+    g_clear_pointer (&fields->name, g_free);
+    g_clear_pointer (&fields->prices, g_ptr_array_unref);
+    g_clear_pointer (&fields->publisher_id, _snapd_ref_string_release);
+    g_clear_pointer (&fields->publisher_username, _snapd_ref_string_release);
+    g_clear_pointer (&fields->publisher_display_name, _snapd_ref_string_release);
+    g_clear_pointer (&fields->revision, g_free);
+    g_clear_pointer (&fields->summary, g_free);
+    g_clear_pointer (&fields->title, g_free);
+    g_clear_pointer (&fields->tracking_channel, _snapd_ref_string_release);
+    g_clear_pointer (&fields->tracks, g_ptr_array_unref);
+    g_clear_pointer (&fields->version, g_free);
+    g_clear_pointer (&fields->website, g_free);
+}
+
+G_DEFINE_AUTO_CLEANUP_CLEAR_FUNC (SnapFields, snap_fields_clear)
+
+static GStrv
+steal_strv (GPtrArray **array)
+{
+    g_ptr_array_add (*array, NULL);
+    return (GStrv) g_ptr_array_free (g_steal_pointer (array), FALSE);
+}
+
+/* Create a snap, taking ownership of all the values */
+static SnapdSnap *
+make_snap (SnapFields *fields)
+{
+    return _snapd_snap_new (g_steal_pointer (&fields->apps),
+                            g_steal_pointer (&fields->base),
+                            g_steal_pointer (&fields->broken),
+                            g_steal_pointer (&fields->channel),
+                            g_steal_pointer (&fields->channels),
+                            steal_strv (&fields->common_ids),
+                            fields->confinement,
+                            g_steal_pointer (&fields->contact),
+                            g_steal_pointer (&fields->description),
+                            fields->devmode,
+                            fields->download_size,
+                            g_steal_pointer (&fields->icon),
+                            g_steal_pointer (&fields->id),
+                            g_steal_pointer (&fields->install_date),
+                            fields->installed_size,
+                            fields->jailmode,
+                            g_steal_pointer (&fields->license),
+                            g_steal_pointer (&fields->media),
+                            g_steal_pointer (&fields->mounted_from),
+                            g_steal_pointer (&fields->name),
+                            g_steal_pointer (&fields->prices),
+                            fields->private,
+                            g_steal_pointer (&fields->publisher_display_name),
+                            g_steal_pointer (&fields->publisher_id),
+                            g_steal_pointer (&fields->publisher_username),
+                            fields->publisher_validation,
+                            g_steal_pointer (&fields->revision),
+                            g_ptr_array_new_with_free_func (g_object_unref),
+                            fields->status,
+                            g_steal_pointer (&fields->summary),
+                            g_steal_pointer (&fields->title),
+                            g_steal_pointer (&fields->tracking_channel),
+                            steal_strv (&fields->tracks),
+                            fields->trymode,
+                            fields->snap_type,
+                            g_steal_pointer (&fields->version),
+                            g_steal_pointer (&fields->website));
+}
+
+static gboolean
+parse_apps (JsonArray *apps, const gchar *snap_name, SnapdStringPool *pool, GPtrArray *apps_array, GError **error)
+{
     for (guint i = 0; i < json_array_get_length (apps); i++) {
         JsonNode *node = json_array_get_element (apps, i);
 
-        SnapdApp *app = _snapd_json_parse_app (node, name, error);
+        SnapdApp *app = _snapd_json_parse_app (node, snap_name, pool, error);
         if (app == NULL)
-            return NULL;
+            return FALSE;
 
         g_ptr_array_add (apps_array, app);
     }
 
-    JsonObject *channels = _snapd_json_get_object (object, "channels");
-    g_autoptr(GPtrArray) channels_array = g_ptr_array_new_with_free_func (g_object_unref);
-    if (channels != NULL) {
-        JsonObjectIter iter;
-        json_object_iter_init (&iter, channels);
-        const gchar *name;
-        JsonNode *channel_node;
-        while (json_object_iter_next (&iter, &name, &channel_node)) {
-            if (json_node_get_value_type (channel_node) != JSON_TYPE_OBJECT) {
-                g_set_error (error, SNAPD_ERROR, SNAPD_ERROR_READ_FAILED, "Unexpected channel type");
-                return NULL;
-            }
-            JsonObject *c = json_node_get_object (channel_node);
-
-            SnapdConfinement confinement = parse_confinement (_snapd_json_get_string (c, "confinement", ""));
-            g_autoptr(GDateTime) released_at = _snapd_json_get_date_time (c, "released-at");
-
-            g_autoptr(SnapdChannel) channel = g_object_new (SNAPD_TYPE_CHANNEL,
-                                                            "confinement", confinement,
-                                                            "epoch", _snapd_json_get_string (c, "epoch", NULL),
-                                                            "name", _snapd_json_get_string (c, "channel", NULL),
-                                                            "released-at", released_at,
-                                                            "revision", _snapd_json_get_string (c, "revision", NULL),
-                                                            "size", _snapd_json_get_int (c, "size", 0),
-                                                            "version", _snapd_json_get_string (c, "version", NULL),
-                                                            NULL);
-            g_ptr_array_add (channels_array, g_steal_pointer (&channel));
+    return TRUE;
+}
+
+static gboolean
+parse_channels (JsonObject *channels, SnapdStringPool *pool, GPtrArray *channels_array, GError **error)
+{
+    JsonObjectIter iter;
+    json_object_iter_init (&iter, channels);
+    const gchar *name;
+    JsonNode *channel_node;
+    while (json_object_iter_next (&iter, &name, &channel_node)) {
+        if (json_node_get_value_type (channel_node) != JSON_TYPE_OBJECT) {
+            g_set_error (error, SNAPD_ERROR, SNAPD_ERROR_READ_FAILED, "Unexpected channel type");
+            return FALSE;
         }
+        JsonObject *c = json_node_get_object (channel_node);
+
+        SnapdChannel *channel = _snapd_channel_new (_snapd_string_pool_intern (pool, _snapd_json_get_string (c, "channel", NULL)),
+                                                    parse_confinement (_snapd_json_get_string (c, "confinement", "")),
+                                                    _snapd_string_pool_intern (pool, _snapd_json_get_string (c, "epoch", NULL)),
+                                                    _snapd_json_get_date_time (c, "released-at"),
+                                                    g_strdup (_snapd_json_get_string (c, "revision", NULL)),
+                                                    _snapd_json_get_int (c, "size", 0),
+                                                    g_strdup (_snapd_json_get_string (c, "version", NULL)));
+        g_ptr_array_add (channels_array, channel);
     }
 
-    g_autoptr(JsonArray) common_ids = _snapd_json_get_array (object, "common-ids");
-    g_autoptr(GPtrArray) common_ids_array = g_ptr_array_new ();
-    for (guint i = 0; i < json_array_get_length (common_ids); i++) {
-        JsonNode *node = json_array_get_element (common_ids, i);
+    return TRUE;
+}
+
+static gboolean
+parse_string_array (JsonArray *array, GPtrArray *strings, const gchar *description, GError **error)
+{
+    for (guint i = 0; i < json_array_get_length (array); i++) {
+        JsonNode *node = json_array_get_element (array, i);
 
         if (json_node_get_value_type (node) != G_TYPE_STRING) {
-            g_set_error (error, SNAPD_ERROR, SNAPD_ERROR_READ_FAILED, "Unexpected common ID type");
-            return NULL;
+            g_set_error (error, SNAPD_ERROR, SNAPD_ERROR_READ_FAILED, "Unexpected %s type", description);
+            return FALSE;
         }
 
-        g_ptr_array_add (common_ids_array, (gpointer) json_node_get_string (node));
+        g_ptr_array_add (strings, g_strdup (json_node_get_string (node)));
     }
-    g_ptr_array_add (common_ids_array, NULL);
 
-    g_autoptr(GDateTime) install_date = _snapd_json_get_date_time (object, "install-date");
-
-    JsonObject *prices = _snapd_json_get_object (object, "prices");
-    g_autoptr(GPtrArray) prices_array = g_ptr_array_new_with_free_func (g_object_unref);
-    if (prices != NULL) {
-        JsonObjectIter iter;
-        json_object_iter_init (&iter, prices);
-        const gchar *currency;
-        JsonNode *amount_node;
-        while (json_object_iter_next (&iter, &currency, &amount_node)) {
-            if (json_node_get_value_type (amount_node) != G_TYPE_DOUBLE) {
-                g_set_error (error, SNAPD_ERROR, SNAPD_ERROR_READ_FAILED, "Unexpected price type");
-                return NULL;
-            }
+    return TRUE;
+}
 
-            g_autoptr(SnapdPrice) price = g_object_new (SNAPD_TYPE_PRICE,
-                                                        "amount", json_node_get_double (amount_node),
-                                                        "currency", currency,
-                                                        NULL);
-            g_ptr_array_add (prices_array, g_steal_pointer (&price));
+static gboolean
+parse_prices (JsonObject *prices, GPtrArray *prices_array, GError **error)
+{
+    JsonObjectIter iter;
+    json_object_iter_init (&iter, prices);
+    const gchar *currency;
+    JsonNode *amount_node;
+    while (json_object_iter_next (&iter, &currency, &amount_node)) {
+        if (json_node_get_value_type (amount_node) != G_TYPE_DOUBLE) {
+            g_set_error (error, SNAPD_ERROR, SNAPD_ERROR_READ_FAILED, "Unexpected price type");
+            return FALSE;
         }
+
+        g_autoptr(SnapdPrice) price = g_object_new (SNAPD_TYPE_PRICE,
+                                                    "amount", json_node_get_double (amount_node),
+                                                    "currency", currency,
+                                                    NULL);
+        g_ptr_array_add (prices_array, g_steal_pointer (&price));
     }
 
-    g_autoptr(JsonArray) media = _snapd_json_get_array (object, "media");
-    g_autoptr(GPtrArray) media_array = g_ptr_array_new_with_free_func (g_object_unref);
+    return TRUE;
+}
+
+static gboolean
+parse_media (JsonArray *media, SnapdStringPool *pool, GPtrArray *media_array, GError **error)
+{
     for (guint i = 0; i < json_array_get_length (media); i++) {
         JsonNode *node = json_array_get_element (media, i);
 
         if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
             g_set_error (error, SNAPD_ERROR, SNAPD_ERROR_READ_FAILED, "Unexpected media type");
-            return NULL;
+            return FALSE;
         }
 
         JsonObject *s = json_node_get_object (node);
-        g_autoptr(SnapdMedia) media = g_object_new (SNAPD_TYPE_MEDIA,
-                                                    "type", _snapd_json_get_string (s, "type", NULL),
-                                                    "url", _snapd_json_get_string (s, "url", NULL),
-                                                    "width", (guint) _snapd_json_get_int (s, "width", 0),
-                                                    "height", (guint) _snapd_json_get_int (s, "height", 0),
-                                                    NULL);
-        g_ptr_array_add (media_array, g_steal_pointer (&media));
+        SnapdMedia *media = _snapd_media_new (_snapd_string_pool_intern (pool, _snapd_json_get_string (s, "type", NULL)),
+                                              g_strdup (_snapd_json_get_string (s, "url", NULL)),
+                                              (guint) _snapd_json_get_int (s, "width", 0),
+                                              (guint) _snapd_json_get_int (s, "height", 0));
+        g_ptr_array_add (media_array, media);
+    }
+
+    return TRUE;
+}
+
+SnapdSnap *
+_snapd_json_parse_snap (JsonNode *node, SnapdStringPool *pool, GError **error)
+{
+    if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
+        g_set_error (error,
+                     SNAPD_ERROR,
+                     SNAPD_ERROR_READ_FAILED,
+                     "Unexpected snap type");
+        return NULL;
     }
+    JsonObject *object = json_node_get_object (node);
+
+    g_auto(SnapFields) fields = { NULL };
+    snap_fields_init (&fields);
+
+    fields.name = g_strdup (_snapd_json_get_string (object, "name", NULL));
+    fields.confinement = parse_confinement (_snapd_json_get_string (object, "confinement", ""));
+    fields.snap_type = parse_snap_type (_snapd_json_get_string (object, "type", ""));
+    fields.status = parse_snap_status (_snapd_json_get_string (object, "status", ""));
+
+    g_autoptr(JsonArray) apps = _snapd_json_get_array (object, "apps");
+    if (!parse_apps (apps, fields.name, pool, fields.apps, error))
+        return NULL;
+
+    JsonObject *channels = _snapd_json_get_object (object, "channels");
+    if (channels != NULL && !parse_channels (channels, pool, fields.channels, error))
+        return NULL;
+
+    g_autoptr(JsonArray) common_ids = _snapd_json_get_array (object, "common-ids");
+    if (!parse_string_array (common_ids, fields.common_ids, "common ID", error))
+        return NULL;
+
+    fields.install_date = _snapd_json_get_date_time (object, "install-date");
 
-    g_autoptr(GPtrArray) screenshots_array = g_ptr_array_new_with_free_func (g_object_unref);
+    JsonObject *prices = _snapd_json_get_object (object, "prices");
+    if (prices != NULL && !parse_prices (prices, fields.prices, error))
+        return NULL;
+
+    g_autoptr(JsonArray) media = _snapd_json_get_array (object, "media");
+    if (!parse_media (media, pool, fields.media, error))
+        return NULL;
 
     /* The tracks field was originally incorrectly named, fixed in snapd 61ad9ed (2.29.5) */
     g_autoptr(JsonArray) tracks = NULL;
@@ -783,217 +996,1297 @@ _snapd_json_parse_snap (JsonNode *node, GError **error)
         tracks = _snapd_json_get_array (object, "Tracks");
     else
         tracks = _snapd_json_get_array (object, "tracks");
-    g_autoptr(GPtrArray) track_array = g_ptr_array_new ();
-    for (guint i = 0; i < json_array_get_length (tracks); i++) {
-        JsonNode *node = json_array_get_element (tracks, i);
-
-        if (json_node_get_value_type (node) != G_TYPE_STRING) {
-            g_set_error (error, SNAPD_ERROR, SNAPD_ERROR_READ_FAILED, "Unexpected track type");
-            return NULL;
-        }
-
-        g_ptr_array_add (track_array, (gpointer) json_node_get_string (node));
-    }
-    g_ptr_array_add (track_array, NULL);
+    if (!parse_string_array (tracks, fields.tracks, "track", error))
+        return NULL;
 
     /* The developer field originally contained the publisher username */
     const gchar *publisher_username = _snapd_json_get_string (object, "developer", NULL);
     JsonObject *publisher = _snapd_json_get_object (object, "publisher");
-    const gchar *publisher_display_name = NULL;
-    const gchar *publisher_id = NULL;
-    SnapdPublisherValidation publisher_validation = SNAPD_PUBLISHER_VALIDATION_UNKNOWN;
     if (publisher != NULL) {
-        publisher_display_name = _snapd_json_get_string (publisher, "display-name", NULL);
-        publisher_id = _snapd_json_get_string (publisher, "id", NULL);
+        fields.publisher_display_name = _snapd_string_pool_intern (pool, _snapd_json_get_string (publisher, "display-name", NULL));
+        fields.publisher_id = _snapd_string_pool_intern (pool, _snapd_json_get_string (publisher, "id", NULL));
         publisher_username = _snapd_json_get_string (publisher, "username", publisher_username);
-        const gchar *validation = _snapd_json_get_string (publisher, "validation", NULL);
-        if (validation == NULL || g_strcmp0 (validation, "") == 0)
-            publisher_validation = SNAPD_PUBLISHER_VALIDATION_UNKNOWN;
-        else if (g_strcmp0 (validation, "unproven") == 0)
-            publisher_validation = SNAPD_PUBLISHER_VALIDATION_UNPROVEN;
-        else if (g_strcmp0 (validation, "verified") == 0)
-            publisher_validation = SNAPD_PUBLISHER_VALIDATION_VERIFIED;
-        /* Any unknown validation is treated as verified for forwards compatibility */
-        else
-            publisher_validation = SNAPD_PUBLISHER_VALIDATION_VERIFIED;
+        fields.publisher_validation = parse_publisher_validation (_snapd_json_get_string (publisher, "validation", NULL));
     }
-
-    return g_object_new (SNAPD_TYPE_SNAP,
-                         "apps", apps_array,
-                         "base", _snapd_json_get_string (object, "base", NULL),
-                         "broken", _snapd_json_get_string (object, "broken", NULL),
-                         "channel", _snapd_json_get_string (object, "channel", NULL),
-                         "channels", channels_array,
-                         "common-ids", (GStrv) common_ids_array->pdata,
-                         "confinement", confinement,
-                         "contact", _snapd_json_get_string (object, "contact", NULL),
-                         "description", _snapd_json_get_string (object, "description", NULL),
-                         "devmode", _snapd_json_get_bool (object, "devmode", FALSE),
-                         "download-size", _snapd_json_get_int (object, "download-size", 0),
-                         "icon", _snapd_json_get_string (object, "icon", NULL),
-                         "id", _snapd_json_get_string (object, "id", NULL),
-                         "install-date", install_date,
-                         "installed-size", _snapd_json_get_int (object, "installed-size", 0),
-                         "jailmode", _snapd_json_get_bool (object, "jailmode", FALSE),
-                         "license", _snapd_json_get_string (object, "license", NULL),
-                         "media", media_array,
-                         "mounted-from", _snapd_json_get_string (object, "mounted-from", NULL),
-                         "name", name,
-                         "prices", prices_array,
-                         "private", _snapd_json_get_bool (object, "private", FALSE),
-                         "publisher-id", publisher_id,
-                         "publisher-username", publisher_username,
-                         "publisher-display-name", publisher_display_name,
-                         "publisher-validation", publisher_validation,
-                         "revision", _snapd_json_get_string (object, "revision", NULL),
-                         "screenshots", screenshots_array,
-                         "snap-type", snap_type,
-                         "status", snap_status,
-                         "summary", _snapd_json_get_string (object, "summary", NULL),
-                         "title", _snapd_json_get_string (object, "title", NULL),
-                         "tracking-channel", _snapd_json_get_string (object, "tracking-channel", NULL),
-                         "tracks", (GStrv) track_array->pdata,
-                         "trymode", _snapd_json_get_bool (object, "trymode", FALSE),
-                         "version", _snapd_json_get_string (object, "version", NULL),
-                         "website", _snapd_json_get_string (object, "website", NULL),
-                         NULL);
+    fields.publisher_username = _snapd_string_pool_intern (pool, publisher_username);
+
+    fields.base = _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "base", NULL));
+    fields.broken = g_strdup (_snapd_json_get_string (object, "broken", NULL));
+    fields.channel = _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "channel", NULL));
+    fields.contact = g_strdup (_snapd_json_get_string (object, "contact", NULL));
+    fields.description = g_strdup (_snapd_json_get_string (object, "description", NULL));
+    fields.devmode = _snapd_json_get_bool (object, "devmode", FALSE);
+    fields.download_size = _snapd_json_get_int (object, "download-size", 0);
+    fields.icon = g_strdup (_snapd_json_get_string (object, "icon", NULL));
+    fields.id = g_strdup (_snapd_json_get_string (object, "id", NULL));
+    fields.installed_size = _snapd_json_get_int (object, "installed-size", 0);
+    fields.jailmode = _snapd_json_get_bool (object, "jailmode", FALSE);
+    fields.license = _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "license", NULL));
+    fields.mounted_from = g_strdup (_snapd_json_get_string (object, "mounted-from", NULL));
+    fields.private = _snapd_json_get_bool (object, "private", FALSE);
+    fields.revision = g_strdup (_snapd_json_get_string (object, "revision", NULL));
+    fields.summary = g_strdup (_snapd_json_get_string (object, "summary", NULL));
+    fields.title = g_strdup (_snapd_json_get_string (object, "title", NULL));
+    fields.tracking_channel = _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "tracking-channel", NULL));
+    fields.trymode = _snapd_json_get_bool (object, "trymode", FALSE);
+    fields.version = g_strdup (_snapd_json_get_string (object, "version", NULL));
+    fields.website = g_strdup (_snapd_json_get_string (object, "website", NULL));
+
+    return make_snap (&fields);
 }
 
-SnapdApp *
-_snapd_json_parse_app (JsonNode *node, const gchar *snap_name, GError **error)
+/* Fast path for parsing snaps.
+ * This reads the JSON directly into the snap fields without building a json-glib tree.
+ * Complex members (apps, channels, media and prices) are read with the same tokenizer, or kept as raw JSON when deferred.
+ * If anything unexpected is found the fast path gives up and the json-glib parser is used instead. */
+
+typedef enum
 {
-    if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
-        g_set_error (error,
-                     SNAPD_ERROR,
-                     SNAPD_ERROR_READ_FAILED,
-                     "Unexpected app type");
-        return NULL;
-    }
-    JsonObject *object = json_node_get_object (node);
+    SNAP_FIELD_UNKNOWN,
+    SNAP_FIELD_APPS,
+    SNAP_FIELD_BASE,
+    SNAP_FIELD_BROKEN,
+    SNAP_FIELD_CHANNEL,
+    SNAP_FIELD_CHANNELS,
+    SNAP_FIELD_COMMON_IDS,
+    SNAP_FIELD_CONFINEMENT,
+    SNAP_FIELD_CONTACT,
+    SNAP_FIELD_DESCRIPTION,
+    SNAP_FIELD_DEVELOPER,
+    SNAP_FIELD_DEVMODE,
+    SNAP_FIELD_DOWNLOAD_SIZE,
+    SNAP_FIELD_ICON,
+    SNAP_FIELD_ID,
+    SNAP_FIELD_INSTALL_DATE,
+    SNAP_FIELD_INSTALLED_SIZE,
+    SNAP_FIELD_JAILMODE,
+    SNAP_FIELD_LICENSE,
+    SNAP_FIELD_MEDIA,
+    SNAP_FIELD_MOUNTED_FROM,
+    SNAP_FIELD_NAME,
+    SNAP_FIELD_PRICES,
+    SNAP_FIELD_PRIVATE,
+    SNAP_FIELD_PUBLISHER,
+    SNAP_FIELD_REVISION,
+    SNAP_FIELD_STATUS,
+    SNAP_FIELD_SUMMARY,
+    SNAP_FIELD_TITLE,
+    SNAP_FIELD_TRACKING_CHANNEL,
+    SNAP_FIELD_TRACKS,
+    SNAP_FIELD_TRACKS_LEGACY,
+    SNAP_FIELD_TRYMODE,
+    SNAP_FIELD_TYPE,
+    SNAP_FIELD_VERSION,
+    SNAP_FIELD_WEBSITE
+} SnapField;
+
+typedef struct
+{
+    const gchar *name;
+    SnapField field;
+} SnapFieldKey;
 
-    const gchar *daemon = _snapd_json_get_string (object, "daemon", NULL);
-    SnapdDaemonType daemon_type = SNAPD_DAEMON_TYPE_NONE;
-    if (daemon == NULL)
-        daemon_type = SNAPD_DAEMON_TYPE_NONE;
-    else if (strcmp (daemon, "simple") == 0)
-        daemon_type = SNAPD_DAEMON_TYPE_SIMPLE;
-    else if (strcmp (daemon, "forking") == 0)
-        daemon_type = SNAPD_DAEMON_TYPE_FORKING;
-    else if (strcmp (daemon, "oneshot") == 0)
-        daemon_type = SNAPD_DAEMON_TYPE_ONESHOT;
-    else if (strcmp (daemon, "dbus") == 0)
-        daemon_type = SNAPD_DAEMON_TYPE_DBUS;
-    else if (strcmp (daemon, "notify") == 0)
-        daemon_type = SNAPD_DAEMON_TYPE_NOTIFY;
-    else
-        daemon_type = SNAPD_DAEMON_TYPE_UNKNOWN;
+#define SNAP_FIELD_HASH_SIZE 128
 
-    const gchar *app_snap_name = _snapd_json_get_string (object, "snap", NULL);
-    return g_object_new (SNAPD_TYPE_APP,
-                         "name", _snapd_json_get_string (object, "name", NULL),
-                         "active", _snapd_json_get_bool (object, "active", FALSE),
-                         "common-id", _snapd_json_get_string (object, "common-id", NULL),
-                         "daemon-type", daemon_type,
-                         "desktop-file", _snapd_json_get_string (object, "desktop-file", NULL),
-                         "enabled", _snapd_json_get_bool (object, "enabled", FALSE),
-                         "snap", snap_name ? snap_name : app_snap_name,
-                         NULL);
+/* Perfect hash of the known snap members, see snap_field_hash() */
+static const SnapFieldKey snap_field_keys[SNAP_FIELD_HASH_SIZE] =
+{
+    [1] = { "base", SNAP_FIELD_BASE },
+    [2] = { "status", SNAP_FIELD_STATUS },
+    [11] = { "summary", SNAP_FIELD_SUMMARY },
+    [12] = { "trymode", SNAP_FIELD_TRYMODE },
+    [18] = { "apps", SNAP_FIELD_APPS },
+    [23] = { "type", SNAP_FIELD_TYPE },
+    [25] = { "tracks", SNAP_FIELD_TRACKS },
+    [28] = { "tracking-channel", SNAP_FIELD_TRACKING_CHANNEL },
+    [32] = { "private", SNAP_FIELD_PRIVATE },
+    [34] = { "license", SNAP_FIELD_LICENSE },
+    [45] = { "prices", SNAP_FIELD_PRICES },
+    [46] = { "broken", SNAP_FIELD_BROKEN },
+    [47] = { "media", SNAP_FIELD_MEDIA },
+    [49] = { "version", SNAP_FIELD_VERSION },
+    [52] = { "channel", SNAP_FIELD_CHANNEL },
+    [53] = { "publisher", SNAP_FIELD_PUBLISHER },
+    [57] = { "Tracks", SNAP_FIELD_TRACKS_LEGACY },
+    [60] = { "channels", SNAP_FIELD_CHANNELS },
+    [65] = { "id", SNAP_FIELD_ID },
+    [66] = { "devmode", SNAP_FIELD_DEVMODE },
+    [67] = { "website", SNAP_FIELD_WEBSITE },
+    [69] = { "name", SNAP_FIELD_NAME },
+    [70] = { "revision", SNAP_FIELD_REVISION },
+    [74] = { "contact", SNAP_FIELD_CONTACT },
+    [75] = { "icon", SNAP_FIELD_ICON },
+    [76] = { "common-ids", SNAP_FIELD_COMMON_IDS },
+    [78] = { "confinement", SNAP_FIELD_CONFINEMENT },
+    [79] = { "description", SNAP_FIELD_DESCRIPTION },
+    [81] = { "developer", SNAP_FIELD_DEVELOPER },
+    [86] = { "mounted-from", SNAP_FIELD_MOUNTED_FROM },
+    [92] = { "download-size", SNAP_FIELD_DOWNLOAD_SIZE },
+    [93] = { "jailmode", SNAP_FIELD_JAILMODE },
+    [96] = { "install-date", SNAP_FIELD_INSTALL_DATE },
+    [98] = { "installed-size", SNAP_FIELD_INSTALLED_SIZE },
+    [120] = { "title", SNAP_FIELD_TITLE },
+};
+
+/* Hash function that has no collisions for the known snap members */
+static guint
+snap_field_hash (const gchar *name, gsize length)
+{
+    return (length + (guchar) name[0] * 27 + (guchar) name[1] * 2 + (guchar) name[length - 1]) % SNAP_FIELD_HASH_SIZE;
 }
 
-SnapdAlias *
-_snapd_json_parse_alias (JsonNode *node, const gchar *snap_name, const gchar *name, GError **error)
+static SnapField
+lookup_snap_field (const gchar *name, gsize length)
 {
-    if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
-        g_set_error (error,
-                     SNAPD_ERROR,
-                     SNAPD_ERROR_READ_FAILED,
-                     "Unexpected alias type");
-        return FALSE;
-    }
-    JsonObject *object = json_node_get_object (node);
+    if (length < 2)
+        return SNAP_FIELD_UNKNOWN;
 
-    const gchar *status_string = _snapd_json_get_string (object, "status", NULL);
-    SnapdAliasStatus status = SNAPD_ALIAS_STATUS_UNKNOWN;
-    if (strcmp (status_string, "disabled") == 0)
-        status = SNAPD_ALIAS_STATUS_DISABLED;
-    else if (strcmp (status_string, "auto") == 0)
-        status = SNAPD_ALIAS_STATUS_AUTO;
-    else if (strcmp (status_string, "manual") == 0)
-        status = SNAPD_ALIAS_STATUS_MANUAL;
-    else
-        status = SNAPD_ALIAS_STATUS_UNKNOWN;
+    const SnapFieldKey *key = &snap_field_keys[snap_field_hash (name, length)];
+    if (key->name != NULL && strlen (key->name) == length && memcmp (key->name, name, length) == 0)
+        return key->field;
 
-    return g_object_new (SNAPD_TYPE_ALIAS,
-                         "snap", snap_name,
-                         "app-auto", _snapd_json_get_string (object, "auto", NULL),
-                         "app-manual", _snapd_json_get_string (object, "manual", NULL),
-                         "command", _snapd_json_get_string (object, "command", NULL),
-                         "name", name,
-                         "status", status,
-                         NULL);
+    return SNAP_FIELD_UNKNOWN;
 }
 
-SnapdUserInformation *
-_snapd_json_parse_user_information (JsonNode *node, GError **error)
+typedef struct
 {
-    if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
-        g_set_error (error,
-                     SNAPD_ERROR,
-                     SNAPD_ERROR_READ_FAILED,
-                     "Unexpected user information type");
-        return NULL;
-    }
-    JsonObject *object = json_node_get_object (node);
-
-    g_autoptr(JsonArray) ssh_keys = _snapd_json_get_array (object, "ssh-keys");
-    g_autoptr(GPtrArray) ssh_key_array = g_ptr_array_new ();
-    for (guint i = 0; i < json_array_get_length (ssh_keys); i++) {
-        JsonNode *node = json_array_get_element (ssh_keys, i);
+    const gchar *c;
+    const gchar *end;
 
-        if (json_node_get_value_type (node) != G_TYPE_STRING) {
-            g_set_error (error, SNAPD_ERROR, SNAPD_ERROR_READ_FAILED, "Unexpected SSH key type");
-            return NULL;
-        }
+    /* Pool to share repeated strings */
+    SnapdStringPool *pool;
+} JsonTokenizer;
 
-        g_ptr_array_add (ssh_key_array, (gpointer) json_node_get_string (node));
-    }
+static void
+tokenizer_skip_whitespace (JsonTokenizer *tokenizer)
+{
+    while (tokenizer->c < tokenizer->end &&
+           (*tokenizer->c == ' ' || *tokenizer->c == '\t' || *tokenizer->c == '\r' || *tokenizer->c == '\n'))
+        tokenizer->c++;
+}
 
-    g_ptr_array_add (ssh_key_array, NULL);
+/* Check the next character is @c and move past it */
+static gboolean
+tokenizer_next_is (JsonTokenizer *tokenizer, gchar c)
+{
+    tokenizer_skip_whitespace (tokenizer);
+    if (tokenizer->c >= tokenizer->end || *tokenizer->c != c)
+        return FALSE;
+    tokenizer->c++;
+    return TRUE;
+}
 
-    g_autoptr(SnapdAuthData) auth_data = NULL;
-    if (json_object_has_member (object, "macaroon")) {
-        g_autoptr(JsonArray) discharges = _snapd_json_get_array (object, "discharges");
-        g_autoptr(GPtrArray) discharge_array = g_ptr_array_new ();
-        for (guint i = 0; i < json_array_get_length (discharges); i++) {
-            JsonNode *node = json_array_get_element (discharges, i);
+static gchar
+tokenizer_peek (JsonTokenizer *tokenizer)
+{
+    tokenizer_skip_whitespace (tokenizer);
+    return tokenizer->c < tokenizer->end ? *tokenizer->c : '\0';
+}
 
-            if (json_node_get_value_type (node) != G_TYPE_STRING) {
-                g_set_error (error,
-                             SNAPD_ERROR,
-                             SNAPD_ERROR_READ_FAILED,
-                             "Unexpected discharge type");
-                return FALSE;
-            }
+/* Find the end of a string, returning FALSE if it contains escapes or is invalid */
+static gboolean
+tokenizer_scan_string (JsonTokenizer *tokenizer, const gchar **start, gsize *length, gboolean *escaped)
+{
+    if (!tokenizer_next_is (tokenizer, '"'))
+        return FALSE;
 
-            g_ptr_array_add (discharge_array, (gpointer) json_node_get_string (node));
+    *start = tokenizer->c;
+    *escaped = FALSE;
+    while (tokenizer->c < tokenizer->end) {
+        gchar c = *tokenizer->c;
+        if (c == '"') {
+            *length = tokenizer->c - *start;
+            tokenizer->c++;
+            return TRUE;
         }
-        g_ptr_array_add (discharge_array, NULL);
-        auth_data = snapd_auth_data_new (_snapd_json_get_string (object, "macaroon", NULL), (GStrv) discharge_array->pdata);
+        if (c == '\\') {
+            *escaped = TRUE;
+            tokenizer->c++;
+        }
+        else if ((guchar) c < 0x20)
+            return FALSE;
+        tokenizer->c++;
     }
 
-    return g_object_new (SNAPD_TYPE_USER_INFORMATION,
-                         "id", _snapd_json_get_int (object, "id", -1),
-                         "username", _snapd_json_get_string (object, "username", NULL),
-                         "email", _snapd_json_get_string (object, "email", NULL),
-                         "ssh-keys", (GStrv) ssh_key_array->pdata,
-                         "auth-data", auth_data,
-                         NULL);
+    return FALSE;
 }
 
-GHashTable *
-_snapd_json_parse_object (JsonObject *object, GError **error)
+static gboolean
+read_hex4 (const gchar *c, const gchar *end, gunichar *value)
 {
-    g_autoptr(GHashTable) attributes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
+    if (end - c < 4)
+        return FALSE;
+
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        gint digit = g_ascii_xdigit_value (c[i]);
+        if (digit < 0)
+            return FALSE;
+        *value = *value << 4 | digit;
+    }
+
+    return TRUE;
+}
+
+/* Convert a string with escape sequences */
+static gboolean
+unescape_string (const gchar *start, gsize length, GString *value)
+{
+    const gchar *end = start + length;
+    for (const gchar *c = start; c < end; c++) {
+        if (*c != '\\') {
+            g_string_append_c (value, *c);
+            continue;
+        }
+
+        c++;
+        switch (*c) {
+        case '"':
+        case '\\':
+        case '/':
+            g_string_append_c (value, *c);
+            break;
+        case 'b':
+            g_string_append_c (value, '\b');
+            break;
+        case 'f':
+            g_string_append_c (value, '\f');
+            break;
+        case 'n':
+            g_string_append_c (value, '\n');
+            break;
+        case 'r':
+            g_string_append_c (value, '\r');
+            break;
+        case 't':
+            g_string_append_c (value, '\t');
+            break;
+        case 'u':
+        {
+            gunichar u;
+            if (!read_hex4 (c + 1, end, &u))
+                return FALSE;
+            c += 4;
+
+            /* Combine surrogate pairs */
+            if (u >= 0xD800 && u <= 0xDBFF) {
+                gunichar low;
+                if (end - c < 7 || c[1] != '\\' || c[2] != 'u' || !read_hex4 (c + 3, end, &low) || low < 0xDC00 || low > 0xDFFF)
+                    return FALSE;
+                c += 6;
+                u = 0x10000 + ((u - 0xD800) << 10) + (low - 0xDC00);
+            }
+            else if (u >= 0xDC00 && u <= 0xDFFF)
+                return FALSE;
+
+            g_string_append_unichar (value, u);
+            break;
+        }
+        default:
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static gboolean
+tokenizer_read_string (JsonTokenizer *tokenizer, gchar **value)
+{
+    const gchar *start;
+    gsize length;
+    gboolean escaped;
+    if (!tokenizer_scan_string (tokenizer, &start, &length, &escaped))
+        return FALSE;
+
+    if (!escaped) {
+        *value = g_strndup (start, length);
+        return TRUE;
+    }
+
+    g_autoptr(GString) unescaped = g_string_sized_new (length);
+    if (!unescape_string (start, length, unescaped))
+        return FALSE;
+    *value = g_string_free (g_steal_pointer (&unescaped), FALSE);
+
+    return TRUE;
+}
+
+static gboolean
+tokenizer_read_literal (JsonTokenizer *tokenizer, const gchar *literal)
+{
+    gsize length = strlen (literal);
+    tokenizer_skip_whitespace (tokenizer);
+    if ((gsize) (tokenizer->end - tokenizer->c) < length || memcmp (tokenizer->c, literal, length) != 0)
+        return FALSE;
+    tokenizer->c += length;
+    return TRUE;
+}
+
+static gboolean
+tokenizer_next_is_digit (JsonTokenizer *tokenizer)
+{
+    return tokenizer->c < tokenizer->end && g_ascii_isdigit (*tokenizer->c);
+}
+
+static void
+tokenizer_skip_digits (JsonTokenizer *tokenizer)
+{
+    while (tokenizer_next_is_digit (tokenizer))
+        tokenizer->c++;
+}
+
+/* Move past a number, returning FALSE if it is not valid JSON number syntax.
+ * @is_integer is set to %FALSE if the number has a fraction or exponent */
+static gboolean
+tokenizer_scan_number (JsonTokenizer *tokenizer, gboolean *is_integer)
+{
+    tokenizer_skip_whitespace (tokenizer);
+
+    if (tokenizer->c < tokenizer->end && *tokenizer->c == '-')
+        tokenizer->c++;
+    if (!tokenizer_next_is_digit (tokenizer))
+        return FALSE;
+    if (*tokenizer->c == '0')
+        tokenizer->c++;
+    else
+        tokenizer_skip_digits (tokenizer);
+
+    *is_integer = TRUE;
+    if (tokenizer->c < tokenizer->end && *tokenizer->c == '.') {
+        tokenizer->c++;
+        if (!tokenizer_next_is_digit (tokenizer))
+            return FALSE;
+        tokenizer_skip_digits (tokenizer);
+        *is_integer = FALSE;
+    }
+    if (tokenizer->c < tokenizer->end && (*tokenizer->c == 'e' || *tokenizer->c == 'E')) {
+        tokenizer->c++;
+        if (tokenizer->c < tokenizer->end && (*tokenizer->c == '+' || *tokenizer->c == '-'))
+            tokenizer->c++;
+        if (!tokenizer_next_is_digit (tokenizer))
+            return FALSE;
+        tokenizer_skip_digits (tokenizer);
+        *is_integer = FALSE;
+    }
+
+    return TRUE;
+}
+
+/* Read an integer, returning FALSE if the number is not an integer */
+static gboolean
+tokenizer_read_int (JsonTokenizer *tokenizer, gint64 *value)
+{
+    tokenizer_skip_whitespace (tokenizer);
+
+    gboolean negative = FALSE;
+    if (tokenizer->c < tokenizer->end && *tokenizer->c == '-') {
+        negative = TRUE;
+        tokenizer->c++;
+    }
+
+    /* Leading zeros are not valid JSON */
+    if (tokenizer->end - tokenizer->c >= 2 && tokenizer->c[0] == '0' && g_ascii_isdigit (tokenizer->c[1]))
+        return FALSE;
+
+    guint64 v = 0;
+    gsize n_digits = 0;
+    while (tokenizer_next_is_digit (tokenizer)) {
+        /* Leave large numbers to json-glib */
+        if (n_digits >= 18)
+            return FALSE;
+        v = v * 10 + (*tokenizer->c - '0');
+        n_digits++;
+        tokenizer->c++;
+    }
+    if (n_digits == 0)
+        return FALSE;
+
+    /* Numbers with fractions / exponents are not integers */
+    if (tokenizer->c < tokenizer->end && (*tokenizer->c == '.' || *tokenizer->c == 'e' || *tokenizer->c == 'E'))
+        return FALSE;
+
+    *value = negative ? -(gint64) v : (gint64) v;
+    return TRUE;
+}
+
+/* Skip over a value of any type */
+static gboolean
+tokenizer_skip_value (JsonTokenizer *tokenizer)
+{
+    switch (tokenizer_peek (tokenizer)) {
+    case '"':
+    {
+        const gchar *start;
+        gsize length;
+        gboolean escaped;
+        return tokenizer_scan_string (tokenizer, &start, &length, &escaped);
+    }
+    case '{':
+    case '[':
+    {
+        guint depth = 0;
+        do {
+            gchar c = tokenizer_peek (tokenizer);
+            if (c == '"') {
+                const gchar *start;
+                gsize length;
+                gboolean escaped;
+                if (!tokenizer_scan_string (tokenizer, &start, &length, &escaped))
+                    return FALSE;
+                continue;
+            }
+            if (c == '\0')
+                return FALSE;
+            if (c == '{' || c == '[')
+                depth++;
+            else if (c == '}' || c == ']')
+                depth--;
+            tokenizer->c++;
+        } while (depth > 0);
+        return TRUE;
+    }
+    case 't':
+        return tokenizer_read_literal (tokenizer, "true");
+    case 'f':
+        return tokenizer_read_literal (tokenizer, "false");
+    case 'n':
+        return tokenizer_read_literal (tokenizer, "null");
+    default:
+    {
+        gboolean is_integer;
+        return tokenizer_scan_number (tokenizer, &is_integer);
+    }
+    }
+}
+
+/* Read a string value, leaving @value as %NULL if it is another type */
+static gboolean
+tokenizer_read_string_value (JsonTokenizer *tokenizer, gchar **value)
+{
+    g_clear_pointer (value, g_free);
+    if (tokenizer_peek (tokenizer) == '"')
+        return tokenizer_read_string (tokenizer, value);
+    return tokenizer_skip_value (tokenizer);
+}
+
+/* Read a string value into a reference counted string from the pool */
+static gboolean
+tokenizer_read_pooled_value (JsonTokenizer *tokenizer, gchar **value)
+{
+    g_autofree gchar *v = NULL;
+    if (!tokenizer_read_string_value (tokenizer, &v))
+        return FALSE;
+
+    _snapd_ref_string_release (*value);
+    *value = _snapd_string_pool_intern (tokenizer->pool, v);
+    return TRUE;
+}
+
+/* Read a boolean value, leaving @value as %FALSE if it is another type */
+static gboolean
+tokenizer_read_bool_value (JsonTokenizer *tokenizer, gboolean *value)
+{
+    *value = FALSE;
+    if (tokenizer_peek (tokenizer) == 't') {
+        *value = TRUE;
+        return tokenizer_read_literal (tokenizer, "true");
+    }
+    return tokenizer_skip_value (tokenizer);
+}
+
+/* Read an integer value, leaving @value as 0 if it is another type */
+static gboolean
+tokenizer_read_int_value (JsonTokenizer *tokenizer, gint64 *value)
+{
+    *value = 0;
+    gchar c = tokenizer_peek (tokenizer);
+    if (c == '-' || g_ascii_isdigit (c))
+        return tokenizer_read_int (tokenizer, value);
+    return tokenizer_skip_value (tokenizer);
+}
+
+/* Read an array of strings, leaving @values empty if it is another type */
+static gboolean
+tokenizer_read_string_array (JsonTokenizer *tokenizer, GPtrArray *values)
+{
+    g_ptr_array_set_size (values, 0);
+    if (tokenizer_peek (tokenizer) != '[')
+        return tokenizer_skip_value (tokenizer);
+    tokenizer->c++;
+
+    if (tokenizer_next_is (tokenizer, ']'))
+        return TRUE;
+    do {
+        gchar *value;
+        if (!tokenizer_read_string (tokenizer, &value))
+            return FALSE;
+        g_ptr_array_add (values, value);
+    } while (tokenizer_next_is (tokenizer, ','));
+
+    return tokenizer_next_is (tokenizer, ']');
+}
+
+/* Parse the members of the publisher object, leaving the values unset if it is another type */
+static gboolean
+tokenizer_read_publisher (JsonTokenizer *tokenizer, gboolean *have_publisher, gchar **display_name, gchar **id, gchar **username, gchar **validation)
+{
+    *have_publisher = FALSE;
+    g_clear_pointer (display_name, g_free);
+    g_clear_pointer (id, g_free);
+    g_clear_pointer (username, g_free);
+    g_clear_pointer (validation, g_free);
+    if (tokenizer_peek (tokenizer) != '{')
+        return tokenizer_skip_value (tokenizer);
+    tokenizer->c++;
+    *have_publisher = TRUE;
+
+    if (tokenizer_next_is (tokenizer, '}'))
+        return TRUE;
+    do {
+        const gchar *name;
+        gsize name_length;
+        gboolean escaped;
+        if (!tokenizer_scan_string (tokenizer, &name, &name_length, &escaped) || escaped)
+            return FALSE;
+        if (!tokenizer_next_is (tokenizer, ':'))
+            return FALSE;
+
+        gchar **value = NULL;
+        if (name_length == 12 && memcmp (name, "display-name", 12) == 0)
+            value = display_name;
+        else if (name_length == 2 && memcmp (name, "id", 2) == 0)
+            value = id;
+        else if (name_length == 8 && memcmp (name, "username", 8) == 0)
+            value = username;
+        else if (name_length == 10 && memcmp (name, "validation", 10) == 0)
+            value = validation;
+
+        if (value != NULL) {
+            if (!tokenizer_read_string_value (tokenizer, value))
+                return FALSE;
+        }
+        else if (!tokenizer_skip_value (tokenizer))
+            return FALSE;
+    } while (tokenizer_next_is (tokenizer, ','));
+
+    return tokenizer_next_is (tokenizer, '}');
+}
+
+/* Read a number with a fraction or exponent, returning FALSE if it is an integer as json-glib doesn't treat these as doubles */
+static gboolean
+tokenizer_read_double (JsonTokenizer *tokenizer, gdouble *value)
+{
+    tokenizer_skip_whitespace (tokenizer);
+    const gchar *start = tokenizer->c;
+    gboolean is_integer;
+    if (!tokenizer_scan_number (tokenizer, &is_integer) || is_integer)
+        return FALSE;
+
+    /* Copy as the data is not nul terminated */
+    g_autofree gchar *number = g_strndup (start, tokenizer->c - start);
+    *value = g_ascii_strtod (number, NULL);
+    return TRUE;
+}
+
+/* Read the name of an object member, returning FALSE if it contains escapes */
+static gboolean
+tokenizer_read_name (JsonTokenizer *tokenizer, const gchar **name, gsize *length)
+{
+    gboolean escaped;
+    return tokenizer_scan_string (tokenizer, name, length, &escaped) && !escaped && tokenizer_next_is (tokenizer, ':');
+}
+
+static gboolean
+name_is (const gchar *name, gsize length, const gchar *value)
+{
+    return strlen (value) == length && memcmp (name, value, length) == 0;
+}
+
+static gboolean
+tokenizer_read_app (JsonTokenizer *tokenizer, const gchar *snap_name, GPtrArray *apps)
+{
+    g_autofree gchar *name = NULL;
+    g_autofree gchar *app_snap_name = NULL;
+    g_autofree gchar *common_id = NULL;
+    g_autofree gchar *daemon = NULL;
+    g_autofree gchar *desktop_file = NULL;
+    gboolean enabled = FALSE;
+    gboolean active = FALSE;
+
+    if (!tokenizer_next_is (tokenizer, '{'))
+        return FALSE;
+    if (!tokenizer_next_is (tokenizer, '}')) {
+        do {
+            const gchar *n;
+            gsize n_length;
+            if (!tokenizer_read_name (tokenizer, &n, &n_length))
+                return FALSE;
+
+            gboolean result;
+            if (name_is (n, n_length, "name"))
+                result = tokenizer_read_string_value (tokenizer, &name);
+            else if (name_is (n, n_length, "snap"))
+                result = tokenizer_read_string_value (tokenizer, &app_snap_name);
+            else if (name_is (n, n_length, "common-id"))
+                result = tokenizer_read_string_value (tokenizer, &common_id);
+            else if (name_is (n, n_length, "daemon"))
+                result = tokenizer_read_string_value (tokenizer, &daemon);
+            else if (name_is (n, n_length, "desktop-file"))
+                result = tokenizer_read_string_value (tokenizer, &desktop_file);
+            else if (name_is (n, n_length, "enabled"))
+                result = tokenizer_read_bool_value (tokenizer, &enabled);
+            else if (name_is (n, n_length, "active"))
+                result = tokenizer_read_bool_value (tokenizer, &active);
+            else
+                result = tokenizer_skip_value (tokenizer);
+            if (!result)
+                return FALSE;
+        } while (tokenizer_next_is (tokenizer, ','));
+
+        if (!tokenizer_next_is (tokenizer, '}'))
+            return FALSE;
+    }
+
+    g_ptr_array_add (apps, _snapd_app_new (g_steal_pointer (&name),
+                                           _snapd_string_pool_intern (tokenizer->pool, snap_name ? snap_name : app_snap_name),
+                                           g_steal_pointer (&common_id),
+                                           parse_daemon_type (daemon),
+                                           g_steal_pointer (&desktop_file),
+                                           enabled,
+                                           active));
+    return TRUE;
+}
+
+/* Read an array of apps, leaving @apps empty if it is another type */
+static gboolean
+tokenizer_read_apps (JsonTokenizer *tokenizer, const gchar *snap_name, GPtrArray *apps)
+{
+    g_ptr_array_set_size (apps, 0);
+    if (tokenizer_peek (tokenizer) != '[')
+        return tokenizer_skip_value (tokenizer);
+    tokenizer->c++;
+
+    if (tokenizer_next_is (tokenizer, ']'))
+        return TRUE;
+    do {
+        if (!tokenizer_read_app (tokenizer, snap_name, apps))
+            return FALSE;
+    } while (tokenizer_next_is (tokenizer, ','));
+
+    return tokenizer_next_is (tokenizer, ']');
+}
+
+static gboolean
+tokenizer_read_channel (JsonTokenizer *tokenizer, GPtrArray *channels)
+{
+    g_autofree gchar *channel = NULL;
+    g_autofree gchar *confinement = NULL;
+    g_autofree gchar *epoch = NULL;
+    g_autofree gchar *released_at = NULL;
+    g_autofree gchar *revision = NULL;
+    gint64 size = 0;
+    g_autofree gchar *version = NULL;
+
+    if (!tokenizer_next_is (tokenizer, '{'))
+        return FALSE;
+    if (!tokenizer_next_is (tokenizer, '}')) {
+        do {
+            const gchar *name;
+            gsize name_length;
+            if (!tokenizer_read_name (tokenizer, &name, &name_length))
+                return FALSE;
+
+            gboolean result;
+            if (name_is (name, name_length, "channel"))
+                result = tokenizer_read_string_value (tokenizer, &channel);
+            else if (name_is (name, name_length, "confinement"))
+                result = tokenizer_read_string_value (tokenizer, &confinement);
+            else if (name_is (name, name_length, "epoch"))
+                result = tokenizer_read_string_value (tokenizer, &epoch);
+            else if (name_is (name, name_length, "released-at"))
+                result = tokenizer_read_string_value (tokenizer, &released_at);
+            else if (name_is (name, name_length, "revision"))
+                result = tokenizer_read_string_value (tokenizer, &revision);
+            else if (name_is (name, name_length, "size"))
+                result = tokenizer_read_int_value (tokenizer, &size);
+            else if (name_is (name, name_length, "version"))
+                result = tokenizer_read_string_value (tokenizer, &version);
+            else
+                result = tokenizer_skip_value (tokenizer);
+            if (!result)
+                return FALSE;
+        } while (tokenizer_next_is (tokenizer, ','));
+
+        if (!tokenizer_next_is (tokenizer, '}'))
+            return FALSE;
+    }
+
+    g_ptr_array_add (channels, _snapd_channel_new (_snapd_string_pool_intern (tokenizer->pool, channel),
+                                                   parse_confinement (confinement != NULL ? confinement : ""),
+                                                   _snapd_string_pool_intern (tokenizer->pool, epoch),
+                                                   released_at != NULL ? parse_date_time (released_at) : NULL,
+                                                   g_steal_pointer (&revision),
+                                                   size,
+                                                   g_steal_pointer (&version)));
+    return TRUE;
+}
+
+/* Read an object of channels, leaving @channels empty if it is another type */
+static gboolean
+tokenizer_read_channels (JsonTokenizer *tokenizer, GPtrArray *channels)
+{
+    g_ptr_array_set_size (channels, 0);
+    if (tokenizer_peek (tokenizer) != '{')
+        return tokenizer_skip_value (tokenizer);
+    tokenizer->c++;
+
+    if (tokenizer_next_is (tokenizer, '}'))
+        return TRUE;
+    do {
+        /* The channel name is also in the channel object */
+        const gchar *name;
+        gsize name_length;
+        gboolean escaped;
+        if (!tokenizer_scan_string (tokenizer, &name, &name_length, &escaped) || !tokenizer_next_is (tokenizer, ':'))
+            return FALSE;
+        if (!tokenizer_read_channel (tokenizer, channels))
+            return FALSE;
+    } while (tokenizer_next_is (tokenizer, ','));
+
+    return tokenizer_next_is (tokenizer, '}');
+}
+
+static gboolean
+tokenizer_read_media_item (JsonTokenizer *tokenizer, GPtrArray *media)
+{
+    g_autofree gchar *type = NULL;
+    g_autofree gchar *url = NULL;
+    gint64 width = 0;
+    gint64 height = 0;
+
+    if (!tokenizer_next_is (tokenizer, '{'))
+        return FALSE;
+    if (!tokenizer_next_is (tokenizer, '}')) {
+        do {
+            const gchar *name;
+            gsize name_length;
+            if (!tokenizer_read_name (tokenizer, &name, &name_length))
+                return FALSE;
+
+            gboolean result;
+            if (name_is (name, name_length, "type"))
+                result = tokenizer_read_string_value (tokenizer, &type);
+            else if (name_is (name, name_length, "url"))
+                result = tokenizer_read_string_value (tokenizer, &url);
+            else if (name_is (name, name_length, "width"))
+                result = tokenizer_read_int_value (tokenizer, &width);
+            else if (name_is (name, name_length, "height"))
+                result = tokenizer_read_int_value (tokenizer, &height);
+            else
+                result = tokenizer_skip_value (tokenizer);
+            if (!result)
+                return FALSE;
+        } while (tokenizer_next_is (tokenizer, ','));
+
+        if (!tokenizer_next_is (tokenizer, '}'))
+            return FALSE;
+    }
+
+    g_ptr_array_add (media, _snapd_media_new (_snapd_string_pool_intern (tokenizer->pool, type),
+                                              g_steal_pointer (&url),
+                                              (guint) width,
+                                              (guint) height));
+    return TRUE;
+}
+
+/* Read an array of media, leaving @media empty if it is another type */
+static gboolean
+tokenizer_read_media (JsonTokenizer *tokenizer, GPtrArray *media)
+{
+    g_ptr_array_set_size (media, 0);
+    if (tokenizer_peek (tokenizer) != '[')
+        return tokenizer_skip_value (tokenizer);
+    tokenizer->c++;
+
+    if (tokenizer_next_is (tokenizer, ']'))
+        return TRUE;
+    do {
+        if (!tokenizer_read_media_item (tokenizer, media))
+            return FALSE;
+    } while (tokenizer_next_is (tokenizer, ','));
+
+    return tokenizer_next_is (tokenizer, ']');
+}
+
+/* Read an object of prices, leaving @prices empty if it is another type */
+static gboolean
+tokenizer_read_prices (JsonTokenizer *tokenizer, GPtrArray *prices)
+{
+    g_ptr_array_set_size (prices, 0);
+    if (tokenizer_peek (tokenizer) != '{')
+        return tokenizer_skip_value (tokenizer);
+    tokenizer->c++;
+
+    if (tokenizer_next_is (tokenizer, '}'))
+        return TRUE;
+    do {
+        g_autofree gchar *currency = NULL;
+        if (!tokenizer_read_string (tokenizer, &currency) || !tokenizer_next_is (tokenizer, ':'))
+            return FALSE;
+        gdouble amount;
+        if (!tokenizer_read_double (tokenizer, &amount))
+            return FALSE;
+
+        g_ptr_array_add (prices, g_object_new (SNAPD_TYPE_PRICE,
+                                               "amount", amount,
+                                               "currency", currency,
+                                               NULL));
+    } while (tokenizer_next_is (tokenizer, ','));
+
+    return tokenizer_next_is (tokenizer, '}');
+}
+
+/* Skip over a value and return the JSON data it covers */
+static gboolean
+tokenizer_read_raw_value (JsonTokenizer *tokenizer, const gchar **start, gsize *length)
+{
+    tokenizer_skip_whitespace (tokenizer);
+    *start = tokenizer->c;
+    if (!tokenizer_skip_value (tokenizer))
+        return FALSE;
+    *length = tokenizer->c - *start;
+    return TRUE;
+}
+
+/* Parse a value with json-glib, @node is left as %NULL if there is no value */
+static gboolean
+parse_raw_value (const gchar *data, gsize length, JsonNode **node)
+{
+    *node = NULL;
+    if (data == NULL)
+        return TRUE;
+
+    g_autoptr(JsonParser) parser = json_parser_new ();
+    if (!json_parser_load_from_data (parser, data, length, NULL))
+        return FALSE;
+
+    *node = json_node_copy (json_parser_get_root (parser));
+    return TRUE;
+}
+
+/* Append a raw JSON value to the deferred members of a snap */
+static void
+append_deferred_value (GString *deferred, const gchar *data, gsize length)
+{
+    if (deferred->len > 1)
+        g_string_append_c (deferred, ',');
+    if (data != NULL)
+        g_string_append_len (deferred, data, length);
+    else
+        g_string_append (deferred, "null");
+}
+
+/* Parse the apps, channels, media and prices of a snap that were stored by parse_snap_fast() */
+static gboolean
+materialize_snap_members (GBytes *data, const gchar *snap_name, GPtrArray *apps, GPtrArray *channels, GPtrArray *media, GPtrArray *prices)
+{
+    gsize length;
+    const gchar *d = g_bytes_get_data (data, &length);
+    JsonTokenizer tokenizer = { d, d + length, NULL };
+    if (tokenizer_next_is (&tokenizer, '[') &&
+        tokenizer_read_apps (&tokenizer, snap_name, apps) && tokenizer_next_is (&tokenizer, ',') &&
+        tokenizer_read_channels (&tokenizer, channels) && tokenizer_next_is (&tokenizer, ',') &&
+        tokenizer_read_media (&tokenizer, media) && tokenizer_next_is (&tokenizer, ',') &&
+        tokenizer_read_prices (&tokenizer, prices) && tokenizer_next_is (&tokenizer, ']'))
+        return TRUE;
+
+    /* Fallback to json-glib for anything the tokenizer can't handle */
+    g_ptr_array_set_size (apps, 0);
+    g_ptr_array_set_size (channels, 0);
+    g_ptr_array_set_size (media, 0);
+    g_ptr_array_set_size (prices, 0);
+    g_autoptr(JsonNode) node = NULL;
+    if (!parse_raw_value (d, length, &node) || node == NULL || !JSON_NODE_HOLDS_ARRAY (node))
+        return FALSE;
+    JsonArray *members = json_node_get_array (node);
+    if (json_array_get_length (members) != 4)
+        return FALSE;
+
+    JsonNode *apps_node = json_array_get_element (members, 0);
+    if (JSON_NODE_HOLDS_ARRAY (apps_node) &&
+        !parse_apps (json_node_get_array (apps_node), snap_name, NULL, apps, NULL))
+        return FALSE;
+    JsonNode *channels_node = json_array_get_element (members, 1);
+    if (JSON_NODE_HOLDS_OBJECT (channels_node) &&
+        !parse_channels (json_node_get_object (channels_node), NULL, channels, NULL))
+        return FALSE;
+    JsonNode *media_node = json_array_get_element (members, 2);
+    if (JSON_NODE_HOLDS_ARRAY (media_node) &&
+        !parse_media (json_node_get_array (media_node), NULL, media, NULL))
+        return FALSE;
+    JsonNode *prices_node = json_array_get_element (members, 3);
+    if (JSON_NODE_HOLDS_OBJECT (prices_node) &&
+        !parse_prices (json_node_get_object (prices_node), prices, NULL))
+        return FALSE;
+
+    return TRUE;
+}
+
+/* If @deferred is not %NULL the apps, channels, media and prices are not parsed,
+ * instead the JSON for them is returned as an array to be parsed with materialize_snap_members() */
+static gboolean
+parse_snap_fast (JsonTokenizer *tokenizer, SnapFields *fields, GBytes **deferred)
+{
+    const gchar *apps_data = NULL, *channels_data = NULL, *media_data = NULL, *prices_data = NULL;
+    gsize apps_length = 0, channels_length = 0, media_length = 0, prices_length = 0;
+    g_autofree gchar *developer = NULL;
+    gboolean have_publisher = FALSE;
+    g_autofree gchar *publisher_display_name = NULL;
+    g_autofree gchar *publisher_id = NULL;
+    g_autofree gchar *publisher_username = NULL;
+    g_autofree gchar *publisher_validation = NULL;
+    g_autofree gchar *confinement = NULL;
+    g_autofree gchar *install_date = NULL;
+    g_autofree gchar *snap_type = NULL;
+    g_autofree gchar *status = NULL;
+    g_autoptr(GPtrArray) tracks = g_ptr_array_new_with_free_func (g_free);
+    g_autoptr(GPtrArray) tracks_legacy = g_ptr_array_new_with_free_func (g_free);
+    gboolean have_tracks_legacy = FALSE;
+
+    if (!tokenizer_next_is (tokenizer, '{'))
+        return FALSE;
+    if (!tokenizer_next_is (tokenizer, '}')) {
+        do {
+            const gchar *name;
+            gsize name_length;
+            gboolean escaped;
+            if (!tokenizer_scan_string (tokenizer, &name, &name_length, &escaped) || escaped)
+                return FALSE;
+            if (!tokenizer_next_is (tokenizer, ':'))
+                return FALSE;
+
+            gboolean result;
+            switch (lookup_snap_field (name, name_length)) {
+            case SNAP_FIELD_APPS:
+                result = tokenizer_read_raw_value (tokenizer, &apps_data, &apps_length);
+                break;
+            case SNAP_FIELD_BASE:
+                result = tokenizer_read_pooled_value (tokenizer, &fields->base);
+                break;
+            case SNAP_FIELD_BROKEN:
+                result = tokenizer_read_string_value (tokenizer, &fields->broken);
+                break;
+            case SNAP_FIELD_CHANNEL:
+                result = tokenizer_read_pooled_value (tokenizer, &fields->channel);
+                break;
+            case SNAP_FIELD_CHANNELS:
+                if (deferred != NULL)
+                    result = tokenizer_read_raw_value (tokenizer, &channels_data, &channels_length);
+                else
+                    result = tokenizer_read_channels (tokenizer, fields->channels);
+                break;
+            case SNAP_FIELD_COMMON_IDS:
+                result = tokenizer_read_string_array (tokenizer, fields->common_ids);
+                break;
+            case SNAP_FIELD_CONFINEMENT:
+                result = tokenizer_read_string_value (tokenizer, &confinement);
+                break;
+            case SNAP_FIELD_CONTACT:
+                result = tokenizer_read_string_value (tokenizer, &fields->contact);
+                break;
+            case SNAP_FIELD_DESCRIPTION:
+                result = tokenizer_read_string_value (tokenizer, &fields->description);
+                break;
+            case SNAP_FIELD_DEVELOPER:
+                result = tokenizer_read_string_value (tokenizer, &developer);
+                break;
+            case SNAP_FIELD_DEVMODE:
+                result = tokenizer_read_bool_value (tokenizer, &fields->devmode);
+                break;
+            case SNAP_FIELD_DOWNLOAD_SIZE:
+                result = tokenizer_read_int_value (tokenizer, &fields->download_size);
+                break;
+            case SNAP_FIELD_ICON:
+                result = tokenizer_read_string_value (tokenizer, &fields->icon);
+                break;
+            case SNAP_FIELD_ID:
+                result = tokenizer_read_string_value (tokenizer, &fields->id);
+                break;
+            case SNAP_FIELD_INSTALL_DATE:
+                result = tokenizer_read_string_value (tokenizer, &install_date);
+                break;
+            case SNAP_FIELD_INSTALLED_SIZE:
+                result = tokenizer_read_int_value (tokenizer, &fields->installed_size);
+                break;
+            case SNAP_FIELD_JAILMODE:
+                result = tokenizer_read_bool_value (tokenizer, &fields->jailmode);
+                break;
+            case SNAP_FIELD_LICENSE:
+                result = tokenizer_read_pooled_value (tokenizer, &fields->license);
+                break;
+            case SNAP_FIELD_MEDIA:
+                if (deferred != NULL)
+                    result = tokenizer_read_raw_value (tokenizer, &media_data, &media_length);
+                else
+                    result = tokenizer_read_media (tokenizer, fields->media);
+                break;
+            case SNAP_FIELD_MOUNTED_FROM:
+                result = tokenizer_read_string_value (tokenizer, &fields->mounted_from);
+                break;
+            case SNAP_FIELD_NAME:
+                result = tokenizer_read_string_value (tokenizer, &fields->name);
+                break;
+            case SNAP_FIELD_PRICES:
+                if (deferred != NULL)
+                    result = tokenizer_read_raw_value (tokenizer, &prices_data, &prices_length);
+                else
+                    result = tokenizer_read_prices (tokenizer, fields->prices);
+                break;
+            case SNAP_FIELD_PRIVATE:
+                result = tokenizer_read_bool_value (tokenizer, &fields->private);
+                break;
+            case SNAP_FIELD_PUBLISHER:
+                result = tokenizer_read_publisher (tokenizer, &have_publisher, &publisher_display_name, &publisher_id, &publisher_username, &publisher_validation);
+                break;
+            case SNAP_FIELD_REVISION:
+                result = tokenizer_read_string_value (tokenizer, &fields->revision);
+                break;
+            case SNAP_FIELD_STATUS:
+                result = tokenizer_read_string_value (tokenizer, &status);
+                break;
+            case SNAP_FIELD_SUMMARY:
+                result = tokenizer_read_string_value (tokenizer, &fields->summary);
+                break;
+            case SNAP_FIELD_TITLE:
+                result = tokenizer_read_string_value (tokenizer, &fields->title);
+                break;
+            case SNAP_FIELD_TRACKING_CHANNEL:
+                result = tokenizer_read_pooled_value (tokenizer, &fields->tracking_channel);
+                break;
+            case SNAP_FIELD_TRACKS:
+                result = tokenizer_read_string_array (tokenizer, tracks);
+                break;
+            case SNAP_FIELD_TRACKS_LEGACY:
+                have_tracks_legacy = TRUE;
+                result = tokenizer_read_string_array (tokenizer, tracks_legacy);
+                break;
+            case SNAP_FIELD_TRYMODE:
+                result = tokenizer_read_bool_value (tokenizer, &fields->trymode);
+                break;
+            case SNAP_FIELD_TYPE:
+                result = tokenizer_read_string_value (tokenizer, &snap_type);
+                break;
+            case SNAP_FIELD_VERSION:
+                result = tokenizer_read_string_value (tokenizer, &fields->version);
+                break;
+            case SNAP_FIELD_WEBSITE:
+                result = tokenizer_read_string_value (tokenizer, &fields->website);
+                break;
+            case SNAP_FIELD_UNKNOWN:
+            default:
+                result = tokenizer_skip_value (tokenizer);
+                break;
+            }
+            if (!result)
+                return FALSE;
+        } while (tokenizer_next_is (tokenizer, ','));
+
+        if (!tokenizer_next_is (tokenizer, '}'))
+            return FALSE;
+    }
+    tokenizer_skip_whitespace (tokenizer);
+    if (tokenizer->c != tokenizer->end)
+        return FALSE;
+
+    fields->confinement = parse_confinement (confinement != NULL ? confinement : "");
+    fields->snap_type = parse_snap_type (snap_type != NULL ? snap_type : "");
+    fields->status = parse_snap_status (status != NULL ? status : "");
+    if (install_date != NULL)
+        fields->install_date = parse_date_time (install_date);
+
+    g_ptr_array_unref (fields->tracks);
+    fields->tracks = have_tracks_legacy ? g_steal_pointer (&tracks_legacy) : g_steal_pointer (&tracks);
+
+    if (have_publisher) {
+        fields->publisher_display_name = _snapd_string_pool_intern (tokenizer->pool, publisher_display_name);
+        fields->publisher_id = _snapd_string_pool_intern (tokenizer->pool, publisher_id);
+        fields->publisher_username = _snapd_string_pool_intern (tokenizer->pool, publisher_username != NULL ? publisher_username : developer);
+        fields->publisher_validation = parse_publisher_validation (publisher_validation);
+    }
+    else
+        fields->publisher_username = _snapd_string_pool_intern (tokenizer->pool, developer);
+
+    /* Keep the complex members to be parsed when they are used */
+    if (deferred != NULL) {
+        g_autoptr(GString) members = g_string_sized_new (apps_length + channels_length + media_length + prices_length + 32);
+        g_string_append_c (members, '[');
+        append_deferred_value (members, apps_data, apps_length);
+        append_deferred_value (members, channels_data, channels_length);
+        append_deferred_value (members, media_data, media_length);
+        append_deferred_value (members, prices_data, prices_length);
+        g_string_append_c (members, ']');
+        gsize length = members->len;
+        *deferred = g_bytes_new_take (g_string_free (g_steal_pointer (&members), FALSE), length);
+        return TRUE;
+    }
+
+    /* Apps are read last as they need the snap name */
+    if (apps_data != NULL) {
+        JsonTokenizer apps_tokenizer = { apps_data, apps_data + apps_length, tokenizer->pool };
+        if (!tokenizer_read_apps (&apps_tokenizer, fields->name, fields->apps))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* If @defer_members is %TRUE then apps, channels, media and prices are parsed when first used.
+ * @parser is always %SNAPD_JSON_PARSER_TOKENIZER in the library, json-glib can be selected to compare the results. */
+SnapdSnap *
+_snapd_json_parse_snap_data (const gchar *data, gsize length, SnapdStringPool *pool, gboolean defer_members, SnapdJsonParser parser, GError **error)
+{
+    /* The tokenizer doesn't check the encoding, so leave invalid data to json-glib */
+    if (parser == SNAPD_JSON_PARSER_TOKENIZER && g_utf8_validate (data, length, NULL)) {
+        JsonTokenizer tokenizer = { data, data + length, pool };
+        g_auto(SnapFields) fields = { NULL };
+        snap_fields_init (&fields);
+        g_autoptr(GBytes) deferred = NULL;
+        if (parse_snap_fast (&tokenizer, &fields, defer_members ? &deferred : NULL)) {
+            SnapdSnap *snap = make_snap (&fields);
+            if (deferred != NULL)
+                _snapd_snap_set_deferred (snap, deferred, materialize_snap_members);
+            return snap;
+        }
+    }
+
+    /* Fallback to json-glib for anything the fast path can't handle */
+    g_autoptr(JsonParser) json_parser = json_parser_new ();
+    g_autoptr(GError) error_local = NULL;
+    if (!json_parser_load_from_data (json_parser, data, length, &error_local)) {
+        g_set_error (error, SNAPD_ERROR, SNAPD_ERROR_BAD_RESPONSE, "Unable to parse snapd response: %s", error_local->message);
+        return NULL;
+    }
+
+    return _snapd_json_parse_snap (json_parser_get_root (json_parser), pool, error);
+}
+
+SnapdApp *
+_snapd_json_parse_app (JsonNode *node, const gchar *snap_name, SnapdStringPool *pool, GError **error)
+{
+    if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
+        g_set_error (error,
+                     SNAPD_ERROR,
+                     SNAPD_ERROR_READ_FAILED,
+                     "Unexpected app type");
+        return NULL;
+    }
+    JsonObject *object = json_node_get_object (node);
+
+    const gchar *app_snap_name = _snapd_json_get_string (object, "snap", NULL);
+    return _snapd_app_new (g_strdup (_snapd_json_get_string (object, "name", NULL)),
+                           _snapd_string_pool_intern (pool, snap_name ? snap_name : app_snap_name),
+                           g_strdup (_snapd_json_get_string (object, "common-id", NULL)),
+                           parse_daemon_type (_snapd_json_get_string (object, "daemon", NULL)),
+                           g_strdup (_snapd_json_get_string (object, "desktop-file", NULL)),
+                           _snapd_json_get_bool (object, "enabled", FALSE),
+                           _snapd_json_get_bool (object, "active", FALSE));
+}
+
+SnapdAlias *
+_snapd_json_parse_alias (JsonNode *node, const gchar *snap_name, const gchar *name, GError **error)
+{
+    if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
+        g_set_error (error,
+                     SNAPD_ERROR,
+                     SNAPD_ERROR_READ_FAILED,
+                     "Unexpected alias type");
+        return FALSE;
+    }
+    JsonObject *object = json_node_get_object (node);
+
+    const gchar *status_string = _snapd_json_get_string (object, "status", NULL);
+    SnapdAliasStatus status = SNAPD_ALIAS_STATUS_UNKNOWN;
+    if (strcmp (status_string, "disabled") == 0)
+        status = SNAPD_ALIAS_STATUS_DISABLED;
+    else if (strcmp (status_string, "auto") == 0)
+        status = SNAPD_ALIAS_STATUS_AUTO;
+    else if (strcmp (status_string, "manual") == 0)
+        status = SNAPD_ALIAS_STATUS_MANUAL;
+    else
+        status = SNAPD_ALIAS_STATUS_UNKNOWN;
+
+    return g_object_new (SNAPD_TYPE_ALIAS,
+                         "snap", snap_name,
+                         "app-auto", _snapd_json_get_string (object, "auto", NULL),
+                         "app-manual", _snapd_json_get_string (object, "manual", NULL),
+                         "command", _snapd_json_get_string (object, "command", NULL),
+                         "name", name,
+                         "status", status,
+                         NULL);
+}
+
+SnapdUserInformation *
+_snapd_json_parse_user_information (JsonNode *node, GError **error)
+{
+    if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
+        g_set_error (error,
+                     SNAPD_ERROR,
+                     SNAPD_ERROR_READ_FAILED,
+                     "Unexpected user information type");
+        return NULL;
+    }
+    JsonObject *object = json_node_get_object (node);
+
+    g_autoptr(JsonArray) ssh_keys = _snapd_json_get_array (object, "ssh-keys");
+    g_autoptr(GPtrArray) ssh_key_array = g_ptr_array_new ();
+    for (guint i = 0; i < json_array_get_length (ssh_keys); i++) {
+        JsonNode *node = json_array_get_element (ssh_keys, i);
+
+        if (json_node_get_value_type (node) != G_TYPE_STRING) {
+            g_set_error (error, SNAPD_ERROR, SNAPD_ERROR_READ_FAILED, "Unexpected SSH key type");
+            return NULL;
+        }
+
+        g_ptr_array_add (ssh_key_array, (gpointer) json_node_get_string (node));
+    }
+
+    g_ptr_array_add (ssh_key_array, NULL);
+
+    g_autoptr(SnapdAuthData) auth_data = NULL;
+    if (json_object_has_member (object, "macaroon")) {
+        g_autoptr(JsonArray) discharges = _snapd_json_get_array (object, "discharges");
+        g_autoptr(GPtrArray) discharge_array = g_ptr_array_new ();
+        for (guint i = 0; i < json_array_get_length (discharges); i++) {
+            JsonNode *node = json_array_get_element (discharges, i);
+
+            if (json_node_get_value_type (node) != G_TYPE_STRING) {
+                g_set_error (error,
+                             SNAPD_ERROR,
+                             SNAPD_ERROR_READ_FAILED,
+                             "Unexpected discharge type");
+                return FALSE;
+            }
+
+            g_ptr_array_add (discharge_array, (gpointer) json_node_get_string (node));
+        }
+        g_ptr_array_add (discharge_array, NULL);
+        auth_data = snapd_auth_data_new (_snapd_json_get_string (object, "macaroon", NULL), (GStrv) discharge_array->pdata);
+    }
+
+    return g_object_new (SNAPD_TYPE_USER_INFORMATION,
+                         "id", _snapd_json_get_int (object, "id", -1),
+                         "username", _snapd_json_get_string (object, "username", NULL),
+                         "email", _snapd_json_get_string (object, "email", NULL),
+                         "ssh-keys", (GStrv) ssh_key_array->pdata,
+                         "auth-data", auth_data,
+                         NULL);
+}
+
+GHashTable *
+_snapd_json_parse_object (JsonObject *object, GError **error)
+{
+    g_autoptr(GHashTable) attributes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
 
     JsonObjectIter iter;
     json_object_iter_init (&iter, object);
@@ -1024,7 +2317,7 @@ _snapd_json_parse_attributes (JsonNode *node, GError **error)
 }
 
 SnapdSlot *
-_snapd_json_parse_slot (JsonNode *node, GError **error)
+_snapd_json_parse_slot (JsonNode *node, SnapdStringPool *pool, GError **error)
 {
     if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
         g_set_error (error,
@@ -1040,7 +2333,7 @@ _snapd_json_parse_slot (JsonNode *node, GError **error)
     for (guint i = 0; i < json_array_get_length (connections); i++) {
         JsonNode *node = json_array_get_element (connections, i);
 
-        SnapdPlugRef *plug_ref = _snapd_json_parse_plug_ref (node, error);
+        SnapdPlugRef *plug_ref = _snapd_json_parse_plug_ref (node, pool, error);
         if (plug_ref == NULL)
             return NULL;
         g_ptr_array_add (plug_refs, plug_ref);
@@ -1055,19 +2348,17 @@ _snapd_json_parse_slot (JsonNode *node, GError **error)
     else
         attributes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
 
-    return g_object_new (SNAPD_TYPE_SLOT,
-                         "name", _snapd_json_get_string (object, "slot", NULL),
-                         "snap", _snapd_json_get_string (object, "snap", NULL),
-                         "interface", _snapd_json_get_string (object, "interface", NULL),
-                         "label", _snapd_json_get_string (object, "label", NULL),
-                         "connections", plug_refs,
-                         "attributes", attributes,
-                         // FIXME: apps
-                         NULL);
+    // FIXME: apps
+    return _snapd_slot_new (g_strdup (_snapd_json_get_string (object, "slot", NULL)),
+                            _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "snap", NULL)),
+                            _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "interface", NULL)),
+                            g_strdup (_snapd_json_get_string (object, "label", NULL)),
+                            g_steal_pointer (&plug_refs),
+                            g_steal_pointer (&attributes));
 }
 
 SnapdPlug *
-_snapd_json_parse_plug (JsonNode *node, GError **error)
+_snapd_json_parse_plug (JsonNode *node, SnapdStringPool *pool, GError **error)
 {
     if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
         g_set_error (error,
@@ -1083,7 +2374,7 @@ _snapd_json_parse_plug (JsonNode *node, GError **error)
     for (guint i = 0; i < json_array_get_length (connections); i++) {
         JsonNode *node = json_array_get_element (connections, i);
 
-        SnapdSlotRef *slot_ref = _snapd_json_parse_slot_ref (node, error);
+        SnapdSlotRef *slot_ref = _snapd_json_parse_slot_ref (node, pool, error);
         if (slot_ref == NULL)
             return NULL;
         g_ptr_array_add (slot_refs, slot_ref);
@@ -1098,19 +2389,17 @@ _snapd_json_parse_plug (JsonNode *node, GError **error)
     else
         attributes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
 
-    return g_object_new (SNAPD_TYPE_PLUG,
-                         "name", _snapd_json_get_string (object, "plug", NULL),
-                         "snap", _snapd_json_get_string (object, "snap", NULL),
-                         "interface", _snapd_json_get_string (object, "interface", NULL),
-                         "label", _snapd_json_get_string (object, "label", NULL),
-                         "connections", slot_refs,
-                         "attributes", attributes,
-                         // FIXME: apps
-                         NULL);
+    // FIXME: apps
+    return _snapd_plug_new (g_strdup (_snapd_json_get_string (object, "plug", NULL)),
+                            _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "snap", NULL)),
+                            _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "interface", NULL)),
+                            g_strdup (_snapd_json_get_string (object, "label", NULL)),
+                            g_steal_pointer (&slot_refs),
+                            g_steal_pointer (&attributes));
 }
 
 SnapdSlotRef *
-_snapd_json_parse_slot_ref (JsonNode *node, GError **error)
+_snapd_json_parse_slot_ref (JsonNode *node, SnapdStringPool *pool, GError **error)
 {
     if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
         g_set_error (error,
@@ -1121,14 +2410,12 @@ _snapd_json_parse_slot_ref (JsonNode *node, GError **error)
     }
     JsonObject *object = json_node_get_object (node);
 
-    return g_object_new (SNAPD_TYPE_SLOT_REF,
-                         "slot", _snapd_json_get_string (object, "slot", NULL),
-                         "snap", _snapd_json_get_string (object, "snap", NULL),
-                         NULL);
+    return _snapd_slot_ref_new (g_strdup (_snapd_json_get_string (object, "slot", NULL)),
+                                _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "snap", NULL)));
 }
 
 SnapdPlugRef *
-_snapd_json_parse_plug_ref (JsonNode *node, GError **error)
+_snapd_json_parse_plug_ref (JsonNode *node, SnapdStringPool *pool, GError **error)
 {
     if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
         g_set_error (error,
@@ -1139,14 +2426,12 @@ _snapd_json_parse_plug_ref (JsonNode *node, GError **error)
     }
     JsonObject *object = json_node_get_object (node);
 
-    return g_object_new (SNAPD_TYPE_PLUG_REF,
-                         "plug", _snapd_json_get_string (object, "plug", NULL),
-                         "snap", _snapd_json_get_string (object, "snap", NULL),
-                         NULL);
+    return _snapd_plug_ref_new (g_strdup (_snapd_json_get_string (object, "plug", NULL)),
+                                _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "snap", NULL)));
 }
 
 SnapdConnection *
-_snapd_json_parse_connection (JsonNode *node, GError **error)
+_snapd_json_parse_connection (JsonNode *node, SnapdStringPool *pool, GError **error)
 {
     if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
         g_set_error (error,
@@ -1159,13 +2444,13 @@ _snapd_json_parse_connection (JsonNode *node, GError **error)
 
     g_autoptr(SnapdSlotRef) slot_ref = NULL;
     if (json_object_has_member (object, "slot")) {
-        slot_ref = _snapd_json_parse_slot_ref (json_object_get_member (object, "slot"), error);
+        slot_ref = _snapd_json_parse_slot_ref (json_object_get_member (object, "slot"), pool, error);
         if (slot_ref == NULL)
             return NULL;
     }
     g_autoptr(SnapdPlugRef) plug_ref = NULL;
     if (json_object_has_member (object, "plug")) {
-        plug_ref = _snapd_json_parse_plug_ref (json_object_get_member (object, "plug"), error);
+        plug_ref = _snapd_json_parse_plug_ref (json_object_get_member (object, "plug"), pool, error);
         if (plug_ref == NULL)
             return NULL;
     }
@@ -1188,19 +2473,17 @@ _snapd_json_parse_connection (JsonNode *node, GError **error)
     else
         plug_attributes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
 
-    return g_object_new (SNAPD_TYPE_CONNECTION,
-                         "slot", slot_ref,
-                         "plug", plug_ref,
-                         "interface", _snapd_json_get_string (object, "interface", NULL),
-                         "manual", _snapd_json_get_bool (object, "manual", FALSE),
-                         "gadget", _snapd_json_get_bool (object, "gadget", FALSE),
-                         "slot-attrs", slot_attributes,
-                         "plug-attrs", plug_attributes,
-                         NULL);
+    return _snapd_connection_new (g_steal_pointer (&slot_ref),
+                                  g_steal_pointer (&plug_ref),
+                                  _snapd_string_pool_intern (pool, _snapd_json_get_string (object, "interface", NULL)),
+                                  _snapd_json_get_bool (object, "manual", FALSE),
+                                  _snapd_json_get_bool (object, "gadget", FALSE),
+                                  g_steal_pointer (&slot_attributes),
+                                  g_steal_pointer (&plug_attributes));
 }
 
 SnapdInterface *
-_snapd_json_parse_interface (JsonNode *node, GError **error)
+_snapd_json_parse_interface (JsonNode *node, SnapdStringPool *pool, GError **error)
 {
     if (json_node_get_value_type (node) != JSON_TYPE_OBJECT) {
         g_set_error (error,
@@ -1216,7 +2499,7 @@ _snapd_json_parse_interface (JsonNode *node, GError **error)
     for (guint i = 0; i < json_array_get_length (plugs); i++) {
         JsonNode *node = json_array_get_element (plugs, i);
 
-        SnapdPlug *plug = _snapd_json_parse_plug (node, error);
+        SnapdPlug *plug = _snapd_json_parse_plug (node, pool, error);
         if (plug == NULL)
             return FALSE;
 
@@ -1228,7 +2511,7 @@ _snapd_json_parse_interface (JsonNode *node, GError **error)
     for (guint i = 0; i < json_array_get_length (slots); i++) {
         JsonNode *node = json_array_get_element (slots, i);
 
-        SnapdSlot *slot = _snapd_json_parse_slot (node, error);
+        SnapdSlot *slot = _snapd_json_parse_slot (node, pool, error);
         if (slot == NULL)
             return FALSE;
 
@@ -1243,3 +2526,274 @@ _snapd_json_parse_interface (JsonNode *node, GError **error)
                          "slots", slot_array,
                          NULL);
 }
+
+typedef enum
+{
+    STREAM_OUTPUT_NONE,
+    STREAM_OUTPUT_ENVELOPE,
+    STREAM_OUTPUT_ELEMENT
+} StreamOutput;
+
+/* Splits the elements out of an array member in a JSON object as data is received */
+struct _SnapdJsonStream
+{
+    /* Member of the top level object that contains the array to stream */
+    gchar *member;
+
+    /* Callback to pass each array element to */
+    SnapdJsonStreamCallback callback;
+    gpointer callback_data;
+
+    /* Depth of objects / arrays */
+    guint depth;
+
+    /* TRUE if inside a string */
+    gboolean in_string;
+    gboolean escaped;
+
+    /* Last string read in the top level object */
+    GString *key;
+
+    /* TRUE if reading the value of the member */
+    gboolean in_member;
+
+    /* TRUE if reading the array being streamed */
+    gboolean in_array;
+
+    /* TRUE if reading an element of the array */
+    gboolean in_element;
+
+    /* Element currently being read */
+    GByteArray *element;
+
+    /* Everything outside the array elements */
+    GByteArray *envelope;
+
+    /* Where data is currently being written to */
+    StreamOutput output;
+};
+
+SnapdJsonStream *
+_snapd_json_stream_new (const gchar *member, SnapdJsonStreamCallback callback, gpointer user_data)
+{
+    SnapdJsonStream *stream = g_slice_new0 (SnapdJsonStream);
+    stream->member = g_strdup (member);
+    stream->callback = callback;
+    stream->callback_data = user_data;
+    stream->key = g_string_new ("");
+    stream->element = g_byte_array_new ();
+    stream->envelope = g_byte_array_new ();
+    stream->output = STREAM_OUTPUT_ENVELOPE;
+
+    return stream;
+}
+
+static void
+stream_write (SnapdJsonStream *stream, const gchar *data, gsize length)
+{
+    switch (stream->output) {
+    case STREAM_OUTPUT_NONE:
+        break;
+    case STREAM_OUTPUT_ENVELOPE:
+        g_byte_array_append (stream->envelope, (const guint8 *) data, length);
+        break;
+    case STREAM_OUTPUT_ELEMENT:
+        g_byte_array_append (stream->element, (const guint8 *) data, length);
+        break;
+    }
+}
+
+/* Change where data is written, writing out data since the last change */
+static void
+stream_set_output (SnapdJsonStream *stream, StreamOutput output, const gchar **run_start, const gchar *c)
+{
+    if (output == stream->output)
+        return;
+
+    stream_write (stream, *run_start, c - *run_start);
+    *run_start = c;
+    stream->output = output;
+}
+
+static gboolean
+stream_complete_element (SnapdJsonStream *stream, GError **error)
+{
+    stream->in_element = FALSE;
+
+    gboolean result = stream->callback ((const gchar *) stream->element->data, stream->element->len, stream->callback_data, error);
+    g_byte_array_set_size (stream->element, 0);
+
+    return result;
+}
+
+gboolean
+_snapd_json_stream_feed (SnapdJsonStream *stream, const gchar *data, gsize length, GError **error)
+{
+    const gchar *run_start = data;
+    const gchar *end = data + length;
+    for (const gchar *c = data; c < end; c++) {
+        if (stream->in_string) {
+            if (stream->escaped)
+                stream->escaped = FALSE;
+            else if (*c == '\\')
+                stream->escaped = TRUE;
+            else if (*c == '"')
+                stream->in_string = FALSE;
+            if (stream->in_string && stream->depth == 1)
+                g_string_append_c (stream->key, *c);
+            continue;
+        }
+
+        /* Everything inside an element goes to that element */
+        if (stream->in_array && stream->depth > 2) {
+            switch (*c) {
+            case '"':
+                stream->in_string = TRUE;
+                break;
+            case '{':
+            case '[':
+                stream->depth++;
+                break;
+            case '}':
+            case ']':
+                stream->depth--;
+                if (stream->depth == 2) {
+                    stream_set_output (stream, STREAM_OUTPUT_NONE, &run_start, c + 1);
+                    if (!stream_complete_element (stream, error))
+                        return FALSE;
+                }
+                break;
+            }
+            continue;
+        }
+
+        /* Between elements in the array */
+        if (stream->in_array) {
+            switch (*c) {
+            case ']':
+                stream->depth--;
+                stream->in_array = FALSE;
+                if (stream->in_element) {
+                    stream_set_output (stream, STREAM_OUTPUT_NONE, &run_start, c);
+                    if (!stream_complete_element (stream, error))
+                        return FALSE;
+                }
+                stream_set_output (stream, STREAM_OUTPUT_ENVELOPE, &run_start, c);
+                break;
+            case ',':
+                if (stream->in_element) {
+                    stream_set_output (stream, STREAM_OUTPUT_NONE, &run_start, c);
+                    if (!stream_complete_element (stream, error))
+                        return FALSE;
+                }
+                break;
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                break;
+            default:
+                if (!stream->in_element) {
+                    stream->in_element = TRUE;
+                    stream_set_output (stream, STREAM_OUTPUT_ELEMENT, &run_start, c);
+                }
+                if (*c == '{' || *c == '[')
+                    stream->depth++;
+                else if (*c == '"')
+                    stream->in_string = TRUE;
+                break;
+            }
+            continue;
+        }
+
+        switch (*c) {
+        case '"':
+            stream->in_string = TRUE;
+            if (stream->depth == 1)
+                g_string_truncate (stream->key, 0);
+            break;
+        case ':':
+            if (stream->depth == 1)
+                stream->in_member = strcmp (stream->key->str, stream->member) == 0;
+            break;
+        case ',':
+            if (stream->depth == 1)
+                stream->in_member = FALSE;
+            break;
+        case '[':
+            if (stream->depth == 1 && stream->in_member) {
+                stream->in_array = TRUE;
+                stream_set_output (stream, STREAM_OUTPUT_NONE, &run_start, c + 1);
+            }
+            stream->depth++;
+            break;
+        case '{':
+            stream->depth++;
+            break;
+        case '}':
+        case ']':
+            if (stream->depth > 0)
+                stream->depth--;
+            break;
+        }
+    }
+
+    stream_write (stream, run_start, end - run_start);
+
+    return TRUE;
+}
+
+GBytes *
+_snapd_json_stream_get_envelope (SnapdJsonStream *stream)
+{
+    return g_bytes_new (stream->envelope->data, stream->envelope->len);
+}
+
+void
+_snapd_json_stream_free (SnapdJsonStream *stream)
+{
+    g_free (stream->member);
+    g_string_free (stream->key, TRUE);
+    g_byte_array_unref (stream->element);
+    g_byte_array_unref (stream->envelope);
+    g_slice_free (SnapdJsonStream, stream);
+}
+
+typedef struct
+{
+    GPtrArray *snaps;
+    SnapdStringPool *pool;
+    gboolean defer_members;
+} CollectSnapsData;
+
+static gboolean
+collect_snap_cb (const gchar *data, gsize length, gpointer user_data, GError **error)
+{
+    CollectSnapsData *d = user_data;
+
+    SnapdSnap *snap = _snapd_json_parse_snap_data (data, length, d->pool, d->defer_members, SNAPD_JSON_PARSER_TOKENIZER, error);
+    if (snap == NULL)
+        return FALSE;
+    g_ptr_array_add (d->snaps, snap);
+
+    return TRUE;
+}
+
+gboolean
+_snapd_json_parse_snaps (SoupMessage *message, GPtrArray *snaps, gboolean defer_members, GError **error)
+{
+    /* Share strings between all the snaps in the response */
+    g_autoptr(SnapdStringPool) pool = _snapd_string_pool_new ();
+    CollectSnapsData data = { snaps, pool, defer_members };
+    g_autoptr(SnapdJsonStream) stream = _snapd_json_stream_new ("result", collect_snap_cb, &data);
+    g_autoptr(SoupBuffer) buffer = soup_message_body_flatten (message->response_body);
+    if (!_snapd_json_stream_feed (stream, buffer->data, buffer->length, error))
+        return FALSE;
+
+    /* Leave the rest of the response to be parsed as normal */
+    g_autoptr(GBytes) envelope = _snapd_json_stream_get_envelope (stream);
+    soup_message_body_truncate (message->response_body);
+    soup_message_body_append (message->response_body, SOUP_MEMORY_COPY, g_bytes_get_data (envelope, NULL), g_bytes_get_size (envelope));
+
+    return TRUE;
+}
@@ -24,11 +24,19 @@
 #include "snapd-slot.h"
 #include "snapd-slot-ref.h"
 #include "snapd-snap.h"
+#include "snapd-string-pool.h"
 #include "snapd-system-information.h"
 #include "snapd-user-information.h"
 
 G_BEGIN_DECLS
 
+/* Parser to use for snaps, json-glib is only selected when comparing the two */
+typedef enum
+{
+    SNAPD_JSON_PARSER_TOKENIZER,
+    SNAPD_JSON_PARSER_JSON_GLIB
+} SnapdJsonParser;
+
 void                  _snapd_json_set_body               (SoupMessage        *message,
                                                           JsonBuilder        *builder);
 
@@ -70,16 +78,26 @@ gchar                *_snapd_json_get_async_result       (JsonObject         *re
                                                           GError            **error);
 
 SnapdChange          *_snapd_json_parse_change           (JsonNode            *node,
+                                                          SnapdStringPool    *pool,
                                                           GError            **error);
 
 SnapdSystemInformation *_snapd_json_parse_system_information (JsonNode       *node,
                                                               GError        **error);
 
 SnapdSnap            *_snapd_json_parse_snap             (JsonNode           *node,
+                                                          SnapdStringPool    *pool,
+                                                          GError            **error);
+
+SnapdSnap            *_snapd_json_parse_snap_data        (const gchar        *data,
+                                                          gsize               length,
+                                                          SnapdStringPool    *pool,
+                                                          gboolean            defer_members,
+                                                          SnapdJsonParser     parser,
                                                           GError            **error);
 
 SnapdApp             *_snapd_json_parse_app              (JsonNode           *node,
                                                           const gchar        *snap_name,
+                                                          SnapdStringPool    *pool,
                                                           GError            **error);
 
 SnapdAlias           *_snapd_json_parse_alias            (JsonNode           *node,
@@ -97,21 +115,51 @@ GHashTable           *_snapd_json_parse_attributes       (JsonNode           *no
                                                           GError            **error);
 
 SnapdSlot            *_snapd_json_parse_slot             (JsonNode           *node,
+                                                          SnapdStringPool    *pool,
                                                           GError            **error);
 
 SnapdPlug            *_snapd_json_parse_plug             (JsonNode           *node,
+                                                          SnapdStringPool    *pool,
                                                           GError            **error);
 
 SnapdSlotRef         *_snapd_json_parse_slot_ref         (JsonNode           *node,
+                                                          SnapdStringPool    *pool,
                                                           GError            **error);
 
 SnapdPlugRef         *_snapd_json_parse_plug_ref         (JsonNode           *node,
+                                                          SnapdStringPool    *pool,
                                                           GError            **error);
 
 SnapdConnection      *_snapd_json_parse_connection       (JsonNode           *node,
+                                                          SnapdStringPool    *pool,
                                                           GError            **error);
 
 SnapdInterface       *_snapd_json_parse_interface        (JsonNode           *node,
+                                                          SnapdStringPool    *pool,
+                                                          GError            **error);
+
+typedef struct _SnapdJsonStream SnapdJsonStream;
+
+typedef gboolean (*SnapdJsonStreamCallback) (const gchar *data, gsize length, gpointer user_data, GError **error);
+
+SnapdJsonStream      *_snapd_json_stream_new             (const gchar        *member,
+                                                          SnapdJsonStreamCallback callback,
+                                                          gpointer            user_data);
+
+gboolean              _snapd_json_stream_feed            (SnapdJsonStream    *stream,
+                                                          const gchar        *data,
+                                                          gsize               length,
+                                                          GError            **error);
+
+GBytes               *_snapd_json_stream_get_envelope    (SnapdJsonStream    *stream);
+
+void                  _snapd_json_stream_free            (SnapdJsonStream    *stream);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SnapdJsonStream, _snapd_json_stream_free)
+
+gboolean              _snapd_json_parse_snaps            (SoupMessage        *message,
+                                                          GPtrArray          *snaps,
+                                                          gboolean            defer_members,
                                                           GError            **error);
 
 G_END_DECLS
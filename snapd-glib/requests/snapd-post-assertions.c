@@ -16,7 +16,7 @@
 struct _SnapdPostAssertions
 {
     SnapdRequest parent_instance;
-    GStrv assertions;
+    GPtrArray *assertions;
 };
 
 G_DEFINE_TYPE (SnapdPostAssertions, snapd_post_assertions, snapd_request_get_type ())
@@ -30,7 +30,24 @@ _snapd_post_assertions_new (GStrv assertions,
                                                                      "ready-callback", callback,
                                                                      "ready-callback-data", user_data,
                                                                      NULL));
-    self->assertions = g_strdupv (assertions);
+    self->assertions = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+    for (int i = 0; assertions[i] != NULL; i++)
+        g_ptr_array_add (self->assertions, g_bytes_new (assertions[i], strlen (assertions[i])));
+
+    return self;
+}
+
+/* Post assertions without copying them, e.g. views from a SnapdAssertionStream */
+SnapdPostAssertions *
+_snapd_post_assertions_new_from_bytes (GPtrArray *assertions,
+                                       GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    SnapdPostAssertions *self = SNAPD_POST_ASSERTIONS (g_object_new (snapd_post_assertions_get_type (),
+                                                                     "cancellable", cancellable,
+                                                                     "ready-callback", callback,
+                                                                     "ready-callback-data", user_data,
+                                                                     NULL));
+    self->assertions = g_ptr_array_ref (assertions);
 
     return self;
 }
@@ -43,10 +60,11 @@ generate_post_assertions_request (SnapdRequest *request)
     SoupMessage *message = soup_message_new ("POST", "http://snapd/v2/assertions");
 
     soup_message_headers_set_content_type (message->request_headers, "application/x.ubuntu.assertion", NULL); //FIXME
-    for (int i = 0; self->assertions[i]; i++) {
+    for (guint i = 0; i < self->assertions->len; i++) {
+        GBytes *assertion = self->assertions->pdata[i];
         if (i != 0)
             soup_message_body_append (message->request_body, SOUP_MEMORY_TEMPORARY, "\n\n", 2);
-        soup_message_body_append (message->request_body, SOUP_MEMORY_TEMPORARY, self->assertions[i], strlen (self->assertions[i]));
+        soup_message_body_append (message->request_body, SOUP_MEMORY_TEMPORARY, g_bytes_get_data (assertion, NULL), g_bytes_get_size (assertion));
     }
     soup_message_headers_set_content_length (message->request_headers, message->request_body->length);
 
@@ -68,7 +86,7 @@ snapd_post_assertions_finalize (GObject *object)
 {
     SnapdPostAssertions *self = SNAPD_POST_ASSERTIONS (object);
 
-    g_clear_pointer (&self->assertions, g_strfreev);
+    g_clear_pointer (&self->assertions, g_ptr_array_unref);
 
     G_OBJECT_CLASS (snapd_post_assertions_parent_class)->finalize (object);
 }
@@ -16,10 +16,15 @@ G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (SnapdPostAssertions, snapd_post_assertions, SNAPD, POST_ASSERTIONS, SnapdRequest)
 
-SnapdPostAssertions *_snapd_post_assertions_new (GStrv                assertions,
-                                                 GCancellable        *cancellable,
-                                                 GAsyncReadyCallback  callback,
-                                                 gpointer             user_data);
+SnapdPostAssertions *_snapd_post_assertions_new            (GStrv                assertions,
+                                                            GCancellable        *cancellable,
+                                                            GAsyncReadyCallback  callback,
+                                                            gpointer             user_data);
+
+SnapdPostAssertions *_snapd_post_assertions_new_from_bytes (GPtrArray           *assertions,
+                                                            GCancellable        *cancellable,
+                                                            GAsyncReadyCallback  callback,
+                                                            gpointer             user_data);
 
 G_END_DECLS
 
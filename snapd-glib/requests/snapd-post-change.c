@@ -87,7 +87,7 @@ parse_post_change_response (SnapdRequest *request, SoupMessage *message, SnapdMa
     if (result == NULL)
         return FALSE;
 
-    self->change = _snapd_json_parse_change (result, error);
+    self->change = _snapd_json_parse_change (result, NULL, error);
     json_node_unref (result);
     if (self->change == NULL)
         return FALSE;
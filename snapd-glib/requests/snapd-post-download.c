@@ -18,6 +18,14 @@ struct _SnapdPostDownload
     gchar *name;
     gchar *channel;
     gchar *revision;
+    gchar *resume_token;
+    guint64 offset;
+    GOutputStream *output_stream;
+    SnapdTransferProgressCallback progress_callback;
+    gpointer progress_callback_data;
+    guint64 n_written;
+    GError *stream_error;
+    gchar *download_token;
     GBytes *data;
 };
 
@@ -39,6 +47,23 @@ _snapd_post_download_new (const gchar *name, const gchar *channel, const gchar *
     return self;
 }
 
+void
+_snapd_post_download_set_resume (SnapdPostDownload *self, const gchar *resume_token, guint64 offset)
+{
+    g_free (self->resume_token);
+    self->resume_token = g_strdup (resume_token);
+    self->offset = offset;
+}
+
+void
+_snapd_post_download_set_output_stream (SnapdPostDownload *self, GOutputStream *stream,
+                                        SnapdTransferProgressCallback progress_callback, gpointer progress_callback_data)
+{
+    g_set_object (&self->output_stream, stream);
+    self->progress_callback = progress_callback;
+    self->progress_callback_data = progress_callback_data;
+}
+
 static SoupMessage *
 generate_post_download_request (SnapdRequest *request)
 {
@@ -58,12 +83,64 @@ generate_post_download_request (SnapdRequest *request)
         json_builder_set_member_name (builder, "revision");
         json_builder_add_string_value (builder, self->revision);
     }
+    if (self->resume_token != NULL) {
+        json_builder_set_member_name (builder, "resume-token");
+        json_builder_add_string_value (builder, self->resume_token);
+    }
     json_builder_end_object (builder);
     _snapd_json_set_body (message, builder);
 
+    if (self->offset > 0) {
+        g_autofree gchar *range = g_strdup_printf ("bytes=%" G_GUINT64_FORMAT "-", self->offset);
+        soup_message_headers_replace (message->request_headers, "Range", range);
+    }
+
     return message;
 }
 
+/* Write the snap contents to the output stream as they arrive from snapd.
+ * Writing blocks further reads, so at most one read of data is held in memory */
+static gboolean
+post_download_content_received (SnapdRequest *request, const gchar *data, gsize length)
+{
+    SnapdPostDownload *self = SNAPD_POST_DOWNLOAD (request);
+
+    if (self->output_stream == NULL)
+        return FALSE;
+
+    /* Leave errors to be parsed as normal */
+    SoupMessage *message = _snapd_request_get_message (request);
+    const gchar *content_type = soup_message_headers_get_content_type (message->response_headers, NULL);
+    if (g_strcmp0 (content_type, "application/octet-stream") != 0)
+        return FALSE;
+
+    if (self->stream_error != NULL)
+        return TRUE;
+
+    /* If snapd ignored the range the data would be written to the wrong place */
+    if (self->offset > 0 && message->status_code != SOUP_STATUS_PARTIAL_CONTENT) {
+        g_set_error (&self->stream_error,
+                     SNAPD_ERROR,
+                     SNAPD_ERROR_BAD_RESPONSE,
+                     "snapd did not resume download");
+        return TRUE;
+    }
+
+    if (!g_output_stream_write_all (self->output_stream, data, length, NULL, _snapd_request_get_cancellable (request), &self->stream_error))
+        return TRUE;
+    self->n_written += length;
+
+    if (self->progress_callback != NULL) {
+        guint64 total = 0;
+        if (soup_message_headers_get_encoding (message->response_headers) == SOUP_ENCODING_CONTENT_LENGTH)
+            total = self->offset + soup_message_headers_get_content_length (message->response_headers);
+        g_autoptr(GObject) client = g_async_result_get_source_object (G_ASYNC_RESULT (self));
+        self->progress_callback (SNAPD_CLIENT (client), self->offset + self->n_written, total, self->progress_callback_data);
+    }
+
+    return TRUE;
+}
+
 static gboolean
 parse_post_download_response (SnapdRequest *request, SoupMessage *message, SnapdMaintenance **maintenance, GError **error)
 {
@@ -71,6 +148,10 @@ parse_post_download_response (SnapdRequest *request, SoupMessage *message, Snapd
 
     const gchar *content_type = soup_message_headers_get_content_type (message->response_headers, NULL);
     if (g_strcmp0 (content_type, "application/octet-stream") != 0) {
+        /* Report any error snapd returned */
+        g_autoptr(JsonObject) response = _snapd_json_parse_response (message, maintenance, error);
+        if (response == NULL)
+            return FALSE;
         g_set_error (error,
                      SNAPD_ERROR,
                      SNAPD_ERROR_READ_FAILED,
@@ -78,6 +159,16 @@ parse_post_download_response (SnapdRequest *request, SoupMessage *message, Snapd
         return FALSE;
     }
 
+    self->download_token = g_strdup (soup_message_headers_get_one (message->response_headers, "Snap-Download-Token"));
+
+    if (self->output_stream != NULL) {
+        if (self->stream_error != NULL) {
+            g_propagate_error (error, g_steal_pointer (&self->stream_error));
+            return FALSE;
+        }
+        return g_output_stream_flush (self->output_stream, _snapd_request_get_cancellable (request), error);
+    }
+
     g_autoptr(SoupBuffer) buffer = soup_message_body_flatten (message->response_body);
     g_autoptr(GBytes) data = soup_buffer_get_as_bytes (buffer);
     self->data = g_steal_pointer (&data);
@@ -93,6 +184,10 @@ snapd_post_download_finalize (GObject *object)
     g_clear_pointer (&self->name, g_free);
     g_clear_pointer (&self->channel, g_free);
     g_clear_pointer (&self->revision, g_free);
+    g_clear_pointer (&self->resume_token, g_free);
+    g_clear_object (&self->output_stream);
+    g_clear_error (&self->stream_error);
+    g_clear_pointer (&self->download_token, g_free);
     g_clear_pointer (&self->data, g_bytes_unref);
 
     G_OBJECT_CLASS (snapd_post_download_parent_class)->finalize (object);
@@ -106,6 +201,7 @@ snapd_post_download_class_init (SnapdPostDownloadClass *klass)
 
     request_class->generate_request = generate_post_download_request;
     request_class->parse_response = parse_post_download_response;
+    request_class->content_received = post_download_content_received;
     gobject_class->finalize = snapd_post_download_finalize;
 }
 
@@ -120,3 +216,10 @@ _snapd_post_download_get_data (SnapdPostDownload *self)
     g_return_val_if_fail (SNAPD_IS_POST_DOWNLOAD (self), NULL);
     return self->data;
 }
+
+const gchar *
+_snapd_post_download_get_download_token (SnapdPostDownload *self)
+{
+    g_return_val_if_fail (SNAPD_IS_POST_DOWNLOAD (self), NULL);
+    return self->download_token;
+}
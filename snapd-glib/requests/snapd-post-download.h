@@ -11,19 +11,31 @@
 #define __SNAPD_POST_DOWNLOAD_H__
 
 #include "snapd-request.h"
+#include "snapd-client.h"
 
 G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (SnapdPostDownload, snapd_post_download, SNAPD, POST_DOWNLOAD, SnapdRequest)
 
-SnapdPostDownload *_snapd_post_download_new      (const gchar         *name,
-                                                  const gchar         *channel,
-                                                  const gchar         *revision,
-                                                  GCancellable        *cancellable,
-                                                  GAsyncReadyCallback  callback,
-                                                  gpointer             user_data);
+SnapdPostDownload *_snapd_post_download_new                 (const gchar                   *name,
+                                                             const gchar                   *channel,
+                                                             const gchar                   *revision,
+                                                             GCancellable                  *cancellable,
+                                                             GAsyncReadyCallback            callback,
+                                                             gpointer                       user_data);
 
-GBytes            *_snapd_post_download_get_data (SnapdPostDownload   *request);
+void               _snapd_post_download_set_resume          (SnapdPostDownload             *request,
+                                                             const gchar                   *resume_token,
+                                                             guint64                        offset);
+
+void               _snapd_post_download_set_output_stream   (SnapdPostDownload             *request,
+                                                             GOutputStream                 *stream,
+                                                             SnapdTransferProgressCallback  progress_callback,
+                                                             gpointer                       progress_callback_data);
+
+GBytes            *_snapd_post_download_get_data            (SnapdPostDownload             *request);
+
+const gchar       *_snapd_post_download_get_download_token  (SnapdPostDownload             *request);
 
 G_END_DECLS
 
@@ -20,13 +20,18 @@ struct _SnapdPostSnapStream
     gboolean dangerous;
     gboolean devmode;
     gboolean jailmode;
-    GByteArray *snap_contents;
+    GInputStream *stream;
+    SnapdTransferProgressCallback upload_progress_callback;
+    gpointer upload_progress_callback_data;
+    gchar *boundary;
 };
 
 G_DEFINE_TYPE (SnapdPostSnapStream, snapd_post_snap_stream, snapd_request_async_get_type ())
 
 SnapdPostSnapStream *
-_snapd_post_snap_stream_new (SnapdProgressCallback progress_callback, gpointer progress_callback_data,
+_snapd_post_snap_stream_new (GInputStream *stream,
+                             SnapdTransferProgressCallback upload_progress_callback, gpointer upload_progress_callback_data,
+                             SnapdProgressCallback progress_callback, gpointer progress_callback_data,
                              GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     SnapdPostSnapStream *self = SNAPD_POST_SNAP_STREAM (g_object_new (snapd_post_snap_stream_get_type (),
@@ -36,6 +41,9 @@ _snapd_post_snap_stream_new (SnapdProgressCallback progress_callback, gpointer p
                                                                       "progress-callback", progress_callback,
                                                                       "progress-callback-data", progress_callback_data,
                                                                       NULL));
+    self->stream = g_object_ref (stream);
+    self->upload_progress_callback = upload_progress_callback;
+    self->upload_progress_callback_data = upload_progress_callback_data;
 
     return self;
 }
@@ -64,23 +72,19 @@ _snapd_post_snap_stream_set_jailmode (SnapdPostSnapStream *self, gboolean jailmo
     self->jailmode = jailmode;
 }
 
-void
-_snapd_post_snap_stream_append_data (SnapdPostSnapStream *self, const guint8 *data, guint len)
-{
-    g_byte_array_append (self->snap_contents, data, len);
-}
-
 static void
-append_multipart_value (SoupMultipart *multipart, const gchar *name, const gchar *value)
+append_multipart_value (GString *body, const gchar *boundary, const gchar *name, const gchar *value)
 {
-    g_autoptr(SoupMessageHeaders) headers = soup_message_headers_new (SOUP_MESSAGE_HEADERS_MULTIPART);
-    g_autoptr(GHashTable) params = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
-    g_hash_table_insert (params, g_strdup ("name"), g_strdup (name));
-    soup_message_headers_set_content_disposition (headers, "form-data", params);
-    g_autoptr(SoupBuffer) buffer = soup_buffer_new_take ((guchar *) g_strdup (value), strlen (value));
-    soup_multipart_append_part (multipart, headers, buffer);
+    g_string_append_printf (body,
+                            "--%s\r\n"
+                            "Content-Disposition: form-data; name=\"%s\"\r\n"
+                            "\r\n"
+                            "%s\r\n",
+                            boundary, name, value);
 }
 
+/* The message body only contains the start of the multipart content,
+ * the snap is sent from the stream after it so it never has to be held in memory */
 static SoupMessage *
 generate_post_snap_stream_request (SnapdRequest *request)
 {
@@ -88,35 +92,61 @@ generate_post_snap_stream_request (SnapdRequest *request)
 
     SoupMessage *message = soup_message_new ("POST", "http://snapd/v2/snaps");
 
-    g_autoptr(SoupMultipart) multipart = soup_multipart_new ("multipart/form-data");
+    g_autoptr(GString) body = g_string_new ("");
     if (self->classic)
-        append_multipart_value (multipart, "classic", "true");
+        append_multipart_value (body, self->boundary, "classic", "true");
     if (self->dangerous)
-        append_multipart_value (multipart, "dangerous", "true");
+        append_multipart_value (body, self->boundary, "dangerous", "true");
     if (self->devmode)
-        append_multipart_value (multipart, "devmode", "true");
+        append_multipart_value (body, self->boundary, "devmode", "true");
     if (self->jailmode)
-        append_multipart_value (multipart, "jailmode", "true");
+        append_multipart_value (body, self->boundary, "jailmode", "true");
+    g_string_append_printf (body,
+                            "--%s\r\n"
+                            "Content-Disposition: form-data; name=\"snap\"; filename=\"x\"\r\n"
+                            "Content-Type: application/vnd.snap\r\n"
+                            "\r\n",
+                            self->boundary);
 
     g_autoptr(GHashTable) params = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
-    g_hash_table_insert (params, g_strdup ("name"), g_strdup ("snap"));
-    g_hash_table_insert (params, g_strdup ("filename"), g_strdup ("x"));
-    soup_message_headers_set_content_disposition (message->request_headers, "form-data", params);
-    soup_message_headers_set_content_type (message->request_headers, "application/vnd.snap", NULL);
-    g_autoptr(SoupBuffer) buffer = soup_buffer_new (SOUP_MEMORY_TEMPORARY, self->snap_contents->data, self->snap_contents->len);
-    soup_multipart_append_part (multipart, message->request_headers, buffer);
-    soup_multipart_to_message (multipart, message->request_headers, message->request_body);
-    soup_message_headers_set_content_length (message->request_headers, message->request_body->length);
+    g_hash_table_insert (params, g_strdup ("boundary"), g_strdup (self->boundary));
+    soup_message_headers_set_content_type (message->request_headers, "multipart/form-data", params);
+    gsize length = body->len;
+    soup_message_body_append (message->request_body, SOUP_MEMORY_TAKE, g_string_free (g_steal_pointer (&body), FALSE), length);
 
     return message;
 }
 
+static GInputStream *
+get_post_snap_stream_body_stream (SnapdRequest *request, GBytes **trailer)
+{
+    SnapdPostSnapStream *self = SNAPD_POST_SNAP_STREAM (request);
+
+    g_autofree gchar *end = g_strdup_printf ("\r\n--%s--\r\n", self->boundary);
+    *trailer = g_bytes_new (end, strlen (end));
+
+    return self->stream;
+}
+
+static void
+post_snap_stream_body_progress (SnapdRequest *request, guint64 n_sent, guint64 length)
+{
+    SnapdPostSnapStream *self = SNAPD_POST_SNAP_STREAM (request);
+
+    if (self->upload_progress_callback == NULL)
+        return;
+
+    g_autoptr(GObject) client = g_async_result_get_source_object (G_ASYNC_RESULT (self));
+    self->upload_progress_callback (SNAPD_CLIENT (client), n_sent, length, self->upload_progress_callback_data);
+}
+
 static void
 snapd_post_snap_stream_finalize (GObject *object)
 {
     SnapdPostSnapStream *self = SNAPD_POST_SNAP_STREAM (object);
 
-    g_clear_pointer (&self->snap_contents, g_byte_array_unref);
+    g_clear_object (&self->stream);
+    g_clear_pointer (&self->boundary, g_free);
 
     G_OBJECT_CLASS (snapd_post_snap_stream_parent_class)->finalize (object);
 }
@@ -128,11 +158,13 @@ snapd_post_snap_stream_class_init (SnapdPostSnapStreamClass *klass)
    GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
    request_class->generate_request = generate_post_snap_stream_request;
+   request_class->get_body_stream = get_post_snap_stream_body_stream;
+   request_class->body_progress = post_snap_stream_body_progress;
    gobject_class->finalize = snapd_post_snap_stream_finalize;
 }
 
 static void
 snapd_post_snap_stream_init (SnapdPostSnapStream *self)
 {
-    self->snap_contents = g_byte_array_new ();
+    self->boundary = g_strdup_printf ("snapd-glib-%08x%08x%08x", g_random_int (), g_random_int (), g_random_int ());
 }
@@ -9,9 +9,9 @@
 
 #include "snapd-request-async.h"
 
+#include "snapd-change-private.h"
 #include "snapd-client.h"
 #include "snapd-json.h"
-#include "snapd-task.h"
 
 enum
 {
@@ -41,6 +41,21 @@ _snapd_request_async_get_change_id (SnapdRequestAsync *self)
     return priv->change_id;
 }
 
+void
+_snapd_request_async_set_change_id (SnapdRequestAsync *self, const gchar *change_id)
+{
+    SnapdRequestAsyncPrivate *priv = snapd_request_async_get_instance_private (self);
+    g_free (priv->change_id);
+    priv->change_id = g_strdup (change_id);
+}
+
+SnapdChange *
+_snapd_request_async_get_change (SnapdRequestAsync *self)
+{
+    SnapdRequestAsyncPrivate *priv = snapd_request_async_get_instance_private (self);
+    return priv->change;
+}
+
 gboolean
 _snapd_request_async_parse_result (SnapdRequestAsync *self, JsonNode *result, GError **error)
 {
@@ -67,74 +82,31 @@ parse_async_response (SnapdRequest *self, SoupMessage *message, SnapdMaintenance
     return TRUE;
 }
 
-static gboolean
-times_equal (GDateTime *time1, GDateTime *time2)
-{
-    if (time1 == NULL || time2 == NULL)
-        return time1 == time2;
-    return g_date_time_equal (time1, time2);
-}
-
-static gboolean
-tasks_equal (SnapdTask *task1, SnapdTask *task2)
-{
-    return g_strcmp0 (snapd_task_get_id (task1), snapd_task_get_id (task2)) == 0 &&
-           g_strcmp0 (snapd_task_get_kind (task1), snapd_task_get_kind (task2)) == 0 &&
-           g_strcmp0 (snapd_task_get_summary (task1), snapd_task_get_summary (task2)) == 0 &&
-           g_strcmp0 (snapd_task_get_status (task1), snapd_task_get_status (task2)) == 0 &&
-           g_strcmp0 (snapd_task_get_progress_label (task1), snapd_task_get_progress_label (task2)) == 0 &&
-           snapd_task_get_progress_done (task1) == snapd_task_get_progress_done (task2) &&
-           snapd_task_get_progress_total (task1) == snapd_task_get_progress_total (task2) &&
-           times_equal (snapd_task_get_spawn_time (task1), snapd_task_get_spawn_time (task2)) &&
-           times_equal (snapd_task_get_spawn_time (task1), snapd_task_get_spawn_time (task2));
-}
-
+/* Changes are compared using the fingerprint calculated when they were parsed, so polling a change with many tasks is cheap */
 static gboolean
 changes_equal (SnapdChange *change1, SnapdChange *change2)
 {
     if (change1 == NULL || change2 == NULL)
         return change1 == change2;
-
-    GPtrArray *tasks1 = snapd_change_get_tasks (change1);
-    GPtrArray *tasks2 = snapd_change_get_tasks (change2);
-    if (tasks1 == NULL || tasks2 == NULL) {
-        if (tasks1 != tasks2)
-            return FALSE;
-    }
-    else {
-        if (tasks1->len != tasks2->len)
-            return FALSE;
-        for (int i = 0; i < tasks1->len; i++) {
-            SnapdTask *t1 = tasks1->pdata[i], *t2 = tasks2->pdata[i];
-            if (!tasks_equal (t1, t2))
-                return FALSE;
-        }
-    }
-
-    return g_strcmp0 (snapd_change_get_id (change1), snapd_change_get_id (change2)) == 0 &&
-           g_strcmp0 (snapd_change_get_kind (change1), snapd_change_get_kind (change2)) == 0 &&
-           g_strcmp0 (snapd_change_get_summary (change1), snapd_change_get_summary (change2)) == 0 &&
-           g_strcmp0 (snapd_change_get_status (change1), snapd_change_get_status (change2)) == 0 &&
-           !!snapd_change_get_ready (change1) == !!snapd_change_get_ready (change2) &&
-           times_equal (snapd_change_get_spawn_time (change1), snapd_change_get_spawn_time (change2)) &&
-           times_equal (snapd_change_get_spawn_time (change1), snapd_change_get_spawn_time (change2));
-
-    return TRUE;
+    return _snapd_change_get_fingerprint (change1) == _snapd_change_get_fingerprint (change2);
 }
 
-void
+gboolean
 _snapd_request_async_report_progress (SnapdRequestAsync *self, SnapdClient *client, SnapdChange *change)
 {
     SnapdRequestAsyncPrivate *priv = snapd_request_async_get_instance_private (self);
 
-    if (!changes_equal (priv->change, change)) {
-        g_set_object (&priv->change, change);
-        if (priv->progress_callback != NULL)
-            priv->progress_callback (client,
-                                     change,
-                                     snapd_change_get_tasks (change), // Passed for ABI compatibility, is deprecated
-                                     priv->progress_callback_data);
-    }
+    if (changes_equal (priv->change, change))
+        return FALSE;
+
+    g_set_object (&priv->change, change);
+    if (priv->progress_callback != NULL)
+        priv->progress_callback (client,
+                                 change,
+                                 snapd_change_get_tasks (change), // Passed for ABI compatibility, is deprecated
+                                 priv->progress_callback_data);
+
+    return TRUE;
 }
 
 static void
@@ -30,11 +30,16 @@ struct _SnapdRequestAsyncClass
 
 const gchar *_snapd_request_async_get_change_id   (SnapdRequestAsync *request);
 
+void         _snapd_request_async_set_change_id   (SnapdRequestAsync *request,
+                                                   const gchar       *change_id);
+
+SnapdChange *_snapd_request_async_get_change      (SnapdRequestAsync *request);
+
 gboolean     _snapd_request_async_parse_result    (SnapdRequestAsync *request,
                                                    JsonNode          *result,
                                                    GError           **error);
 
-void         _snapd_request_async_report_progress (SnapdRequestAsync *request,
+gboolean     _snapd_request_async_report_progress (SnapdRequestAsync *request,
                                                    SnapdClient       *client,
                                                    SnapdChange       *change);
 
@@ -29,6 +29,13 @@ typedef struct
 
     GCancellable *cancellable;
 
+    /* Objects waiting to be passed to deliver_item in the request context */
+    GMutex items_mutex;
+    GPtrArray *pending_items;
+
+    /* Sources attached to the request context, protected by items_mutex */
+    GPtrArray *sources;
+
     gboolean responded;
     GAsyncReadyCallback ready_callback;
     gpointer ready_callback_data;
@@ -49,6 +56,43 @@ _snapd_request_get_context (SnapdRequest *self)
     return priv->context;
 }
 
+/* Attach @source to the context of the request, so it can be removed if the request finishes before it runs.
+ * This is safe to call from any thread */
+void
+_snapd_request_attach_source (SnapdRequest *self, GSource *source)
+{
+    SnapdRequestPrivate *priv = snapd_request_get_instance_private (self);
+
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->items_mutex);
+        if (priv->sources == NULL)
+            priv->sources = g_ptr_array_new_with_free_func ((GDestroyNotify) g_source_unref);
+        for (guint i = priv->sources->len; i > 0; i--)
+            if (g_source_is_destroyed (g_ptr_array_index (priv->sources, i - 1)))
+                g_ptr_array_remove_index_fast (priv->sources, i - 1);
+        g_ptr_array_add (priv->sources, g_source_ref (source));
+    }
+    g_source_attach (source, priv->context);
+}
+
+/* Remove any sources attached by _snapd_request_attach_source () that haven't run yet.
+ * Used when the request context is reused, so they don't run during a later call */
+void
+_snapd_request_destroy_sources (SnapdRequest *self)
+{
+    SnapdRequestPrivate *priv = snapd_request_get_instance_private (self);
+
+    g_autoptr(GPtrArray) sources = NULL;
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->items_mutex);
+        sources = g_steal_pointer (&priv->sources);
+    }
+    if (sources == NULL)
+        return;
+    for (guint i = 0; i < sources->len; i++)
+        g_source_destroy (g_ptr_array_index (sources, i));
+}
+
 GCancellable *
 _snapd_request_get_cancellable (SnapdRequest *self)
 {
@@ -74,12 +118,77 @@ _snapd_request_get_message (SnapdRequest *self)
     return priv->message;
 }
 
+GInputStream *
+_snapd_request_get_body_stream (SnapdRequest *self, GBytes **trailer)
+{
+    *trailer = NULL;
+    if (SNAPD_REQUEST_GET_CLASS (self)->get_body_stream == NULL)
+        return NULL;
+    return SNAPD_REQUEST_GET_CLASS (self)->get_body_stream (self, trailer);
+}
+
+void
+_snapd_request_body_progress (SnapdRequest *self, guint64 n_sent, guint64 length)
+{
+    if (SNAPD_REQUEST_GET_CLASS (self)->body_progress != NULL)
+        SNAPD_REQUEST_GET_CLASS (self)->body_progress (self, n_sent, length);
+}
+
+static void
+deliver_pending_items (SnapdRequest *self)
+{
+    SnapdRequestPrivate *priv = snapd_request_get_instance_private (self);
+
+    g_autoptr(GPtrArray) items = NULL;
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->items_mutex);
+        items = g_steal_pointer (&priv->pending_items);
+    }
+    if (items == NULL)
+        return;
+
+    for (guint i = 0; i < items->len; i++)
+        SNAPD_REQUEST_GET_CLASS (self)->deliver_item (self, g_ptr_array_index (items, i));
+}
+
+static gboolean
+deliver_cb (gpointer user_data)
+{
+    deliver_pending_items (SNAPD_REQUEST (user_data));
+    return G_SOURCE_REMOVE;
+}
+
+/* Pass @item to the deliver_item method from the context of the request.
+ * This is safe to call from any thread and with locks held, as the callbacks run later */
+void
+_snapd_request_deliver (SnapdRequest *self, GObject *item)
+{
+    SnapdRequestPrivate *priv = snapd_request_get_instance_private (self);
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->items_mutex);
+
+    /* Drop items that arrive after the request has returned (e.g. it was cancelled), the callback data may no longer be valid */
+    if (priv->responded)
+        return;
+
+    /* Items are delivered in batches, the source is scheduled by the first item in each batch */
+    if (priv->pending_items == NULL) {
+        priv->pending_items = g_ptr_array_new_with_free_func (g_object_unref);
+        g_autoptr(GSource) source = g_idle_source_new ();
+        g_source_set_callback (source, deliver_cb, g_object_ref (self), g_object_unref);
+        g_source_attach (source, _snapd_request_get_context (self));
+    }
+    g_ptr_array_add (priv->pending_items, g_object_ref (item));
+}
+
 static gboolean
 respond_cb (gpointer user_data)
 {
     SnapdRequest *self = SNAPD_REQUEST (user_data);
     SnapdRequestPrivate *priv = snapd_request_get_instance_private (self);
 
+    /* Report any items still waiting before the request completes */
+    deliver_pending_items (self);
+
     if (priv->ready_callback != NULL)
         priv->ready_callback (priv->source_object, G_ASYNC_RESULT (self), priv->ready_callback_data);
 
@@ -91,9 +200,12 @@ _snapd_request_return (SnapdRequest *self, GError *error)
 {
     SnapdRequestPrivate *priv = snapd_request_get_instance_private (self);
 
-    if (priv->responded)
-        return;
-    priv->responded = TRUE;
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->items_mutex);
+        if (priv->responded)
+            return;
+        priv->responded = TRUE;
+    }
     if (error != NULL)
         priv->error = g_error_copy (error);
 
@@ -102,6 +214,15 @@ _snapd_request_return (SnapdRequest *self, GError *error)
     g_source_attach (source, _snapd_request_get_context (self));
 }
 
+/* Check if the result has been returned, any further response content should be ignored */
+gboolean
+_snapd_request_has_returned (SnapdRequest *self)
+{
+    SnapdRequestPrivate *priv = snapd_request_get_instance_private (self);
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->items_mutex);
+    return priv->responded;
+}
+
 gboolean
 _snapd_request_propagate_error (SnapdRequest *self, GError **error)
 {
@@ -170,6 +291,9 @@ snapd_request_finalize (GObject *object)
     g_clear_object (&priv->cancellable);
     g_clear_pointer (&priv->error, g_error_free);
     g_clear_pointer (&priv->context, g_main_context_unref);
+    g_mutex_clear (&priv->items_mutex);
+    g_clear_pointer (&priv->pending_items, g_ptr_array_unref);
+    g_clear_pointer (&priv->sources, g_ptr_array_unref);
 
     G_OBJECT_CLASS (snapd_request_parent_class)->finalize (object);
 }
@@ -216,4 +340,5 @@ snapd_request_init (SnapdRequest *self)
     SnapdRequestPrivate *priv = snapd_request_get_instance_private (self);
 
     priv->context = g_main_context_ref_thread_default ();
+    g_mutex_init (&priv->items_mutex);
 }
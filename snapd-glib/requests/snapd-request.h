@@ -25,6 +25,14 @@ struct _SnapdRequestClass
 
     SoupMessage *(*generate_request)(SnapdRequest *request);
     gboolean (*parse_response)(SnapdRequest *request, SoupMessage *message, SnapdMaintenance **maintenance, GError **error);
+    gboolean (*content_received)(SnapdRequest *request, const gchar *data, gsize length);
+
+    /* Content to send after the message body without holding it in memory, followed by @trailer */
+    GInputStream *(*get_body_stream)(SnapdRequest *request, GBytes **trailer);
+    void (*body_progress)(SnapdRequest *request, guint64 n_sent, guint64 length);
+
+    /* Called from the context of the request for objects passed to _snapd_request_deliver () */
+    void (*deliver_item)(SnapdRequest *request, GObject *item);
 };
 
 void          _snapd_request_set_source_object (SnapdRequest *request,
@@ -32,15 +40,32 @@ void          _snapd_request_set_source_object (SnapdRequest *request,
 
 GMainContext *_snapd_request_get_context       (SnapdRequest *request);
 
+void          _snapd_request_attach_source     (SnapdRequest *request,
+                                                GSource      *source);
+
+void          _snapd_request_destroy_sources   (SnapdRequest *request);
+
 GCancellable *_snapd_request_get_cancellable   (SnapdRequest *request);
 
 void          _snapd_request_generate          (SnapdRequest *request);
 
 SoupMessage  *_snapd_request_get_message       (SnapdRequest *request);
 
+GInputStream *_snapd_request_get_body_stream   (SnapdRequest *request,
+                                                GBytes      **trailer);
+
+void          _snapd_request_body_progress     (SnapdRequest *request,
+                                                guint64       n_sent,
+                                                guint64       length);
+
+void          _snapd_request_deliver           (SnapdRequest *request,
+                                                GObject      *item);
+
 void          _snapd_request_return            (SnapdRequest *request,
                                                 GError       *error);
 
+gboolean      _snapd_request_has_returned      (SnapdRequest *request);
+
 gboolean      _snapd_request_propagate_error   (SnapdRequest *request,
                                                 GError      **error);
 
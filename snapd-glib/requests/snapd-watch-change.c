@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#include "snapd-watch-change.h"
+
+#include "snapd-error.h"
+#include "snapd-json.h"
+
+/* Follows a change that already exists, the initial request gets the current state of the change */
+struct _SnapdWatchChange
+{
+    SnapdRequestAsync parent_instance;
+    gchar *change_id;
+    SnapdChange *change;
+    JsonNode *data;
+};
+
+G_DEFINE_TYPE (SnapdWatchChange, snapd_watch_change, snapd_request_async_get_type ())
+
+SnapdWatchChange *
+_snapd_watch_change_new (const gchar *change_id,
+                         SnapdProgressCallback progress_callback, gpointer progress_callback_data,
+                         GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    SnapdWatchChange *self = SNAPD_WATCH_CHANGE (g_object_new (snapd_watch_change_get_type (),
+                                                               "cancellable", cancellable,
+                                                               "ready-callback", callback,
+                                                               "ready-callback-data", user_data,
+                                                               "progress-callback", progress_callback,
+                                                               "progress-callback-data", progress_callback_data,
+                                                               NULL));
+    self->change_id = g_strdup (change_id);
+
+    return self;
+}
+
+SnapdChange *
+_snapd_watch_change_get_change (SnapdWatchChange *self)
+{
+    return self->change;
+}
+
+JsonNode *
+_snapd_watch_change_get_data (SnapdWatchChange *self)
+{
+    return self->data;
+}
+
+static SoupMessage *
+generate_watch_change_request (SnapdRequest *request)
+{
+    SnapdWatchChange *self = SNAPD_WATCH_CHANGE (request);
+
+    g_autofree gchar *path = g_strdup_printf ("http://snapd/v2/changes/%s", self->change_id);
+    return soup_message_new ("GET", path);
+}
+
+static gboolean
+parse_watch_change_response (SnapdRequest *request, SoupMessage *message, SnapdMaintenance **maintenance, GError **error)
+{
+    SnapdWatchChange *self = SNAPD_WATCH_CHANGE (request);
+
+    g_autoptr(JsonObject) response = _snapd_json_parse_response (message, maintenance, error);
+    if (response == NULL)
+        return FALSE;
+    /* FIXME: Needs json-glib to be fixed to use json_node_unref */
+    /*g_autoptr(JsonNode) result = NULL;*/
+    JsonNode *result = _snapd_json_get_sync_result (response, error);
+    if (result == NULL)
+        return FALSE;
+
+    self->change = _snapd_json_parse_change (result, NULL, error);
+    if (self->change == NULL) {
+        json_node_unref (result);
+        return FALSE;
+    }
+
+    if (g_strcmp0 (self->change_id, snapd_change_get_id (self->change)) != 0) {
+        json_node_unref (result);
+        g_set_error (error,
+                     SNAPD_ERROR,
+                     SNAPD_ERROR_READ_FAILED,
+                     "Unexpected change ID returned");
+        return FALSE;
+    }
+
+    if (json_object_has_member (json_node_get_object (result), "data"))
+        self->data = json_node_ref (json_object_get_member (json_node_get_object (result), "data"));
+    json_node_unref (result);
+
+    /* From now on follow the change like any other asynchronous request */
+    _snapd_request_async_set_change_id (SNAPD_REQUEST_ASYNC (self), self->change_id);
+
+    return TRUE;
+}
+
+static void
+snapd_watch_change_finalize (GObject *object)
+{
+    SnapdWatchChange *self = SNAPD_WATCH_CHANGE (object);
+
+    g_clear_pointer (&self->change_id, g_free);
+    g_clear_object (&self->change);
+    g_clear_pointer (&self->data, json_node_unref);
+
+    G_OBJECT_CLASS (snapd_watch_change_parent_class)->finalize (object);
+}
+
+static void
+snapd_watch_change_class_init (SnapdWatchChangeClass *klass)
+{
+   SnapdRequestClass *request_class = SNAPD_REQUEST_CLASS (klass);
+   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+   request_class->generate_request = generate_watch_change_request;
+   request_class->parse_response = parse_watch_change_response;
+   gobject_class->finalize = snapd_watch_change_finalize;
+}
+
+static void
+snapd_watch_change_init (SnapdWatchChange *self)
+{
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_WATCH_CHANGE_H__
+#define __SNAPD_WATCH_CHANGE_H__
+
+#include <json-glib/json-glib.h>
+
+#include "snapd-request-async.h"
+
+#include "snapd-client.h"
+
+G_BEGIN_DECLS
+
+G_DECLARE_FINAL_TYPE (SnapdWatchChange, snapd_watch_change, SNAPD, WATCH_CHANGE, SnapdRequestAsync)
+
+SnapdWatchChange *_snapd_watch_change_new        (const gchar           *change_id,
+                                                  SnapdProgressCallback  progress_callback,
+                                                  gpointer               progress_callback_data,
+                                                  GCancellable          *cancellable,
+                                                  GAsyncReadyCallback    callback,
+                                                  gpointer               user_data);
+
+SnapdChange      *_snapd_watch_change_get_change (SnapdWatchChange      *request);
+
+JsonNode         *_snapd_watch_change_get_data   (SnapdWatchChange      *request);
+
+G_END_DECLS
+
+#endif /* __SNAPD_WATCH_CHANGE_H__ */
@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_APP_PRIVATE_H__
+#define __SNAPD_APP_PRIVATE_H__
+
+#include "snapd-app.h"
+
+G_BEGIN_DECLS
+
+/* The app takes ownership of the strings, @snap is a reference counted string */
+SnapdApp *_snapd_app_new (gchar               *name,
+                          gchar               *snap,
+                          gchar               *common_id,
+                          SnapdDaemonType      daemon_type,
+                          gchar               *desktop_file,
+                          gboolean             enabled,
+                          gboolean             active);
+
+G_END_DECLS
+
+#endif /* __SNAPD_APP_PRIVATE_H__ */
@@ -9,8 +9,9 @@
 
 #include <string.h>
 
-#include "snapd-app.h"
+#include "snapd-app-private.h"
 #include "snapd-enum-types.h"
+#include "snapd-string-pool.h"
 
 /**
  * SECTION:snapd-app
@@ -58,6 +59,22 @@ enum
 
 G_DEFINE_TYPE (SnapdApp, snapd_app, G_TYPE_OBJECT)
 
+SnapdApp *
+_snapd_app_new (gchar *name, gchar *snap, gchar *common_id, SnapdDaemonType daemon_type, gchar *desktop_file, gboolean enabled, gboolean active)
+{
+    SnapdApp *self = g_object_new (SNAPD_TYPE_APP, NULL);
+
+    self->name = name;
+    self->snap = snap;
+    self->common_id = common_id;
+    self->daemon_type = daemon_type;
+    self->desktop_file = desktop_file;
+    self->enabled = enabled;
+    self->active = active;
+
+    return self;
+}
+
 /**
  * snapd_app_get_name:
  * @app: a #SnapdApp.
@@ -219,8 +236,8 @@ snapd_app_set_property (GObject *object, guint prop_id, const GValue *value, GPa
         self->desktop_file = g_strdup (g_value_get_string (value));
         break;
     case PROP_SNAP:
-        g_free (self->snap);
-        self->snap = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->snap);
+        self->snap = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_ACTIVE:
         self->active = g_value_get_boolean (value);
@@ -278,7 +295,7 @@ snapd_app_finalize (GObject *object)
     g_clear_pointer (&self->name, g_free);
     g_clear_pointer (&self->common_id, g_free);
     g_clear_pointer (&self->desktop_file, g_free);
-    g_clear_pointer (&self->snap, g_free);
+    g_clear_pointer (&self->snap, _snapd_ref_string_release);
 
     G_OBJECT_CLASS (snapd_app_parent_class)->finalize (object);
 }
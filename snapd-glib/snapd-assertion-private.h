@@ -0,0 +1,21 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_ASSERTION_PRIVATE_H__
+#define __SNAPD_ASSERTION_PRIVATE_H__
+
+#include "snapd-assertion.h"
+
+G_BEGIN_DECLS
+
+SnapdAssertion *_snapd_assertion_new_from_bytes (GBytes *content);
+
+G_END_DECLS
+
+#endif /* __SNAPD_ASSERTION_PRIVATE_H__ */
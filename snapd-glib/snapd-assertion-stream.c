@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#include <string.h>
+
+#include "snapd-assertion-stream.h"
+
+/* Splits a bundle of assertions into individual assertions.
+ * Each assertion is a set of headers terminated by a blank line, an optional body
+ * of length set by the body-length header followed by a blank line, and a signature.
+ * Assertions are separated by a blank line.
+ * Data is only scanned once, so it can be fed in as it is received. */
+
+typedef enum
+{
+    SCANNER_STATE_HEADERS,
+    SCANNER_STATE_BODY,
+    SCANNER_STATE_SIGNATURE
+} ScannerState;
+
+typedef struct
+{
+    ScannerState state;
+
+    /* Offset of the assertion being scanned */
+    gsize start;
+
+    /* Offset of the current header line or signature */
+    gsize line_start;
+
+    /* Offset to continue scanning from */
+    gsize offset;
+
+    gsize body_length;
+} Scanner;
+
+struct _SnapdAssertionStream
+{
+    SnapdAssertionStreamCallback callback;
+    gpointer user_data;
+
+    /* Data not yet returned in an assertion */
+    GByteArray *buffer;
+
+    Scanner scanner;
+};
+
+static void
+scanner_reset (Scanner *scanner, gsize start)
+{
+    scanner->state = SCANNER_STATE_HEADERS;
+    scanner->start = start;
+    scanner->line_start = start;
+    scanner->offset = start;
+    scanner->body_length = 0;
+}
+
+static gsize
+parse_body_length (const gchar *line, gsize length)
+{
+    const gchar *prefix = "body-length:";
+    gsize prefix_length = strlen (prefix);
+    if (length < prefix_length || strncmp (line, prefix, prefix_length) != 0)
+        return 0;
+
+    gsize offset = prefix_length;
+    while (offset < length && line[offset] == ' ')
+        offset++;
+    gsize value = 0;
+    while (offset < length && line[offset] >= '0' && line[offset] <= '9') {
+        value = value * 10 + (line[offset] - '0');
+        offset++;
+    }
+
+    return value;
+}
+
+/* Find the next complete assertion in @data, returning FALSE if more data is required */
+static gboolean
+scanner_next (Scanner *scanner, const gchar *data, gsize length, gsize *start, gsize *end)
+{
+    while (TRUE) {
+        if (scanner->state == SCANNER_STATE_HEADERS) {
+            if (scanner->line_start >= length)
+                return FALSE;
+
+            /* Headers terminated by a blank line */
+            if (data[scanner->line_start] == '\n') {
+                scanner->offset = scanner->line_start + 1;
+                scanner->line_start = scanner->offset;
+                scanner->state = scanner->body_length > 0 ? SCANNER_STATE_BODY : SCANNER_STATE_SIGNATURE;
+                continue;
+            }
+
+            const gchar *newline = memchr (data + scanner->offset, '\n', length - scanner->offset);
+            if (newline == NULL) {
+                scanner->offset = length;
+                return FALSE;
+            }
+            gsize line_end = newline - data;
+            gsize body_length = parse_body_length (data + scanner->line_start, line_end - scanner->line_start);
+            if (body_length > 0)
+                scanner->body_length = body_length;
+            scanner->line_start = scanner->offset = line_end + 1;
+        }
+        else if (scanner->state == SCANNER_STATE_BODY) {
+            /* Body is followed by a blank line */
+            if (length - scanner->offset < scanner->body_length + 2)
+                return FALSE;
+            scanner->offset += scanner->body_length + 2;
+            scanner->line_start = scanner->offset;
+            scanner->state = SCANNER_STATE_SIGNATURE;
+        }
+        else {
+            /* Signature terminated by a blank line */
+            const gchar *newline = memchr (data + scanner->offset, '\n', length - scanner->offset);
+            if (newline == NULL) {
+                scanner->offset = length;
+                return FALSE;
+            }
+            gsize newline_offset = newline - data;
+            if (newline_offset + 1 >= length) {
+                scanner->offset = newline_offset;
+                return FALSE;
+            }
+            if (data[newline_offset + 1] == '\n') {
+                *start = scanner->start;
+                *end = newline_offset;
+                scanner_reset (scanner, newline_offset + 2);
+                return TRUE;
+            }
+            scanner->offset = newline_offset + 1;
+        }
+    }
+}
+
+SnapdAssertionStream *
+_snapd_assertion_stream_new (SnapdAssertionStreamCallback callback, gpointer user_data)
+{
+    SnapdAssertionStream *stream = g_slice_new0 (SnapdAssertionStream);
+    stream->callback = callback;
+    stream->user_data = user_data;
+    stream->buffer = g_byte_array_new ();
+    scanner_reset (&stream->scanner, 0);
+
+    return stream;
+}
+
+static gboolean
+report_assertions (SnapdAssertionStream *stream, GArray *spans, gsize consumed, GError **error)
+{
+    if (spans->len == 0)
+        return TRUE;
+
+    /* Return all assertions as views into one buffer, avoiding a copy if all the data is used */
+    g_autoptr(GBytes) data = NULL;
+    if (consumed == stream->buffer->len) {
+        data = g_byte_array_free_to_bytes (stream->buffer);
+        stream->buffer = g_byte_array_new ();
+    }
+    else {
+        data = g_bytes_new (stream->buffer->data, consumed);
+        g_byte_array_remove_range (stream->buffer, 0, consumed);
+    }
+
+    for (guint i = 0; i < spans->len; i += 2) {
+        gsize start = g_array_index (spans, gsize, i);
+        gsize end = g_array_index (spans, gsize, i + 1);
+        g_autoptr(GBytes) assertion = g_bytes_new_from_bytes (data, start, end - start);
+        if (!stream->callback (assertion, stream->user_data, error))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+gboolean
+_snapd_assertion_stream_feed (SnapdAssertionStream *stream, const gchar *data, gsize length, GError **error)
+{
+    g_byte_array_append (stream->buffer, (const guint8 *) data, length);
+
+    g_autoptr(GArray) spans = g_array_new (FALSE, FALSE, sizeof (gsize));
+    gsize start, end;
+    while (scanner_next (&stream->scanner, (const gchar *) stream->buffer->data, stream->buffer->len, &start, &end)) {
+        g_array_append_val (spans, start);
+        g_array_append_val (spans, end);
+    }
+
+    /* Move the incomplete assertion to the start of the buffer */
+    gsize consumed = stream->scanner.start;
+    Scanner *scanner = &stream->scanner;
+    scanner->start -= consumed;
+    scanner->line_start -= consumed;
+    scanner->offset -= consumed;
+
+    return report_assertions (stream, spans, consumed, error);
+}
+
+gboolean
+_snapd_assertion_stream_finish (SnapdAssertionStream *stream, GError **error)
+{
+    /* Remaining data is the last assertion, which has no trailing blank line */
+    if (stream->buffer->len == 0)
+        return TRUE;
+
+    g_autoptr(GArray) spans = g_array_new (FALSE, FALSE, sizeof (gsize));
+    gsize start = 0, end = stream->buffer->len;
+    g_array_append_val (spans, start);
+    g_array_append_val (spans, end);
+    scanner_reset (&stream->scanner, 0);
+
+    return report_assertions (stream, spans, stream->buffer->len, error);
+}
+
+void
+_snapd_assertion_stream_free (SnapdAssertionStream *stream)
+{
+    g_byte_array_unref (stream->buffer);
+    g_slice_free (SnapdAssertionStream, stream);
+}
+
+/* Split a complete bundle of assertions into views of @data */
+GPtrArray *
+_snapd_assertion_split (GBytes *data)
+{
+    gsize length;
+    const gchar *content = g_bytes_get_data (data, &length);
+
+    g_autoptr(GPtrArray) assertions = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+    Scanner scanner;
+    scanner_reset (&scanner, 0);
+    gsize start, end;
+    while (scanner_next (&scanner, content, length, &start, &end))
+        g_ptr_array_add (assertions, g_bytes_new_from_bytes (data, start, end - start));
+    if (scanner.start < length)
+        g_ptr_array_add (assertions, g_bytes_new_from_bytes (data, scanner.start, length - scanner.start));
+
+    return g_steal_pointer (&assertions);
+}
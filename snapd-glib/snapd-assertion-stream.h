@@ -0,0 +1,40 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_ASSERTION_STREAM_H__
+#define __SNAPD_ASSERTION_STREAM_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _SnapdAssertionStream SnapdAssertionStream;
+
+typedef gboolean (*SnapdAssertionStreamCallback) (GBytes *assertion, gpointer user_data, GError **error);
+
+SnapdAssertionStream *_snapd_assertion_stream_new    (SnapdAssertionStreamCallback callback,
+                                                      gpointer                     user_data);
+
+gboolean              _snapd_assertion_stream_feed   (SnapdAssertionStream        *stream,
+                                                      const gchar                 *data,
+                                                      gsize                        length,
+                                                      GError                     **error);
+
+gboolean              _snapd_assertion_stream_finish (SnapdAssertionStream        *stream,
+                                                      GError                     **error);
+
+void                  _snapd_assertion_stream_free   (SnapdAssertionStream        *stream);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SnapdAssertionStream, _snapd_assertion_stream_free)
+
+GPtrArray            *_snapd_assertion_split         (GBytes                      *data);
+
+G_END_DECLS
+
+#endif /* __SNAPD_ASSERTION_STREAM_H__ */
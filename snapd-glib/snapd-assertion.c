@@ -11,7 +11,7 @@
 #include <string.h>
 #include <ctype.h>
 
-#include "snapd-assertion.h"
+#include "snapd-assertion-private.h"
 
 /**
  * SECTION: snapd-assertion
@@ -40,9 +40,29 @@ struct _SnapdAssertion
 {
     GObject parent_instance;
 
-    gchar *content;
+    /* Copy of the content with the header names, header values and body
+     * terminated in place so they can be returned without copying */
+    gchar *buffer;
+    gsize length;
+
+    /* Characters replaced when terminating fields in @buffer */
+    GArray *terminators;
+
+    /* Header names in order (NULL terminated) and values indexed by name */
+    GPtrArray *header_names;
+    GHashTable *header_values;
+
+    const gchar *body;
+    gsize body_length;
+    const gchar *signature;
 };
 
+typedef struct
+{
+    gsize offset;
+    gchar value;
+} Terminator;
+
 enum
 {
     PROP_CONTENT = 1,
@@ -64,10 +84,9 @@ G_DEFINE_TYPE (SnapdAssertion, snapd_assertion, G_TYPE_OBJECT)
 SnapdAssertion *
 snapd_assertion_new (const gchar *content)
 {
-    SnapdAssertion *self = g_object_new (SNAPD_TYPE_ASSERTION, NULL);
-    self->content = g_strdup (content);
-
-    return self;
+    return g_object_new (SNAPD_TYPE_ASSERTION,
+                         "content", content,
+                         NULL);
 }
 
 static gboolean
@@ -111,6 +130,120 @@ get_header (const gchar *content, gsize *offset, gsize *name_start, gsize *name_
     return TRUE;
 }
 
+static void
+terminate (SnapdAssertion *self, gsize offset)
+{
+    Terminator terminator = { offset, self->buffer[offset] };
+    g_array_append_val (self->terminators, terminator);
+    self->buffer[offset] = '\0';
+}
+
+static void
+clear_index (SnapdAssertion *self)
+{
+    g_clear_pointer (&self->buffer, g_free);
+    self->length = 0;
+    g_clear_pointer (&self->terminators, g_array_unref);
+    g_clear_pointer (&self->header_names, g_ptr_array_unref);
+    g_clear_pointer (&self->header_values, g_hash_table_unref);
+    self->body = NULL;
+    self->body_length = 0;
+    self->signature = NULL;
+}
+
+/* Parse the content once, recording where each part of the assertion is */
+static void
+set_content (SnapdAssertion *self, const gchar *content, gssize length)
+{
+    clear_index (self);
+
+    if (content == NULL)
+        content = "";
+    if (length < 0)
+        length = strlen (content);
+    self->length = length;
+    self->buffer = g_malloc (length + 1);
+    memcpy (self->buffer, content, length);
+    self->buffer[length] = '\0';
+    self->terminators = g_array_new (FALSE, FALSE, sizeof (Terminator));
+    self->header_names = g_ptr_array_new ();
+    self->header_values = g_hash_table_new (g_str_hash, g_str_equal);
+
+    /* Headers terminated by double newline or EOF.
+     * get_header() only looks forward so fields can be terminated as we go */
+    gsize offset = 0;
+    gboolean has_divider = FALSE;
+    while (TRUE) {
+        if (self->buffer[offset] == '\n')
+            has_divider = TRUE;
+        if (self->buffer[offset] == '\0' || self->buffer[offset] == '\n')
+            break;
+
+        gsize name_start, name_length, value_start, value_length;
+        if (!get_header (self->buffer, &offset, &name_start, &name_length, &value_start, &value_length))
+            break;
+
+        terminate (self, name_start + name_length);
+        terminate (self, value_start + value_length);
+
+        /* First definition of a header wins */
+        const gchar *name = self->buffer + name_start;
+        g_ptr_array_add (self->header_names, (gpointer) name);
+        if (!g_hash_table_contains (self->header_values, name))
+            g_hash_table_insert (self->header_values, (gpointer) name, self->buffer + value_start);
+    }
+    g_ptr_array_add (self->header_names, NULL);
+
+    /* No divider, so no body or signature */
+    if (!has_divider) {
+        self->signature = self->buffer + self->length;
+        return;
+    }
+
+    gsize body_start = offset + 1;
+    gsize body_length = 0;
+    const gchar *body_length_header = g_hash_table_lookup (self->header_values, "body-length");
+    if (body_length_header != NULL)
+        body_length = strtoul (body_length_header, NULL, 10);
+
+    gsize signature_start = body_start;
+    if (body_length > 0) {
+        body_length = MIN (body_length, self->length - body_start);
+        self->body = self->buffer + body_start;
+        self->body_length = body_length;
+        if (body_start + body_length < self->length)
+            terminate (self, body_start + body_length);
+
+        /* Body separated from signature by double newline */
+        signature_start = MIN (body_start + body_length + 2, self->length);
+    }
+    self->signature = self->buffer + signature_start;
+}
+
+SnapdAssertion *
+_snapd_assertion_new_from_bytes (GBytes *content)
+{
+    SnapdAssertion *self = g_object_new (SNAPD_TYPE_ASSERTION, NULL);
+    gsize length;
+    const gchar *data = g_bytes_get_data (content, &length);
+    set_content (self, data, length);
+
+    return self;
+}
+
+static gchar *
+get_content (SnapdAssertion *self)
+{
+    gchar *content = g_malloc (self->length + 1);
+    memcpy (content, self->buffer, self->length + 1);
+    for (guint i = 0; i < self->terminators->len; i++) {
+        Terminator *terminator = &g_array_index (self->terminators, Terminator, i);
+        content[terminator->offset] = terminator->value;
+    }
+
+    return content;
+}
+
 /**
  * snapd_assertion_get_headers:
  * @assertion: a #SnapdAssertion.
@@ -125,22 +258,24 @@ GStrv
 snapd_assertion_get_headers (SnapdAssertion *self)
 {
     g_return_val_if_fail (SNAPD_IS_ASSERTION (self), NULL);
+    return g_strdupv ((GStrv) self->header_names->pdata);
+}
 
-    gsize offset = 0;
-    g_autoptr(GPtrArray) headers = g_ptr_array_new ();
-    while (TRUE) {
-        /* Headers terminated by double newline or EOF */
-        gsize name_start, name_length;
-        if (self->content[offset] == '\0' ||
-            self->content[offset] == '\n' ||
-            !get_header (self->content, &offset, &name_start, &name_length, NULL, NULL))
-            break;
-
-        g_ptr_array_add (headers, g_strndup (self->content + name_start, name_length));
-    }
-    g_ptr_array_add (headers, NULL);
-
-    return g_steal_pointer ((GStrv *)&headers->pdata);
+/**
+ * snapd_assertion_peek_headers:
+ * @assertion: a #SnapdAssertion.
+ *
+ * Get the headers provided by this assertion without copying them.
+ *
+ * Returns: (transfer none) (array zero-terminated=1): array of header names.
+ *
+ * Since: 1.59
+ */
+const gchar * const *
+snapd_assertion_peek_headers (SnapdAssertion *self)
+{
+    g_return_val_if_fail (SNAPD_IS_ASSERTION (self), NULL);
+    return (const gchar * const *) self->header_names->pdata;
 }
 
 /**
@@ -159,44 +294,27 @@ snapd_assertion_get_header (SnapdAssertion *self, const gchar *name)
 {
     g_return_val_if_fail (SNAPD_IS_ASSERTION (self), NULL);
     g_return_val_if_fail (name != NULL, NULL);
-
-    gsize offset = 0;
-    while (TRUE) {
-        /* Headers terminated by double newline or EOF */
-        if (self->content[offset] == '\0' || self->content[offset] == '\n')
-            return NULL;
-
-        gsize name_start, name_length, value_start, value_length;
-        if (!get_header (self->content, &offset, &name_start, &name_length, &value_start, &value_length))
-            return NULL;
-
-        /* Return value if header we're looking for */
-        if (strncmp (self->content + name_start, name, name_length) == 0)
-            return g_strndup (self->content + value_start, value_length);
-    }
-
-    return NULL;
+    return g_strdup (snapd_assertion_peek_header (self, name));
 }
 
-static gsize
-get_headers_length (SnapdAssertion *self)
-{
-    /* Headers terminated by double newline */
-    gchar *divider = strstr (self->content, "\n\n");
-    if (divider == NULL)
-        return 0;
-
-    return divider - self->content;
-}
-
-static gsize
-get_body_length (SnapdAssertion *self)
+/**
+ * snapd_assertion_peek_header:
+ * @assertion: a #SnapdAssertion.
+ * @name: name of the header.
+ *
+ * Get a header from an assertion without copying it. The header is looked up
+ * from an index built when the assertion is created.
+ *
+ * Returns: (transfer none) (allow-none): header value or %NULL if undefined.
+ *
+ * Since: 1.59
+ */
+const gchar *
+snapd_assertion_peek_header (SnapdAssertion *self, const gchar *name)
 {
-    g_autofree gchar *body_length_header = snapd_assertion_get_header (self, "body-length");
-    if (body_length_header == NULL)
-        return 0;
-
-    return strtoul (body_length_header, NULL, 10);
+    g_return_val_if_fail (SNAPD_IS_ASSERTION (self), NULL);
+    g_return_val_if_fail (name != NULL, NULL);
+    return g_hash_table_lookup (self->header_values, name);
 }
 
 /**
@@ -213,12 +331,27 @@ gchar *
 snapd_assertion_get_body (SnapdAssertion *self)
 {
     g_return_val_if_fail (SNAPD_IS_ASSERTION (self), NULL);
+    return g_strdup (self->body);
+}
 
-    gsize body_length = get_body_length (self);
-    if (body_length == 0)
-        return NULL;
-
-    return g_strndup (self->content + get_headers_length (self) + 2, body_length);
+/**
+ * snapd_assertion_peek_body:
+ * @assertion: a #SnapdAssertion.
+ * @length: (out) (allow-none): location to write the length of the body or %NULL.
+ *
+ * Get the body of the assertion without copying it.
+ *
+ * Returns: (transfer none) (allow-none): assertion body or %NULL.
+ *
+ * Since: 1.59
+ */
+const gchar *
+snapd_assertion_peek_body (SnapdAssertion *self, gsize *length)
+{
+    g_return_val_if_fail (SNAPD_IS_ASSERTION (self), NULL);
+    if (length != NULL)
+        *length = self->body_length;
+    return self->body;
 }
 
 /**
@@ -235,12 +368,24 @@ gchar *
 snapd_assertion_get_signature (SnapdAssertion *self)
 {
     g_return_val_if_fail (SNAPD_IS_ASSERTION (self), NULL);
+    return g_strdup (self->signature);
+}
 
-    gsize body_length = get_body_length (self);
-    if (body_length > 0)
-        return g_strdup (self->content + get_headers_length (self) + 2 + body_length + 2);
-    else
-        return g_strdup (self->content + get_headers_length (self) + 2);
+/**
+ * snapd_assertion_peek_signature:
+ * @assertion: a #SnapdAssertion.
+ *
+ * Get the signature of the assertion without copying it.
+ *
+ * Returns: (transfer none): assertion signature.
+ *
+ * Since: 1.59
+ */
+const gchar *
+snapd_assertion_peek_signature (SnapdAssertion *self)
+{
+    g_return_val_if_fail (SNAPD_IS_ASSERTION (self), NULL);
+    return self->signature;
 }
 
 static void
@@ -250,8 +395,7 @@ snapd_assertion_set_property (GObject *object, guint prop_id, const GValue *valu
 
     switch (prop_id) {
     case PROP_CONTENT:
-        g_free (self->content);
-        self->content = g_strdup (g_value_get_string (value));
+        set_content (self, g_value_get_string (value), -1);
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -266,7 +410,7 @@ snapd_assertion_get_property (GObject *object, guint prop_id, GValue *value, GPa
 
     switch (prop_id) {
     case PROP_CONTENT:
-        g_value_set_string (value, self->content);
+        g_value_take_string (value, get_content (self));
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -274,12 +418,24 @@ snapd_assertion_get_property (GObject *object, guint prop_id, GValue *value, GPa
     }
 }
 
+static void
+snapd_assertion_constructed (GObject *object)
+{
+    SnapdAssertion *self = SNAPD_ASSERTION (object);
+
+    G_OBJECT_CLASS (snapd_assertion_parent_class)->constructed (object);
+
+    /* Content not provided */
+    if (self->buffer == NULL)
+        set_content (self, NULL, -1);
+}
+
 static void
 snapd_assertion_finalize (GObject *object)
 {
     SnapdAssertion *self = SNAPD_ASSERTION (object);
 
-    g_clear_pointer (&self->content, g_free);
+    clear_index (self);
 
     G_OBJECT_CLASS (snapd_assertion_parent_class)->finalize (object);
 }
@@ -291,6 +447,7 @@ snapd_assertion_class_init (SnapdAssertionClass *klass)
 
     gobject_class->set_property = snapd_assertion_set_property;
     gobject_class->get_property = snapd_assertion_get_property;
+    gobject_class->constructed = snapd_assertion_constructed;
     gobject_class->finalize = snapd_assertion_finalize;
 
     g_object_class_install_property (gobject_class,
@@ -22,16 +22,26 @@ G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (SnapdAssertion, snapd_assertion, SNAPD, ASSERTION, GObject)
 
-SnapdAssertion *snapd_assertion_new                   (const gchar    *content);
+SnapdAssertion     *snapd_assertion_new            (const gchar    *content);
 
-GStrv           snapd_assertion_get_headers           (SnapdAssertion *assertion);
+GStrv               snapd_assertion_get_headers    (SnapdAssertion *assertion);
 
-gchar          *snapd_assertion_get_header            (SnapdAssertion *assertion,
-                                                       const gchar    *name);
+const gchar * const *snapd_assertion_peek_headers  (SnapdAssertion *assertion);
 
-gchar          *snapd_assertion_get_body              (SnapdAssertion *assertion);
+gchar              *snapd_assertion_get_header     (SnapdAssertion *assertion,
+                                                    const gchar    *name);
 
-gchar          *snapd_assertion_get_signature         (SnapdAssertion *assertion);
+const gchar        *snapd_assertion_peek_header    (SnapdAssertion *assertion,
+                                                    const gchar    *name);
+
+gchar              *snapd_assertion_get_body       (SnapdAssertion *assertion);
+
+const gchar        *snapd_assertion_peek_body      (SnapdAssertion *assertion,
+                                                    gsize          *length);
+
+gchar              *snapd_assertion_get_signature  (SnapdAssertion *assertion);
+
+const gchar        *snapd_assertion_peek_signature (SnapdAssertion *assertion);
 
 G_END_DECLS
 
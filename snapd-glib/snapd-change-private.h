@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_CHANGE_PRIVATE_H__
+#define __SNAPD_CHANGE_PRIVATE_H__
+
+#include "snapd-change.h"
+
+G_BEGIN_DECLS
+
+/* The change takes ownership of the strings, tasks and dates, @kind and @status are reference counted strings */
+SnapdChange *_snapd_change_new (gchar               *id,
+                                gchar               *kind,
+                                gchar               *summary,
+                                gchar               *status,
+                                GPtrArray           *tasks,
+                                gboolean             ready,
+                                GDateTime           *spawn_time,
+                                GDateTime           *ready_time,
+                                gchar               *error);
+
+guint64      _snapd_change_get_fingerprint   (SnapdChange *change);
+
+/* Get the tasks in @change that are new or different since @previous */
+GPtrArray   *_snapd_change_get_changed_tasks (SnapdChange *change,
+                                              SnapdChange *previous);
+
+G_END_DECLS
+
+#endif /* __SNAPD_CHANGE_PRIVATE_H__ */
@@ -9,7 +9,9 @@
 
 #include <string.h>
 
-#include "snapd-change.h"
+#include "snapd-change-private.h"
+#include "snapd-string-pool.h"
+#include "snapd-task-private.h"
 
 /**
  * SECTION: snapd-change
@@ -41,6 +43,9 @@ struct _SnapdChange
     GDateTime *spawn_time;
     GDateTime *ready_time;
     gchar *error;
+
+    /* Hash of all the above including the tasks, so changes can be compared quickly when polling */
+    guint64 fingerprint;
 };
 
 enum
@@ -59,6 +64,98 @@ enum
 
 G_DEFINE_TYPE (SnapdChange, snapd_change, G_TYPE_OBJECT)
 
+static void
+update_fingerprint (SnapdChange *self)
+{
+    guint64 fingerprint = SNAPD_FINGERPRINT_INIT;
+    fingerprint = _snapd_fingerprint_add_string (fingerprint, self->id);
+    fingerprint = _snapd_fingerprint_add_string (fingerprint, self->kind);
+    fingerprint = _snapd_fingerprint_add_string (fingerprint, self->summary);
+    fingerprint = _snapd_fingerprint_add_string (fingerprint, self->status);
+    fingerprint = _snapd_fingerprint_add_int (fingerprint, self->ready ? 1 : 0);
+    fingerprint = _snapd_fingerprint_add_date_time (fingerprint, self->spawn_time);
+    fingerprint = _snapd_fingerprint_add_date_time (fingerprint, self->ready_time);
+    fingerprint = _snapd_fingerprint_add_string (fingerprint, self->error);
+    if (self->tasks != NULL) {
+        fingerprint = _snapd_fingerprint_add_int (fingerprint, self->tasks->len);
+        for (guint i = 0; i < self->tasks->len; i++)
+            fingerprint = _snapd_fingerprint_add_int (fingerprint, _snapd_task_get_fingerprint (g_ptr_array_index (self->tasks, i)));
+    }
+    else
+        fingerprint = _snapd_fingerprint_add_int (fingerprint, -1);
+    self->fingerprint = fingerprint;
+}
+
+SnapdChange *
+_snapd_change_new (gchar *id, gchar *kind, gchar *summary, gchar *status, GPtrArray *tasks, gboolean ready, GDateTime *spawn_time, GDateTime *ready_time, gchar *error)
+{
+    SnapdChange *self = g_object_new (SNAPD_TYPE_CHANGE, NULL);
+
+    self->id = id;
+    self->kind = kind;
+    self->summary = summary;
+    self->status = status;
+    self->tasks = tasks;
+    self->ready = ready;
+    self->spawn_time = spawn_time;
+    self->ready_time = ready_time;
+    self->error = error;
+    update_fingerprint (self);
+
+    return self;
+}
+
+guint64
+_snapd_change_get_fingerprint (SnapdChange *self)
+{
+    return self->fingerprint;
+}
+
+static SnapdTask *
+find_task (GPtrArray *tasks, GHashTable **tasks_by_id, guint index, const gchar *id)
+{
+    /* Tasks are normally in the same order each time */
+    if (index < tasks->len) {
+        SnapdTask *task = g_ptr_array_index (tasks, index);
+        if (g_strcmp0 (snapd_task_get_id (task), id) == 0)
+            return task;
+    }
+
+    if (*tasks_by_id == NULL) {
+        *tasks_by_id = g_hash_table_new (g_str_hash, g_str_equal);
+        for (guint i = 0; i < tasks->len; i++) {
+            SnapdTask *task = g_ptr_array_index (tasks, i);
+            if (snapd_task_get_id (task) != NULL)
+                g_hash_table_insert (*tasks_by_id, (gpointer) snapd_task_get_id (task), task);
+        }
+    }
+
+    return id != NULL ? g_hash_table_lookup (*tasks_by_id, id) : NULL;
+}
+
+GPtrArray *
+_snapd_change_get_changed_tasks (SnapdChange *self, SnapdChange *previous)
+{
+    g_autoptr(GPtrArray) changed_tasks = g_ptr_array_new_with_free_func (g_object_unref);
+
+    if (self->tasks == NULL)
+        return g_steal_pointer (&changed_tasks);
+
+    GPtrArray *previous_tasks = previous != NULL ? previous->tasks : NULL;
+    g_autoptr(GHashTable) previous_tasks_by_id = NULL;
+    for (guint i = 0; i < self->tasks->len; i++) {
+        SnapdTask *task = g_ptr_array_index (self->tasks, i);
+
+        SnapdTask *previous_task = NULL;
+        if (previous_tasks != NULL)
+            previous_task = find_task (previous_tasks, &previous_tasks_by_id, i, snapd_task_get_id (task));
+        if (previous_task == NULL || _snapd_task_get_fingerprint (previous_task) != _snapd_task_get_fingerprint (task))
+            g_ptr_array_add (changed_tasks, g_object_ref (task));
+    }
+
+    return g_steal_pointer (&changed_tasks);
+}
+
 /**
  * snapd_change_get_id:
  * @change: a #SnapdChange.
@@ -223,16 +320,16 @@ snapd_change_set_property (GObject *object, guint prop_id, const GValue *value,
         self->id = g_strdup (g_value_get_string (value));
         break;
     case PROP_KIND:
-        g_free (self->kind);
-        self->kind = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->kind);
+        self->kind = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_SUMMARY:
         g_free (self->summary);
         self->summary = g_strdup (g_value_get_string (value));
         break;
     case PROP_STATUS:
-        g_free (self->status);
-        self->status = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->status);
+        self->status = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_TASKS:
         g_clear_pointer (&self->tasks, g_ptr_array_unref);
@@ -301,15 +398,23 @@ snapd_change_get_property (GObject *object, guint prop_id, GValue *value, GParam
     }
 }
 
+static void
+snapd_change_constructed (GObject *object)
+{
+    update_fingerprint (SNAPD_CHANGE (object));
+
+    G_OBJECT_CLASS (snapd_change_parent_class)->constructed (object);
+}
+
 static void
 snapd_change_finalize (GObject *object)
 {
     SnapdChange *self = SNAPD_CHANGE (object);
 
     g_clear_pointer (&self->id, g_free);
-    g_clear_pointer (&self->kind, g_free);
+    g_clear_pointer (&self->kind, _snapd_ref_string_release);
     g_clear_pointer (&self->summary, g_free);
-    g_clear_pointer (&self->status, g_free);
+    g_clear_pointer (&self->status, _snapd_ref_string_release);
     g_clear_pointer (&self->tasks, g_ptr_array_unref);
     g_clear_pointer (&self->spawn_time, g_date_time_unref);
     g_clear_pointer (&self->ready_time, g_date_time_unref);
@@ -325,6 +430,7 @@ snapd_change_class_init (SnapdChangeClass *klass)
 
     gobject_class->set_property = snapd_change_set_property;
     gobject_class->get_property = snapd_change_get_property;
+    gobject_class->constructed = snapd_change_constructed;
     gobject_class->finalize = snapd_change_finalize;
 
     g_object_class_install_property (gobject_class,
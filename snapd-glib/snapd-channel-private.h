@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_CHANNEL_PRIVATE_H__
+#define __SNAPD_CHANNEL_PRIVATE_H__
+
+#include "snapd-channel.h"
+
+G_BEGIN_DECLS
+
+/* The channel takes ownership of the strings and date, @name and @epoch are reference counted strings */
+SnapdChannel *_snapd_channel_new (gchar               *name,
+                                  SnapdConfinement     confinement,
+                                  gchar               *epoch,
+                                  GDateTime           *released_at,
+                                  gchar               *revision,
+                                  gint64               size,
+                                  gchar               *version);
+
+G_END_DECLS
+
+#endif /* __SNAPD_CHANNEL_PRIVATE_H__ */
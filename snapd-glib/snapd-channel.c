@@ -7,8 +7,9 @@
  * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
  */
 
-#include "snapd-channel.h"
+#include "snapd-channel-private.h"
 #include "snapd-enum-types.h"
+#include "snapd-string-pool.h"
 
 /**
  * SECTION:snapd-channel
@@ -249,15 +250,18 @@ is_risk (const gchar *risk)
 }
 
 static void
-set_name (SnapdChannel *self, const gchar *name)
+set_name (SnapdChannel *self, gchar *name)
 {
-    g_free (self->name);
-    self->name = g_strdup (name);
+    _snapd_ref_string_release (self->name);
+    self->name = name;
 
     g_clear_pointer (&self->track, g_free);
     g_clear_pointer (&self->risk, g_free);
     g_clear_pointer (&self->branch, g_free);
 
+    if (name == NULL)
+        return;
+
     g_auto(GStrv) tokens = g_strsplit (name, "/", -1);
     switch (g_strv_length (tokens)) {
     case 1:
@@ -291,6 +295,22 @@ set_name (SnapdChannel *self, const gchar *name)
     }
 }
 
+SnapdChannel *
+_snapd_channel_new (gchar *name, SnapdConfinement confinement, gchar *epoch, GDateTime *released_at, gchar *revision, gint64 size, gchar *version)
+{
+    SnapdChannel *self = g_object_new (SNAPD_TYPE_CHANNEL, NULL);
+
+    set_name (self, name);
+    self->confinement = confinement;
+    self->epoch = epoch;
+    self->released_at = released_at;
+    self->revision = revision;
+    self->size = size;
+    self->version = version;
+
+    return self;
+}
+
 static void
 snapd_channel_set_property (GObject *object, guint prop_id, const GValue *value, GParamSpec *pspec)
 {
@@ -301,11 +321,11 @@ snapd_channel_set_property (GObject *object, guint prop_id, const GValue *value,
         self->confinement = g_value_get_enum (value);
         break;
     case PROP_EPOCH:
-        g_free (self->epoch);
-        self->epoch = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->epoch);
+        self->epoch = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_NAME:
-        set_name (self, g_value_get_string (value));
+        set_name (self, _snapd_ref_string_new (g_value_get_string (value)));
         break;
     case PROP_RELEASED_AT:
         g_clear_pointer (&self->released_at, g_date_time_unref);
@@ -368,8 +388,8 @@ snapd_channel_finalize (GObject *object)
     SnapdChannel *self = SNAPD_CHANNEL (object);
 
     g_clear_pointer (&self->branch, g_free);
-    g_clear_pointer (&self->epoch, g_free);
-    g_clear_pointer (&self->name, g_free);
+    g_clear_pointer (&self->epoch, _snapd_ref_string_release);
+    g_clear_pointer (&self->name, _snapd_ref_string_release);
     g_clear_pointer (&self->revision, g_free);
     g_clear_pointer (&self->released_at, g_date_time_unref);
     g_clear_pointer (&self->risk, g_free);
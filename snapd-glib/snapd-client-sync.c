@@ -10,32 +10,69 @@
 #include "snapd-client.h"
 #include "snapd-error.h"
 
+#include "requests/snapd-request.h"
+
+typedef struct {
+    GMainContext *context;
+    gboolean      in_use;
+} SyncContext;
+
+static void
+sync_context_free (SyncContext *sync_context)
+{
+    g_main_context_unref (sync_context->context);
+    g_slice_free (SyncContext, sync_context);
+}
+
+/* Context used for synchronous calls in each thread, reused so calls don't need to create a new one */
+static GPrivate thread_sync_context = G_PRIVATE_INIT ((GDestroyNotify) sync_context_free);
+
 typedef struct {
+    SyncContext  *sync_context;
     GMainContext *context;
-    GMainLoop    *loop;
     GAsyncResult *result;
 } SyncData;
 
 static void
 start_sync (SyncData *data)
 {
-    data->context = g_main_context_new ();
-    data->loop = g_main_loop_new (data->context, FALSE);
+    SyncContext *sync_context = g_private_get (&thread_sync_context);
+    if (sync_context == NULL) {
+        sync_context = g_slice_new0 (SyncContext);
+        sync_context->context = g_main_context_new ();
+        g_private_set (&thread_sync_context, sync_context);
+    }
+
+    /* Use a new context if called from a callback while another synchronous call is running in this thread */
+    if (sync_context->in_use)
+        data->context = g_main_context_new ();
+    else {
+        sync_context->in_use = TRUE;
+        data->sync_context = sync_context;
+        data->context = g_main_context_ref (sync_context->context);
+    }
     g_main_context_push_thread_default (data->context);
 }
 
 static void
 end_sync (SyncData *data)
 {
-    if (data->loop != NULL)
-        g_main_loop_run (data->loop);
+    while (data->result == NULL)
+        g_main_context_iteration (data->context, TRUE);
+
+    /* The context is reused, so remove sources the request left behind (e.g. a late cancellation) so they don't run during a later call */
+    if (SNAPD_IS_REQUEST (data->result))
+        _snapd_request_destroy_sources (SNAPD_REQUEST (data->result));
+
     g_main_context_pop_thread_default (data->context);
 }
 
 static void
 sync_data_clear (SyncData *data)
 {
-    g_clear_pointer (&data->loop, g_main_loop_unref);
+    if (data->sync_context != NULL)
+        data->sync_context->in_use = FALSE;
+    data->sync_context = NULL;
     g_clear_pointer (&data->context, g_main_context_unref);
     g_clear_object (&data->result);
 }
@@ -47,8 +84,6 @@ sync_cb (GObject *object, GAsyncResult *result, gpointer user_data)
 {
     SyncData *data = user_data;
     data->result = g_object_ref (result);
-    g_main_loop_quit (data->loop);
-    g_clear_pointer (&data->loop, g_main_loop_unref);
 }
 
 /**
@@ -254,6 +289,40 @@ snapd_client_abort_change_sync (SnapdClient *self,
     return snapd_client_abort_change_finish (self, data.result, error);
 }
 
+/**
+ * snapd_client_watch_change_sync:
+ * @client: a #SnapdClient.
+ * @id: a change ID to follow.
+ * @progress_callback: (allow-none) (scope call): function to callback with progress.
+ * @progress_callback_data: (closure): user data to pass to @progress_callback.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Follow a change started elsewhere until it completes, without modifying it.
+ * Progress is checked once for all requests following the same change.
+ * Cancelling stops following the change, it does not abort it.
+ *
+ * Returns: (transfer full): the completed #SnapdChange or %NULL on error.
+ *
+ * Since: 1.59
+ */
+SnapdChange *
+snapd_client_watch_change_sync (SnapdClient *self,
+                                const gchar *id,
+                                SnapdProgressCallback progress_callback, gpointer progress_callback_data,
+                                GCancellable *cancellable, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
+    g_return_val_if_fail (id != NULL, NULL);
+
+    g_auto(SyncData) data = { 0 };
+    start_sync (&data);
+    snapd_client_watch_change_async (self, id, progress_callback, progress_callback_data, cancellable, sync_cb, &data);
+    end_sync (&data);
+
+    return snapd_client_watch_change_finish (self, data.result, error);
+}
+
 /**
  * snapd_client_get_system_information_sync:
  * @client: a #SnapdClient.
@@ -469,6 +538,43 @@ snapd_client_get_icon_sync (SnapdClient *self,
     return snapd_client_get_icon_finish (self, data.result, error);
 }
 
+/**
+ * snapd_client_get_icons_sync:
+ * @client: a #SnapdClient.
+ * @names: a list of snap names to get icons for.
+ * @max_requests: maximum number of icons to request at once or 0 for the default.
+ * @icon_callback: (scope call): function to callback with each icon.
+ * @icon_callback_data: (closure): user data to pass to @icon_callback.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Get the icons for multiple installed snaps. Each icon is passed to
+ * @icon_callback as it is received, or the error if the icon could not be
+ * retrieved. At most @max_requests icons are requested from snapd at once.
+ * Names that appear more than once are only requested once, and icons that are
+ * already being requested by another call in the same thread share the same
+ * request.
+ *
+ * Returns: %TRUE if all icons were requested or %FALSE if cancelled.
+ *
+ * Since: 1.59
+ */
+gboolean
+snapd_client_get_icons_sync (SnapdClient *self,
+                             GStrv names, guint max_requests,
+                             SnapdIconCallback icon_callback, gpointer icon_callback_data,
+                             GCancellable *cancellable, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (names != NULL, FALSE);
+
+    g_auto(SyncData) data = { 0 };
+    start_sync (&data);
+    snapd_client_get_icons_async (self, names, max_requests, icon_callback, icon_callback_data, cancellable, sync_cb, &data);
+    end_sync (&data);
+    return snapd_client_get_icons_finish (self, data.result, error);
+}
+
 /**
  * snapd_client_list_sync:
  * @client: a #SnapdClient.
@@ -533,6 +639,39 @@ snapd_client_get_snaps_sync (SnapdClient *self,
     return snapd_client_get_snaps_finish (self, data.result, error);
 }
 
+/**
+ * snapd_client_update_snap_set_sync:
+ * @client: a #SnapdClient.
+ * @snap_set: a #SnapdSnapSet to update.
+ * @flags: a set of #SnapdGetSnapsFlags to control what results are returned.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Update @snap_set to contain the currently installed snaps, as returned by
+ * snapd_client_get_snaps_sync(). Snaps that are unchanged since the last update
+ * are not parsed again and keep the same #SnapdSnap object. The changes are
+ * available from snapd_snap_set_get_added(), snapd_snap_set_get_removed() and
+ * snapd_snap_set_get_changed().
+ *
+ * Returns: %TRUE on success.
+ *
+ * Since: 1.59
+ */
+gboolean
+snapd_client_update_snap_set_sync (SnapdClient *self,
+                                   SnapdSnapSet *snap_set,
+                                   SnapdGetSnapsFlags flags,
+                                   GCancellable *cancellable, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+
+    g_auto(SyncData) data = { 0 };
+    start_sync (&data);
+    snapd_client_update_snap_set_async (self, snap_set, flags, cancellable, sync_cb, &data);
+    end_sync (&data);
+    return snapd_client_update_snap_set_finish (self, data.result, error);
+}
+
 /**
  * snapd_client_get_assertions_sync:
  * @client: a #SnapdClient.
@@ -560,6 +699,39 @@ snapd_client_get_assertions_sync (SnapdClient *self,
     return snapd_client_get_assertions_finish (self, data.result, error);
 }
 
+/**
+ * snapd_client_get_assertions2_sync:
+ * @client: a #SnapdClient.
+ * @type: assertion type to get.
+ * @filters: (allow-none) (element-type utf8 utf8): header values the assertions must have or %NULL to get all assertions.
+ * @flags: a set of #SnapdGetAssertionsFlags to control what is returned.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Get assertions. The filters are checked by snapd, so only the matching
+ * assertions are transferred. If %SNAPD_GET_ASSERTIONS_FLAGS_HEADERS_ONLY is
+ * set the assertions are returned without their body and signature.
+ *
+ * Returns: (transfer full) (array zero-terminated=1): an array of assertions or %NULL on error.
+ *
+ * Since: 1.59
+ */
+GStrv
+snapd_client_get_assertions2_sync (SnapdClient *self,
+                                   const gchar *type,
+                                   GHashTable *filters,
+                                   SnapdGetAssertionsFlags flags,
+                                   GCancellable *cancellable, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
+
+    g_auto(SyncData) data = { 0 };
+    start_sync (&data);
+    snapd_client_get_assertions2_async (self, type, filters, flags, cancellable, sync_cb, &data);
+    end_sync (&data);
+    return snapd_client_get_assertions2_finish (self, data.result, error);
+}
+
 /**
  * snapd_client_add_assertions_sync:
  * @client: a #SnapdClient.
@@ -588,6 +760,47 @@ snapd_client_add_assertions_sync (SnapdClient *self,
     return snapd_client_add_assertions_finish (self, data.result, error);
 }
 
+/**
+ * snapd_client_import_assertions_sync:
+ * @client: a #SnapdClient.
+ * @stream: a #GInputStream to read assertions from.
+ * @max_batch_size: maximum number of bytes of assertions to send in one request or 0 for the default.
+ * @max_requests: maximum number of requests to send at once or 0 for the default.
+ * @batch_callback: (allow-none) (scope call): function to call as each batch is added.
+ * @batch_callback_data: (closure): user data to pass to @batch_callback.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Add assertions read from a stream, e.g. a file opened with g_file_read().
+ * The stream is read as the assertions are sent, so it doesn't need to fit in
+ * memory. Assertions are sent to snapd in batches of at most @max_batch_size
+ * bytes, with up to @max_requests batches being sent at once. A batch is only
+ * larger than @max_batch_size if it contains a single larger assertion.
+ *
+ * @batch_callback is called as each batch is added or fails to be added.
+ * A batch failing does not stop later batches from being sent.
+ *
+ * Returns: %TRUE if all assertions were added or %FALSE on the first error.
+ *
+ * Since: 1.59
+ */
+gboolean
+snapd_client_import_assertions_sync (SnapdClient *self,
+                                     GInputStream *stream,
+                                     gsize max_batch_size, guint max_requests,
+                                     SnapdAssertionBatchCallback batch_callback, gpointer batch_callback_data,
+                                     GCancellable *cancellable, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (G_IS_INPUT_STREAM (stream), FALSE);
+
+    g_auto(SyncData) data = { 0 };
+    start_sync (&data);
+    snapd_client_import_assertions_async (self, stream, max_batch_size, max_requests, batch_callback, batch_callback_data, cancellable, sync_cb, &data);
+    end_sync (&data);
+    return snapd_client_import_assertions_finish (self, data.result, error);
+}
+
 /**
  * snapd_client_get_interfaces_sync:
  * @client: a #SnapdClient.
@@ -721,6 +934,37 @@ snapd_client_get_connections2_sync (SnapdClient *self,
     return snapd_client_get_connections2_finish (self, data.result, established, undesired, plugs, slots, error);
 }
 
+/**
+ * snapd_client_get_connection_index_sync:
+ * @client: a #SnapdClient.
+ * @flags: a set of #SnapdGetConnectionsFlags to control what results are returned.
+ * @snap: (allow-none): the name of the snap to get connections for or %NULL for all snaps.
+ * @interface: (allow-none): the name of the interface to get connections for or %NULL for all interfaces.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Get the installed snap connections, indexed so plugs, slots and connections
+ * can be looked up by snap, interface and name.
+ * This returns the same information as snapd_client_get_connections2_sync().
+ *
+ * Returns: (transfer full): a #SnapdConnectionIndex or %NULL on error.
+ *
+ * Since: 1.59
+ */
+SnapdConnectionIndex *
+snapd_client_get_connection_index_sync (SnapdClient *self,
+                                        SnapdGetConnectionsFlags flags, const gchar *snap, const gchar *interface,
+                                        GCancellable *cancellable, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
+
+    g_auto(SyncData) data = { 0 };
+    start_sync (&data);
+    snapd_client_get_connection_index_async (self, flags, snap, interface, cancellable, sync_cb, &data);
+    end_sync (&data);
+    return snapd_client_get_connection_index_finish (self, data.result, error);
+}
+
 /**
  * snapd_client_connect_interface_sync:
  * @client: a #SnapdClient.
@@ -979,6 +1223,46 @@ snapd_client_install_stream_sync (SnapdClient *self,
     return snapd_client_install_stream_finish (self, data.result, error);
 }
 
+/**
+ * snapd_client_install_stream2_sync:
+ * @client: a #SnapdClient.
+ * @flags: a set of #SnapdInstallFlags to control install options.
+ * @stream: a #GInputStream containing the snap file contents to install.
+ * @upload_progress_callback: (allow-none) (scope call): function to callback as the snap is sent to snapd.
+ * @upload_progress_callback_data: (closure): user data to pass to @upload_progress_callback.
+ * @progress_callback: (allow-none) (scope call): function to callback with progress.
+ * @progress_callback_data: (closure): user data to pass to @progress_callback.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Install a snap, as with snapd_client_install_stream_sync() but also reporting
+ * how much of the snap has been sent to snapd.
+ *
+ * The snap is sent as it is read from @stream, so only a small part of it is
+ * held in memory at once. If @stream is a local file it is sent directly from the file.
+ *
+ * Returns: %TRUE on success or %FALSE on error.
+ *
+ * Since: 1.59
+ */
+gboolean
+snapd_client_install_stream2_sync (SnapdClient *self,
+                                   SnapdInstallFlags flags,
+                                   GInputStream *stream,
+                                   SnapdTransferProgressCallback upload_progress_callback, gpointer upload_progress_callback_data,
+                                   SnapdProgressCallback progress_callback, gpointer progress_callback_data,
+                                   GCancellable *cancellable, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (G_IS_INPUT_STREAM (stream), FALSE);
+
+    g_auto(SyncData) data = { 0 };
+    start_sync (&data);
+    snapd_client_install_stream2_async (self, flags, stream, upload_progress_callback, upload_progress_callback_data, progress_callback, progress_callback_data, cancellable, sync_cb, &data);
+    end_sync (&data);
+    return snapd_client_install_stream2_finish (self, data.result, error);
+}
+
 /**
  * snapd_client_try_sync:
  * @client: a #SnapdClient.
@@ -1658,3 +1942,51 @@ snapd_client_download_sync (SnapdClient *self,
     end_sync (&data);
     return snapd_client_download_finish (self, data.result, error);
 }
+
+/**
+ * snapd_client_download_to_stream_sync:
+ * @client: a #SnapdClient.
+ * @name: name of snap to download.
+ * @channel: (allow-none): channel to download from.
+ * @revision: (allow-none): revision to download.
+ * @resume_token: (allow-none): token from a previous download to resume or %NULL.
+ * @offset: number of bytes already downloaded when resuming.
+ * @stream: a #GOutputStream to write the snap contents to.
+ * @progress_callback: (allow-none) (scope call): function to callback as the snap is received.
+ * @progress_callback_data: (closure): user data to pass to @progress_callback.
+ * @resume_token_out: (out) (allow-none): location to store a token to resume this download or %NULL.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL
+ *     to ignore.
+ *
+ * Download the given snap, writing the contents to @stream as they are
+ * received. Unlike snapd_client_download_sync() the snap is never held in
+ * memory. To download into a file descriptor use g_unix_output_stream_new().
+ *
+ * If a download is interrupted it can be continued by passing the token
+ * returned in @resume_token_out and the number of bytes already written as
+ * @offset.
+ *
+ * Returns: %TRUE on success or %FALSE on error.
+ *
+ * Since: 1.59
+ */
+gboolean
+snapd_client_download_to_stream_sync (SnapdClient *self,
+                                      const gchar *name, const gchar *channel, const gchar *revision,
+                                      const gchar *resume_token, guint64 offset,
+                                      GOutputStream *stream,
+                                      SnapdTransferProgressCallback progress_callback, gpointer progress_callback_data,
+                                      gchar **resume_token_out,
+                                      GCancellable *cancellable, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (name != NULL, FALSE);
+    g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
+
+    g_auto(SyncData) data = { 0 };
+    start_sync (&data);
+    snapd_client_download_to_stream_async (self, name, channel, revision, resume_token, offset, stream, progress_callback, progress_callback_data, cancellable, sync_cb, &data);
+    end_sync (&data);
+    return snapd_client_download_to_stream_finish (self, data.result, resume_token_out, error);
+}
@@ -7,14 +7,26 @@
  * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
  */
 
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#include <gio/gfiledescriptorbased.h>
 #include <gio/gunixsocketaddress.h>
 #include <libsoup/soup.h>
 
 #include "snapd-client.h"
 
+#include "snapd-assertion-stream.h"
+#include "snapd-change-private.h"
 #include "snapd-error.h"
+#include "snapd-icon-cache.h"
+#include "snapd-response-cache.h"
+#include "snapd-snap-set-private.h"
 #include "requests/snapd-get-aliases.h"
 #include "requests/snapd-get-apps.h"
 #include "requests/snapd-get-assertions.h"
@@ -26,6 +38,7 @@
 #include "requests/snapd-get-icon.h"
 #include "requests/snapd-get-interfaces.h"
 #include "requests/snapd-get-interfaces-legacy.h"
+#include "requests/snapd-get-notices.h"
 #include "requests/snapd-get-sections.h"
 #include "requests/snapd-get-snap.h"
 #include "requests/snapd-get-snap-conf.h"
@@ -48,6 +61,7 @@
 #include "requests/snapd-post-snaps.h"
 #include "requests/snapd-post-snapctl.h"
 #include "requests/snapd-put-snap-conf.h"
+#include "requests/snapd-watch-change.h"
 
 /**
  * SECTION:snapd-client
@@ -97,8 +111,14 @@ typedef struct
     /* Socket path to connect to */
     gchar *socket_path;
 
-    /* Socket to communicate with snapd */
-    GSocket *snapd_socket;
+    /* Connections to snapd */
+    GPtrArray *connections;
+
+    /* Maximum number of connections to open to snapd (0 for a connection per thread) */
+    guint max_connections;
+
+    /* Number of seconds to keep an unused connection open (0 for forever) */
+    guint connection_idle_timeout;
 
     /* User agent to send to snapd */
     gchar *user_agent;
@@ -113,13 +133,54 @@ typedef struct
     /* Whether to send the X-Allow-Interaction request header */
     gboolean allow_interaction;
 
-    /* Data received from snapd */
-    GMutex buffer_mutex;
-    GByteArray *buffer;
-    gsize n_read;
+    /* Maximum number of requests to have sent on a connection without a response (0 for unlimited) */
+    guint pipeline_depth;
+
+    /* Requests waiting to be written, in the order they were made (not referenced) */
+    GQueue send_queue;
+
+    /* Maximum number of requests to have waiting to be written (0 for unlimited) */
+    guint max_queued_requests;
 
     /* Maintenance information returned from snapd */
+    GMutex maintenance_mutex;
     SnapdMaintenance *maintenance;
+
+    /* Request waiting for snapd to notify changes have been updated */
+    SnapdRequest *notices_request;
+
+    /* TRUE if snapd doesn't support notices */
+    gboolean notices_unsupported;
+
+    /* Timeout to request notices again after a failure, and the number of milliseconds it waits */
+    GSource *notices_retry_source;
+    guint notices_retry_time;
+
+    /* Time of the last change notice from snapd */
+    gchar *notices_after;
+
+    /* Changes being followed, keyed by change ID */
+    GHashTable *change_watches;
+
+    /* Callback to report tasks that have changed */
+    SnapdTaskDeltaCallback task_delta_callback;
+    gpointer task_delta_callback_data;
+    GDestroyNotify task_delta_callback_destroy_notify;
+
+    /* Icons stored on disk */
+    SnapdIconCache *icon_cache;
+
+    /* Icons being fetched by snapd_client_get_icons_async(), keyed by context and name */
+    GHashTable *icon_fetches;
+
+    /* Thread to parse responses in, or %NULL to parse them where they are received */
+    GThreadPool *parse_pool;
+
+    /* TRUE if the details of snaps are parsed when first used */
+    gboolean lazy_snaps;
+
+    /* Responses to requests that don't change the system */
+    SnapdResponseCache *response_cache;
 } SnapdClientPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (SnapdClient, snapd_client, G_TYPE_OBJECT)
@@ -129,21 +190,274 @@ G_DEFINE_TYPE_WITH_PRIVATE (SnapdClient, snapd_client, G_TYPE_OBJECT)
 /* Default socket to connect to */
 #define SNAPD_SOCKET "/run/snapd.socket"
 
-/* Number of bytes to read at a time */
-#define READ_SIZE 1024
+/* Number of bytes to read at a time, grows for large responses */
+#define MIN_READ_SIZE 1024
+#define MAX_READ_SIZE 65536
 
-/* Number of milliseconds to poll for status in asynchronous operations */
+/* Number of milliseconds to poll for status in asynchronous operations.
+ * Polling backs off to the maximum time while a change is not making progress */
 #define ASYNC_POLL_TIME 100
+#define ASYNC_POLL_TIME_MAX 1000
+
+/* Maximum poll time when snapd notifies us of changes being updated */
+#define ASYNC_POLL_TIME_MAX_NOTICES 5000
+
+/* Number of seconds snapd waits for a change to be updated before responding to a notices request */
+#define NOTICES_TIMEOUT 30
+
+/* Number of milliseconds to wait before requesting notices again after a failure.
+ * This backs off to the maximum time while requests keep failing */
+#define NOTICES_RETRY_TIME 1000
+#define NOTICES_RETRY_TIME_MAX 60000
+
+/* Number of times to resend a request if the connection drops before it is answered */
+#define MAX_RESENDS 1
+
+/* Number of bytes of a streamed request body to read at a time */
+#define UPLOAD_BLOCK_SIZE 65536
+
+/* Number of bytes to send directly from a file before letting the main loop run */
+#define UPLOAD_SENDFILE_SIZE (16 * UPLOAD_BLOCK_SIZE)
+
+typedef struct _RequestData RequestData;
+
+typedef enum
+{
+    PARSE_STATE_HEADERS,
+    PARSE_STATE_CONTENT,
+    PARSE_STATE_CONTENT_TO_EOF,
+    PARSE_STATE_CHUNK_HEADER,
+    PARSE_STATE_CHUNK_DATA,
+    PARSE_STATE_CHUNK_END,
+    PARSE_STATE_TRAILER
+} ParseState;
+
+typedef struct
+{
+    int ref_count;
+    SnapdClient *client;
+
+    /* Lock for data received on this connection, responses on other connections are read in parallel */
+    GMutex read_mutex;
+
+    /* Socket to communicate with snapd (NULL if not connected) */
+    GSocket *socket;
+
+    /* State of the response being read */
+    ParseState parse_state;
+
+    /* Request the response being read is for */
+    SnapdRequest *response_request;
+
+    /* TRUE if the content of this response has been passed to the request as it was received */
+    gboolean response_streamed;
+
+    /* Headers and chunk sizes received from snapd that have not been parsed yet */
+    GByteArray *buffer;
+
+    /* Offset in buffer to continue searching for the end of the headers */
+    gsize scan_offset;
+
+    /* Number of bytes remaining in the content or current chunk */
+    gsize content_remaining;
+
+    /* Number of bytes to read next */
+    gsize read_size;
+
+    /* Context of the last request sent on this connection */
+    GMainContext *context;
+
+    /* Thread the last request sent on this connection was made from */
+    GThread *thread;
+
+    /* Timeout to close the connection when it is no longer being used */
+    GSource *idle_source;
+
+    /* Time this connection was last used */
+    gint64 last_used_time;
+
+    /* Usage statistics */
+    guint64 n_requests;
+    guint64 n_bytes_sent;
+    guint64 n_bytes_received;
+
+    /* TRUE while a request body is being streamed, no other requests can be written until it completes */
+    gboolean uploading;
+
+    /* Request being written when the socket stopped accepting data (not referenced), and the source waiting to continue */
+    RequestData *writing;
+    GSource *write_source;
+
+    /* Requests written to this connection waiting for a response, in the order they were sent (not referenced).
+     * Updated as requests are sent and answered so the pool doesn't need to check every request */
+    GQueue awaiting;
+
+    /* Number of requests in @awaiting that snapd holds until changes are updated */
+    guint n_notices;
+
+    /* TRUE if this connection is only used for notices requests, so it isn't counted in max-connections */
+    gboolean for_notices;
+} Connection;
+
+static Connection *
+connection_new (SnapdClient *client, GSocket *socket)
+{
+    Connection *connection = g_slice_new0 (Connection);
+    connection->ref_count = 1;
+    connection->client = client;
+    g_mutex_init (&connection->read_mutex);
+    if (socket != NULL)
+        connection->socket = g_object_ref (socket);
+    connection->buffer = g_byte_array_new ();
+    connection->read_size = MIN_READ_SIZE;
+    g_queue_init (&connection->awaiting);
+    connection->last_used_time = g_get_monotonic_time ();
+
+    return connection;
+}
+
+static Connection *
+connection_ref (Connection *connection)
+{
+    g_atomic_int_inc (&connection->ref_count);
+    return connection;
+}
+
+static void
+connection_close (Connection *connection)
+{
+    if (connection->idle_source != NULL)
+        g_source_destroy (connection->idle_source);
+    g_clear_pointer (&connection->idle_source, g_source_unref);
+    if (connection->write_source != NULL)
+        g_source_destroy (connection->write_source);
+    g_clear_pointer (&connection->write_source, g_source_unref);
+    connection->writing = NULL;
+    g_queue_clear (&connection->awaiting);
+    connection->n_notices = 0;
+    if (connection->socket != NULL)
+        g_socket_close (connection->socket, NULL);
+    g_clear_object (&connection->socket);
+}
+
+static void
+connection_unref (Connection *connection)
+{
+    if (!g_atomic_int_dec_and_test (&connection->ref_count))
+        return;
 
+    connection_close (connection);
+    g_clear_object (&connection->response_request);
+    g_clear_pointer (&connection->buffer, g_byte_array_unref);
+    g_clear_pointer (&connection->context, g_main_context_unref);
+    g_mutex_clear (&connection->read_mutex);
+    g_slice_free (Connection, connection);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (Connection, connection_unref)
+
+/* Request body that is streamed to snapd after the headers, so only a block at a time is held in memory */
 typedef struct
+{
+    GInputStream *stream;
+
+    /* File descriptor to send the content from directly or -1 to read from the stream */
+    int fd;
+
+    /* TRUE if sent using chunked transfer encoding (the length is not known) */
+    gboolean chunked;
+
+    /* Number of bytes in the stream or 0 if not known */
+    guint64 length;
+
+    /* Number of bytes from the stream that have been sent */
+    guint64 n_sent;
+
+    /* Data to send after the stream content */
+    GBytes *trailer;
+
+    /* Data waiting to be written and how many bytes of the stream it contains */
+    GByteArray *pending;
+    gsize pending_offset;
+    gsize pending_content;
+
+    /* TRUE when the stream has been read to the end, and when everything has been queued to write */
+    gboolean eof;
+    gboolean done;
+
+    /* Source waiting for the socket to be ready to write */
+    GSource *write_source;
+} Upload;
+
+static Upload *
+upload_new (GInputStream *stream, GBytes *trailer)
+{
+    Upload *upload = g_slice_new0 (Upload);
+    upload->stream = g_object_ref (stream);
+    upload->fd = -1;
+    upload->chunked = TRUE;
+    upload->trailer = g_bytes_ref (trailer);
+    upload->pending = g_byte_array_sized_new (UPLOAD_BLOCK_SIZE + 64);
+
+#ifdef __linux__
+    /* Files of a known size can be sent directly without reading them into memory */
+    if (G_IS_FILE_DESCRIPTOR_BASED (stream)) {
+        int fd = g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (stream));
+        struct stat file_info;
+        off_t offset = lseek (fd, 0, SEEK_CUR);
+        if (fstat (fd, &file_info) == 0 && S_ISREG (file_info.st_mode) && offset >= 0 && offset <= file_info.st_size) {
+            upload->fd = fd;
+            upload->chunked = FALSE;
+            upload->length = file_info.st_size - offset;
+        }
+    }
+#endif
+
+    return upload;
+}
+
+static void
+upload_free (Upload *upload)
+{
+    if (upload->write_source != NULL)
+        g_source_destroy (upload->write_source);
+    g_clear_pointer (&upload->write_source, g_source_unref);
+    g_clear_object (&upload->stream);
+    g_clear_pointer (&upload->trailer, g_bytes_unref);
+    g_clear_pointer (&upload->pending, g_byte_array_unref);
+    g_slice_free (Upload, upload);
+}
+
+struct _RequestData
 {
     int ref_count;
     SnapdClient *client;
     SnapdRequest *request;
+    Connection *connection;
     GSource *read_source;
-    GSource *poll_source;
     gulong cancelled_id;
-} RequestData;
+
+    /* Thread the request was made from */
+    GThread *thread;
+
+    /* HTTP data to send to snapd */
+    GByteArray *http_data;
+
+    /* Body streamed after the HTTP data */
+    Upload *upload;
+
+    /* TRUE if this request has been written (or started to be written) to snapd */
+    gboolean sent;
+
+    /* Number of bytes of the HTTP data written */
+    gsize n_written;
+
+    /* Number of times this request has been resent */
+    guint n_resends;
+
+    /* TRUE if the response to this request has been received */
+    gboolean responded;
+};
 
 static RequestData *
 request_data_new (SnapdClient *client, SnapdRequest *request)
@@ -152,6 +466,7 @@ request_data_new (SnapdClient *client, SnapdRequest *request)
     data->ref_count = 1;
     data->client = client;
     data->request = g_object_ref (request);
+    data->thread = g_thread_self ();
 
     return data;
 }
@@ -159,34 +474,97 @@ request_data_new (SnapdClient *client, SnapdRequest *request)
 static RequestData *
 request_data_ref (RequestData *data)
 {
-    data->ref_count++;
+    g_atomic_int_inc (&data->ref_count);
     return data;
 }
 
 static void
 request_data_unref (RequestData *data)
 {
-    data->ref_count--;
-    if (data->ref_count > 0)
+    if (!g_atomic_int_dec_and_test (&data->ref_count))
         return;
 
     if (data->read_source != NULL)
         g_source_destroy (data->read_source);
     g_clear_pointer (&data->read_source, g_source_unref);
-    if (data->poll_source != NULL)
-        g_source_destroy (data->poll_source);
-    g_clear_pointer (&data->poll_source, g_source_unref);
     if (data->cancelled_id != 0)
         g_cancellable_disconnect (_snapd_request_get_cancellable (data->request), data->cancelled_id);
     data->cancelled_id = 0;
     g_clear_object (&data->request);
+    g_clear_pointer (&data->connection, connection_unref);
+    g_clear_pointer (&data->http_data, g_byte_array_unref);
+    g_clear_pointer (&data->upload, upload_free);
     g_slice_free (RequestData, data);
 }
 
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (RequestData, request_data_unref)
 
+/* A change being followed by one or more asynchronous requests, which is polled once for all of them */
+typedef struct
+{
+    SnapdClient *client;
+    gchar *change_id;
+
+    /* Requests following this change */
+    GPtrArray *requests;
+
+    /* Timeout to poll for the status of this change */
+    GSource *poll_source;
+
+    /* Number of milliseconds to wait before polling */
+    guint poll_time;
+
+    /* Request polling for the status of this and other changes at the same time */
+    SnapdRequest *batch_request;
+
+    /* TRUE if the next poll should only check this change */
+    gboolean poll_alone;
+
+    /* Last change reported to the task delta callback */
+    SnapdChange *last_change;
+} ChangeWatch;
+
+static ChangeWatch *
+change_watch_new (SnapdClient *client, const gchar *change_id)
+{
+    ChangeWatch *watch = g_slice_new0 (ChangeWatch);
+    watch->client = client;
+    watch->change_id = g_strdup (change_id);
+    watch->requests = g_ptr_array_new_with_free_func (g_object_unref);
+    watch->poll_time = ASYNC_POLL_TIME;
+
+    return watch;
+}
+
+static void
+change_watch_free (ChangeWatch *watch)
+{
+    if (watch->poll_source != NULL)
+        g_source_destroy (watch->poll_source);
+    g_clear_pointer (&watch->poll_source, g_source_unref);
+    g_clear_pointer (&watch->change_id, g_free);
+    g_clear_pointer (&watch->requests, g_ptr_array_unref);
+    g_clear_object (&watch->last_change);
+    g_slice_free (ChangeWatch, watch);
+}
+
+/* Polls are made in the context of the longest following request */
+static GMainContext *
+change_watch_get_context (ChangeWatch *watch)
+{
+    return _snapd_request_get_context (g_ptr_array_index (watch->requests, 0));
+}
+
 static void send_request (SnapdClient *self, SnapdRequest *request);
 
+static void send_internal_request (SnapdClient *self, SnapdRequest *request);
+
+static void send_queued_requests_unlocked (SnapdClient *self);
+
+static void send_queued_requests (SnapdClient *self);
+
+static void start_notices (SnapdClient *self, SnapdRequest *request);
+
 static RequestData *
 get_request_data (SnapdClient *self, SnapdRequest *request)
 {
@@ -201,6 +579,134 @@ get_request_data (SnapdClient *self, SnapdRequest *request)
     return NULL;
 }
 
+/* Check if snapd is expected to send a response for this request */
+static gboolean
+is_awaiting_response (RequestData *data)
+{
+    if (!data->sent || data->responded)
+        return FALSE;
+
+    /* Asynchronous requests are complete once snapd returns a change ID */
+    if (SNAPD_IS_REQUEST_ASYNC (data->request))
+        return _snapd_request_async_get_change_id (SNAPD_REQUEST_ASYNC (data->request)) == NULL;
+
+    return TRUE;
+}
+
+/* Check if a request can be safely sent again if we don't know if snapd processed it */
+static gboolean
+is_idempotent (RequestData *data)
+{
+    SoupMessage *message = _snapd_request_get_message (data->request);
+    return strcmp (message->method, "GET") == 0;
+}
+
+/* Track a request written to a connection until the response is received. Requests must be locked */
+static void
+connection_add_awaiting (Connection *connection, RequestData *data)
+{
+    g_queue_push_tail (&connection->awaiting, data);
+    if (SNAPD_IS_GET_NOTICES (data->request))
+        connection->n_notices++;
+}
+
+/* Stop tracking a request that has been answered or completed. Requests must be locked */
+static void
+connection_remove_awaiting (Connection *connection, RequestData *data)
+{
+    if (!g_queue_remove (&connection->awaiting, data))
+        return;
+    if (SNAPD_IS_GET_NOTICES (data->request))
+        connection->n_notices--;
+}
+
+static gboolean async_poll_cb (gpointer data);
+
+static void
+schedule_poll_unlocked (SnapdClient *self, ChangeWatch *watch)
+{
+    if (watch->poll_source != NULL)
+        g_source_destroy (watch->poll_source);
+    g_clear_pointer (&watch->poll_source, g_source_unref);
+    watch->poll_source = g_timeout_source_new (watch->poll_time);
+    g_source_set_callback (watch->poll_source, async_poll_cb, watch, NULL);
+    g_source_attach (watch->poll_source, change_watch_get_context (watch));
+}
+
+/* Follow the change an asynchronous request is waiting on. Requests must be locked */
+static ChangeWatch *
+watch_change_unlocked (SnapdClient *self, SnapdRequestAsync *request)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    const gchar *change_id = _snapd_request_async_get_change_id (request);
+    ChangeWatch *watch = g_hash_table_lookup (priv->change_watches, change_id);
+    if (watch == NULL) {
+        watch = change_watch_new (self, change_id);
+        g_hash_table_insert (priv->change_watches, watch->change_id, watch);
+    }
+
+    for (guint i = 0; i < watch->requests->len; i++)
+        if (g_ptr_array_index (watch->requests, i) == request)
+            return watch;
+    g_ptr_array_add (watch->requests, g_object_ref (request));
+
+    return watch;
+}
+
+/* Stop following a change when the last request waiting on it completes. Requests must be locked */
+static void
+unwatch_change_unlocked (SnapdClient *self, SnapdRequest *request)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    if (!SNAPD_IS_REQUEST_ASYNC (request))
+        return;
+    const gchar *change_id = _snapd_request_async_get_change_id (SNAPD_REQUEST_ASYNC (request));
+    if (change_id == NULL)
+        return;
+
+    ChangeWatch *watch = g_hash_table_lookup (priv->change_watches, change_id);
+    if (watch == NULL)
+        return;
+
+    GMainContext *context = change_watch_get_context (watch);
+    g_ptr_array_remove (watch->requests, request);
+    if (watch->requests->len == 0)
+        g_hash_table_remove (priv->change_watches, change_id);
+    else if (watch->poll_source != NULL && change_watch_get_context (watch) != context)
+        schedule_poll_unlocked (self, watch);
+}
+
+static void
+schedule_poll (SnapdClient *self, SnapdRequestAsync *request)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+
+    schedule_poll_unlocked (self, watch_change_unlocked (self, request));
+}
+
+/* Poll again for changes that were going to be checked by a request that failed.
+ * These are checked individually in case snapd can't report all changes. Requests must be locked */
+static void
+reschedule_batch_unlocked (SnapdClient *self, SnapdRequest *batch_request)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    GHashTableIter iter;
+    g_hash_table_iter_init (&iter, priv->change_watches);
+    ChangeWatch *watch;
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &watch)) {
+        if (watch->batch_request != batch_request)
+            continue;
+
+        watch->batch_request = NULL;
+        watch->poll_alone = TRUE;
+        schedule_poll_unlocked (self, watch);
+    }
+}
+
 static void
 complete_request_unlocked (SnapdClient *self, SnapdRequest *request, GError *error)
 {
@@ -208,7 +714,25 @@ complete_request_unlocked (SnapdClient *self, SnapdRequest *request, GError *err
 
     _snapd_request_return (request, error);
 
+    /* Changes may have modified the system so cached responses can't be used */
+    if (SNAPD_IS_REQUEST_ASYNC (request))
+        _snapd_response_cache_clear (priv->response_cache);
+
+    reschedule_batch_unlocked (self, request);
+    if (request == priv->notices_request)
+        g_clear_object (&priv->notices_request);
+    unwatch_change_unlocked (self, request);
+
     RequestData *data = get_request_data (self, request);
+    if (data == NULL)
+        return;
+    if (!data->sent)
+        g_queue_remove (&priv->send_queue, data);
+    if (data->connection != NULL) {
+        connection_remove_awaiting (data->connection, data);
+        if (data->connection->writing == data)
+            data->connection->writing = NULL;
+    }
     g_ptr_array_remove (priv->requests, data);
 }
 
@@ -220,55 +744,200 @@ complete_request (SnapdClient *self, SnapdRequest *request, GError *error)
     complete_request_unlocked (self, request, error);
 }
 
+/* Add other changes that are waiting to be polled in the same context to a request for all changes in progress.
+ * Returns %FALSE if there are no other changes to poll. Requests must be locked */
+static gboolean
+add_to_batch_unlocked (SnapdClient *self, ChangeWatch *watch, SnapdRequest *batch_request)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    if (watch->poll_alone) {
+        watch->poll_alone = FALSE;
+        return FALSE;
+    }
+
+    GMainContext *context = change_watch_get_context (watch);
+    gboolean have_others = FALSE;
+    GHashTableIter iter;
+    g_hash_table_iter_init (&iter, priv->change_watches);
+    ChangeWatch *w;
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &w)) {
+        if (w == watch || w->poll_source == NULL || w->poll_alone || change_watch_get_context (w) != context)
+            continue;
+
+        g_source_destroy (w->poll_source);
+        g_clear_pointer (&w->poll_source, g_source_unref);
+        w->batch_request = batch_request;
+        have_others = TRUE;
+    }
+    if (have_others)
+        watch->batch_request = batch_request;
+
+    return have_others;
+}
+
 static gboolean
 async_poll_cb (gpointer data)
 {
-    RequestData *d = data;
+    ChangeWatch *watch = data;
+    SnapdClient *self = watch->client;
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    /* Check all the changes waiting to be polled with one request, otherwise just check this change */
+    g_autoptr(SnapdGetChanges) changes_request = _snapd_get_changes_new ("in-progress", NULL, NULL, NULL, NULL);
+    g_autofree gchar *change_id = NULL;
+    gboolean batched;
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+
+        if (watch->poll_source != NULL)
+            g_source_destroy (watch->poll_source);
+        g_clear_pointer (&watch->poll_source, g_source_unref);
+
+        batched = add_to_batch_unlocked (self, watch, SNAPD_REQUEST (changes_request));
+        change_id = g_strdup (watch->change_id);
+    }
 
-    g_autoptr(SnapdGetChange) change_request = _snapd_get_change_new (_snapd_request_async_get_change_id (SNAPD_REQUEST_ASYNC (d->request)), NULL, NULL, NULL);
-    send_request (d->client, SNAPD_REQUEST (change_request));
+    if (batched) {
+        send_internal_request (self, SNAPD_REQUEST (changes_request));
+    }
+    else {
+        g_autoptr(SnapdGetChange) change_request = _snapd_get_change_new (change_id, NULL, NULL, NULL);
+        send_internal_request (self, SNAPD_REQUEST (change_request));
+    }
 
-    if (d->poll_source != NULL)
-        g_source_destroy (d->poll_source);
-    g_clear_pointer (&d->poll_source, g_source_unref);
     return G_SOURCE_REMOVE;
 }
 
+/* Poll sooner while a change is making progress, and back off while it isn't. Requests must be locked */
 static void
-schedule_poll (SnapdClient *self, SnapdRequestAsync *request)
+update_poll_time_unlocked (SnapdClient *self, ChangeWatch *watch, gboolean progressed)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    guint max_poll_time = priv->notices_request != NULL ? ASYNC_POLL_TIME_MAX_NOTICES : ASYNC_POLL_TIME_MAX;
+    if (progressed)
+        watch->poll_time = ASYNC_POLL_TIME;
+    else
+        watch->poll_time = CLAMP (watch->poll_time * 2, ASYNC_POLL_TIME, max_poll_time);
+}
+
+/* Remove a connection from the pool. Requests must be locked */
+static void
+remove_connection_unlocked (SnapdClient *self, Connection *connection)
 {
-    RequestData *data = get_request_data (self, SNAPD_REQUEST (request));
-    if (data->poll_source != NULL)
-        g_source_destroy (data->poll_source);
-    g_clear_pointer (&data->poll_source, g_source_unref);
-    data->poll_source = g_timeout_source_new (ASYNC_POLL_TIME);
-    g_source_set_callback (data->poll_source, async_poll_cb, data, NULL);
-    g_source_attach (data->poll_source, _snapd_request_get_context (SNAPD_REQUEST (request)));
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    connection_close (connection);
+    g_ptr_array_remove (priv->connections, connection);
 }
 
 static void
-complete_all_requests (SnapdClient *self, GError *error)
+complete_connection_requests (SnapdClient *self, Connection *connection, GError *error)
 {
     SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
     g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
 
     /* Disconnect socket - we will reconnect on demand */
-    if (priv->snapd_socket != NULL)
-        g_socket_close (priv->snapd_socket, NULL);
-    g_clear_object (&priv->snapd_socket);
+    g_autoptr(Connection) c = connection_ref (connection);
+    remove_connection_unlocked (self, c);
 
-    /* Cancel synchronous requests (we'll never know the result); reschedule async ones (can reconnect to check result) */
+    /* Resend requests that are safe to repeat;
+     * cancel other synchronous requests (we'll never know the result); reschedule async ones (can reconnect to check result) */
+    g_autoptr(GPtrArray) resends = g_ptr_array_new ();
     g_autoptr(GPtrArray) requests_copy = g_ptr_array_new_with_free_func ((GDestroyNotify) request_data_unref);
     for (guint i = 0; i < priv->requests->len; i++)
         g_ptr_array_add (requests_copy, request_data_ref (g_ptr_array_index (priv->requests, i)));
     for (guint i = 0; i < requests_copy->len; i++) {
         RequestData *data = g_ptr_array_index (requests_copy, i);
 
-        if (SNAPD_IS_REQUEST_ASYNC (data->request))
-            schedule_poll (self, SNAPD_REQUEST_ASYNC (data->request));
+        /* Not sent on this connection */
+        if (!data->sent || data->connection != c)
+            continue;
+
+        /* Can't repeat content that has already been passed to the request */
+        gboolean streamed = data->request == c->response_request && c->response_streamed;
+
+        if (is_awaiting_response (data) && is_idempotent (data) && !streamed && data->n_resends < MAX_RESENDS) {
+            SoupMessage *message = _snapd_request_get_message (data->request);
+            soup_message_headers_clear (message->response_headers);
+            soup_message_body_truncate (message->response_body);
+            data->sent = FALSE;
+            data->n_written = 0;
+            g_clear_pointer (&data->connection, connection_unref);
+            data->n_resends++;
+            g_ptr_array_add (resends, data);
+        }
+        else if (SNAPD_IS_REQUEST_ASYNC (data->request) && _snapd_request_async_get_change_id (SNAPD_REQUEST_ASYNC (data->request)) != NULL)
+            schedule_poll_unlocked (self, watch_change_unlocked (self, SNAPD_REQUEST_ASYNC (data->request)));
         else
             complete_request_unlocked (self, data->request, error);
     }
+
+    /* Requests being resent were made before any that are still waiting to be sent */
+    for (guint i = resends->len; i > 0; i--)
+        g_queue_push_head (&priv->send_queue, g_ptr_array_index (resends, i - 1));
+
+    send_queued_requests_unlocked (self);
+}
+
+static gboolean
+idle_timeout_cb (gpointer user_data)
+{
+    Connection *connection = user_data;
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (connection->client);
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+
+    g_clear_pointer (&connection->idle_source, g_source_unref);
+
+    /* Close if still not being used */
+    if (g_queue_is_empty (&connection->awaiting))
+        remove_connection_unlocked (connection->client, connection);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* Close connections that have been unused for longer than the idle timeout. Requests must be locked.
+ * This catches connections whose timeout can't run as their main context is not being iterated (e.g. synchronous calls) */
+static void
+reap_idle_connections_unlocked (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    if (priv->connection_idle_timeout == 0)
+        return;
+
+    gint64 now = g_get_monotonic_time ();
+    for (guint i = priv->connections->len; i > 0; i--) {
+        Connection *connection = g_ptr_array_index (priv->connections, i - 1);
+
+        if (now - connection->last_used_time >= (gint64) priv->connection_idle_timeout * G_USEC_PER_SEC &&
+            g_queue_is_empty (&connection->awaiting))
+            remove_connection_unlocked (self, connection);
+    }
+}
+
+/* Set timeouts to close connections that are no longer being used. Requests must be locked */
+static void
+schedule_idle_timeouts_unlocked (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    if (priv->connection_idle_timeout == 0)
+        return;
+
+    for (guint i = 0; i < priv->connections->len; i++) {
+        Connection *connection = g_ptr_array_index (priv->connections, i);
+
+        if (connection->socket == NULL || connection->idle_source != NULL || !g_queue_is_empty (&connection->awaiting))
+            continue;
+
+        connection->idle_source = g_timeout_source_new_seconds (priv->connection_idle_timeout);
+        g_source_set_name (connection->idle_source, "snapd-glib-idle-source");
+        g_source_set_callback (connection->idle_source, idle_timeout_cb, connection_ref (connection), (GDestroyNotify) connection_unref);
+        g_source_attach (connection->idle_source, connection->context);
+    }
 }
 
 static void
@@ -370,159 +1039,337 @@ send_cancel (SnapdClient *self, SnapdRequestAsync *request)
         return;
 
     change_request = _snapd_post_change_new (_snapd_request_async_get_change_id (request), "abort", NULL, NULL, NULL);
-    send_request (self, SNAPD_REQUEST (change_request));
+    send_internal_request (self, SNAPD_REQUEST (change_request));
 }
 
-static SnapdRequestAsync *
-find_change_request (SnapdClient *self, const gchar *change_id)
+/* Get the requests following a change */
+static GPtrArray *
+get_change_requests (SnapdClient *self, const gchar *change_id)
 {
     SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
     g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
 
-    for (guint i = 0; i < priv->requests->len; i++) {
-        RequestData *data = g_ptr_array_index (priv->requests, i);
-
-        if (SNAPD_IS_REQUEST_ASYNC (data->request) &&
-            g_strcmp0 (_snapd_request_async_get_change_id (SNAPD_REQUEST_ASYNC (data->request)), change_id) == 0)
-            return SNAPD_REQUEST_ASYNC (data->request);
+    GPtrArray *requests = g_ptr_array_new_with_free_func (g_object_unref);
+    ChangeWatch *watch = g_hash_table_lookup (priv->change_watches, change_id);
+    if (watch != NULL) {
+        for (guint i = 0; i < watch->requests->len; i++)
+            g_ptr_array_add (requests, g_object_ref (g_ptr_array_index (watch->requests, i)));
     }
 
-    return NULL;
+    return requests;
 }
 
 static SnapdRequest *
-get_first_request (SnapdClient *self)
+get_first_request (SnapdClient *self, Connection *connection)
 {
     SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
     g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
 
-    for (guint i = 0; i < priv->requests->len; i++) {
-        RequestData *data = g_ptr_array_index (priv->requests, i);
-
-        /* Return first non-async request or async request without change id */
-        if (SNAPD_IS_REQUEST_ASYNC (data->request)) {
-            if (_snapd_request_async_get_change_id (SNAPD_REQUEST_ASYNC (data->request)) == NULL)
-                return data->request;
-        }
-        else
-            return data->request;
-    }
+    /* Return first request sent on this connection that hasn't been responded to */
+    RequestData *data = g_queue_peek_head (&connection->awaiting);
+    return data != NULL ? data->request : NULL;
+}
 
-    return NULL;
+static void
+complete_change (SnapdClient *self, const gchar *change_id, GError *error)
+{
+    g_autoptr(GPtrArray) requests = get_change_requests (self, change_id);
+    for (guint i = 0; i < requests->len; i++)
+        complete_request (self, g_ptr_array_index (requests, i), error);
 }
 
-/* Check if we have all HTTP chunks */
-static gboolean
-have_chunked_body (const gchar *body, gsize body_length)
+static void
+complete_async_request (SnapdClient *self, SnapdRequestAsync *request, SnapdChange *change, JsonNode *data)
 {
-    while (TRUE) {
-        /* Read chunk header, stopping on zero length chunk */
-        const gchar *chunk_start = g_strstr_len (body, body_length, "\r\n");
-        if (chunk_start == NULL)
-            return FALSE;
-        gsize chunk_header_length = chunk_start - body + 2;
-        gsize chunk_length = strtoul (body, NULL, 16);
-        if (chunk_length == 0)
-            return TRUE;
+    g_autoptr(GError) error = NULL;
+    if (!_snapd_request_async_parse_result (request, data, &error)) {
+        complete_request (self, SNAPD_REQUEST (request), error);
+        return;
+    }
 
-        /* Check enough space for chunk body */
-        gsize required_length = chunk_header_length + chunk_length + 2;
-        if (required_length > body_length)
-            return FALSE;
-        // FIXME: Validate that \r\n is on the end of a chunk?
-        body += required_length;
-        body_length -= required_length;
+    if (g_cancellable_set_error_if_cancelled (_snapd_request_get_cancellable (SNAPD_REQUEST (request)), &error)) {
+        complete_request (self, SNAPD_REQUEST (request), error);
+        return;
     }
+
+    /* Watching a change succeeds however it ends */
+    if (snapd_change_get_error (change) != NULL && !SNAPD_IS_WATCH_CHANGE (request)) {
+        g_set_error_literal (&error,
+                             SNAPD_ERROR,
+                             SNAPD_ERROR_FAILED,
+                             snapd_change_get_error (change));
+        complete_request (self, SNAPD_REQUEST (request), error);
+        return;
+    }
+
+    complete_request (self, SNAPD_REQUEST (request), NULL);
 }
 
-/* If more than one HTTP chunk, re-order buffer to contain one chunk.
- * Assumes body is a valid chunked data block (as checked with have_chunked_body()) */
+/* Report a change to every request following it */
 static void
-compress_chunks (gchar *body, gsize body_length, gchar **combined_start, gsize *combined_length, gsize *total_length)
+update_changes (SnapdClient *self, SnapdChange *change, JsonNode *data)
 {
-    /* Use first chunk as output */
-    *combined_length = strtoul (body, NULL, 16);
-    *combined_start = strstr (body, "\r\n") + 2;
-    if (*combined_length == 0) {
-        *total_length = *combined_start - body;
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_autoptr(GPtrArray) requests = get_change_requests (self, snapd_change_get_id (change));
+    if (requests->len == 0)
         return;
+
+    /* Work out which tasks have changed once for all the requests following this change */
+    SnapdTaskDeltaCallback task_delta_callback = NULL;
+    gpointer task_delta_callback_data = NULL;
+    g_autoptr(GPtrArray) changed_tasks = NULL;
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+        ChangeWatch *watch = g_hash_table_lookup (priv->change_watches, snapd_change_get_id (change));
+        if (priv->task_delta_callback != NULL && watch != NULL &&
+            (watch->last_change == NULL || _snapd_change_get_fingerprint (watch->last_change) != _snapd_change_get_fingerprint (change))) {
+            changed_tasks = _snapd_change_get_changed_tasks (change, watch->last_change);
+            g_set_object (&watch->last_change, change);
+            task_delta_callback = priv->task_delta_callback;
+            task_delta_callback_data = priv->task_delta_callback_data;
+        }
     }
+    if (changed_tasks != NULL && changed_tasks->len > 0)
+        task_delta_callback (self, change, changed_tasks, task_delta_callback_data);
 
-    /* Copy any remaining chunks beside the first one */
-    gchar *chunk_start = *combined_start + *combined_length + 2;
-    while (TRUE) {
-        gsize chunk_length;
+    gboolean progressed = FALSE;
+    for (guint i = 0; i < requests->len; i++)
+        if (_snapd_request_async_report_progress (g_ptr_array_index (requests, i), self, change))
+            progressed = TRUE;
 
-        chunk_length = strtoul (chunk_start, NULL, 16);
-        chunk_start = strstr (chunk_start, "\r\n") + 2;
-        if (chunk_length == 0) {
-            *total_length = chunk_start - body;
-            return;
-        }
+    /* Complete requests */
+    if (snapd_change_get_ready (change)) {
+        for (guint i = 0; i < requests->len; i++)
+            complete_async_request (self, g_ptr_array_index (requests, i), change, data);
+        return;
+    }
 
-        /* Move this chunk on the end of the last one */
-        memmove (*combined_start + *combined_length, chunk_start, chunk_length);
-        *combined_length += chunk_length;
+    /* Poll for updates */
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+        ChangeWatch *watch = g_hash_table_lookup (priv->change_watches, snapd_change_get_id (change));
+        if (watch != NULL) {
+            update_poll_time_unlocked (self, watch, progressed);
+            schedule_poll_unlocked (self, watch);
+        }
+    }
+    start_notices (self, g_ptr_array_index (requests, 0));
+}
 
-        chunk_start += chunk_length + 2;
+static SnapdChange *
+find_change (GPtrArray *changes, const gchar *change_id)
+{
+    for (guint i = 0; i < changes->len; i++) {
+        SnapdChange *change = g_ptr_array_index (changes, i);
+        if (g_strcmp0 (snapd_change_get_id (change), change_id) == 0)
+            return change;
     }
+
+    return NULL;
 }
 
+/* Update the changes that were polled together */
 static void
-complete_change (SnapdClient *self, const gchar *change_id, GError *error)
+update_batched_changes (SnapdClient *self, SnapdRequest *batch_request, GPtrArray *changes)
 {
-    SnapdRequestAsync *request = find_change_request (self, change_id);
-    if (request != NULL)
-        complete_request (self, SNAPD_REQUEST (request), error);
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_autoptr(GPtrArray) change_ids = g_ptr_array_new_with_free_func (g_free);
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+        GHashTableIter iter;
+        g_hash_table_iter_init (&iter, priv->change_watches);
+        ChangeWatch *watch;
+        while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &watch)) {
+            if (watch->batch_request != batch_request)
+                continue;
+
+            watch->batch_request = NULL;
+            g_ptr_array_add (change_ids, g_strdup (watch->change_id));
+        }
+    }
+
+    for (guint i = 0; i < change_ids->len; i++) {
+        const gchar *change_id = g_ptr_array_index (change_ids, i);
+
+        /* Completed changes are no longer in progress, so get the result directly */
+        SnapdChange *change = find_change (changes, change_id);
+        if (change == NULL || snapd_change_get_ready (change)) {
+            g_autoptr(SnapdGetChange) change_request = _snapd_get_change_new (change_id, NULL, NULL, NULL);
+            send_internal_request (self, SNAPD_REQUEST (change_request));
+        }
+        else
+            update_changes (self, change, NULL);
+    }
 }
 
+static gchar *
+make_notices_timestamp (void)
+{
+    g_autoptr(GDateTime) now = g_date_time_new_now_utc ();
+    g_autofree gchar *time = g_date_time_format (now, "%Y-%m-%dT%H:%M:%S");
+    return g_strdup_printf ("%s.%06dZ", time, g_date_time_get_microsecond (now));
+}
+
+/* Ask snapd to notify us when changes are updated, so polling can back off further.
+ * The request holds a connection open, so it is sent on a separate connection to other requests */
 static void
-update_changes (SnapdClient *self, SnapdChange *change, JsonNode *data)
+request_notices (SnapdClient *self)
 {
-    SnapdRequestAsync *request = find_change_request (self, snapd_change_get_id (change));
-    if (request == NULL)
-        return;
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
 
-    _snapd_request_async_report_progress (request, self, change);
+    g_autoptr(SnapdGetNotices) notices_request = NULL;
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
 
-    /* Complete parent */
-    if (snapd_change_get_ready (change)) {
-        g_autoptr(GError) error = NULL;
-        if (!_snapd_request_async_parse_result (request, data, &error)) {
-            complete_request (self, SNAPD_REQUEST (request), error);
+        if (priv->notices_unsupported || priv->notices_request != NULL || priv->notices_retry_source != NULL)
             return;
-        }
 
-        if (g_cancellable_set_error_if_cancelled (_snapd_request_get_cancellable (SNAPD_REQUEST (request)), &error)) {
-            complete_request (self, SNAPD_REQUEST (request), error);
+        /* Only needed while there are changes being polled */
+        gboolean have_changes = FALSE;
+        GHashTableIter iter;
+        g_hash_table_iter_init (&iter, priv->change_watches);
+        ChangeWatch *watch;
+        while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &watch))
+            if (change_watch_get_context (watch) == g_main_context_default ())
+                have_changes = TRUE;
+        if (!have_changes)
             return;
-        }
 
-        if (snapd_change_get_error (change) != NULL) {
-            g_set_error_literal (&error,
-                                 SNAPD_ERROR,
-                                 SNAPD_ERROR_FAILED,
-                                 snapd_change_get_error (change));
-            complete_request (self, SNAPD_REQUEST (request), error);
-            return;
-        }
+        if (priv->notices_after == NULL)
+            priv->notices_after = make_notices_timestamp ();
+        notices_request = _snapd_get_notices_new ("change-update", priv->notices_after, NOTICES_TIMEOUT, NULL, NULL, NULL);
+        priv->notices_request = g_object_ref (SNAPD_REQUEST (notices_request));
+    }
+
+    send_internal_request (self, SNAPD_REQUEST (notices_request));
+}
+
+/* Other contexts may stop being iterated while the request is open, so notices are only requested from the default context */
+static void
+start_notices (SnapdClient *self, SnapdRequest *request)
+{
+    if (_snapd_request_get_context (request) == g_main_context_default ())
+        request_notices (self);
+}
+
+static gboolean
+notices_retry_cb (gpointer user_data)
+{
+    SnapdClient *self = user_data;
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+        g_clear_pointer (&priv->notices_retry_source, g_source_unref);
+    }
+    request_notices (self);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* Stop requesting notices if snapd doesn't support them, otherwise try again later */
+static void
+notices_failed (SnapdClient *self, SnapdRequest *request)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
 
-        complete_request (self, SNAPD_REQUEST (request), NULL);
+    /* Older versions of snapd don't have the notices endpoint */
+    guint status_code = _snapd_request_get_message (request)->status_code;
+    if (status_code == SOUP_STATUS_NOT_FOUND || status_code == SOUP_STATUS_METHOD_NOT_ALLOWED || status_code == SOUP_STATUS_NOT_IMPLEMENTED) {
+        priv->notices_unsupported = TRUE;
         return;
     }
 
-    /* Poll for updates */
-    schedule_poll (self, request);
+    if (priv->notices_retry_source != NULL)
+        return;
+    priv->notices_retry_time = CLAMP (priv->notices_retry_time * 2, NOTICES_RETRY_TIME, NOTICES_RETRY_TIME_MAX);
+    priv->notices_retry_source = g_timeout_source_new (priv->notices_retry_time);
+    g_source_set_name (priv->notices_retry_source, "snapd-glib-notices-retry");
+    g_source_set_callback (priv->notices_retry_source, notices_retry_cb, self, NULL);
+    g_source_attach (priv->notices_retry_source, g_main_context_default ());
 }
 
+/* Poll changes that snapd has notified us of straight away */
 static void
-parse_response (SnapdClient *self, SnapdRequest *request, SoupMessage *message)
+update_notices (SnapdClient *self, SnapdGetNotices *request)
 {
     SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
 
-    g_clear_object (&priv->maintenance);
-    g_autoptr(GError) error = NULL;
-    if (!SNAPD_REQUEST_GET_CLASS (request)->parse_response (request, message, &priv->maintenance, &error)) {
+    /* Requests are working again */
+    priv->notices_retry_time = 0;
+
+    const gchar *last_occurred = _snapd_get_notices_get_last_occurred (request);
+    if (last_occurred != NULL) {
+        g_free (priv->notices_after);
+        priv->notices_after = g_strdup (last_occurred);
+    }
+
+    GStrv keys = _snapd_get_notices_get_keys (request);
+    for (guint i = 0; keys[i] != NULL; i++) {
+        ChangeWatch *watch = g_hash_table_lookup (priv->change_watches, keys[i]);
+
+        /* Skip changes not being followed or that are already being polled */
+        if (watch == NULL || watch->poll_source == NULL)
+            continue;
+
+        watch->poll_time = 0;
+        schedule_poll_unlocked (self, watch);
+    }
+}
+
+static void
+record_snap_revision (SnapdClient *self, SnapdSnap *snap)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    if (snapd_snap_get_status (snap) == SNAPD_SNAP_STATUS_ACTIVE)
+        _snapd_icon_cache_set_revision (priv->icon_cache, snapd_snap_get_name (snap), snapd_snap_get_revision (snap));
+}
+
+/* Track the installed revision of each snap so icons for old revisions aren't used, and store icons received from snapd */
+static void
+update_icon_cache (SnapdClient *self, SnapdRequest *request)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    if (SNAPD_IS_GET_SNAPS (request)) {
+        GPtrArray *snaps = _snapd_get_snaps_get_snaps (SNAPD_GET_SNAPS (request));
+        for (guint i = 0; snaps != NULL && i < snaps->len; i++)
+            record_snap_revision (self, g_ptr_array_index (snaps, i));
+
+        GHashTable *revisions = _snapd_get_snaps_get_revisions (SNAPD_GET_SNAPS (request));
+        if (revisions != NULL) {
+            GHashTableIter iter;
+            g_hash_table_iter_init (&iter, revisions);
+            const gchar *name, *revision;
+            while (g_hash_table_iter_next (&iter, (gpointer *) &name, (gpointer *) &revision))
+                _snapd_icon_cache_set_revision (priv->icon_cache, name, revision);
+        }
+    }
+    else if (SNAPD_IS_GET_SNAP (request))
+        record_snap_revision (self, _snapd_get_snap_get_snap (SNAPD_GET_SNAP (request)));
+    else if (SNAPD_IS_GET_ICON (request)) {
+        SnapdGetIcon *r = SNAPD_GET_ICON (request);
+        _snapd_icon_cache_insert (priv->icon_cache, _snapd_get_icon_get_name (r), _snapd_get_icon_get_revision (r), _snapd_get_icon_get_icon (r));
+    }
+}
+
+/* Act on a response after the request has parsed it */
+static void
+handle_response (SnapdClient *self, SnapdRequest *request, gboolean result, SnapdMaintenance *maintenance, GError *error)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->maintenance_mutex);
+        g_clear_object (&priv->maintenance);
+        priv->maintenance = maintenance != NULL ? g_object_ref (maintenance) : NULL;
+    }
+    if (!result) {
         if (SNAPD_IS_GET_CHANGE (request)) {
             complete_change (self, _snapd_get_change_get_change_id (SNAPD_GET_CHANGE (request)), error);
             complete_request (self, request, NULL);
@@ -531,6 +1378,11 @@ parse_response (SnapdClient *self, SnapdRequest *request, SoupMessage *message)
             complete_change (self, _snapd_post_change_get_change_id (SNAPD_POST_CHANGE (request)), error);
             complete_request (self, request, NULL);
         }
+        else if (SNAPD_IS_GET_NOTICES (request)) {
+            /* Changes are still polled while notices aren't working */
+            notices_failed (self, request);
+            complete_request (self, request, NULL);
+        }
         else
             complete_request (self, request, error);
         return;
@@ -544,1453 +1396,3743 @@ parse_response (SnapdClient *self, SnapdRequest *request, SoupMessage *message)
         update_changes (self,
                         _snapd_post_change_get_change (SNAPD_POST_CHANGE (request)),
                         _snapd_post_change_get_data (SNAPD_POST_CHANGE (request)));
-
-    if (SNAPD_IS_REQUEST_ASYNC (request)) {
+    else if (SNAPD_IS_GET_CHANGES (request))
+        update_batched_changes (self, request, _snapd_get_changes_get_changes (SNAPD_GET_CHANGES (request)));
+    else if (SNAPD_IS_GET_NOTICES (request))
+        update_notices (self, SNAPD_GET_NOTICES (request));
+    update_icon_cache (self, request);
+
+    if (SNAPD_IS_WATCH_CHANGE (request)) {
+        /* Stop if requested, otherwise join any other requests following this change */
+        g_autoptr(GError) cancel_error = NULL;
+        if (g_cancellable_set_error_if_cancelled (_snapd_request_get_cancellable (request), &cancel_error)) {
+            complete_request (self, request, cancel_error);
+            return;
+        }
+        {
+            g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+            watch_change_unlocked (self, SNAPD_REQUEST_ASYNC (request));
+        }
+        update_changes (self,
+                        _snapd_watch_change_get_change (SNAPD_WATCH_CHANGE (request)),
+                        _snapd_watch_change_get_data (SNAPD_WATCH_CHANGE (request)));
+    }
+    else if (SNAPD_IS_REQUEST_ASYNC (request)) {
         /* Immediately cancel if requested, otherwise poll for updates */
         if (g_cancellable_is_cancelled (_snapd_request_get_cancellable (request)))
             send_cancel (self, SNAPD_REQUEST_ASYNC (request));
-        else
+        else {
             schedule_poll (self, SNAPD_REQUEST_ASYNC (request));
+            start_notices (self, request);
+        }
     }
     else
         complete_request (self, request, NULL);
+
+    /* Wait for the next notices */
+    if (SNAPD_IS_GET_NOTICES (request))
+        start_notices (self, request);
 }
 
-static gboolean
-read_cb (GSocket *socket, GIOCondition condition, SnapdClient *self)
+/* Add received content to the response without copying it */
+static void
+append_content (Connection *connection, GBytes *bytes, gsize offset, gsize length)
 {
-    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
-    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->buffer_mutex);
-
-    if (priv->n_read + READ_SIZE > priv->buffer->len)
-        g_byte_array_set_size (priv->buffer, priv->n_read + READ_SIZE);
-    g_autoptr(GError) error = NULL;
-    gssize n_read = g_socket_receive (socket,
-                                      (gchar *) (priv->buffer->data + priv->n_read),
-                                      READ_SIZE,
-                                      NULL,
-                                      &error);
+    if (length == 0)
+        return;
 
-    if (n_read == 0) {
-        g_autoptr(GError) e = g_error_new (SNAPD_ERROR,
-                                           SNAPD_ERROR_READ_FAILED,
-                                           "snapd connection closed");
-        complete_all_requests (self, e);
-        return G_SOURCE_REMOVE;
+    /* Discard the rest of the response to a request that has already returned (i.e. was cancelled) */
+    if (_snapd_request_has_returned (connection->response_request)) {
+        connection->response_streamed = TRUE;
+        return;
     }
 
-    if (n_read < 0) {
-        if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
-            return TRUE;
-
-        g_autoptr(GError) e = g_error_new (SNAPD_ERROR,
-                                           SNAPD_ERROR_READ_FAILED,
-                                           "Failed to read from snapd: %s",
-                                           error->message);
-        complete_all_requests (self, e);
-        return G_SOURCE_REMOVE;
+    /* Let the request process the content as it arrives */
+    SnapdRequestClass *klass = SNAPD_REQUEST_GET_CLASS (connection->response_request);
+    const guint8 *data = g_bytes_get_data (bytes, NULL);
+    if (klass->content_received != NULL &&
+        klass->content_received (connection->response_request, (const gchar *) data + offset, length)) {
+        connection->response_streamed = TRUE;
+        return;
     }
 
-    priv->n_read += n_read;
+    SoupMessage *message = _snapd_request_get_message (connection->response_request);
+    g_autoptr(SoupBuffer) buffer = soup_buffer_new_with_owner (data + offset, length, g_bytes_ref (bytes), (GDestroyNotify) g_bytes_unref);
+    soup_message_body_append_buffer (message->response_body, buffer);
+}
 
-    while (TRUE) {
-        /* Look for header divider */
-        gchar *body = g_strstr_len ((gchar *) priv->buffer->data, priv->n_read, "\r\n\r\n");
-        if (body == NULL)
-            return G_SOURCE_CONTINUE;
-        body += 4;
-        gsize header_length = body - (gchar *) priv->buffer->data;
-
-        /* Match this response to the next uncompleted request */
-        SnapdRequest *request = get_first_request (self);
-        if (request == NULL) {
-            g_warning ("Ignoring unexpected response");
-            return G_SOURCE_REMOVE;
-        }
+static void
+parse_response (SnapdClient *self, SnapdRequest *request)
+{
+    g_autoptr(SnapdMaintenance) maintenance = NULL;
+    g_autoptr(GError) error = NULL;
+    gboolean result = SNAPD_REQUEST_GET_CLASS (request)->parse_response (request, _snapd_request_get_message (request), &maintenance, &error);
+    handle_response (self, request, result, maintenance, error);
+}
 
-        SoupMessage *message = _snapd_request_get_message (request);
+typedef struct
+{
+    SnapdClient *client;
+    SnapdRequest *request;
+    gboolean result;
+    SnapdMaintenance *maintenance;
+    GError *error;
+} ParseJob;
 
-        /* Parse headers */
-        g_clear_pointer (&message->reason_phrase, g_free);
-        if (!soup_headers_parse_response ((gchar *) priv->buffer->data, header_length, message->response_headers,
-                                          NULL, &message->status_code, &message->reason_phrase)) {
-            g_autoptr(GError) e = g_error_new (SNAPD_ERROR,
-                                               SNAPD_ERROR_READ_FAILED,
-                                               "Failed to parse headers from snapd");
-            complete_all_requests (self, e);
-            return G_SOURCE_REMOVE;
-        }
+static void
+parse_job_free (ParseJob *job)
+{
+    g_object_unref (job->request);
+    g_clear_object (&job->maintenance);
+    g_clear_error (&job->error);
+    g_slice_free (ParseJob, job);
+}
 
-        /* Read content and process content */
-        gsize content_length;
-        switch (soup_message_headers_get_encoding (message->response_headers)) {
-        case SOUP_ENCODING_EOF:
-            if (!g_socket_is_closed (priv->snapd_socket))
-                return G_SOURCE_CONTINUE;
+static gboolean
+parse_job_complete_cb (gpointer user_data)
+{
+    ParseJob *job = user_data;
+    handle_response (job->client, job->request, job->result, job->maintenance, job->error);
+    return G_SOURCE_REMOVE;
+}
 
-            content_length = priv->n_read - header_length;
-            soup_message_body_append (message->response_body, SOUP_MEMORY_COPY, body, content_length);
-            parse_response (self, request, message);
-            break;
+/* Parse a response in the parse thread, then act on it in the context of the request.
+ * There is only one parse thread so responses are handled in the order they were received */
+static void
+parse_thread_cb (gpointer data, gpointer user_data)
+{
+    ParseJob *job = data;
 
-        case SOUP_ENCODING_CHUNKED:
-            // FIXME: Find a way to abort on error
-            if (!have_chunked_body (body, priv->n_read - header_length))
-                return G_SOURCE_CONTINUE;
+    job->result = SNAPD_REQUEST_GET_CLASS (job->request)->parse_response (job->request, _snapd_request_get_message (job->request), &job->maintenance, &job->error);
 
-            gchar *combined_start;
-            gsize combined_length;
-            compress_chunks (body, priv->n_read - header_length, &combined_start, &combined_length, &content_length);
-            soup_message_body_append (message->response_body, SOUP_MEMORY_COPY, combined_start, combined_length);
-            parse_response (self, request, message);
-            break;
+    g_autoptr(GSource) source = g_idle_source_new ();
+    g_source_set_name (source, "snapd-glib-parse-complete");
+    g_source_set_callback (source, parse_job_complete_cb, job, (GDestroyNotify) parse_job_free);
+    g_source_attach (source, _snapd_request_get_context (job->request));
+}
 
-        case SOUP_ENCODING_CONTENT_LENGTH:
-            content_length = soup_message_headers_get_content_length (message->response_headers);
-            if (priv->n_read < header_length + content_length)
-                return G_SOURCE_CONTINUE;
+/* Pass a complete response body to a request as if it had been received from snapd */
+static void
+replay_content (SnapdRequest *request, GBytes *body)
+{
+    SnapdRequestClass *klass = SNAPD_REQUEST_GET_CLASS (request);
+    gsize length;
+    const gchar *data = g_bytes_get_data (body, &length);
+    if (klass->content_received != NULL && klass->content_received (request, data, length))
+        return;
 
-            soup_message_body_append (message->response_body, SOUP_MEMORY_COPY, body, content_length);
-            parse_response (self, request, message);
-            break;
+    SoupMessage *message = _snapd_request_get_message (request);
+    g_autoptr(SoupBuffer) buffer = soup_buffer_new_with_owner (data, length, g_bytes_ref (body), (GDestroyNotify) g_bytes_unref);
+    soup_message_body_truncate (message->response_body);
+    soup_message_body_append_buffer (message->response_body, buffer);
+}
 
-        default:
-            {
-                g_autoptr(GError) e = g_error_new (SNAPD_ERROR,
-                                                   SNAPD_ERROR_READ_FAILED,
-                                                   "Unable to determine header encoding");
-                complete_all_requests (self, e);
-            }
-            return G_SOURCE_REMOVE;
-        }
+typedef struct
+{
+    SnapdClient *client;
+    RequestData *data;
+    GBytes *body;
+} CachedResponse;
 
-        /* Move remaining data to the start of the buffer */
-        g_byte_array_remove_range (priv->buffer, 0, header_length + content_length);
-        priv->n_read -= header_length + content_length;
-    }
+static void
+cached_response_free (CachedResponse *response)
+{
+    g_object_unref (response->client);
+    request_data_unref (response->data);
+    g_bytes_unref (response->body);
+    g_slice_free (CachedResponse, response);
 }
 
 static gboolean
-cancel_idle_cb (gpointer user_data)
+cached_response_cb (gpointer user_data)
 {
-    RequestData *data = user_data;
+    CachedResponse *response = user_data;
+    SnapdRequest *request = response->data->request;
 
     g_autoptr(GError) error = NULL;
-    g_cancellable_set_error_if_cancelled (_snapd_request_get_cancellable (data->request), &error);
-    complete_request (data->client, data->request, error);
+    if (g_cancellable_set_error_if_cancelled (_snapd_request_get_cancellable (request), &error)) {
+        complete_request (response->client, request, error);
+        return G_SOURCE_REMOVE;
+    }
 
+    replay_content (request, response->body);
+    parse_response (response->client, request);
     return G_SOURCE_REMOVE;
 }
 
 static void
-request_cancelled_cb (GCancellable *cancellable, RequestData *data)
+complete_response (Connection *connection)
 {
-    /* Asynchronous requests require asking snapd to stop them */
-    if (SNAPD_IS_REQUEST_ASYNC (data->request)) {
-        SnapdRequestAsync *r = SNAPD_REQUEST_ASYNC (data->request);
+    SnapdClient *self = connection->client;
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
 
-        /* Cancel if we have got a response from snapd */
-        if (_snapd_request_async_get_change_id (r) != NULL)
-            send_cancel (data->client, r);
-    }
-    else {
-        /* Execute in an idle thread so g_cancellable_disconnect doesn't deadlock */
-        g_autoptr(GSource) idle_source = g_idle_source_new ();
-        g_source_set_callback (idle_source, cancel_idle_cb, request_data_ref (data), (GDestroyNotify) request_data_unref);
-        g_source_attach (idle_source, _snapd_request_get_context (data->request));
+    g_autoptr(SnapdRequest) request = g_steal_pointer (&connection->response_request);
+    connection->parse_state = PARSE_STATE_HEADERS;
+
+    /* Use the cached response if snapd reports it is unchanged, otherwise store it for next time.
+     * Any request that isn't a GET may have changed the system so cached responses can't be used */
+    SoupMessage *message = _snapd_request_get_message (request);
+    g_autoptr(GBytes) cached_body = NULL;
+    if (message->status_code == SOUP_STATUS_NOT_MODIFIED &&
+        _snapd_response_cache_revalidate (priv->response_cache, message, &cached_body))
+        replay_content (request, cached_body);
+    else if (strcmp (message->method, "GET") != 0)
+        _snapd_response_cache_clear (priv->response_cache);
+    else if (!connection->response_streamed)
+        _snapd_response_cache_insert (priv->response_cache, message);
+
+    /* Don't match any more responses to this request while it is being parsed */
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+        /* Responses arrive in the order requests were sent, so this is normally the first request waiting */
+        RequestData *data = g_queue_peek_head (&connection->awaiting);
+        if (data == NULL || data->request != request)
+            data = get_request_data (self, request);
+        if (data != NULL) {
+            data->responded = TRUE;
+            connection_remove_awaiting (connection, data);
+        }
+
+        if (priv->parse_pool != NULL) {
+            ParseJob *job = g_slice_new0 (ParseJob);
+            job->client = self;
+            job->request = g_steal_pointer (&request);
+            g_thread_pool_push (priv->parse_pool, job, NULL);
+            return;
+        }
     }
+
+    parse_response (self, request);
 }
 
-static GSocket *
-open_snapd_socket (const gchar *socket_path, GCancellable *cancellable, GError **error)
+/* Get the next line from the received data, buffering partial lines.
+ * Returns the line (without the line ending) or %NULL if more data is required */
+static const gchar *
+read_line (Connection *connection, const guint8 *data, gsize length, gsize *offset, gsize *line_length)
 {
-    g_autoptr(GError) error_local = NULL;
-    g_autoptr(GSocket) socket = g_socket_new (G_SOCKET_FAMILY_UNIX,
-                                              G_SOCKET_TYPE_STREAM,
-                                              G_SOCKET_PROTOCOL_DEFAULT,
-                                              &error_local);
-    if (socket == NULL) {
-        g_set_error (error,
-                     SNAPD_ERROR,
-                     SNAPD_ERROR_CONNECTION_FAILED,
-                     "Unable to create snapd socket: %s",
-                     error_local->message);
-        return NULL;
-    }
-    g_socket_set_blocking (socket, FALSE);
-    g_autoptr(GSocketAddress) address = g_unix_socket_address_new (socket_path);
-    if (!g_socket_connect (socket, address, cancellable, &error_local)) {
-        g_set_error (error,
-                     SNAPD_ERROR,
-                     SNAPD_ERROR_CONNECTION_FAILED,
-                     "Unable to connect snapd socket: %s",
-                     error_local->message);
+    const guint8 *start = data + *offset;
+    gsize n_available = length - *offset;
+    const guint8 *end = memchr (start, '\n', n_available);
+    if (end == NULL) {
+        g_byte_array_append (connection->buffer, start, n_available);
+        *offset = length;
         return NULL;
     }
 
-    return g_steal_pointer (&socket);
-}
+    gsize n_used = end - start + 1;
+    *offset += n_used;
 
-static GSource *
-make_read_source (SnapdClient *self, GMainContext *context)
+    /* Use the data directly if we have the whole line, otherwise combine with previous data */
+    const gchar *line = (const gchar *) start;
+    gsize n = n_used;
+    if (connection->buffer->len > 0) {
+        g_byte_array_append (connection->buffer, start, n_used);
+        line = (const gchar *) connection->buffer->data;
+        n = connection->buffer->len;
+    }
+
+    /* Strip line ending */
+    n--;
+    if (n > 0 && line[n - 1] == '\r')
+        n--;
+    *line_length = n;
+
+    return line;
+}
+
+/* Process data received from snapd. Returns %FALSE if the data is invalid */
+static gboolean
+parse_data (Connection *connection, GBytes *bytes, GError **error)
+{
+    SnapdClient *self = connection->client;
+
+    gsize length;
+    const guint8 *data = g_bytes_get_data (bytes, &length);
+    gsize offset = 0;
+    while (offset < length) {
+        switch (connection->parse_state) {
+        case PARSE_STATE_HEADERS:
+        {
+            /* Collect headers until we find the divider, continuing the search where we stopped last time */
+            gsize n_buffered = connection->buffer->len;
+            g_byte_array_append (connection->buffer, data + offset, length - offset);
+            gsize scan_start = connection->scan_offset > 3 ? connection->scan_offset - 3 : 0;
+            const gchar *divider = g_strstr_len ((const gchar *) connection->buffer->data + scan_start, connection->buffer->len - scan_start, "\r\n\r\n");
+            if (divider == NULL) {
+                connection->scan_offset = connection->buffer->len;
+                return TRUE;
+            }
+            gsize header_length = divider + 4 - (const gchar *) connection->buffer->data;
+
+            /* Match this response to the next uncompleted request */
+            SnapdRequest *request = get_first_request (self, connection);
+            if (request == NULL) {
+                g_set_error (error,
+                             SNAPD_ERROR,
+                             SNAPD_ERROR_READ_FAILED,
+                             "Unexpected response from snapd");
+                return FALSE;
+            }
+            connection->response_request = g_object_ref (request);
+            connection->response_streamed = FALSE;
+
+            SoupMessage *message = _snapd_request_get_message (request);
+
+            /* Parse headers */
+            g_clear_pointer (&message->reason_phrase, g_free);
+            if (!soup_headers_parse_response ((gchar *) connection->buffer->data, header_length, message->response_headers,
+                                              NULL, &message->status_code, &message->reason_phrase)) {
+                g_set_error (error,
+                             SNAPD_ERROR,
+                             SNAPD_ERROR_READ_FAILED,
+                             "Failed to parse headers from snapd");
+                return FALSE;
+            }
+
+            /* Continue with the data after the headers */
+            offset += header_length - n_buffered;
+            g_byte_array_set_size (connection->buffer, 0);
+            connection->scan_offset = 0;
+
+            switch (soup_message_headers_get_encoding (message->response_headers)) {
+            case SOUP_ENCODING_EOF:
+                connection->parse_state = PARSE_STATE_CONTENT_TO_EOF;
+                break;
+            case SOUP_ENCODING_CHUNKED:
+                connection->parse_state = PARSE_STATE_CHUNK_HEADER;
+                break;
+            case SOUP_ENCODING_CONTENT_LENGTH:
+                connection->content_remaining = soup_message_headers_get_content_length (message->response_headers);
+                connection->parse_state = PARSE_STATE_CONTENT;
+                if (connection->content_remaining == 0)
+                    complete_response (connection);
+                break;
+            default:
+                g_set_error (error,
+                             SNAPD_ERROR,
+                             SNAPD_ERROR_READ_FAILED,
+                             "Unable to determine header encoding");
+                return FALSE;
+            }
+            break;
+        }
+
+        case PARSE_STATE_CONTENT:
+        {
+            gsize n = MIN (connection->content_remaining, length - offset);
+            append_content (connection, bytes, offset, n);
+            offset += n;
+            connection->content_remaining -= n;
+            if (connection->content_remaining == 0)
+                complete_response (connection);
+            break;
+        }
+
+        case PARSE_STATE_CONTENT_TO_EOF:
+            /* Completed when the connection closes */
+            append_content (connection, bytes, offset, length - offset);
+            offset = length;
+            break;
+
+        case PARSE_STATE_CHUNK_HEADER:
+        {
+            gsize line_length;
+            const gchar *line = read_line (connection, data, length, &offset, &line_length);
+            if (line == NULL)
+                break;
+
+            gchar *end;
+            connection->content_remaining = g_ascii_strtoull (line, &end, 16);
+            if (end == line) {
+                g_set_error (error,
+                             SNAPD_ERROR,
+                             SNAPD_ERROR_READ_FAILED,
+                             "Invalid chunk header from snapd");
+                return FALSE;
+            }
+            g_byte_array_set_size (connection->buffer, 0);
+
+            /* Zero length chunk marks the end of the content */
+            connection->parse_state = connection->content_remaining > 0 ? PARSE_STATE_CHUNK_DATA : PARSE_STATE_TRAILER;
+            break;
+        }
+
+        case PARSE_STATE_CHUNK_DATA:
+        {
+            gsize n = MIN (connection->content_remaining, length - offset);
+            append_content (connection, bytes, offset, n);
+            offset += n;
+            connection->content_remaining -= n;
+            if (connection->content_remaining == 0)
+                connection->parse_state = PARSE_STATE_CHUNK_END;
+            break;
+        }
+
+        case PARSE_STATE_CHUNK_END:
+        {
+            /* Skip line ending after chunk data */
+            gsize line_length;
+            const gchar *line = read_line (connection, data, length, &offset, &line_length);
+            if (line == NULL)
+                break;
+            g_byte_array_set_size (connection->buffer, 0);
+            connection->parse_state = PARSE_STATE_CHUNK_HEADER;
+            break;
+        }
+
+        case PARSE_STATE_TRAILER:
+        {
+            /* Ignore trailers until empty line */
+            gsize line_length;
+            const gchar *line = read_line (connection, data, length, &offset, &line_length);
+            if (line == NULL)
+                break;
+            g_byte_array_set_size (connection->buffer, 0);
+            if (line_length == 0)
+                complete_response (connection);
+            break;
+        }
+        }
+    }
+
+    return TRUE;
+}
+
+static gboolean
+read_cb (GSocket *socket, GIOCondition condition, Connection *connection)
 {
-    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    SnapdClient *self = connection->client;
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&connection->read_mutex);
+
+    /* Ignore sources left over from a previous connection */
+    if (socket != connection->socket)
+        return G_SOURCE_REMOVE;
+
+    /* Read into a new block each time so the content can be passed to the request without copying */
+    g_autofree gchar *block = g_malloc (connection->read_size);
+    g_autoptr(GError) error = NULL;
+    gssize n_read = g_socket_receive (socket,
+                                      block,
+                                      connection->read_size,
+                                      NULL,
+                                      &error);
+
+    if (n_read == 0) {
+        /* Content without a length is complete when the connection closes */
+        if (connection->parse_state == PARSE_STATE_CONTENT_TO_EOF)
+            complete_response (connection);
+
+        g_autoptr(GError) e = g_error_new (SNAPD_ERROR,
+                                           SNAPD_ERROR_READ_FAILED,
+                                           "snapd connection closed");
+        complete_connection_requests (self, connection, e);
+        return G_SOURCE_REMOVE;
+    }
+
+    if (n_read < 0) {
+        if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            return TRUE;
+
+        g_autoptr(GError) e = g_error_new (SNAPD_ERROR,
+                                           SNAPD_ERROR_READ_FAILED,
+                                           "Failed to read from snapd: %s",
+                                           error->message);
+        complete_connection_requests (self, connection, e);
+        return G_SOURCE_REMOVE;
+    }
+
+    connection->n_bytes_received += n_read;
+    connection->last_used_time = g_get_monotonic_time ();
+
+    /* Read more at a time for large responses, less when there's not much data */
+    if ((gsize) n_read == connection->read_size)
+        connection->read_size = MIN (connection->read_size * 2, MAX_READ_SIZE);
+    else if ((gsize) n_read < connection->read_size / 4)
+        connection->read_size = MAX (connection->read_size / 2, MIN_READ_SIZE);
+
+    /* The content may be kept for as long as the response, so shrink the block to what was read */
+    g_autoptr(GBytes) bytes = g_bytes_new_take (g_realloc (g_steal_pointer (&block), n_read), n_read);
+    if (!parse_data (connection, bytes, &error)) {
+        complete_connection_requests (self, connection, error);
+        return G_SOURCE_REMOVE;
+    }
+
+    /* Now we may have had a response there is space to send more requests */
+    send_queued_requests (self);
+
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+cancel_idle_cb (gpointer user_data)
+{
+    RequestData *data = user_data;
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (data->client);
+
+    g_autoptr(GError) error = NULL;
+    g_cancellable_set_error_if_cancelled (_snapd_request_get_cancellable (data->request), &error);
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+
+    /* If snapd is still going to respond then keep the request so the response is matched to the right request.
+     * The response is still read from the connection, but its content is discarded */
+    RequestData *d = get_request_data (data->client, data->request);
+    if (d != NULL && is_awaiting_response (d))
+        _snapd_request_return (data->request, error);
+    else
+        complete_request_unlocked (data->client, data->request, error);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+request_cancelled_cb (GCancellable *cancellable, RequestData *data)
+{
+    /* Asynchronous requests require asking snapd to stop them, watching a change doesn't affect it */
+    if (SNAPD_IS_REQUEST_ASYNC (data->request) && !SNAPD_IS_WATCH_CHANGE (data->request)) {
+        SnapdRequestAsync *r = SNAPD_REQUEST_ASYNC (data->request);
+
+        /* Cancel if we have got a response from snapd */
+        if (_snapd_request_async_get_change_id (r) != NULL)
+            send_cancel (data->client, r);
+    }
+    else {
+        /* Execute in an idle thread so g_cancellable_disconnect doesn't deadlock */
+        g_autoptr(GSource) idle_source = g_idle_source_new ();
+        g_source_set_callback (idle_source, cancel_idle_cb, request_data_ref (data), (GDestroyNotify) request_data_unref);
+        _snapd_request_attach_source (data->request, idle_source);
+    }
+}
+
+static GSocket *
+open_snapd_socket (const gchar *socket_path, GCancellable *cancellable, GError **error)
+{
+    g_autoptr(GError) error_local = NULL;
+    g_autoptr(GSocket) socket = g_socket_new (G_SOCKET_FAMILY_UNIX,
+                                              G_SOCKET_TYPE_STREAM,
+                                              G_SOCKET_PROTOCOL_DEFAULT,
+                                              &error_local);
+    if (socket == NULL) {
+        g_set_error (error,
+                     SNAPD_ERROR,
+                     SNAPD_ERROR_CONNECTION_FAILED,
+                     "Unable to create snapd socket: %s",
+                     error_local->message);
+        return NULL;
+    }
+    g_socket_set_blocking (socket, FALSE);
+    g_autoptr(GSocketAddress) address = g_unix_socket_address_new (socket_path);
+    if (!g_socket_connect (socket, address, cancellable, &error_local)) {
+        g_set_error (error,
+                     SNAPD_ERROR,
+                     SNAPD_ERROR_CONNECTION_FAILED,
+                     "Unable to connect snapd socket: %s",
+                     error_local->message);
+        return NULL;
+    }
+
+    return g_steal_pointer (&socket);
+}
 
-    g_autoptr(GSource) source = g_socket_create_source (priv->snapd_socket, G_IO_IN, NULL);
+static GSource *
+make_read_source (Connection *connection, GMainContext *context)
+{
+    g_autoptr(GSource) source = g_socket_create_source (connection->socket, G_IO_IN, NULL);
     g_source_set_name (source, "snapd-glib-read-source");
-    g_source_set_callback (source, (GSourceFunc) read_cb, self, NULL);
+    g_source_set_callback (source, (GSourceFunc) read_cb, connection_ref (connection), (GDestroyNotify) connection_unref);
     g_source_attach (source, context);
 
     return g_steal_pointer (&source);
 }
 
+/* Write as much of the HTTP data for a request as the socket will accept.
+ * Returns FALSE on error, @blocked is set if the socket is full */
 static gboolean
-write_to_snapd (SnapdClient *self, GByteArray *data, GCancellable *cancellable, GError **error)
+write_to_snapd (Connection *connection, RequestData *data, gboolean *blocked, GError **error)
+{
+    *blocked = FALSE;
+    while (data->n_written < data->http_data->len) {
+        g_autoptr(GError) error_local = NULL;
+        gssize n_written = g_socket_send (connection->socket,
+                                          (const gchar *) data->http_data->data + data->n_written,
+                                          data->http_data->len - data->n_written,
+                                          NULL,
+                                          &error_local);
+        if (n_written < 0) {
+            if (g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+                *blocked = TRUE;
+                return TRUE;
+            }
+            g_propagate_error (error, g_steal_pointer (&error_local));
+            return FALSE;
+        }
+
+        data->n_written += n_written;
+        connection->n_bytes_sent += n_written;
+    }
+
+    return TRUE;
+}
+
+static void
+set_request_connection (RequestData *data, Connection *connection)
+{
+    g_clear_pointer (&data->connection, connection_unref);
+    data->connection = connection_ref (connection);
+
+    if (data->read_source != NULL)
+        g_source_destroy (data->read_source);
+    g_clear_pointer (&data->read_source, g_source_unref);
+    data->read_source = make_read_source (connection, _snapd_request_get_context (data->request));
+}
+
+static void upload_continue (RequestData *data);
+
+/* Stop streaming a request body, the rest of the request can't be sent so the connection is closed */
+static void
+upload_stop (RequestData *data, GError *error)
 {
+    SnapdClient *self = data->client;
     SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
 
-    guint n_sent = 0;
-    while (n_sent < data->len) {
-        gssize n_written = g_socket_send (priv->snapd_socket, (const gchar *) (data->data + n_sent), data->len - n_sent, cancellable, error);
-        if (n_written < 0)
+    g_autoptr(Connection) connection = NULL;
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+        connection = connection_ref (data->connection);
+        connection->uploading = FALSE;
+        g_clear_pointer (&data->upload, upload_free);
+    }
+
+    complete_request (self, data->request, error);
+    if (connection->socket != NULL)
+        complete_connection_requests (self, connection, error);
+    request_data_unref (data);
+}
+
+/* Finish streaming a request body, the connection can now be used for other requests */
+static void
+upload_complete (RequestData *data)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (data->client);
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+
+    data->connection->uploading = FALSE;
+    g_clear_pointer (&data->upload, upload_free);
+    send_queued_requests_unlocked (data->client);
+    request_data_unref (data);
+}
+
+static gboolean
+upload_write_cb (GSocket *socket, GIOCondition condition, gpointer user_data)
+{
+    RequestData *data = user_data;
+
+    g_clear_pointer (&data->upload->write_source, g_source_unref);
+    upload_continue (data);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* Continue when the socket can be written to */
+static void
+upload_wait (RequestData *data, GSocket *socket)
+{
+    Upload *upload = data->upload;
+
+    upload->write_source = g_socket_create_source (socket, G_IO_OUT, NULL);
+    g_source_set_callback (upload->write_source, (GSourceFunc) upload_write_cb, data, NULL);
+    g_source_attach (upload->write_source, _snapd_request_get_context (data->request));
+}
+
+/* Write as much pending data as the socket will accept */
+static gboolean
+upload_write_pending (RequestData *data, GSocket *socket, gboolean *blocked, GError **error)
+{
+    Upload *upload = data->upload;
+
+    *blocked = FALSE;
+    while (upload->pending_offset < upload->pending->len) {
+        g_autoptr(GError) error_local = NULL;
+        gssize n_written = g_socket_send (socket,
+                                          (const gchar *) upload->pending->data + upload->pending_offset,
+                                          upload->pending->len - upload->pending_offset,
+                                          NULL,
+                                          &error_local);
+        if (n_written < 0) {
+            if (g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+                *blocked = TRUE;
+                return TRUE;
+            }
+            g_propagate_error (error, g_steal_pointer (&error_local));
+            return FALSE;
+        }
+
+        upload->pending_offset += n_written;
+        data->connection->n_bytes_sent += n_written;
+    }
+
+    g_byte_array_set_size (upload->pending, 0);
+    upload->pending_offset = 0;
+    if (upload->pending_content > 0) {
+        upload->n_sent += upload->pending_content;
+        upload->pending_content = 0;
+        _snapd_request_body_progress (data->request, upload->n_sent, upload->length);
+    }
+
+    return TRUE;
+}
+
+static void
+upload_read_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    RequestData *data = user_data;
+    Upload *upload = data->upload;
+
+    g_autoptr(GError) error = NULL;
+    g_autoptr(GBytes) bytes = g_input_stream_read_bytes_finish (upload->stream, result, &error);
+    if (bytes == NULL) {
+        upload_stop (data, error);
+        return;
+    }
+
+    gsize size;
+    const guint8 *content = g_bytes_get_data (bytes, &size);
+    if (size == 0)
+        upload->eof = TRUE;
+    else {
+        if (upload->chunked) {
+            g_autofree gchar *chunk_header = g_strdup_printf ("%" G_GSIZE_MODIFIER "x\r\n", size);
+            g_byte_array_append (upload->pending, (const guint8 *) chunk_header, strlen (chunk_header));
+        }
+        g_byte_array_append (upload->pending, content, size);
+        if (upload->chunked)
+            g_byte_array_append (upload->pending, (const guint8 *) "\r\n", 2);
+        upload->pending_content = size;
+    }
+
+    upload_continue (data);
+}
+
+#ifdef __linux__
+/* Send file content without copying it through userspace. Returns FALSE on error */
+static gboolean
+upload_sendfile (RequestData *data, GSocket *socket, gboolean *blocked, GError **error)
+{
+    Upload *upload = data->upload;
+
+    *blocked = FALSE;
+    guint64 n_sent = 0;
+    while (n_sent < UPLOAD_SENDFILE_SIZE && upload->n_sent < upload->length) {
+        ssize_t n_written = sendfile (g_socket_get_fd (socket), upload->fd, NULL, MIN (upload->length - upload->n_sent, UPLOAD_SENDFILE_SIZE - n_sent));
+        if (n_written < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN) {
+                *blocked = TRUE;
+                break;
+            }
+            int errsv = errno;
+            g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv), "%s", g_strerror (errsv));
+            return FALSE;
+        }
+        if (n_written == 0) {
+            g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_FAILED, "File is shorter than expected");
             return FALSE;
+        }
+
+        n_sent += n_written;
+        upload->n_sent += n_written;
+        data->connection->n_bytes_sent += n_written;
+    }
+
+    if (upload->n_sent == upload->length)
+        upload->eof = TRUE;
+    if (n_sent > 0)
+        _snapd_request_body_progress (data->request, upload->n_sent, upload->length);
+
+    return TRUE;
+}
+#endif
+
+/* Write the next part of a request body, runs in the context of the request */
+static void
+upload_continue (RequestData *data)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (data->client);
+    Upload *upload = data->upload;
+
+    /* Stop if the request has been completed (e.g. snapd responded early) or the connection has gone */
+    g_autoptr(GSocket) socket = NULL;
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+        if (get_request_data (data->client, data->request) != NULL && data->connection->socket != NULL)
+            socket = g_object_ref (data->connection->socket);
+    }
+    g_autoptr(GError) error = NULL;
+    if (socket == NULL) {
+        error = g_error_new (SNAPD_ERROR, SNAPD_ERROR_WRITE_FAILED, "Request stopped before it was sent");
+        upload_stop (data, error);
+        return;
+    }
+    if (g_cancellable_set_error_if_cancelled (_snapd_request_get_cancellable (data->request), &error)) {
+        upload_stop (data, error);
+        return;
+    }
+
+    while (TRUE) {
+        gboolean blocked;
+        if (!upload_write_pending (data, socket, &blocked, &error)) {
+            g_autoptr(GError) e = g_error_new (SNAPD_ERROR, SNAPD_ERROR_WRITE_FAILED, "Failed to write to snapd: %s", error->message);
+            upload_stop (data, e);
+            return;
+        }
+        if (blocked) {
+            upload_wait (data, socket);
+            return;
+        }
+
+        if (upload->done) {
+            upload_complete (data);
+            return;
+        }
+
+        /* Finish the multipart content and the chunked encoding */
+        if (upload->eof) {
+            gsize trailer_length;
+            const guint8 *trailer = g_bytes_get_data (upload->trailer, &trailer_length);
+            if (upload->chunked) {
+                g_autofree gchar *chunk_header = g_strdup_printf ("%" G_GSIZE_MODIFIER "x\r\n", trailer_length);
+                g_byte_array_append (upload->pending, (const guint8 *) chunk_header, strlen (chunk_header));
+            }
+            g_byte_array_append (upload->pending, trailer, trailer_length);
+            if (upload->chunked)
+                g_byte_array_append (upload->pending, (const guint8 *) "\r\n0\r\n\r\n", 7);
+            upload->done = TRUE;
+            continue;
+        }
+
+#ifdef __linux__
+        if (upload->fd >= 0) {
+            if (!upload_sendfile (data, socket, &blocked, &error)) {
+                g_autoptr(GError) e = g_error_new (SNAPD_ERROR, SNAPD_ERROR_WRITE_FAILED, "Failed to write to snapd: %s", error->message);
+                upload_stop (data, e);
+                return;
+            }
+
+            /* Let the main loop run between blocks */
+            if (!upload->eof) {
+                upload_wait (data, socket);
+                return;
+            }
+            continue;
+        }
+#endif
+
+        g_input_stream_read_bytes_async (upload->stream, UPLOAD_BLOCK_SIZE, G_PRIORITY_DEFAULT,
+                                         _snapd_request_get_cancellable (data->request),
+                                         upload_read_cb, data);
+        return;
+    }
+}
+
+static gboolean
+upload_start_cb (gpointer user_data)
+{
+    upload_continue (user_data);
+    return G_SOURCE_REMOVE;
+}
+
+/* Start streaming the body of a request that has had its headers written. Requests must be locked */
+static void
+start_upload_unlocked (RequestData *data)
+{
+    data->connection->uploading = TRUE;
+
+    /* The body is written from the context of the request, the data is kept until the upload finishes */
+    g_autoptr(GSource) source = g_idle_source_new ();
+    g_source_set_callback (source, upload_start_cb, request_data_ref (data), NULL);
+    g_source_attach (source, _snapd_request_get_context (data->request));
+}
+
+static gboolean write_cb (GSocket *socket, GIOCondition condition, Connection *connection);
+
+/* Finish writing a request, the connection can be used for the next request unless there is a body to send. Requests must be locked */
+static void
+write_complete_unlocked (Connection *connection, RequestData *data)
+{
+    connection->writing = NULL;
+    connection->n_requests++;
+    if (data->upload != NULL)
+        start_upload_unlocked (data);
+}
+
+/* Continue writing a request when the socket has space. Requests must be locked */
+static void
+write_wait_unlocked (Connection *connection, RequestData *data)
+{
+    connection->writing = data;
+    connection->write_source = g_socket_create_source (connection->socket, G_IO_OUT, NULL);
+    g_source_set_name (connection->write_source, "snapd-glib-write-source");
+    g_source_set_callback (connection->write_source, (GSourceFunc) write_cb, connection_ref (connection), (GDestroyNotify) connection_unref);
+    g_source_attach (connection->write_source, _snapd_request_get_context (data->request));
+}
+
+static gboolean
+write_cb (GSocket *socket, GIOCondition condition, Connection *connection)
+{
+    SnapdClient *self = connection->client;
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_autoptr(GError) error = NULL;
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+
+        g_clear_pointer (&connection->write_source, g_source_unref);
+
+        /* Stop if the connection has been closed or the request completed while waiting */
+        RequestData *data = connection->writing;
+        if (socket != connection->socket || data == NULL)
+            return G_SOURCE_REMOVE;
+
+        gboolean blocked;
+        if (write_to_snapd (connection, data, &blocked, &error)) {
+            if (blocked)
+                write_wait_unlocked (connection, data);
+            else {
+                write_complete_unlocked (connection, data);
+                send_queued_requests_unlocked (self);
+            }
+            return G_SOURCE_REMOVE;
+        }
+    }
+
+    /* Part of the request has been written, so nothing else can be sent on this connection */
+    g_autoptr(GError) e = g_error_new (SNAPD_ERROR,
+                                       SNAPD_ERROR_WRITE_FAILED,
+                                       "Failed to write to snapd: %s",
+                                       error->message);
+    complete_connection_requests (self, connection, e);
+
+    return G_SOURCE_REMOVE;
+}
+
+/* Start writing a request. If the socket is full the rest is written when it has space. Requests must be locked */
+static gboolean
+write_request (SnapdClient *self, Connection *connection, RequestData *data, GError **error)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    GCancellable *cancellable = _snapd_request_get_cancellable (data->request);
+
+    gboolean new_socket = FALSE;
+    if (connection->socket == NULL) {
+        connection->socket = open_snapd_socket (priv->socket_path, cancellable, error);
+        if (connection->socket == NULL)
+            return FALSE;
+        new_socket = TRUE;
+    }
+
+    /* Connection is being used again */
+    if (connection->idle_source != NULL)
+        g_source_destroy (connection->idle_source);
+    g_clear_pointer (&connection->idle_source, g_source_unref);
+    g_clear_pointer (&connection->context, g_main_context_unref);
+    connection->context = g_main_context_ref (_snapd_request_get_context (data->request));
+    connection->thread = data->thread;
+    connection->last_used_time = g_get_monotonic_time ();
+
+    set_request_connection (data, connection);
+
+    /* send HTTP request */
+    g_autoptr(GError) error_local = NULL;
+    gboolean blocked;
+    gboolean result = write_to_snapd (connection, data, &blocked, &error_local);
+
+    /* If was re-using closed socket, then reconnect and retry */
+    if (!result && !new_socket && data->n_written == 0 && g_error_matches (error_local, G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE)) {
+        g_clear_error (&error_local);
+        g_clear_object (&connection->socket);
+
+        connection->socket = open_snapd_socket (priv->socket_path, cancellable, error);
+        if (connection->socket == NULL)
+            return FALSE;
+
+        set_request_connection (data, connection);
+
+        result = write_to_snapd (connection, data, &blocked, &error_local);
+    }
+
+    if (!result) {
+        g_set_error (error,
+                     SNAPD_ERROR,
+                     SNAPD_ERROR_WRITE_FAILED,
+                     "Failed to write to snapd: %s",
+                     error_local->message);
+        return FALSE;
+    }
+
+    data->sent = TRUE;
+    connection_add_awaiting (connection, data);
+    if (blocked)
+        write_wait_unlocked (connection, data);
+    else
+        write_complete_unlocked (connection, data);
+
+    return TRUE;
+}
+
+static gboolean
+connection_is_busy (Connection *connection)
+{
+    return connection->uploading || connection->writing != NULL || connection->n_notices > 0;
+}
+
+/* Pick an unused connection for a notices request, opening one if necessary */
+static Connection *
+choose_notices_connection (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    for (guint i = 0; i < priv->connections->len; i++) {
+        Connection *c = g_ptr_array_index (priv->connections, i);
+        if (c->for_notices && !connection_is_busy (c) && g_queue_is_empty (&c->awaiting))
+            return c;
+    }
+
+    Connection *connection = connection_new (self, NULL);
+    connection->for_notices = TRUE;
+    g_ptr_array_add (priv->connections, connection);
+    return connection;
+}
+
+/* Pick the connection for a thread when there is a connection per thread, or %NULL if its connection is full */
+static Connection *
+choose_thread_connection (SnapdClient *self, RequestData *data)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    Connection *connection = NULL, *unused = NULL;
+    for (guint i = 0; i < priv->connections->len && connection == NULL; i++) {
+        Connection *c = g_ptr_array_index (priv->connections, i);
+        if (c->for_notices)
+            continue;
+        if (c->thread == data->thread)
+            connection = c;
+        else if (unused == NULL && !connection_is_busy (c) && g_queue_is_empty (&c->awaiting))
+            unused = c;
+    }
+
+    /* Requests from the same thread are pipelined on its connection */
+    if (connection != NULL) {
+        if (connection_is_busy (connection))
+            return NULL;
+        if (priv->pipeline_depth > 0 && connection->awaiting.length >= priv->pipeline_depth)
+            return NULL;
+        return connection;
+    }
+
+    /* Take over a connection no longer used by another thread, otherwise open a new one */
+    if (unused != NULL)
+        return unused;
+    connection = connection_new (self, NULL);
+    g_ptr_array_add (priv->connections, connection);
+    return connection;
+}
+
+/* Pick the connection to send @data on, or %NULL if all connections are full */
+static Connection *
+choose_connection (SnapdClient *self, RequestData *data)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    if (SNAPD_IS_GET_NOTICES (data->request))
+        return choose_notices_connection (self);
+    if (priv->max_connections == 0)
+        return choose_thread_connection (self, data);
+
+    /* Find the least loaded connection, skipping any held open waiting for notices.
+     * Prefer an unused connection last used from the same thread, so threads making
+     * synchronous calls each keep reading from their own socket */
+    Connection *connection = NULL;
+    guint n_awaiting = G_MAXUINT, n_connections = 0;
+    for (guint i = 0; i < priv->connections->len; i++) {
+        Connection *c = g_ptr_array_index (priv->connections, i);
+        if (c->for_notices)
+            continue;
+        n_connections++;
+        if (connection_is_busy (c))
+            continue;
+        guint n = c->awaiting.length;
+        if (n == 0 && c->thread == data->thread)
+            return c;
+        if (n < n_awaiting) {
+            connection = c;
+            n_awaiting = n;
+        }
+    }
+
+    /* Use an unused connection if we have one, otherwise open another connection if allowed */
+    if (connection != NULL && n_awaiting == 0)
+        return connection;
+    if (n_connections < priv->max_connections) {
+        connection = connection_new (self, NULL);
+        g_ptr_array_add (priv->connections, connection);
+        return connection;
+    }
+
+    if (priv->pipeline_depth > 0 && n_awaiting >= priv->pipeline_depth)
+        return NULL;
+
+    return connection;
+}
+
+/* Write requests in the order they were made, stopping when the pipeline is full.
+ * With a connection per thread, requests from other threads are still sent when one thread's connection is full */
+static void
+send_queued_requests_unlocked (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    GQueue waiting = G_QUEUE_INIT;
+    while (!g_queue_is_empty (&priv->send_queue)) {
+        RequestData *data = g_queue_peek_head (&priv->send_queue);
+
+        Connection *connection = choose_connection (self, data);
+        if (connection == NULL) {
+            if (priv->max_connections > 0)
+                break;
+            g_queue_push_tail (&waiting, g_queue_pop_head (&priv->send_queue));
+            continue;
+        }
+        g_queue_pop_head (&priv->send_queue);
+
+        g_autoptr(GError) error = NULL;
+        if (!write_request (self, connection, data, &error))
+            complete_request_unlocked (self, data->request, error);
+    }
+
+    /* Keep the requests that couldn't be sent at the front, in order */
+    while (!g_queue_is_empty (&waiting))
+        g_queue_push_head (&priv->send_queue, g_queue_pop_tail (&waiting));
+
+    schedule_idle_timeouts_unlocked (self);
+}
+
+static void
+send_queued_requests (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+    send_queued_requests_unlocked (self);
+}
+
+static void
+send_request_full (SnapdClient *self, SnapdRequest *request, gboolean limit_queue)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    // NOTE: Would love to use libsoup but it doesn't support unix sockets
+    // https://bugzilla.gnome.org/show_bug.cgi?id=727563
+
+    _snapd_request_set_source_object (request, G_OBJECT (self));
+
+    if (SNAPD_IS_GET_SNAPS (request))
+        _snapd_get_snaps_set_defer_members (SNAPD_GET_SNAPS (request), priv->lazy_snaps);
+    else if (SNAPD_IS_GET_FIND (request))
+        _snapd_get_find_set_defer_members (SNAPD_GET_FIND (request), priv->lazy_snaps);
+
+    g_autoptr(RequestData) data = request_data_new (self, request);
+
+    SoupMessage *message = _snapd_request_get_message (request);
+    soup_message_headers_append (message->request_headers, "Host", "");
+    soup_message_headers_append (message->request_headers, "Connection", "keep-alive");
+    if (priv->user_agent != NULL)
+        soup_message_headers_append (message->request_headers, "User-Agent", priv->user_agent);
+    if (priv->allow_interaction)
+        soup_message_headers_append (message->request_headers, "X-Allow-Interaction", "true");
+
+    g_autofree gchar *accept_languages = get_accept_languages ();
+    soup_message_headers_append (message->request_headers, "Accept-Language", accept_languages);
+
+    g_autoptr(GBytes) trailer = NULL;
+    GInputStream *body_stream = _snapd_request_get_body_stream (request, &trailer);
+    if (body_stream != NULL) {
+        data->upload = upload_new (body_stream, trailer);
+        if (data->upload->chunked)
+            soup_message_headers_set_encoding (message->request_headers, SOUP_ENCODING_CHUNKED);
+        else
+            soup_message_headers_set_content_length (message->request_headers,
+                                                      message->request_body->length + data->upload->length + g_bytes_get_size (trailer));
+    }
+
+    if (priv->auth_data != NULL) {
+        g_autoptr(GString) authorization = g_string_new ("");
+        g_string_append_printf (authorization, "Macaroon root=\"%s\"", snapd_auth_data_get_macaroon (priv->auth_data));
+        GStrv discharges = snapd_auth_data_get_discharges (priv->auth_data);
+        if (discharges != NULL)
+            for (gsize i = 0; discharges[i] != NULL; i++)
+                g_string_append_printf (authorization, ",discharge=\"%s\"", discharges[i]);
+        soup_message_headers_append (message->request_headers, "Authorization", authorization->str);
+    }
+
+    GCancellable *cancellable = _snapd_request_get_cancellable (request);
+    if (cancellable != NULL)
+        data->cancelled_id = g_cancellable_connect (cancellable, G_CALLBACK (request_cancelled_cb), request_data_new (self, request), (GDestroyNotify) request_data_unref);
+
+    /* Answer from the cache if there is a recent response to the same request.
+     * The request data is kept until then so cancelling still completes the request */
+    g_autoptr(GBytes) cached_body = NULL;
+    g_autofree gchar *etag = NULL;
+    if (_snapd_response_cache_lookup (priv->response_cache, message, &cached_body, &etag)) {
+        CachedResponse *response = g_slice_new0 (CachedResponse);
+        response->client = g_object_ref (self);
+        response->data = request_data_ref (data);
+        response->body = g_steal_pointer (&cached_body);
+        g_autoptr(GSource) source = g_idle_source_new ();
+        g_source_set_name (source, "snapd-glib-cached-response");
+        g_source_set_callback (source, cached_response_cb, response, (GDestroyNotify) cached_response_free);
+        _snapd_request_attach_source (request, source);
+        return;
+    }
+    if (etag != NULL)
+        soup_message_headers_append (message->request_headers, "If-None-Match", etag);
+
+    data->http_data = g_byte_array_new ();
+    append_string (data->http_data, message->method);
+    append_string (data->http_data, " ");
+    SoupURI *uri = soup_message_get_uri (message);
+    append_string (data->http_data, uri->path);
+    if (uri->query != NULL) {
+        append_string (data->http_data, "?");
+        append_string (data->http_data, uri->query);
+    }
+    append_string (data->http_data, " HTTP/1.1\r\n");
+    SoupMessageHeadersIter iter;
+    soup_message_headers_iter_init (&iter, message->request_headers);
+    const char *name, *value;
+    while (soup_message_headers_iter_next (&iter, &name, &value)) {
+        append_string (data->http_data, name);
+        append_string (data->http_data, ": ");
+        append_string (data->http_data, value);
+        append_string (data->http_data, "\r\n");
+    }
+    append_string (data->http_data, "\r\n");
+
+    g_autoptr(SoupBuffer) buffer = soup_message_body_flatten (message->request_body);
+    if (data->upload != NULL && data->upload->chunked) {
+        if (buffer->length > 0) {
+            g_autofree gchar *chunk_header = g_strdup_printf ("%" G_GSIZE_MODIFIER "x\r\n", buffer->length);
+            append_string (data->http_data, chunk_header);
+            g_byte_array_append (data->http_data, (const guint8 *) buffer->data, buffer->length);
+            append_string (data->http_data, "\r\n");
+        }
+    }
+    else
+        g_byte_array_append (data->http_data, (const guint8 *) buffer->data, buffer->length);
+
+    /* Queue the request and write it when there is space in the pipeline.
+     * This is done with the lock held so requests are written in the same order they are queued. */
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+    reap_idle_connections_unlocked (self);
+
+    /* Refuse the request if too many are already waiting, so the caller can slow down */
+    if (limit_queue && priv->max_queued_requests > 0 && priv->send_queue.length >= priv->max_queued_requests) {
+        g_autoptr(GError) error = g_error_new (SNAPD_ERROR,
+                                               SNAPD_ERROR_QUEUE_FULL,
+                                               "Too many requests waiting to be sent to snapd");
+        _snapd_request_return (request, error);
+        return;
+    }
+
+    g_ptr_array_add (priv->requests, request_data_ref (data));
+    g_queue_push_tail (&priv->send_queue, data);
+    send_queued_requests_unlocked (self);
+}
+
+static void
+send_request (SnapdClient *self, SnapdRequest *request)
+{
+    send_request_full (self, request, TRUE);
+}
+
+/* Requests made by snapd-glib itself (e.g. polling changes) are never refused, as requests depend on them to complete */
+static void
+send_internal_request (SnapdClient *self, SnapdRequest *request)
+{
+    send_request_full (self, request, FALSE);
+}
+
+/**
+ * snapd_client_connect_async:
+ * @client: a #SnapdClient
+ * @cancellable: (allow-none): a #GCancellable or %NULL
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
+ * @user_data: (closure): the data to pass to callback function.
+ *
+ * This method is no longer required and does nothing, snapd-glib now connects on demand.
+ *
+ * Since: 1.3
+ * Deprecated: 1.24
+ */
+void
+snapd_client_connect_async (SnapdClient *self,
+                            GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    g_autoptr(GTask) task = g_task_new (self, cancellable, callback, user_data);
+    g_task_return_boolean (task, TRUE);
+}
+
+/**
+ * snapd_client_connect_finish:
+ * @client: a #SnapdClient
+ * @result: a #GAsyncResult.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Complete request started with snapd_client_connect_async().
+ * See snapd_client_connect_sync() for more information.
+ *
+ * Returns: %TRUE if successfully connected to snapd.
+ *
+ * Since: 1.3
+ */
+gboolean
+snapd_client_connect_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
+
+    return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/**
+ * snapd_client_set_socket_path:
+ * @client: a #SnapdClient
+ * @socket_path: (allow-none): a socket path or %NULL to reset to the default.
+ *
+ * Set the Unix socket path to connect to snapd with.
+ * Defaults to the system socket.
+ *
+ * Since: 1.24
+ */
+void
+snapd_client_set_socket_path (SnapdClient *self, const gchar *socket_path)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    g_free (priv->socket_path);
+    if (socket_path != NULL)
+        priv->socket_path = g_strdup (socket_path);
+    else
+        priv->socket_path = g_strdup (SNAPD_SOCKET);
+}
+
+/**
+ * snapd_client_get_socket_path:
+ * @client: a #SnapdClient
+ *
+ * Get the unix socket path to connect to snapd with.
+ *
+ * Returns: socket path.
+ *
+ * Since: 1.24
+ */
+const gchar *
+snapd_client_get_socket_path (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
+    return priv->socket_path;
+}
+
+/**
+ * snapd_client_set_user_agent:
+ * @client: a #SnapdClient
+ * @user_agent: (allow-none): a user agent or %NULL.
+ *
+ * Set the HTTP user-agent that is sent with each request to snapd.
+ * Defaults to "snapd-glib/VERSION".
+ *
+ * Since: 1.16
+ */
+void
+snapd_client_set_user_agent (SnapdClient *self, const gchar *user_agent)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    g_free (priv->user_agent);
+    priv->user_agent = g_strdup (user_agent);
+}
+
+/**
+ * snapd_client_get_user_agent:
+ * @client: a #SnapdClient
+ *
+ * Get the HTTP user-agent that is sent with each request to snapd.
+ *
+ * Returns: (allow-none): user agent or %NULL if none set.
+ *
+ * Since: 1.16
+ */
+const gchar *
+snapd_client_get_user_agent (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
+    return priv->user_agent;
+}
+
+/**
+ * snapd_client_set_allow_interaction:
+ * @client: a #SnapdClient
+ * @allow_interaction: whether to allow interaction.
+ *
+ * Set whether snapd operations are allowed to interact with the user.
+ * This affects operations that use polkit authorisation.
+ * Defaults to TRUE.
+ *
+ * Since: 1.19
+ */
+void
+snapd_client_set_allow_interaction (SnapdClient *self, gboolean allow_interaction)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+    priv->allow_interaction = allow_interaction;
+}
+
+/**
+ * snapd_client_get_maintenance:
+ * @client: a #SnapdClient
+ *
+ * Get the maintenance information reported by snapd or %NULL if no maintenance is in progress.
+ * This information is updated after every request.
+ *
+ * Returns: (transfer none) (allow-none): a #SnapdMaintenance or %NULL.
+ *
+ * Since: 1.45
+ */
+SnapdMaintenance *
+snapd_client_get_maintenance (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
+    return priv->maintenance;
+}
+
+/**
+ * snapd_client_get_allow_interaction:
+ * @client: a #SnapdClient
+ *
+ * Get whether snapd operations are allowed to interact with the user.
+ *
+ * Returns: %TRUE if interaction is allowed.
+ *
+ * Since: 1.19
+ */
+gboolean
+snapd_client_get_allow_interaction (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    return priv->allow_interaction;
+}
+
+/**
+ * snapd_client_set_pipeline_depth:
+ * @client: a #SnapdClient
+ * @depth: maximum number of requests to send before waiting for a response or 0 for no limit.
+ *
+ * Set the maximum number of requests that are sent on each connection to snapd
+ * without having received a response. Requests made beyond this limit are queued and sent in
+ * order as responses are received. This stops a large number of requests from
+ * flooding snapd. Use snapd_client_set_max_queued_requests() to limit how many
+ * requests can be queued.
+ * Defaults to 0 (no limit).
+ *
+ * If the connection to snapd is lost before a response is received, requests
+ * that don't modify state are sent again on a new connection.
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_set_pipeline_depth (SnapdClient *self, guint depth)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+    priv->pipeline_depth = depth;
+
+    /* Send anything that now fits in the pipeline */
+    send_queued_requests_unlocked (self);
+}
+
+/**
+ * snapd_client_get_pipeline_depth:
+ * @client: a #SnapdClient
+ *
+ * Get the maximum number of requests that are sent on each connection to snapd
+ * without having received a response.
+ *
+ * Returns: the pipeline depth or 0 if there is no limit.
+ *
+ * Since: 1.59
+ */
+guint
+snapd_client_get_pipeline_depth (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), 0);
+    return priv->pipeline_depth;
+}
+
+/**
+ * snapd_client_set_max_queued_requests:
+ * @client: a #SnapdClient
+ * @max_queued_requests: maximum number of requests waiting to be sent or 0 for no limit.
+ *
+ * Set the maximum number of requests that can be waiting to be sent to snapd
+ * because the pipeline is full (see snapd_client_set_pipeline_depth()).
+ * Requests made when this many are waiting fail with %SNAPD_ERROR_QUEUE_FULL
+ * so the caller can make them again later. Requests that snapd-glib makes
+ * itself, such as polling the progress of changes, are not refused.
+ * Defaults to 0 (no limit).
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_set_max_queued_requests (SnapdClient *self, guint max_queued_requests)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+    priv->max_queued_requests = max_queued_requests;
+}
+
+/**
+ * snapd_client_get_max_queued_requests:
+ * @client: a #SnapdClient
+ *
+ * Get the maximum number of requests that can be waiting to be sent to snapd.
+ *
+ * Returns: the maximum number of queued requests or 0 if there is no limit.
+ *
+ * Since: 1.59
+ */
+guint
+snapd_client_get_max_queued_requests (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), 0);
+    return priv->max_queued_requests;
+}
+
+/**
+ * snapd_client_set_max_connections:
+ * @client: a #SnapdClient
+ * @max_connections: maximum number of connections to open to snapd or 0 for a connection per thread.
+ *
+ * Set the maximum number of connections that are opened to snapd. Requests are
+ * sent on the connection with the fewest outstanding requests, so slow
+ * requests (e.g. downloads) don't delay other requests.
+ * Connections are opened on demand.
+ * If set to 0, a connection is opened for each thread making requests so
+ * synchronous calls from different threads don't wait for each other. A
+ * connection left unused by one thread is reused by the next thread that needs one.
+ * Defaults to 1.
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_set_max_connections (SnapdClient *self, guint max_connections)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+    priv->max_connections = max_connections;
+
+    /* Send anything that can now use a new connection */
+    send_queued_requests_unlocked (self);
+}
+
+/**
+ * snapd_client_get_max_connections:
+ * @client: a #SnapdClient
+ *
+ * Get the maximum number of connections that are opened to snapd.
+ *
+ * Returns: the maximum number of connections or 0 if there is a connection per thread.
+ *
+ * Since: 1.59
+ */
+guint
+snapd_client_get_max_connections (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), 0);
+    return priv->max_connections;
+}
+
+/**
+ * snapd_client_set_connection_idle_timeout:
+ * @client: a #SnapdClient
+ * @timeout: number of seconds to keep an unused connection open or 0 to keep connections open.
+ *
+ * Set how long a connection to snapd is kept open when it has no outstanding
+ * requests. Connections are closed once this timeout is reached and reopened on demand.
+ * Defaults to 0 (connections are kept open).
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_set_connection_idle_timeout (SnapdClient *self, guint timeout)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+    priv->connection_idle_timeout = timeout;
+
+    /* Replace existing timeouts */
+    for (guint i = 0; i < priv->connections->len; i++) {
+        Connection *connection = g_ptr_array_index (priv->connections, i);
+        if (connection->idle_source != NULL)
+            g_source_destroy (connection->idle_source);
+        g_clear_pointer (&connection->idle_source, g_source_unref);
+    }
+    schedule_idle_timeouts_unlocked (self);
+}
+
+/**
+ * snapd_client_get_connection_idle_timeout:
+ * @client: a #SnapdClient
+ *
+ * Get how long a connection to snapd is kept open when it has no outstanding requests.
+ *
+ * Returns: timeout in seconds or 0 if connections are kept open.
+ *
+ * Since: 1.59
+ */
+guint
+snapd_client_get_connection_idle_timeout (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), 0);
+    return priv->connection_idle_timeout;
+}
+
+/**
+ * snapd_client_set_task_delta_callback:
+ * @client: a #SnapdClient
+ * @callback: (allow-none) (scope notified): function to call with the tasks that have changed or %NULL.
+ * @user_data: (closure): user data to pass to @callback.
+ * @destroy_notify: (allow-none): function to free @user_data when no longer required.
+ *
+ * Set a function to be called each time a change being followed by this client
+ * is updated. Only the tasks that were added or changed since the last update
+ * are passed, so a user interface showing many tasks can update just those rows.
+ * Changes are followed for each asynchronous request in progress, and by
+ * snapd_client_watch_change_async(). The callback is called once per update
+ * even if more than one request is following the change.
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_set_task_delta_callback (SnapdClient *self, SnapdTaskDeltaCallback callback, gpointer user_data, GDestroyNotify destroy_notify)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    GDestroyNotify old_destroy_notify;
+    gpointer old_data;
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+
+        old_destroy_notify = priv->task_delta_callback_destroy_notify;
+        old_data = priv->task_delta_callback_data;
+        priv->task_delta_callback = callback;
+        priv->task_delta_callback_data = user_data;
+        priv->task_delta_callback_destroy_notify = destroy_notify;
+
+        /* Report all tasks to the new callback */
+        GHashTableIter iter;
+        g_hash_table_iter_init (&iter, priv->change_watches);
+        ChangeWatch *watch;
+        while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &watch))
+            g_clear_object (&watch->last_change);
+    }
+
+    if (old_destroy_notify != NULL)
+        old_destroy_notify (old_data);
+}
+
+/**
+ * snapd_client_get_n_connections:
+ * @client: a #SnapdClient
+ *
+ * Get the number of connections currently in use to snapd.
+ * Use snapd_client_get_connection_stats() to get information on each connection.
+ *
+ * Returns: number of connections.
+ *
+ * Since: 1.59
+ */
+guint
+snapd_client_get_n_connections (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), 0);
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+    return priv->connections->len;
+}
+
+/**
+ * snapd_client_get_connection_stats:
+ * @client: a #SnapdClient
+ * @index: index of the connection, less than snapd_client_get_n_connections().
+ * @n_pending: (out) (allow-none): location to store the number of requests waiting for a response or %NULL.
+ * @n_requests: (out) (allow-none): location to store the number of requests sent or %NULL.
+ * @n_bytes_sent: (out) (allow-none): location to store the number of bytes sent or %NULL.
+ * @n_bytes_received: (out) (allow-none): location to store the number of bytes received or %NULL.
+ *
+ * Get usage statistics for a connection to snapd.
+ *
+ * Returns: %TRUE if @index is a valid connection.
+ *
+ * Since: 1.59
+ */
+gboolean
+snapd_client_get_connection_stats (SnapdClient *self, guint index,
+                                   guint *n_pending, guint64 *n_requests,
+                                   guint64 *n_bytes_sent, guint64 *n_bytes_received)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+    if (index >= priv->connections->len)
+        return FALSE;
+
+    Connection *connection = g_ptr_array_index (priv->connections, index);
+    if (n_pending != NULL)
+        *n_pending = connection->awaiting.length;
+    if (n_requests != NULL)
+        *n_requests = connection->n_requests;
+    if (n_bytes_sent != NULL)
+        *n_bytes_sent = connection->n_bytes_sent;
+    if (n_bytes_received != NULL)
+        *n_bytes_received = connection->n_bytes_received;
+
+    return TRUE;
+}
+
+/**
+ * snapd_client_set_parse_in_thread:
+ * @client: a #SnapdClient
+ * @parse_in_thread: %TRUE to parse responses in a separate thread.
+ *
+ * Set if responses from snapd are parsed in a separate thread. Large responses
+ * such as those from snapd_client_find_async() can take a noticeable time to
+ * parse, which will block a user interface running in the same main context.
+ * When enabled, only the parsed results are returned to the context the request
+ * was made from. Responses are still returned in the order they were received.
+ * Defaults to %FALSE.
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_set_parse_in_thread (SnapdClient *self, gboolean parse_in_thread)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    GThreadPool *pool = NULL;
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+        if (parse_in_thread && priv->parse_pool == NULL)
+            priv->parse_pool = g_thread_pool_new (parse_thread_cb, NULL, 1, FALSE, NULL);
+        else if (!parse_in_thread)
+            pool = g_steal_pointer (&priv->parse_pool);
+    }
+
+    /* Finish parsing any responses already received */
+    if (pool != NULL)
+        g_thread_pool_free (pool, FALSE, TRUE);
+}
+
+/**
+ * snapd_client_get_parse_in_thread:
+ * @client: a #SnapdClient
+ *
+ * Get if responses from snapd are parsed in a separate thread.
+ *
+ * Returns: %TRUE if responses are parsed in a separate thread.
+ *
+ * Since: 1.59
+ */
+gboolean
+snapd_client_get_parse_in_thread (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+    return priv->parse_pool != NULL;
+}
+
+/**
+ * snapd_client_set_lazy_snaps:
+ * @client: a #SnapdClient
+ * @lazy_snaps: %TRUE to parse the details of snaps when they are first used.
+ *
+ * Set if the apps, channels, media and prices of snaps returned by
+ * snapd_client_get_snaps_async(), snapd_client_find_async() and related calls
+ * are parsed when the snaps are returned or when they are first used. Callers
+ * that only use simple properties such as the name and version of many snaps
+ * can enable this to reduce the time to parse responses and the memory they
+ * use. The details are parsed when snapd_snap_get_apps(),
+ * snapd_snap_get_channels(), snapd_snap_get_media() or
+ * snapd_snap_get_prices() is first called for each snap.
+ * Defaults to %FALSE.
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_set_lazy_snaps (SnapdClient *self, gboolean lazy_snaps)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    priv->lazy_snaps = lazy_snaps;
+}
+
+/**
+ * snapd_client_get_lazy_snaps:
+ * @client: a #SnapdClient
+ *
+ * Get if the details of snaps are parsed when they are first used.
+ *
+ * Returns: %TRUE if snap details are parsed when first used.
+ *
+ * Since: 1.59
+ */
+gboolean
+snapd_client_get_lazy_snaps (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+
+    return priv->lazy_snaps;
+}
+
+/**
+ * snapd_client_set_response_cache_ttl:
+ * @client: a #SnapdClient
+ * @path: path of the snapd endpoint, e.g. "/v2/system-info".
+ * @ttl: number of seconds to reuse a response for or 0 to not cache responses.
+ *
+ * Set how long responses from a snapd endpoint are reused before asking snapd
+ * again. This allows information such as the system information or the list of
+ * installed snaps to be requested frequently without loading snapd. Only
+ * endpoints that don't change the system can be cached: "/v2/system-info",
+ * "/v2/sections", "/v2/interfaces", "/v2/connections", "/v2/aliases" and
+ * "/v2/snaps". Cached responses are dropped when a request that may change the
+ * system completes. Expired responses are revalidated with snapd if it supplied
+ * an ETag.
+ * Defaults to 0 for all endpoints (responses are not cached).
+ *
+ * Returns: %TRUE if responses from @path can be cached.
+ *
+ * Since: 1.59
+ */
+gboolean
+snapd_client_set_response_cache_ttl (SnapdClient *self, const gchar *path, guint ttl)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (path != NULL, FALSE);
+
+    return _snapd_response_cache_set_ttl (priv->response_cache, path, ttl);
+}
+
+/**
+ * snapd_client_get_response_cache_ttl:
+ * @client: a #SnapdClient
+ * @path: path of the snapd endpoint, e.g. "/v2/system-info".
+ *
+ * Get how long responses from a snapd endpoint are reused as set by
+ * snapd_client_set_response_cache_ttl().
+ *
+ * Returns: number of seconds or 0 if responses are not cached.
+ *
+ * Since: 1.59
+ */
+guint
+snapd_client_get_response_cache_ttl (SnapdClient *self, const gchar *path)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), 0);
+    g_return_val_if_fail (path != NULL, 0);
+
+    return _snapd_response_cache_get_ttl (priv->response_cache, path);
+}
+
+/**
+ * snapd_client_clear_response_cache:
+ * @client: a #SnapdClient
+ *
+ * Drop all cached responses, so the next requests are answered by snapd.
+ * Use this if the system may have been changed by another client.
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_clear_response_cache (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    _snapd_response_cache_clear (priv->response_cache);
+}
+
+/**
+ * snapd_client_get_response_cache_stats:
+ * @client: a #SnapdClient
+ * @n_hits: (out) (allow-none): location to store the number of requests answered from the cache or %NULL.
+ * @n_misses: (out) (allow-none): location to store the number of cacheable requests sent to snapd or %NULL.
+ * @n_revalidated: (out) (allow-none): location to store the number of expired responses snapd reported as unchanged or %NULL.
+ *
+ * Get statistics on the use of the response cache.
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_get_response_cache_stats (SnapdClient *self, guint64 *n_hits, guint64 *n_misses, guint64 *n_revalidated)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    _snapd_response_cache_get_stats (priv->response_cache, n_hits, n_misses, n_revalidated);
+}
+
+/**
+ * snapd_client_set_icon_cache_size:
+ * @client: a #SnapdClient
+ * @max_size: maximum number of bytes of icons to store or 0 to disable the cache.
+ *
+ * Set the amount of disk space to use to store icons returned by
+ * snapd_client_get_icon_sync(). When the cache is enabled, icons are stored
+ * for each snap revision and reused while that revision is installed. The
+ * installed revisions are learnt from snapd_client_get_snaps_sync(),
+ * snapd_client_get_snap_sync() and related calls, so icons are only taken
+ * from the cache after the snap has been listed. The least recently used
+ * icons are removed when the cache is full.
+ * Defaults to 0 (icons are not cached).
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_set_icon_cache_size (SnapdClient *self, guint64 max_size)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    _snapd_icon_cache_set_max_size (priv->icon_cache, max_size);
+}
+
+/**
+ * snapd_client_get_icon_cache_size:
+ * @client: a #SnapdClient
+ *
+ * Get the amount of disk space used to store icons.
+ *
+ * Returns: maximum number of bytes of icons to store or 0 if the cache is disabled.
+ *
+ * Since: 1.59
+ */
+guint64
+snapd_client_get_icon_cache_size (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), 0);
+
+    return _snapd_icon_cache_get_max_size (priv->icon_cache);
+}
+
+/**
+ * snapd_client_set_icon_cache_path:
+ * @client: a #SnapdClient
+ * @path: (allow-none): directory to store icons in or %NULL for the default.
+ *
+ * Set the directory to store icons in when the icon cache is enabled with
+ * snapd_client_set_icon_cache_size().
+ * Defaults to $XDG_CACHE_HOME/snapd-glib/icons.
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_set_icon_cache_path (SnapdClient *self, const gchar *path)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    _snapd_icon_cache_set_path (priv->icon_cache, path);
+}
+
+/**
+ * snapd_client_get_icon_cache_path:
+ * @client: a #SnapdClient
+ *
+ * Get the directory icons are stored in.
+ *
+ * Returns: a directory path.
+ *
+ * Since: 1.59
+ */
+const gchar *
+snapd_client_get_icon_cache_path (SnapdClient *self)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
 
-        n_sent += n_written;
-    }
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
 
-    return TRUE;
+    return _snapd_icon_cache_get_path (priv->icon_cache);
 }
 
-static void
-send_request (SnapdClient *self, SnapdRequest *request)
+/**
+ * snapd_client_get_icon_cache_stats:
+ * @client: a #SnapdClient
+ * @n_hits: (out) (allow-none): location to store the number of icons returned from the cache or %NULL.
+ * @n_misses: (out) (allow-none): location to store the number of icons requested from snapd or %NULL.
+ * @n_entries: (out) (allow-none): location to store the number of icons in the cache or %NULL.
+ * @size: (out) (allow-none): location to store the number of bytes used by the cache or %NULL.
+ *
+ * Get usage statistics for the icon cache.
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_get_icon_cache_stats (SnapdClient *self, guint64 *n_hits, guint64 *n_misses, guint *n_entries, guint64 *size)
 {
     SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
 
-    // NOTE: Would love to use libsoup but it doesn't support unix sockets
-    // https://bugzilla.gnome.org/show_bug.cgi?id=727563
-
-    _snapd_request_set_source_object (request, G_OBJECT (self));
-
-    g_autoptr(RequestData) data = request_data_new (self, request);
-    {
-        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
-        g_ptr_array_add (priv->requests, request_data_ref (data));
-    }
-
-    GCancellable *cancellable = _snapd_request_get_cancellable (request);
-    if (cancellable != NULL)
-        data->cancelled_id = g_cancellable_connect (cancellable, G_CALLBACK (request_cancelled_cb), request_data_new (self, request), (GDestroyNotify) request_data_unref);
-
-    SoupMessage *message = _snapd_request_get_message (request);
-    soup_message_headers_append (message->request_headers, "Host", "");
-    soup_message_headers_append (message->request_headers, "Connection", "keep-alive");
-    if (priv->user_agent != NULL)
-        soup_message_headers_append (message->request_headers, "User-Agent", priv->user_agent);
-    if (priv->allow_interaction)
-        soup_message_headers_append (message->request_headers, "X-Allow-Interaction", "true");
-
-    g_autofree gchar *accept_languages = get_accept_languages ();
-    soup_message_headers_append (message->request_headers, "Accept-Language", accept_languages);
-
-    if (priv->auth_data != NULL) {
-        g_autoptr(GString) authorization = g_string_new ("");
-        g_string_append_printf (authorization, "Macaroon root=\"%s\"", snapd_auth_data_get_macaroon (priv->auth_data));
-        GStrv discharges = snapd_auth_data_get_discharges (priv->auth_data);
-        if (discharges != NULL)
-            for (gsize i = 0; discharges[i] != NULL; i++)
-                g_string_append_printf (authorization, ",discharge=\"%s\"", discharges[i]);
-        soup_message_headers_append (message->request_headers, "Authorization", authorization->str);
-    }
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
 
-    g_autoptr(GByteArray) request_data = g_byte_array_new ();
-    append_string (request_data, message->method);
-    append_string (request_data, " ");
-    SoupURI *uri = soup_message_get_uri (message);
-    append_string (request_data, uri->path);
-    if (uri->query != NULL) {
-        append_string (request_data, "?");
-        append_string (request_data, uri->query);
-    }
-    append_string (request_data, " HTTP/1.1\r\n");
-    SoupMessageHeadersIter iter;
-    soup_message_headers_iter_init (&iter, message->request_headers);
-    const char *name, *value;
-    while (soup_message_headers_iter_next (&iter, &name, &value)) {
-        append_string (request_data, name);
-        append_string (request_data, ": ");
-        append_string (request_data, value);
-        append_string (request_data, "\r\n");
-    }
-    append_string (request_data, "\r\n");
+    _snapd_icon_cache_get_stats (priv->icon_cache, n_hits, n_misses, n_entries, size);
+}
 
-    g_autoptr(SoupBuffer) buffer = soup_message_body_flatten (message->request_body);
-    g_byte_array_append (request_data, (const guint8 *) buffer->data, buffer->length);
+/**
+ * snapd_client_login_async:
+ * @client: a #SnapdClient.
+ * @email: email address to log in with.
+ * @password: password to log in with.
+ * @otp: (allow-none): response to one-time password challenge.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
+ * @user_data: (closure): the data to pass to callback function.
+ *
+ * Asynchronously get authorization to install/remove snaps.
+ * See snapd_client_login_sync() for more information.
+ *
+ * Since: 1.0
+ * Deprecated: 1.26: Use snapd_client_login2_async()
+ */
+void
+snapd_client_login_async (SnapdClient *self,
+                          const gchar *email, const gchar *password, const gchar *otp,
+                          GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    snapd_client_login2_async (self, email, password, otp, cancellable, callback, user_data);
+}
 
-    gboolean new_socket = FALSE;
-    if (priv->snapd_socket == NULL) {
-        g_autoptr(GError) error = NULL;
-        priv->snapd_socket = open_snapd_socket (priv->socket_path, cancellable, &error);
-        if (priv->snapd_socket == NULL) {
-            complete_request (self, request, error);
-            return;
-        }
-        new_socket = TRUE;
-    }
+/**
+ * snapd_client_login_finish:
+ * @client: a #SnapdClient.
+ * @result: a #GAsyncResult.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Complete request started with snapd_client_login_async().
+ * See snapd_client_login_sync() for more information.
+ *
+ * Returns: (transfer full): a #SnapdAuthData or %NULL on error.
+ *
+ * Since: 1.0
+ * Deprecated: 1.26: Use snapd_client_login2_finish()
+ */
+SnapdAuthData *
+snapd_client_login_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
 
-    data->read_source = make_read_source (self, _snapd_request_get_context (request));
+    g_autoptr(SnapdUserInformation) user_information = snapd_client_login2_finish (self, result, error);
+    if (user_information == NULL)
+        return NULL;
 
-    /* send HTTP request */
-    g_autoptr(GError) error = NULL;
-    if (write_to_snapd (self, request_data, cancellable, &error))
-        return;
+    return g_object_ref (snapd_user_information_get_auth_data (user_information));
+}
 
-    /* If was re-using closed socket, then reconnect and retry */
-    if (!new_socket && g_error_matches (error, G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE)) {
-        g_clear_error (&error);
-        g_clear_object (&priv->snapd_socket);
-        g_source_destroy (data->read_source);
-        g_clear_pointer (&data->read_source, g_source_unref);
+/**
+ * snapd_client_login2_async:
+ * @client: a #SnapdClient.
+ * @email: email address to log in with.
+ * @password: password to log in with.
+ * @otp: (allow-none): response to one-time password challenge.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
+ * @user_data: (closure): the data to pass to callback function.
+ *
+ * Asynchronously get authorization to install/remove snaps.
+ * See snapd_client_login2_sync() for more information.
+ *
+ * Since: 1.26
+ */
+void
+snapd_client_login2_async (SnapdClient *self,
+                           const gchar *email, const gchar *password, const gchar *otp,
+                           GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
 
-        priv->snapd_socket = open_snapd_socket (priv->socket_path, cancellable, &error);
-        if (priv->snapd_socket == NULL) {
-            complete_request (self, request, error);
-            return;
-        }
+    g_autoptr(SnapdPostLogin) request = _snapd_post_login_new (email, password, otp, cancellable, callback, user_data);
+    send_request (self, SNAPD_REQUEST (request));
+}
 
-        data->read_source = make_read_source (self, _snapd_request_get_context (request));
+/**
+ * snapd_client_login2_finish:
+ * @client: a #SnapdClient.
+ * @result: a #GAsyncResult.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Complete request started with snapd_client_login2_async().
+ * See snapd_client_login2_sync() for more information.
+ *
+ * Returns: (transfer full): a #SnapdUserInformation or %NULL on error.
+ *
+ * Since: 1.26
+ */
+SnapdUserInformation *
+snapd_client_login2_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
+    g_return_val_if_fail (SNAPD_IS_POST_LOGIN (result), NULL);
 
-        if (write_to_snapd (self, request_data, cancellable, &error))
-            return;
-    }
+    SnapdPostLogin *request = SNAPD_POST_LOGIN (result);
 
-    g_autoptr(GError) e = g_error_new (SNAPD_ERROR,
-                                       SNAPD_ERROR_WRITE_FAILED,
-                                       "Failed to write to snapd: %s",
-                                       error->message);
-    complete_request (self, request, e);
+    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
+        return NULL;
+    return g_object_ref (_snapd_post_login_get_user_information (request));
 }
 
 /**
- * snapd_client_connect_async:
- * @client: a #SnapdClient
- * @cancellable: (allow-none): a #GCancellable or %NULL
+ * snapd_client_logout_async:
+ * @client: a #SnapdClient.
+ * @id: login ID to use.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * This method is no longer required and does nothing, snapd-glib now connects on demand.
+ * Asynchronously log out from the snap store.
+ * See snapd_client_logout_sync() for more information.
  *
- * Since: 1.3
- * Deprecated: 1.24
+ * Since: 1.55
  */
 void
-snapd_client_connect_async (SnapdClient *self,
-                            GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_logout_async (SnapdClient *self,
+                           gint64 id,
+                           GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
 
-    g_autoptr(GTask) task = g_task_new (self, cancellable, callback, user_data);
-    g_task_return_boolean (task, TRUE);
+    g_autoptr(SnapdPostLogout) request = _snapd_post_logout_new (id, cancellable, callback, user_data);
+    send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_connect_finish:
- * @client: a #SnapdClient
+ * snapd_client_logout_finish:
+ * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_connect_async().
- * See snapd_client_connect_sync() for more information.
+ * Complete request started with snapd_client_logout_async().
+ * See snapd_client_logout_sync() for more information.
  *
- * Returns: %TRUE if successfully connected to snapd.
+ * Returns: %TRUE on success or %FALSE on error.
  *
- * Since: 1.3
+ * Since: 1.55
  */
 gboolean
-snapd_client_connect_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+snapd_client_logout_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
     g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
-    g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
+    g_return_val_if_fail (SNAPD_IS_POST_LOGOUT (result), FALSE);
 
-    return g_task_propagate_boolean (G_TASK (result), error);
+    SnapdPostLogout *request = SNAPD_POST_LOGOUT (result);
+
+    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
+        return FALSE;
+    return TRUE;
 }
 
 /**
- * snapd_client_set_socket_path:
- * @client: a #SnapdClient
- * @socket_path: (allow-none): a socket path or %NULL to reset to the default.
+ * snapd_client_set_auth_data:
+ * @client: a #SnapdClient.
+ * @auth_data: (allow-none): a #SnapdAuthData or %NULL.
  *
- * Set the Unix socket path to connect to snapd with.
- * Defaults to the system socket.
+ * Set the authorization data to use for requests. Authorization data can be
+ * obtained by:
  *
- * Since: 1.24
+ * - Logging into snapd using snapd_client_login_sync()
+ *
+ * - Using an existing authorization with snapd_auth_data_new().
+ *
+ * Since: 1.0
  */
 void
-snapd_client_set_socket_path (SnapdClient *self, const gchar *socket_path)
+snapd_client_set_auth_data (SnapdClient *self, SnapdAuthData *auth_data)
 {
     SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
-
     g_return_if_fail (SNAPD_IS_CLIENT (self));
-
-    g_free (priv->socket_path);
-    if (socket_path != NULL)
-        priv->socket_path = g_strdup (socket_path);
-    else
-        priv->socket_path = g_strdup (SNAPD_SOCKET);
+    g_clear_object (&priv->auth_data);
+    if (auth_data != NULL)
+        priv->auth_data = g_object_ref (auth_data);
 }
 
 /**
- * snapd_client_get_socket_path:
- * @client: a #SnapdClient
+ * snapd_client_get_auth_data:
+ * @client: a #SnapdClient.
  *
- * Get the unix socket path to connect to snapd with.
+ * Get the authorization data that is used for requests.
  *
- * Returns: socket path.
+ * Returns: (transfer none) (allow-none): a #SnapdAuthData or %NULL.
  *
- * Since: 1.24
- */
-const gchar *
-snapd_client_get_socket_path (SnapdClient *self)
+ * Since: 1.0
+ */
+SnapdAuthData *
+snapd_client_get_auth_data (SnapdClient *self)
 {
     SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
     g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    return priv->socket_path;
+    return priv->auth_data;
 }
 
 /**
- * snapd_client_set_user_agent:
- * @client: a #SnapdClient
- * @user_agent: (allow-none): a user agent or %NULL.
+ * snapd_client_get_changes_async:
+ * @client: a #SnapdClient.
+ * @filter: changes to filter on.
+ * @snap_name: (allow-none): name of snap to filter on or %NULL for changes for any snap.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
+ * @user_data: (closure): the data to pass to callback function.
  *
- * Set the HTTP user-agent that is sent with each request to snapd.
- * Defaults to "snapd-glib/VERSION".
+ * Asynchronously get changes that have occurred / are occurring on the snap daemon.
+ * See snapd_client_get_changes_sync() for more information.
  *
- * Since: 1.16
+ * Since: 1.29
  */
 void
-snapd_client_set_user_agent (SnapdClient *self, const gchar *user_agent)
+snapd_client_get_changes_async (SnapdClient *self,
+                                SnapdChangeFilter filter, const gchar *snap_name,
+                                GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
-    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
-
     g_return_if_fail (SNAPD_IS_CLIENT (self));
 
-    g_free (priv->user_agent);
-    priv->user_agent = g_strdup (user_agent);
+    const gchar *select = NULL;
+    switch (filter)
+    {
+    case SNAPD_CHANGE_FILTER_ALL:
+        select = "all";
+        break;
+    case SNAPD_CHANGE_FILTER_IN_PROGRESS:
+        select = "in-progress";
+        break;
+    case SNAPD_CHANGE_FILTER_READY:
+        select = "ready";
+        break;
+    }
+
+    g_autoptr(SnapdGetChanges) request = _snapd_get_changes_new (select, snap_name, cancellable, callback, user_data);
+    send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_get_user_agent:
- * @client: a #SnapdClient
+ * snapd_client_get_changes_finish:
+ * @client: a #SnapdClient.
+ * @result: a #GAsyncResult.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Get the HTTP user-agent that is sent with each request to snapd.
+ * Complete request started with snapd_client_get_changes_async().
+ * See snapd_client_get_changes_sync() for more information.
  *
- * Returns: (allow-none): user agent or %NULL if none set.
+ * Returns: (transfer container) (element-type SnapdChange): an array of #SnapdChange or %NULL on error.
  *
- * Since: 1.16
+ * Since: 1.29
  */
-const gchar *
-snapd_client_get_user_agent (SnapdClient *self)
+GPtrArray *
+snapd_client_get_changes_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
-    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
     g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    return priv->user_agent;
+    g_return_val_if_fail (SNAPD_IS_GET_CHANGES (result), NULL);
+
+    SnapdGetChanges *request = SNAPD_GET_CHANGES (result);
+
+    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
+        return NULL;
+    return g_ptr_array_ref (_snapd_get_changes_get_changes (request));
 }
 
 /**
- * snapd_client_set_allow_interaction:
- * @client: a #SnapdClient
- * @allow_interaction: whether to allow interaction.
+ * snapd_client_get_change_async:
+ * @client: a #SnapdClient.
+ * @id: a change ID to get information on.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
+ * @user_data: (closure): the data to pass to callback function.
  *
- * Set whether snapd operations are allowed to interact with the user.
- * This affects operations that use polkit authorisation.
- * Defaults to TRUE.
+ * Asynchronously get information on a change.
+ * See snapd_client_get_change_sync() for more information.
  *
- * Since: 1.19
+ * Since: 1.29
  */
 void
-snapd_client_set_allow_interaction (SnapdClient *self, gboolean allow_interaction)
+snapd_client_get_change_async (SnapdClient *self,
+                               const gchar *id,
+                               GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
-    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
     g_return_if_fail (SNAPD_IS_CLIENT (self));
-    priv->allow_interaction = allow_interaction;
+    g_return_if_fail (id != NULL);
+
+    g_autoptr(SnapdGetChange) request = _snapd_get_change_new (id, cancellable, callback, user_data);
+    send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_get_maintenance:
- * @client: a #SnapdClient
+ * snapd_client_get_change_finish:
+ * @client: a #SnapdClient.
+ * @result: a #GAsyncResult.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Get the maintenance information reported by snapd or %NULL if no maintenance is in progress.
- * This information is updated after every request.
+ * Complete request started with snapd_client_get_change_async().
+ * See snapd_client_get_change_sync() for more information.
  *
- * Returns: (transfer none) (allow-none): a #SnapdMaintenance or %NULL.
+ * Returns: (transfer full): a #SnapdChange or %NULL on error.
  *
- * Since: 1.45
+ * Since: 1.29
  */
-SnapdMaintenance *
-snapd_client_get_maintenance (SnapdClient *self)
+SnapdChange *
+snapd_client_get_change_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
-    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
     g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    return priv->maintenance;
-}
+    g_return_val_if_fail (SNAPD_IS_GET_CHANGE (result), NULL);
 
-/**
- * snapd_client_get_allow_interaction:
- * @client: a #SnapdClient
- *
- * Get whether snapd operations are allowed to interact with the user.
- *
- * Returns: %TRUE if interaction is allowed.
- *
- * Since: 1.19
- */
-gboolean
-snapd_client_get_allow_interaction (SnapdClient *self)
-{
-    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
-    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
-    return priv->allow_interaction;
+    SnapdGetChange *request = SNAPD_GET_CHANGE (result);
+
+    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
+        return NULL;
+    return g_object_ref (_snapd_get_change_get_change (request));
 }
 
 /**
- * snapd_client_login_async:
+ * snapd_client_abort_change_async:
  * @client: a #SnapdClient.
- * @email: email address to log in with.
- * @password: password to log in with.
- * @otp: (allow-none): response to one-time password challenge.
+ * @id: a change ID to abort.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously get authorization to install/remove snaps.
- * See snapd_client_login_sync() for more information.
+ * Asynchronously abort a change.
+ * See snapd_client_abort_change_sync() for more information.
  *
- * Since: 1.0
- * Deprecated: 1.26: Use snapd_client_login2_async()
+ * Since: 1.30
  */
 void
-snapd_client_login_async (SnapdClient *self,
-                          const gchar *email, const gchar *password, const gchar *otp,
-                          GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_abort_change_async (SnapdClient *self,
+                                 const gchar *id,
+                                 GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
-    snapd_client_login2_async (self, email, password, otp, cancellable, callback, user_data);
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+    g_return_if_fail (id != NULL);
+
+    g_autoptr(SnapdPostChange) request = _snapd_post_change_new (id, "abort", cancellable, callback, user_data);
+    send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_login_finish:
+ * snapd_client_abort_change_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_login_async().
- * See snapd_client_login_sync() for more information.
+ * Complete request started with snapd_client_abort_change_async().
+ * See snapd_client_abort_change_sync() for more information.
  *
- * Returns: (transfer full): a #SnapdAuthData or %NULL on error.
+ * Returns: (transfer full): a #SnapdChange or %NULL on error.
  *
- * Since: 1.0
- * Deprecated: 1.26: Use snapd_client_login2_finish()
+ * Since: 1.30
  */
-SnapdAuthData *
-snapd_client_login_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+SnapdChange *
+snapd_client_abort_change_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
     g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
+    g_return_val_if_fail (SNAPD_IS_POST_CHANGE (result), NULL);
 
-    g_autoptr(SnapdUserInformation) user_information = snapd_client_login2_finish (self, result, error);
-    if (user_information == NULL)
-        return NULL;
+    SnapdPostChange *request = SNAPD_POST_CHANGE (result);
 
-    return g_object_ref (snapd_user_information_get_auth_data (user_information));
+    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
+        return NULL;
+    return g_object_ref (_snapd_post_change_get_change (request));
 }
 
 /**
- * snapd_client_login2_async:
+ * snapd_client_watch_change_async:
  * @client: a #SnapdClient.
- * @email: email address to log in with.
- * @password: password to log in with.
- * @otp: (allow-none): response to one-time password challenge.
+ * @id: a change ID to follow.
+ * @progress_callback: (allow-none) (scope call): function to callback with progress.
+ * @progress_callback_data: (closure): user data to pass to @progress_callback.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously get authorization to install/remove snaps.
- * See snapd_client_login2_sync() for more information.
+ * Asynchronously follow a change until it completes.
+ * See snapd_client_watch_change_sync() for more information.
  *
- * Since: 1.26
+ * Since: 1.59
  */
 void
-snapd_client_login2_async (SnapdClient *self,
-                           const gchar *email, const gchar *password, const gchar *otp,
-                           GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_watch_change_async (SnapdClient *self,
+                                 const gchar *id,
+                                 SnapdProgressCallback progress_callback, gpointer progress_callback_data,
+                                 GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
+    g_return_if_fail (id != NULL);
 
-    g_autoptr(SnapdPostLogin) request = _snapd_post_login_new (email, password, otp, cancellable, callback, user_data);
+    g_autoptr(SnapdWatchChange) request = _snapd_watch_change_new (id, progress_callback, progress_callback_data, cancellable, callback, user_data);
     send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_login2_finish:
+ * snapd_client_watch_change_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_login2_async().
- * See snapd_client_login2_sync() for more information.
+ * Complete request started with snapd_client_watch_change_async().
+ * See snapd_client_watch_change_sync() for more information.
  *
- * Returns: (transfer full): a #SnapdUserInformation or %NULL on error.
+ * Returns: (transfer full): a #SnapdChange or %NULL on error.
  *
- * Since: 1.26
+ * Since: 1.59
  */
-SnapdUserInformation *
-snapd_client_login2_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+SnapdChange *
+snapd_client_watch_change_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
     g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    g_return_val_if_fail (SNAPD_IS_POST_LOGIN (result), NULL);
+    g_return_val_if_fail (SNAPD_IS_WATCH_CHANGE (result), NULL);
 
-    SnapdPostLogin *request = SNAPD_POST_LOGIN (result);
+    SnapdWatchChange *request = SNAPD_WATCH_CHANGE (result);
 
     if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
         return NULL;
-    return g_object_ref (_snapd_post_login_get_user_information (request));
+    return g_object_ref (_snapd_request_async_get_change (SNAPD_REQUEST_ASYNC (request)));
 }
 
 /**
- * snapd_client_logout_async:
+ * snapd_client_get_system_information_async:
  * @client: a #SnapdClient.
- * @id: login ID to use.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously log out from the snap store.
- * See snapd_client_logout_sync() for more information.
+ * Request system information asynchronously from snapd.
+ * See snapd_client_get_system_information_sync() for more information.
  *
- * Since: 1.55
+ * Since: 1.0
  */
 void
-snapd_client_logout_async (SnapdClient *self,
-                           gint64 id,
-                           GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_get_system_information_async (SnapdClient *self,
+                                           GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
 
-    g_autoptr(SnapdPostLogout) request = _snapd_post_logout_new (id, cancellable, callback, user_data);
+    g_autoptr(SnapdGetSystemInfo) request = _snapd_get_system_info_new (cancellable, callback, user_data);
     send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_logout_finish:
+ * snapd_client_get_system_information_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_logout_async().
- * See snapd_client_logout_sync() for more information.
+ * Complete request started with snapd_client_get_system_information_async().
+ * See snapd_client_get_system_information_sync() for more information.
  *
- * Returns: %TRUE on success or %FALSE on error.
+ * Returns: (transfer full): a #SnapdSystemInformation or %NULL on error.
  *
- * Since: 1.55
+ * Since: 1.0
  */
-gboolean
-snapd_client_logout_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+SnapdSystemInformation *
+snapd_client_get_system_information_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
-    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
-    g_return_val_if_fail (SNAPD_IS_POST_LOGOUT (result), FALSE);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
+    g_return_val_if_fail (SNAPD_IS_GET_SYSTEM_INFO (result), NULL);
 
-    SnapdPostLogout *request = SNAPD_POST_LOGOUT (result);
+    SnapdGetSystemInfo *request = SNAPD_GET_SYSTEM_INFO (result);
 
     if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
-        return FALSE;
-    return TRUE;
+        return NULL;
+    return g_object_ref (_snapd_get_system_info_get_system_information (request));
 }
 
 /**
- * snapd_client_set_auth_data:
+ * snapd_client_list_one_async:
  * @client: a #SnapdClient.
- * @auth_data: (allow-none): a #SnapdAuthData or %NULL.
- *
- * Set the authorization data to use for requests. Authorization data can be
- * obtained by:
- *
- * - Logging into snapd using snapd_client_login_sync()
+ * @name: name of snap to get.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
+ * @user_data: (closure): the data to pass to callback function.
  *
- * - Using an existing authorization with snapd_auth_data_new().
+ * Asynchronously get information of a single installed snap.
+ * See snapd_client_list_one_sync() for more information.
  *
  * Since: 1.0
+ * Deprecated: 1.42: Use snapd_client_get_snap_async()
  */
 void
-snapd_client_set_auth_data (SnapdClient *self, SnapdAuthData *auth_data)
+snapd_client_list_one_async (SnapdClient *self,
+                             const gchar *name,
+                             GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
-    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
-    g_return_if_fail (SNAPD_IS_CLIENT (self));
-    g_clear_object (&priv->auth_data);
-    if (auth_data != NULL)
-        priv->auth_data = g_object_ref (auth_data);
+    return snapd_client_get_snap_async (self, name, cancellable, callback, user_data);
 }
 
 /**
- * snapd_client_get_auth_data:
+ * snapd_client_list_one_finish:
  * @client: a #SnapdClient.
+ * @result: a #GAsyncResult.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Get the authorization data that is used for requests.
+ * Complete request started with snapd_client_list_one_async().
+ * See snapd_client_list_one_sync() for more information.
  *
- * Returns: (transfer none) (allow-none): a #SnapdAuthData or %NULL.
+ * Returns: (transfer full): a #SnapdSnap or %NULL on error.
  *
  * Since: 1.0
+ * Deprecated: 1.42: Use snapd_client_get_snap_finish()
  */
-SnapdAuthData *
-snapd_client_get_auth_data (SnapdClient *self)
+SnapdSnap *
+snapd_client_list_one_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
-    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
-    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    return priv->auth_data;
+    return snapd_client_get_snap_finish (self, result, error);
 }
 
 /**
- * snapd_client_get_changes_async:
+ * snapd_client_get_snap_async:
  * @client: a #SnapdClient.
- * @filter: changes to filter on.
- * @snap_name: (allow-none): name of snap to filter on or %NULL for changes for any snap.
+ * @name: name of snap to get.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously get changes that have occurred / are occurring on the snap daemon.
- * See snapd_client_get_changes_sync() for more information.
+ * Asynchronously get information of a single installed snap.
+ * See snapd_client_get_snap_sync() for more information.
  *
- * Since: 1.29
+ * Since: 1.42
  */
 void
-snapd_client_get_changes_async (SnapdClient *self,
-                                SnapdChangeFilter filter, const gchar *snap_name,
-                                GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_get_snap_async (SnapdClient *self,
+                             const gchar *name,
+                             GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
 
-    const gchar *select = NULL;
-    switch (filter)
-    {
-    case SNAPD_CHANGE_FILTER_ALL:
-        select = "all";
-        break;
-    case SNAPD_CHANGE_FILTER_IN_PROGRESS:
-        select = "in-progress";
-        break;
-    case SNAPD_CHANGE_FILTER_READY:
-        select = "ready";
-        break;
-    }
-
-    g_autoptr(SnapdGetChanges) request = _snapd_get_changes_new (select, snap_name, cancellable, callback, user_data);
+    g_autoptr(SnapdGetSnap) request = _snapd_get_snap_new (name, cancellable, callback, user_data);
     send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_get_changes_finish:
+ * snapd_client_get_snap_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_get_changes_async().
- * See snapd_client_get_changes_sync() for more information.
+ * Complete request started with snapd_client_get_snap_async().
+ * See snapd_client_get_snap_sync() for more information.
  *
- * Returns: (transfer container) (element-type SnapdChange): an array of #SnapdChange or %NULL on error.
+ * Returns: (transfer full): a #SnapdSnap or %NULL on error.
  *
- * Since: 1.29
+ * Since: 1.42
  */
-GPtrArray *
-snapd_client_get_changes_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+SnapdSnap *
+snapd_client_get_snap_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
     g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    g_return_val_if_fail (SNAPD_IS_GET_CHANGES (result), NULL);
+    g_return_val_if_fail (SNAPD_IS_GET_SNAP (result), NULL);
 
-    SnapdGetChanges *request = SNAPD_GET_CHANGES (result);
+    SnapdGetSnap *request = SNAPD_GET_SNAP (result);
 
     if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
         return NULL;
-    return g_ptr_array_ref (_snapd_get_changes_get_changes (request));
+    return g_object_ref (_snapd_get_snap_get_snap (request));
 }
 
 /**
- * snapd_client_get_change_async:
+ * snapd_client_get_snap_conf_async:
  * @client: a #SnapdClient.
- * @id: a change ID to get information on.
+ * @name: name of snap to get configuration from.
+ * @keys: (allow-none): keys to returns or %NULL to return all.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously get information on a change.
- * See snapd_client_get_change_sync() for more information.
+ * Asynchronously get configuration for a snap.
+ * See snapd_client_get_snap_conf_sync() for more information.
  *
- * Since: 1.29
+ * Since: 1.48
  */
 void
-snapd_client_get_change_async (SnapdClient *self,
-                               const gchar *id,
-                               GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_get_snap_conf_async (SnapdClient *self,
+                                  const gchar *name,
+                                  GStrv keys,
+                                  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
-    g_return_if_fail (id != NULL);
+    g_return_if_fail (name != NULL);
 
-    g_autoptr(SnapdGetChange) request = _snapd_get_change_new (id, cancellable, callback, user_data);
+    g_autoptr(SnapdGetSnapConf) request = _snapd_get_snap_conf_new (name, keys, cancellable, callback, user_data);
     send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_get_change_finish:
+ * snapd_client_get_snap_conf_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_get_change_async().
- * See snapd_client_get_change_sync() for more information.
+ * Complete request started with snapd_client_get_snap_conf_async().
+ * See snapd_client_get_snap_conf_sync() for more information.
  *
- * Returns: (transfer full): a #SnapdChange or %NULL on error.
+ * Returns: (transfer container) (element-type utf8 GVariant): a table of configuration values or %NULL on error.
  *
- * Since: 1.29
+ * Since: 1.48
  */
-SnapdChange *
-snapd_client_get_change_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+GHashTable *
+snapd_client_get_snap_conf_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
     g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    g_return_val_if_fail (SNAPD_IS_GET_CHANGE (result), NULL);
+    g_return_val_if_fail (SNAPD_IS_GET_SNAP_CONF (result), NULL);
 
-    SnapdGetChange *request = SNAPD_GET_CHANGE (result);
+    SnapdGetSnapConf *request = SNAPD_GET_SNAP_CONF (result);
 
     if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
         return NULL;
-    return g_object_ref (_snapd_get_change_get_change (request));
+    return g_hash_table_ref (_snapd_get_snap_conf_get_conf (request));
 }
 
 /**
- * snapd_client_abort_change_async:
+ * snapd_client_set_snap_conf_async:
  * @client: a #SnapdClient.
- * @id: a change ID to abort.
+ * @name: name of snap to set configuration for.
+ * @key_values: (element-type utf8 GVariant): Keys to set.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously abort a change.
- * See snapd_client_abort_change_sync() for more information.
+ * Asynchronously set configuration for a snap.
+ * See snapd_client_set_snap_conf_sync() for more information.
  *
- * Since: 1.30
+ * Since: 1.48
  */
 void
-snapd_client_abort_change_async (SnapdClient *self,
-                                 const gchar *id,
-                                 GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_set_snap_conf_async (SnapdClient *self,
+                                  const gchar *name,
+                                  GHashTable *key_values,
+                                  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
-    g_return_if_fail (id != NULL);
+    g_return_if_fail (name != NULL);
+    g_return_if_fail (key_values != NULL);
 
-    g_autoptr(SnapdPostChange) request = _snapd_post_change_new (id, "abort", cancellable, callback, user_data);
+    g_autoptr(SnapdPutSnapConf) request = _snapd_put_snap_conf_new (name, key_values, cancellable, callback, user_data);
     send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_abort_change_finish:
+ * snapd_client_set_snap_conf_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_abort_change_async().
- * See snapd_client_abort_change_sync() for more information.
+ * Complete request started with snapd_client_set_snap_conf_async().
+ * See snapd_client_set_snap_conf_sync() for more information.
  *
- * Returns: (transfer full): a #SnapdChange or %NULL on error.
+ * Returns: %TRUE if configuration successfully applied.
  *
- * Since: 1.30
+ * Since: 1.48
  */
-SnapdChange *
-snapd_client_abort_change_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+gboolean
+snapd_client_set_snap_conf_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
-    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    g_return_val_if_fail (SNAPD_IS_POST_CHANGE (result), NULL);
-
-    SnapdPostChange *request = SNAPD_POST_CHANGE (result);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (SNAPD_IS_PUT_SNAP_CONF (result), FALSE);
 
-    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
-        return NULL;
-    return g_object_ref (_snapd_post_change_get_change (request));
+    return _snapd_request_propagate_error (SNAPD_REQUEST (result), error);
 }
 
 /**
- * snapd_client_get_system_information_async:
+ * snapd_client_get_apps_async:
  * @client: a #SnapdClient.
+ * @flags: a set of #SnapdGetAppsFlags to control what results are returned.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Request system information asynchronously from snapd.
- * See snapd_client_get_system_information_sync() for more information.
+ * Asynchronously get information on installed apps.
+ * See snapd_client_get_apps_sync() for more information.
  *
- * Since: 1.0
+ * Since: 1.25
+ * Deprecated: 1.45: Use snapd_client_get_apps2_async()
  */
 void
-snapd_client_get_system_information_async (SnapdClient *self,
-                                           GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_get_apps_async (SnapdClient *self,
+                             SnapdGetAppsFlags flags,
+                             GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
-    g_return_if_fail (SNAPD_IS_CLIENT (self));
-
-    g_autoptr(SnapdGetSystemInfo) request = _snapd_get_system_info_new (cancellable, callback, user_data);
-    send_request (self, SNAPD_REQUEST (request));
+    return snapd_client_get_apps2_async (self, flags, NULL, cancellable, callback, user_data);
 }
 
 /**
- * snapd_client_get_system_information_finish:
+ * snapd_client_get_apps_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_get_system_information_async().
- * See snapd_client_get_system_information_sync() for more information.
+ * Complete request started with snapd_client_get_apps_async().
+ * See snapd_client_get_apps_sync() for more information.
  *
- * Returns: (transfer full): a #SnapdSystemInformation or %NULL on error.
+ * Returns: (transfer container) (element-type SnapdApp): an array of #SnapdApp or %NULL on error.
  *
- * Since: 1.0
+ * Since: 1.25
+ * Deprecated: 1.45: Use snapd_client_get_apps2_finish()
  */
-SnapdSystemInformation *
-snapd_client_get_system_information_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+GPtrArray *
+snapd_client_get_apps_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
-    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    g_return_val_if_fail (SNAPD_IS_GET_SYSTEM_INFO (result), NULL);
-
-    SnapdGetSystemInfo *request = SNAPD_GET_SYSTEM_INFO (result);
-
-    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
-        return NULL;
-    return g_object_ref (_snapd_get_system_info_get_system_information (request));
+    return snapd_client_get_apps2_finish (self, result, error);
 }
 
 /**
- * snapd_client_list_one_async:
+ * snapd_client_get_apps2_async:
  * @client: a #SnapdClient.
- * @name: name of snap to get.
+ * @flags: a set of #SnapdGetAppsFlags to control what results are returned.
+ * @snaps: (allow-none): A list of snap names to return results for. If %NULL or empty then apps for all installed snaps are returned.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously get information of a single installed snap.
- * See snapd_client_list_one_sync() for more information.
+ * Asynchronously get information on installed apps.
+ * See snapd_client_get_apps2_sync() for more information.
  *
- * Since: 1.0
- * Deprecated: 1.42: Use snapd_client_get_snap_async()
+ * Since: 1.45
  */
 void
-snapd_client_list_one_async (SnapdClient *self,
-                             const gchar *name,
-                             GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_get_apps2_async (SnapdClient *self,
+                              SnapdGetAppsFlags flags,
+                              GStrv snaps,
+                              GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
-    return snapd_client_get_snap_async (self, name, cancellable, callback, user_data);
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    g_autoptr(SnapdGetApps) request = _snapd_get_apps_new (snaps, cancellable, callback, user_data);
+    if ((flags & SNAPD_GET_APPS_FLAGS_SELECT_SERVICES) != 0)
+        _snapd_get_apps_set_select (request, "service");
+    send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_list_one_finish:
+ * snapd_client_get_apps2_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_list_one_async().
- * See snapd_client_list_one_sync() for more information.
+ * Complete request started with snapd_client_get_apps2_async().
+ * See snapd_client_get_apps2_sync() for more information.
  *
- * Returns: (transfer full): a #SnapdSnap or %NULL on error.
+ * Returns: (transfer container) (element-type SnapdApp): an array of #SnapdApp or %NULL on error.
  *
- * Since: 1.0
- * Deprecated: 1.42: Use snapd_client_get_snap_finish()
+ * Since: 1.45
  */
-SnapdSnap *
-snapd_client_list_one_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+GPtrArray *
+snapd_client_get_apps2_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
-    return snapd_client_get_snap_finish (self, result, error);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
+    g_return_val_if_fail (SNAPD_IS_GET_APPS (result), NULL);
+
+    SnapdGetApps *request = SNAPD_GET_APPS (result);
+
+    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
+        return NULL;
+    return g_ptr_array_ref (_snapd_get_apps_get_apps (request));
 }
 
 /**
- * snapd_client_get_snap_async:
+ * snapd_client_get_icon_async:
  * @client: a #SnapdClient.
- * @name: name of snap to get.
+ * @name: name of snap to get icon for.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously get information of a single installed snap.
- * See snapd_client_get_snap_sync() for more information.
+ * Asynchronously get the icon for an installed snap.
+ * See snapd_client_get_icon_sync() for more information.
  *
- * Since: 1.42
+ * Since: 1.0
  */
 void
-snapd_client_get_snap_async (SnapdClient *self,
+snapd_client_get_icon_async (SnapdClient *self,
                              const gchar *name,
                              GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
 
-    g_autoptr(SnapdGetSnap) request = _snapd_get_snap_new (name, cancellable, callback, user_data);
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    g_autoptr(SnapdGetIcon) request = _snapd_get_icon_new (name, cancellable, callback, user_data);
+
+    /* Use the cached icon if it is for the installed revision */
+    g_autofree gchar *revision = _snapd_icon_cache_get_revision (priv->icon_cache, name);
+    g_autoptr(SnapdIcon) icon = _snapd_icon_cache_lookup (priv->icon_cache, name, revision);
+    if (icon != NULL) {
+        _snapd_get_icon_set_icon (request, icon);
+        _snapd_request_set_source_object (SNAPD_REQUEST (request), G_OBJECT (self));
+        _snapd_request_return (SNAPD_REQUEST (request), NULL);
+        return;
+    }
+
+    _snapd_get_icon_set_revision (request, revision);
     send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_get_snap_finish:
+ * snapd_client_get_icon_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_get_snap_async().
- * See snapd_client_get_snap_sync() for more information.
+ * Complete request started with snapd_client_get_icon_async().
+ * See snapd_client_get_icon_sync() for more information.
  *
- * Returns: (transfer full): a #SnapdSnap or %NULL on error.
+ * Returns: (transfer full): a #SnapdIcon or %NULL on error.
  *
- * Since: 1.42
+ * Since: 1.0
  */
-SnapdSnap *
-snapd_client_get_snap_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+SnapdIcon *
+snapd_client_get_icon_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
     g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    g_return_val_if_fail (SNAPD_IS_GET_SNAP (result), NULL);
+    g_return_val_if_fail (SNAPD_IS_GET_ICON (result), NULL);
 
-    SnapdGetSnap *request = SNAPD_GET_SNAP (result);
+    SnapdGetIcon *request = SNAPD_GET_ICON (result);
 
     if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
         return NULL;
-    return g_object_ref (_snapd_get_snap_get_snap (request));
+    return g_object_ref (_snapd_get_icon_get_icon (request));
+}
+
+/* Default number of icons to request from snapd at once */
+#define DEFAULT_MAX_ICON_FETCHES 4
+
+/* An icon being requested for one or more snapd_client_get_icons_async() calls */
+typedef struct
+{
+    SnapdClient *client;
+    gchar *key;
+    gchar *name;
+
+    /* Tasks waiting for this icon */
+    GPtrArray *tasks;
+} IconFetch;
+
+typedef struct
+{
+    GStrv names;
+    guint next_name;
+    guint n_active;
+    guint max_active;
+    SnapdIconCallback icon_callback;
+    gpointer icon_callback_data;
+} GetIconsData;
+
+static void
+icon_fetch_free (IconFetch *fetch)
+{
+    g_free (fetch->key);
+    g_free (fetch->name);
+    g_ptr_array_unref (fetch->tasks);
+    g_slice_free (IconFetch, fetch);
+}
+
+static void
+get_icons_data_free (GetIconsData *data)
+{
+    g_strfreev (data->names);
+    g_slice_free (GetIconsData, data);
+}
+
+static void fetch_icon (SnapdClient *self, const gchar *name, GTask *task);
+
+/* Start fetching icons until the limit is reached, and complete once all are done */
+static void
+fetch_icons (GTask *task)
+{
+    SnapdClient *self = g_task_get_source_object (task);
+    GetIconsData *data = g_task_get_task_data (task);
+
+    while (data->n_active < data->max_active && data->names[data->next_name] != NULL &&
+           !g_cancellable_is_cancelled (g_task_get_cancellable (task))) {
+        const gchar *name = data->names[data->next_name];
+        data->next_name++;
+        data->n_active++;
+        fetch_icon (self, name, task);
+    }
+
+    if (data->n_active == 0 && !g_task_return_error_if_cancelled (task))
+        g_task_return_boolean (task, TRUE);
+}
+
+static void
+icon_fetch_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    IconFetch *fetch = user_data;
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (fetch->client);
+
+    g_autoptr(GError) error = NULL;
+    g_autoptr(SnapdIcon) icon = snapd_client_get_icon_finish (SNAPD_CLIENT (object), result, &error);
+
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+        g_hash_table_remove (priv->icon_fetches, fetch->key);
+    }
+
+    for (guint i = 0; i < fetch->tasks->len; i++) {
+        GTask *task = g_ptr_array_index (fetch->tasks, i);
+        GetIconsData *data = g_task_get_task_data (task);
+
+        data->n_active--;
+        if (data->icon_callback != NULL && !g_cancellable_is_cancelled (g_task_get_cancellable (task)))
+            data->icon_callback (fetch->client, fetch->name, icon, error, data->icon_callback_data);
+        fetch_icons (task);
+    }
+
+    icon_fetch_free (fetch);
+}
+
+/* Request an icon, sharing the request if the same icon is already being fetched in this context */
+static void
+fetch_icon (SnapdClient *self, const gchar *name, GTask *task)
+{
+    SnapdClientPrivate *priv = snapd_client_get_instance_private (self);
+
+    GMainContext *context = g_main_context_get_thread_default ();
+    if (context == NULL)
+        context = g_main_context_default ();
+    g_autofree gchar *key = g_strdup_printf ("%p:%s", (gpointer) context, name);
+
+    IconFetch *fetch;
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->requests_mutex);
+
+        fetch = g_hash_table_lookup (priv->icon_fetches, key);
+        if (fetch != NULL) {
+            g_ptr_array_add (fetch->tasks, g_object_ref (task));
+            return;
+        }
+
+        fetch = g_slice_new0 (IconFetch);
+        fetch->client = self;
+        fetch->key = g_steal_pointer (&key);
+        fetch->name = g_strdup (name);
+        fetch->tasks = g_ptr_array_new_with_free_func (g_object_unref);
+        g_ptr_array_add (fetch->tasks, g_object_ref (task));
+        g_hash_table_insert (priv->icon_fetches, fetch->key, fetch);
+    }
+
+    snapd_client_get_icon_async (self, name, NULL, icon_fetch_cb, fetch);
 }
 
 /**
- * snapd_client_get_snap_conf_async:
+ * snapd_client_get_icons_async:
  * @client: a #SnapdClient.
- * @name: name of snap to get configuration from.
- * @keys: (allow-none): keys to returns or %NULL to return all.
+ * @names: a list of snap names to get icons for.
+ * @max_requests: maximum number of icons to request at once or 0 for the default.
+ * @icon_callback: (scope async): function to callback with each icon.
+ * @icon_callback_data: (closure): user data to pass to @icon_callback.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously get configuration for a snap.
- * See snapd_client_get_snap_conf_sync() for more information.
+ * Asynchronously get the icons for installed snaps.
+ * See snapd_client_get_icons_sync() for more information.
  *
- * Since: 1.48
+ * Since: 1.59
  */
 void
-snapd_client_get_snap_conf_async (SnapdClient *self,
-                                  const gchar *name,
-                                  GStrv keys,
-                                  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_get_icons_async (SnapdClient *self,
+                              GStrv names, guint max_requests,
+                              SnapdIconCallback icon_callback, gpointer icon_callback_data,
+                              GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
-    g_return_if_fail (name != NULL);
+    g_return_if_fail (names != NULL);
 
-    g_autoptr(SnapdGetSnapConf) request = _snapd_get_snap_conf_new (name, keys, cancellable, callback, user_data);
-    send_request (self, SNAPD_REQUEST (request));
+    g_autoptr(GTask) task = g_task_new (self, cancellable, callback, user_data);
+
+    /* Only request each icon once */
+    g_autoptr(GHashTable) seen = g_hash_table_new (g_str_hash, g_str_equal);
+    g_autoptr(GPtrArray) unique_names = g_ptr_array_new ();
+    for (int i = 0; names[i] != NULL; i++) {
+        if (g_hash_table_contains (seen, names[i]))
+            continue;
+        g_hash_table_add (seen, names[i]);
+        g_ptr_array_add (unique_names, g_strdup (names[i]));
+    }
+    g_ptr_array_add (unique_names, NULL);
+
+    GetIconsData *data = g_slice_new0 (GetIconsData);
+    data->names = (GStrv) g_ptr_array_free (g_steal_pointer (&unique_names), FALSE);
+    data->max_active = max_requests > 0 ? max_requests : DEFAULT_MAX_ICON_FETCHES;
+    data->icon_callback = icon_callback;
+    data->icon_callback_data = icon_callback_data;
+    g_task_set_task_data (task, data, (GDestroyNotify) get_icons_data_free);
+
+    fetch_icons (task);
 }
 
 /**
- * snapd_client_get_snap_conf_finish:
+ * snapd_client_get_icons_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_get_snap_conf_async().
- * See snapd_client_get_snap_conf_sync() for more information.
+ * Complete request started with snapd_client_get_icons_async().
+ * See snapd_client_get_icons_sync() for more information.
  *
- * Returns: (transfer container) (element-type utf8 GVariant): a table of configuration values or %NULL on error.
+ * Returns: %TRUE if all icons were requested or %FALSE if cancelled.
  *
- * Since: 1.48
+ * Since: 1.59
  */
-GHashTable *
-snapd_client_get_snap_conf_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+gboolean
+snapd_client_get_icons_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
-    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    g_return_val_if_fail (SNAPD_IS_GET_SNAP_CONF (result), NULL);
-
-    SnapdGetSnapConf *request = SNAPD_GET_SNAP_CONF (result);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
 
-    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
-        return NULL;
-    return g_hash_table_ref (_snapd_get_snap_conf_get_conf (request));
+    return g_task_propagate_boolean (G_TASK (result), error);
 }
 
 /**
- * snapd_client_set_snap_conf_async:
+ * snapd_client_list_async:
  * @client: a #SnapdClient.
- * @name: name of snap to set configuration for.
- * @key_values: (element-type utf8 GVariant): Keys to set.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously set configuration for a snap.
- * See snapd_client_set_snap_conf_sync() for more information.
+ * Asynchronously get information on all installed snaps.
+ * See snapd_client_list_sync() for more information.
  *
- * Since: 1.48
+ * Since: 1.0
+ * Deprecated: 1.42: Use snapd_client_get_snaps_async()
  */
 void
-snapd_client_set_snap_conf_async (SnapdClient *self,
-                                  const gchar *name,
-                                  GHashTable *key_values,
-                                  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_list_async (SnapdClient *self,
+                         GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
-    g_return_if_fail (SNAPD_IS_CLIENT (self));
-    g_return_if_fail (name != NULL);
-    g_return_if_fail (key_values != NULL);
-
-    g_autoptr(SnapdPutSnapConf) request = _snapd_put_snap_conf_new (name, key_values, cancellable, callback, user_data);
-    send_request (self, SNAPD_REQUEST (request));
+    return snapd_client_get_snaps_async (self, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, cancellable, callback, user_data);
 }
 
 /**
- * snapd_client_set_snap_conf_finish:
+ * snapd_client_list_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_set_snap_conf_async().
- * See snapd_client_set_snap_conf_sync() for more information.
+ * Complete request started with snapd_client_list_async().
+ * See snapd_client_list_sync() for more information.
  *
- * Returns: %TRUE if configuration successfully applied.
+ * Returns: (transfer container) (element-type SnapdSnap): an array of #SnapdSnap or %NULL on error.
  *
- * Since: 1.48
+ * Since: 1.0
+ * Deprecated: 1.42: Use snapd_client_get_snaps_finish()
  */
-gboolean
-snapd_client_set_snap_conf_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+GPtrArray *
+snapd_client_list_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
-    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
-    g_return_val_if_fail (SNAPD_IS_PUT_SNAP_CONF (result), FALSE);
-
-    return _snapd_request_propagate_error (SNAPD_REQUEST (result), error);
+    return snapd_client_get_snaps_finish (self, result, error);
 }
 
 /**
- * snapd_client_get_apps_async:
+ * snapd_client_get_snaps_async:
  * @client: a #SnapdClient.
- * @flags: a set of #SnapdGetAppsFlags to control what results are returned.
+ * @flags: a set of #SnapdGetSnapsFlags to control what results are returned.
+ * @names: (allow-none): A list of snap names to return results for. If %NULL or empty then all installed snaps are returned.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously get information on installed apps.
- * See snapd_client_get_apps_sync() for more information.
+ * Asynchronously get information on installed snaps.
+ * See snapd_client_get_snaps_sync() for more information.
  *
- * Since: 1.25
- * Deprecated: 1.45: Use snapd_client_get_apps2_async()
+ * Since: 1.42
  */
 void
-snapd_client_get_apps_async (SnapdClient *self,
-                             SnapdGetAppsFlags flags,
-                             GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_get_snaps_async (SnapdClient *self,
+                              SnapdGetSnapsFlags flags,
+                              GStrv names,
+                              GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
-    return snapd_client_get_apps2_async (self, flags, NULL, cancellable, callback, user_data);
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    g_autoptr(SnapdGetSnaps) request = _snapd_get_snaps_new (cancellable, names, callback, user_data);
+    if ((flags & SNAPD_GET_SNAPS_FLAGS_INCLUDE_INACTIVE) != 0)
+        _snapd_get_snaps_set_select (request, "all");
+    send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_get_apps_finish:
+ * snapd_client_get_snaps_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_get_apps_async().
- * See snapd_client_get_apps_sync() for more information.
+ * Complete request started with snapd_client_get_snaps_async().
+ * See snapd_client_get_snaps_sync() for more information.
  *
- * Returns: (transfer container) (element-type SnapdApp): an array of #SnapdApp or %NULL on error.
+ * Returns: (transfer container) (element-type SnapdSnap): an array of #SnapdSnap or %NULL on error.
  *
- * Since: 1.25
- * Deprecated: 1.45: Use snapd_client_get_apps2_finish()
+ * Since: 1.42
  */
 GPtrArray *
-snapd_client_get_apps_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+snapd_client_get_snaps_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
-    return snapd_client_get_apps2_finish (self, result, error);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
+    g_return_val_if_fail (SNAPD_IS_GET_SNAPS (result), NULL);
+
+    SnapdGetSnaps *request = SNAPD_GET_SNAPS (result);
+
+    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
+        return NULL;
+    return g_ptr_array_ref (_snapd_get_snaps_get_snaps (request));
 }
 
 /**
- * snapd_client_get_apps2_async:
+ * snapd_client_get_snaps_stream_async:
  * @client: a #SnapdClient.
- * @flags: a set of #SnapdGetAppsFlags to control what results are returned.
- * @snaps: (allow-none): A list of snap names to return results for. If %NULL or empty then apps for all installed snaps are returned.
+ * @flags: a set of #SnapdGetSnapsFlags to control what results are returned.
+ * @names: (allow-none): A list of snap names to return results for. If %NULL or empty then all installed snaps are returned.
+ * @snap_callback: (scope async): function to call with each snap as it is received.
+ * @snap_callback_data: (closure): user data to pass to @snap_callback.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously get information on installed apps.
- * See snapd_client_get_apps2_sync() for more information.
+ * Asynchronously get information on installed snaps.
+ * Unlike snapd_client_get_snaps_async(), each snap is passed to @snap_callback
+ * as soon as it is received from snapd instead of waiting for the complete response.
+ * @snap_callback is called from the thread-default main context of the caller, before @callback.
+ * See snapd_client_get_snaps_sync() for more information.
  *
- * Since: 1.45
+ * Since: 1.59
  */
 void
-snapd_client_get_apps2_async (SnapdClient *self,
-                              SnapdGetAppsFlags flags,
-                              GStrv snaps,
-                              GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_get_snaps_stream_async (SnapdClient *self,
+                                     SnapdGetSnapsFlags flags,
+                                     GStrv names,
+                                     SnapdSnapCallback snap_callback, gpointer snap_callback_data,
+                                     GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
+    g_return_if_fail (snap_callback != NULL);
 
-    g_autoptr(SnapdGetApps) request = _snapd_get_apps_new (snaps, cancellable, callback, user_data);
-    if ((flags & SNAPD_GET_APPS_FLAGS_SELECT_SERVICES) != 0)
-        _snapd_get_apps_set_select (request, "service");
+    g_autoptr(SnapdGetSnaps) request = _snapd_get_snaps_new (cancellable, names, callback, user_data);
+    if ((flags & SNAPD_GET_SNAPS_FLAGS_INCLUDE_INACTIVE) != 0)
+        _snapd_get_snaps_set_select (request, "all");
+    _snapd_get_snaps_set_snap_callback (request, snap_callback, snap_callback_data);
     send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_get_apps2_finish:
+ * snapd_client_get_snaps_stream_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_get_apps2_async().
- * See snapd_client_get_apps2_sync() for more information.
+ * Complete request started with snapd_client_get_snaps_stream_async().
+ * See snapd_client_get_snaps_sync() for more information.
  *
- * Returns: (transfer container) (element-type SnapdApp): an array of #SnapdApp or %NULL on error.
+ * Returns: %TRUE if all snaps were received.
  *
- * Since: 1.45
+ * Since: 1.59
  */
-GPtrArray *
-snapd_client_get_apps2_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+gboolean
+snapd_client_get_snaps_stream_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
-    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    g_return_val_if_fail (SNAPD_IS_GET_APPS (result), NULL);
-
-    SnapdGetApps *request = SNAPD_GET_APPS (result);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (SNAPD_IS_GET_SNAPS (result), FALSE);
 
-    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
-        return NULL;
-    return g_ptr_array_ref (_snapd_get_apps_get_apps (request));
+    return _snapd_request_propagate_error (SNAPD_REQUEST (result), error);
 }
 
 /**
- * snapd_client_get_icon_async:
+ * snapd_client_update_snap_set_async:
  * @client: a #SnapdClient.
- * @name: name of snap to get icon for.
+ * @snap_set: a #SnapdSnapSet to update.
+ * @flags: a set of #SnapdGetSnapsFlags to control what results are returned.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously get the icon for an installed snap.
- * See snapd_client_get_icon_sync() for more information.
+ * Asynchronously update a set of installed snaps.
+ * See snapd_client_update_snap_set_sync() for more information.
  *
- * Since: 1.0
+ * Since: 1.59
  */
 void
-snapd_client_get_icon_async (SnapdClient *self,
-                             const gchar *name,
-                             GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_update_snap_set_async (SnapdClient *self,
+                                    SnapdSnapSet *snap_set,
+                                    SnapdGetSnapsFlags flags,
+                                    GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
+    g_return_if_fail (SNAPD_IS_SNAP_SET (snap_set));
 
-    g_autoptr(SnapdGetIcon) request = _snapd_get_icon_new (name, cancellable, callback, user_data);
+    g_autoptr(SnapdGetSnaps) request = _snapd_get_snaps_new (cancellable, NULL, callback, user_data);
+    if ((flags & SNAPD_GET_SNAPS_FLAGS_INCLUDE_INACTIVE) != 0)
+        _snapd_get_snaps_set_select (request, "all");
+    _snapd_get_snaps_set_snap_set (request, snap_set);
     send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_get_icon_finish:
+ * snapd_client_update_snap_set_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_get_icon_async().
- * See snapd_client_get_icon_sync() for more information.
+ * Complete request started with snapd_client_update_snap_set_async().
+ * See snapd_client_update_snap_set_sync() for more information.
  *
- * Returns: (transfer full): a #SnapdIcon or %NULL on error.
+ * Returns: %TRUE on success.
  *
- * Since: 1.0
+ * Since: 1.59
  */
-SnapdIcon *
-snapd_client_get_icon_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+gboolean
+snapd_client_update_snap_set_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
-    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    g_return_val_if_fail (SNAPD_IS_GET_ICON (result), NULL);
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (SNAPD_IS_GET_SNAPS (result), FALSE);
 
-    SnapdGetIcon *request = SNAPD_GET_ICON (result);
+    SnapdGetSnaps *request = SNAPD_GET_SNAPS (result);
 
     if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
-        return NULL;
-    return g_object_ref (_snapd_get_icon_get_icon (request));
+        return FALSE;
+
+    /* The set is changed here so it is only modified in the context of the caller */
+    _snapd_snap_set_update (_snapd_get_snaps_get_snap_set (request), _snapd_get_snaps_get_snaps (request), _snapd_get_snaps_get_fingerprints (request));
+
+    return TRUE;
 }
 
 /**
- * snapd_client_list_async:
+ * snapd_client_get_assertions_async:
  * @client: a #SnapdClient.
+ * @type: assertion type to get.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously get information on all installed snaps.
- * See snapd_client_list_sync() for more information.
+ * Asynchronously get assertions.
+ * See snapd_client_get_assertions_sync() for more information.
  *
- * Since: 1.0
- * Deprecated: 1.42: Use snapd_client_get_snaps_async()
+ * Since: 1.8
  */
 void
-snapd_client_list_async (SnapdClient *self,
-                         GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_get_assertions_async (SnapdClient *self,
+                                   const gchar *type,
+                                   GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
-    return snapd_client_get_snaps_async (self, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, cancellable, callback, user_data);
+    snapd_client_get_assertions2_async (self, type, NULL, SNAPD_GET_ASSERTIONS_FLAGS_NONE, cancellable, callback, user_data);
 }
 
 /**
- * snapd_client_list_finish:
+ * snapd_client_get_assertions_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_list_async().
- * See snapd_client_list_sync() for more information.
+ * Complete request started with snapd_client_get_assertions_async().
+ * See snapd_client_get_assertions_sync() for more information.
  *
- * Returns: (transfer container) (element-type SnapdSnap): an array of #SnapdSnap or %NULL on error.
+ * Returns: (transfer full) (array zero-terminated=1): an array of assertions or %NULL on error.
  *
- * Since: 1.0
- * Deprecated: 1.42: Use snapd_client_get_snaps_finish()
+ * Since: 1.8
  */
-GPtrArray *
-snapd_client_list_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+GStrv
+snapd_client_get_assertions_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
-    return snapd_client_get_snaps_finish (self, result, error);
+    return snapd_client_get_assertions2_finish (self, result, error);
 }
 
 /**
- * snapd_client_get_snaps_async:
+ * snapd_client_get_assertions2_async:
  * @client: a #SnapdClient.
- * @flags: a set of #SnapdGetSnapsFlags to control what results are returned.
- * @names: (allow-none): A list of snap names to return results for. If %NULL or empty then all installed snaps are returned.
+ * @type: assertion type to get.
+ * @filters: (allow-none) (element-type utf8 utf8): header values the assertions must have or %NULL to get all assertions.
+ * @flags: a set of #SnapdGetAssertionsFlags to control what is returned.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously get information on installed snaps.
- * See snapd_client_get_snaps_sync() for more information.
+ * Asynchronously get assertions.
+ * See snapd_client_get_assertions2_sync() for more information.
  *
- * Since: 1.42
+ * Since: 1.59
  */
 void
-snapd_client_get_snaps_async (SnapdClient *self,
-                              SnapdGetSnapsFlags flags,
-                              GStrv names,
-                              GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_get_assertions2_async (SnapdClient *self,
+                                    const gchar *type,
+                                    GHashTable *filters,
+                                    SnapdGetAssertionsFlags flags,
+                                    GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
+    g_return_if_fail (type != NULL);
 
-    g_autoptr(SnapdGetSnaps) request = _snapd_get_snaps_new (cancellable, names, callback, user_data);
-    if ((flags & SNAPD_GET_SNAPS_FLAGS_INCLUDE_INACTIVE) != 0)
-        _snapd_get_snaps_set_select (request, "all");
+    g_autoptr(SnapdGetAssertions) request = _snapd_get_assertions_new (type, cancellable, callback, user_data);
+    _snapd_get_assertions_set_filters (request, filters);
+    _snapd_get_assertions_set_headers_only (request, (flags & SNAPD_GET_ASSERTIONS_FLAGS_HEADERS_ONLY) != 0);
     send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_get_snaps_finish:
+ * snapd_client_get_assertions2_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_get_snaps_async().
- * See snapd_client_get_snaps_sync() for more information.
+ * Complete request started with snapd_client_get_assertions2_async().
+ * See snapd_client_get_assertions2_sync() for more information.
  *
- * Returns: (transfer container) (element-type SnapdSnap): an array of #SnapdSnap or %NULL on error.
+ * Returns: (transfer full) (array zero-terminated=1): an array of assertions or %NULL on error.
  *
- * Since: 1.42
+ * Since: 1.59
  */
-GPtrArray *
-snapd_client_get_snaps_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+GStrv
+snapd_client_get_assertions2_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
     g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    g_return_val_if_fail (SNAPD_IS_GET_SNAPS (result), NULL);
+    g_return_val_if_fail (SNAPD_IS_GET_ASSERTIONS (result), NULL);
 
-    SnapdGetSnaps *request = SNAPD_GET_SNAPS (result);
+    SnapdGetAssertions *request = SNAPD_GET_ASSERTIONS (result);
 
     if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
         return NULL;
-    return g_ptr_array_ref (_snapd_get_snaps_get_snaps (request));
+
+    GPtrArray *assertions = _snapd_get_assertions_get_assertions (request);
+    GStrv result = g_new (gchar *, assertions->len + 1);
+    for (guint i = 0; i < assertions->len; i++) {
+        GBytes *assertion = assertions->pdata[i];
+        result[i] = g_strndup (g_bytes_get_data (assertion, NULL), g_bytes_get_size (assertion));
+    }
+    result[assertions->len] = NULL;
+
+    return result;
 }
 
 /**
- * snapd_client_get_assertions_async:
+ * snapd_client_get_assertions_stream_async:
  * @client: a #SnapdClient.
  * @type: assertion type to get.
+ * @filters: (allow-none) (element-type utf8 utf8): header values the assertions must have or %NULL to get all assertions.
+ * @flags: a set of #SnapdGetAssertionsFlags to control what is returned.
+ * @assertion_callback: (scope async): function to call with each assertion as it is received.
+ * @assertion_callback_data: (closure): user data to pass to @assertion_callback.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
  * Asynchronously get assertions.
- * See snapd_client_get_assertions_sync() for more information.
+ * Unlike snapd_client_get_assertions_async(), each assertion is passed to
+ * @assertion_callback as soon as it is received from snapd instead of waiting
+ * for the complete response.
+ * @assertion_callback is called from the thread-default main context of the caller, before @callback.
+ * See snapd_client_get_assertions2_sync() for more information.
  *
- * Since: 1.8
+ * Since: 1.59
  */
 void
-snapd_client_get_assertions_async (SnapdClient *self,
-                                   const gchar *type,
-                                   GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_get_assertions_stream_async (SnapdClient *self,
+                                          const gchar *type,
+                                          GHashTable *filters,
+                                          SnapdGetAssertionsFlags flags,
+                                          SnapdAssertionCallback assertion_callback, gpointer assertion_callback_data,
+                                          GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
     g_return_if_fail (type != NULL);
+    g_return_if_fail (assertion_callback != NULL);
 
     g_autoptr(SnapdGetAssertions) request = _snapd_get_assertions_new (type, cancellable, callback, user_data);
+    _snapd_get_assertions_set_filters (request, filters);
+    _snapd_get_assertions_set_headers_only (request, (flags & SNAPD_GET_ASSERTIONS_FLAGS_HEADERS_ONLY) != 0);
+    _snapd_get_assertions_set_assertion_callback (request, assertion_callback, assertion_callback_data);
     send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_get_assertions_finish:
+ * snapd_client_get_assertions_stream_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_get_assertions_async().
+ * Complete request started with snapd_client_get_assertions_stream_async().
  * See snapd_client_get_assertions_sync() for more information.
  *
- * Returns: (transfer full) (array zero-terminated=1): an array of assertions or %NULL on error.
+ * Returns: %TRUE if all assertions were received.
+ *
+ * Since: 1.59
+ */
+gboolean
+snapd_client_get_assertions_stream_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (SNAPD_IS_GET_ASSERTIONS (result), FALSE);
+
+    return _snapd_request_propagate_error (SNAPD_REQUEST (result), error);
+}
+
+/**
+ * snapd_client_add_assertions_async:
+ * @client: a #SnapdClient.
+ * @assertions: assertions to add.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
+ * @user_data: (closure): the data to pass to callback function.
+ *
+ * Asynchronously add an assertion.
+ * See snapd_client_add_assertions_sync() for more information.
  *
  * Since: 1.8
  */
-GStrv
-snapd_client_get_assertions_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+void
+snapd_client_add_assertions_async (SnapdClient *self,
+                                   GStrv assertions,
+                                   GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+    g_return_if_fail (assertions != NULL);
+
+    g_autoptr(SnapdPostAssertions) request = _snapd_post_assertions_new (assertions, cancellable, callback, user_data);
+    send_request (self, SNAPD_REQUEST (request));
+}
+
+/**
+ * snapd_client_add_assertions_finish:
+ * @client: a #SnapdClient.
+ * @result: a #GAsyncResult.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Complete request started with snapd_client_add_assertions_async().
+ * See snapd_client_add_assertions_sync() for more information.
+ *
+ * Returns: %TRUE on success or %FALSE on error.
+ *
+ * Since: 1.8
+ */
+gboolean
+snapd_client_add_assertions_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (SNAPD_IS_POST_ASSERTIONS (result), FALSE);
+
+    return _snapd_request_propagate_error (SNAPD_REQUEST (result), error);
+}
+
+/* Default maximum size of assertions to send to snapd in one request */
+#define DEFAULT_MAX_ASSERTION_BATCH_SIZE (1024 * 1024)
+
+/* Default number of batches of assertions to send to snapd at once */
+#define DEFAULT_MAX_ASSERTION_BATCHES 2
+
+/* Amount of data to read from the stream at once */
+#define ASSERTION_READ_SIZE 65536
+
+typedef struct
+{
+    GInputStream *stream;
+    SnapdAssertionStream *splitter;
+    gsize max_batch_size;
+    guint max_active;
+    SnapdAssertionBatchCallback batch_callback;
+    gpointer batch_callback_data;
+
+    /* Batch being filled from the stream */
+    GPtrArray *batch;
+    gsize batch_size;
+
+    /* Complete batches waiting to be sent */
+    GQueue batches;
+
+    guint n_batches;
+    guint n_active;
+    gboolean reading;
+    gboolean eof;
+
+    /* First error reading the stream or adding a batch */
+    GError *error;
+} AddAssertionsData;
+
+typedef struct
+{
+    GTask *task;
+    guint index;
+    guint n_assertions;
+} AssertionBatch;
+
+static void
+add_assertions_data_free (AddAssertionsData *data)
+{
+    g_object_unref (data->stream);
+    _snapd_assertion_stream_free (data->splitter);
+    g_ptr_array_unref (data->batch);
+    while (!g_queue_is_empty (&data->batches))
+        g_ptr_array_unref (g_queue_pop_head (&data->batches));
+    g_clear_error (&data->error);
+    g_slice_free (AddAssertionsData, data);
+}
+
+static void
+queue_assertion_batch (AddAssertionsData *data)
+{
+    if (data->batch->len == 0)
+        return;
+
+    g_queue_push_tail (&data->batches, data->batch);
+    data->batch = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+    data->batch_size = 0;
+}
+
+static gboolean
+import_assertion_cb (GBytes *assertion, gpointer user_data, GError **error)
+{
+    AddAssertionsData *data = user_data;
+
+    /* Start a new batch if this assertion won't fit, allowing for the separator */
+    gsize size = g_bytes_get_size (assertion);
+    if (data->batch->len > 0 && data->batch_size + 2 + size > data->max_batch_size)
+        queue_assertion_batch (data);
+
+    if (data->batch->len > 0)
+        data->batch_size += 2;
+    data->batch_size += size;
+    g_ptr_array_add (data->batch, g_bytes_ref (assertion));
+
+    return TRUE;
+}
+
+static void add_assertion_batches (GTask *task);
+
+static void
+assertion_batch_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    AssertionBatch *batch = user_data;
+    g_autoptr(GTask) task = batch->task;
+    AddAssertionsData *data = g_task_get_task_data (task);
+
+    g_autoptr(GError) error = NULL;
+    snapd_client_add_assertions_finish (SNAPD_CLIENT (object), result, &error);
+    if (error != NULL && data->error == NULL)
+        data->error = g_error_copy (error);
+
+    data->n_active--;
+    if (data->batch_callback != NULL && !g_cancellable_is_cancelled (g_task_get_cancellable (task)))
+        data->batch_callback (SNAPD_CLIENT (object), batch->index, batch->n_assertions, error, data->batch_callback_data);
+    g_slice_free (AssertionBatch, batch);
+
+    add_assertion_batches (task);
+}
+
+static void
+send_assertion_batch (GTask *task, GPtrArray *assertions)
+{
+    SnapdClient *self = g_task_get_source_object (task);
+    AddAssertionsData *data = g_task_get_task_data (task);
+
+    AssertionBatch *batch = g_slice_new0 (AssertionBatch);
+    batch->task = g_object_ref (task);
+    batch->index = data->n_batches;
+    batch->n_assertions = assertions->len;
+    data->n_batches++;
+    data->n_active++;
+
+    g_autoptr(SnapdPostAssertions) request = _snapd_post_assertions_new_from_bytes (assertions, g_task_get_cancellable (task), assertion_batch_cb, batch);
+    send_request (self, SNAPD_REQUEST (request));
+}
+
+static void
+read_assertions_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    g_autoptr(GTask) task = user_data;
+    AddAssertionsData *data = g_task_get_task_data (task);
+
+    data->reading = FALSE;
+
+    g_autoptr(GError) error = NULL;
+    g_autoptr(GBytes) bytes = g_input_stream_read_bytes_finish (G_INPUT_STREAM (object), result, &error);
+    if (bytes == NULL) {
+        /* Still send the complete assertions that were read */
+        if (data->error == NULL)
+            data->error = g_steal_pointer (&error);
+        queue_assertion_batch (data);
+        data->eof = TRUE;
+    }
+    else if (g_bytes_get_size (bytes) == 0) {
+        /* Send the last assertion and any partial batch */
+        _snapd_assertion_stream_finish (data->splitter, NULL);
+        queue_assertion_batch (data);
+        data->eof = TRUE;
+    }
+    else {
+        gsize length;
+        const gchar *content = g_bytes_get_data (bytes, &length);
+        _snapd_assertion_stream_feed (data->splitter, content, length, NULL);
+    }
+
+    add_assertion_batches (task);
+}
+
+/* Send batches until the limit is reached, and read more assertions while there is room for them */
+static void
+add_assertion_batches (GTask *task)
 {
-    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
-    g_return_val_if_fail (SNAPD_IS_GET_ASSERTIONS (result), NULL);
+    AddAssertionsData *data = g_task_get_task_data (task);
+    GCancellable *cancellable = g_task_get_cancellable (task);
 
-    SnapdGetAssertions *request = SNAPD_GET_ASSERTIONS (result);
+    while (data->n_active < data->max_active && !g_queue_is_empty (&data->batches) &&
+           !g_cancellable_is_cancelled (cancellable)) {
+        g_autoptr(GPtrArray) assertions = g_queue_pop_head (&data->batches);
+        send_assertion_batch (task, assertions);
+    }
 
-    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
-        return NULL;
-    return g_strdupv (_snapd_get_assertions_get_assertions (request));
+    if (!data->reading && !data->eof && g_queue_get_length (&data->batches) < data->max_active &&
+        !g_cancellable_is_cancelled (cancellable)) {
+        data->reading = TRUE;
+        g_input_stream_read_bytes_async (data->stream, ASSERTION_READ_SIZE, G_PRIORITY_DEFAULT, cancellable,
+                                         read_assertions_cb, g_object_ref (task));
+        return;
+    }
+
+    if (data->n_active > 0 || data->reading)
+        return;
+
+    if (g_task_return_error_if_cancelled (task))
+        return;
+
+    if (data->error != NULL)
+        g_task_return_error (task, g_steal_pointer (&data->error));
+    else
+        g_task_return_boolean (task, TRUE);
 }
 
 /**
- * snapd_client_add_assertions_async:
+ * snapd_client_import_assertions_async:
  * @client: a #SnapdClient.
- * @assertions: assertions to add.
+ * @stream: a #GInputStream to read assertions from.
+ * @max_batch_size: maximum number of bytes of assertions to send in one request or 0 for the default.
+ * @max_requests: maximum number of requests to send at once or 0 for the default.
+ * @batch_callback: (allow-none) (scope async): function to call as each batch is added.
+ * @batch_callback_data: (closure): user data to pass to @batch_callback.
  * @cancellable: (allow-none): a #GCancellable or %NULL.
  * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
  * @user_data: (closure): the data to pass to callback function.
  *
- * Asynchronously add an assertion.
- * See snapd_client_add_assertions_sync() for more information.
+ * Asynchronously add assertions read from a stream.
+ * See snapd_client_import_assertions_sync() for more information.
  *
- * Since: 1.8
+ * Since: 1.59
  */
 void
-snapd_client_add_assertions_async (SnapdClient *self,
-                                   GStrv assertions,
-                                   GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+snapd_client_import_assertions_async (SnapdClient *self,
+                                      GInputStream *stream,
+                                      gsize max_batch_size, guint max_requests,
+                                      SnapdAssertionBatchCallback batch_callback, gpointer batch_callback_data,
+                                      GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
-    g_return_if_fail (assertions != NULL);
+    g_return_if_fail (G_IS_INPUT_STREAM (stream));
 
-    g_autoptr(SnapdPostAssertions) request = _snapd_post_assertions_new (assertions, cancellable, callback, user_data);
-    send_request (self, SNAPD_REQUEST (request));
+    g_autoptr(GTask) task = g_task_new (self, cancellable, callback, user_data);
+
+    AddAssertionsData *data = g_slice_new0 (AddAssertionsData);
+    data->stream = g_object_ref (stream);
+    data->splitter = _snapd_assertion_stream_new (import_assertion_cb, data);
+    data->max_batch_size = max_batch_size > 0 ? max_batch_size : DEFAULT_MAX_ASSERTION_BATCH_SIZE;
+    data->max_active = max_requests > 0 ? max_requests : DEFAULT_MAX_ASSERTION_BATCHES;
+    data->batch_callback = batch_callback;
+    data->batch_callback_data = batch_callback_data;
+    data->batch = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+    g_queue_init (&data->batches);
+    g_task_set_task_data (task, data, (GDestroyNotify) add_assertions_data_free);
+
+    add_assertion_batches (task);
 }
 
 /**
- * snapd_client_add_assertions_finish:
+ * snapd_client_import_assertions_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_add_assertions_async().
- * See snapd_client_add_assertions_sync() for more information.
+ * Complete request started with snapd_client_import_assertions_async().
+ * See snapd_client_import_assertions_sync() for more information.
  *
- * Returns: %TRUE on success or %FALSE on error.
+ * Returns: %TRUE if all assertions were added.
  *
- * Since: 1.8
+ * Since: 1.59
  */
 gboolean
-snapd_client_add_assertions_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+snapd_client_import_assertions_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
     g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
-    g_return_val_if_fail (SNAPD_IS_POST_ASSERTIONS (result), FALSE);
+    g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
 
-    return _snapd_request_propagate_error (SNAPD_REQUEST (result), error);
+    return g_task_propagate_boolean (G_TASK (result), error);
 }
 
 /**
@@ -2232,6 +5374,62 @@ snapd_client_get_connections2_finish (SnapdClient *self, GAsyncResult *result,
     return TRUE;
 }
 
+/**
+ * snapd_client_get_connection_index_async:
+ * @client: a #SnapdClient.
+ * @flags: a set of #SnapdGetConnectionsFlags to control what results are returned.
+ * @snap: (allow-none): the name of the snap to get connections for or %NULL for all snaps.
+ * @interface: (allow-none): the name of the interface to get connections for or %NULL for all interfaces.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
+ * @user_data: (closure): the data to pass to callback function.
+ *
+ * Asynchronously get the installed snap connections, indexed for lookups.
+ * See snapd_client_get_connection_index_sync() for more information.
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_get_connection_index_async (SnapdClient *self,
+                                         SnapdGetConnectionsFlags flags, const gchar *snap, const gchar *interface,
+                                         GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+
+    const gchar *select = NULL;
+    if ((flags & SNAPD_GET_CONNECTIONS_FLAGS_SELECT_ALL) != 0)
+        select = "all";
+    g_autoptr(SnapdGetConnections) request = _snapd_get_connections_new (snap, interface, select, cancellable, callback, user_data);
+    _snapd_get_connections_set_build_index (request, TRUE);
+    send_request (self, SNAPD_REQUEST (request));
+}
+
+/**
+ * snapd_client_get_connection_index_finish:
+ * @client: a #SnapdClient.
+ * @result: a #GAsyncResult.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Complete request started with snapd_client_get_connection_index_async().
+ * See snapd_client_get_connection_index_sync() for more information.
+ *
+ * Returns: (transfer full): a #SnapdConnectionIndex or %NULL on error.
+ *
+ * Since: 1.59
+ */
+SnapdConnectionIndex *
+snapd_client_get_connection_index_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), NULL);
+    g_return_val_if_fail (SNAPD_IS_GET_CONNECTIONS (result), NULL);
+
+    SnapdGetConnections *request = SNAPD_GET_CONNECTIONS (result);
+
+    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
+        return NULL;
+    return g_object_ref (_snapd_get_connections_get_index (request));
+}
+
 /**
  * snapd_client_connect_interface_async:
  * @client: a #SnapdClient.
@@ -2453,6 +5651,84 @@ snapd_client_find_section_finish (SnapdClient *self, GAsyncResult *result, gchar
     return g_ptr_array_ref (_snapd_get_find_get_snaps (request));
 }
 
+/**
+ * snapd_client_find_stream_async:
+ * @client: a #SnapdClient.
+ * @flags: a set of #SnapdFindFlags to control how the find is performed.
+ * @section: (allow-none): store section to search in or %NULL to search in all sections.
+ * @query: (allow-none): query string to send or %NULL to get all snaps from the given section.
+ * @snap_callback: (scope async): function to call with each snap as it is received.
+ * @snap_callback_data: (closure): user data to pass to @snap_callback.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
+ * @user_data: (closure): the data to pass to callback function.
+ *
+ * Asynchronously find snaps in the store.
+ * Unlike snapd_client_find_section_async(), each snap is passed to @snap_callback
+ * as soon as it is received from snapd instead of waiting for the complete response.
+ * @snap_callback is called from the thread-default main context of the caller, before @callback.
+ * See snapd_client_find_section_sync() for more information.
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_find_stream_async (SnapdClient *self,
+                                SnapdFindFlags flags, const gchar *section, const gchar *query,
+                                SnapdSnapCallback snap_callback, gpointer snap_callback_data,
+                                GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+    g_return_if_fail (section != NULL || query != NULL);
+    g_return_if_fail (snap_callback != NULL);
+
+    g_autoptr(SnapdGetFind) request = _snapd_get_find_new (cancellable, callback, user_data);
+    if ((flags & SNAPD_FIND_FLAGS_MATCH_NAME) != 0)
+        _snapd_get_find_set_name (request, query);
+    else if ((flags & SNAPD_FIND_FLAGS_MATCH_COMMON_ID) != 0)
+        _snapd_get_find_set_common_id (request, query);
+    else
+        _snapd_get_find_set_query (request, query);
+    if ((flags & SNAPD_FIND_FLAGS_SELECT_PRIVATE) != 0)
+        _snapd_get_find_set_select (request, "private");
+    else if ((flags & SNAPD_FIND_FLAGS_SELECT_REFRESH) != 0)
+        _snapd_get_find_set_select (request, "refresh");
+    else if ((flags & SNAPD_FIND_FLAGS_SCOPE_WIDE) != 0)
+        _snapd_get_find_set_scope (request, "wide");
+    _snapd_get_find_set_section (request, section);
+    _snapd_get_find_set_snap_callback (request, snap_callback, snap_callback_data);
+    send_request (self, SNAPD_REQUEST (request));
+}
+
+/**
+ * snapd_client_find_stream_finish:
+ * @client: a #SnapdClient.
+ * @result: a #GAsyncResult.
+ * @suggested_currency: (out) (allow-none): location to store the ISO 4217 currency that is suggested to purchase with.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Complete request started with snapd_client_find_stream_async().
+ * See snapd_client_find_section_sync() for more information.
+ *
+ * Returns: %TRUE if all snaps were received.
+ *
+ * Since: 1.59
+ */
+gboolean
+snapd_client_find_stream_finish (SnapdClient *self, GAsyncResult *result, gchar **suggested_currency, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (SNAPD_IS_GET_FIND (result), FALSE);
+
+    SnapdGetFind *request = SNAPD_GET_FIND (result);
+
+    if (!_snapd_request_propagate_error (SNAPD_REQUEST (request), error))
+        return FALSE;
+
+    if (suggested_currency != NULL)
+        *suggested_currency = g_strdup (_snapd_get_find_get_suggested_currency (request));
+    return TRUE;
+}
+
 /**
  * snapd_client_find_refreshable_async:
  * @client: a #SnapdClient.
@@ -2613,58 +5889,6 @@ snapd_client_install2_finish (SnapdClient *self, GAsyncResult *result, GError **
     return _snapd_request_propagate_error (SNAPD_REQUEST (result), error);
 }
 
-typedef struct
-{
-    SnapdClient *client;
-    SnapdPostSnapStream *request;
-    GCancellable *cancellable;
-    GInputStream *stream;
-} InstallStreamData;
-
-static InstallStreamData *
-install_stream_data_new (SnapdClient *client, SnapdPostSnapStream *request, GCancellable *cancellable, GInputStream *stream)
-{
-    InstallStreamData *data = g_slice_new (InstallStreamData);
-    data->client = g_object_ref (client);
-    data->request = g_object_ref (request);
-    data->cancellable = cancellable != NULL ? g_object_ref (cancellable) : NULL;
-    data->stream = g_object_ref (stream);
-
-    return data;
-}
-
-static void
-install_stream_data_free (InstallStreamData *data)
-{
-    g_object_unref (data->client);
-    g_object_unref (data->request);
-    if (data->cancellable != NULL)
-        g_object_unref (data->cancellable);
-    g_object_unref (data->stream);
-    g_slice_free (InstallStreamData, data);
-}
-
-G_DEFINE_AUTOPTR_CLEANUP_FUNC (InstallStreamData, install_stream_data_free)
-
-static void
-stream_read_cb (GObject *source_object, GAsyncResult *result, gpointer user_data)
-{
-    g_autoptr(InstallStreamData) data = user_data;
-
-    g_autoptr(GError) error = NULL;
-    g_autoptr(GBytes) read_data = g_input_stream_read_bytes_finish (data->stream, result, &error);
-    if (!_snapd_request_propagate_error (SNAPD_REQUEST (data->request), &error))
-        return;
-
-    if (g_bytes_get_size (read_data) == 0)
-        send_request (data->client, SNAPD_REQUEST (data->request));
-    else {
-        _snapd_post_snap_stream_append_data (data->request, g_bytes_get_data (read_data, NULL), g_bytes_get_size (read_data));
-        InstallStreamData *d = g_steal_pointer (&data);
-        g_input_stream_read_bytes_async (d->stream, 65535, G_PRIORITY_DEFAULT, d->cancellable, stream_read_cb, d);
-    }
-}
-
 /**
  * snapd_client_install_stream_async:
  * @client: a #SnapdClient.
@@ -2687,11 +5911,65 @@ snapd_client_install_stream_async (SnapdClient *self,
                                    GInputStream *stream,
                                    SnapdProgressCallback progress_callback, gpointer progress_callback_data,
                                    GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    snapd_client_install_stream2_async (self, flags, stream, NULL, NULL, progress_callback, progress_callback_data, cancellable, callback, user_data);
+}
+
+/**
+ * snapd_client_install_stream_finish:
+ * @client: a #SnapdClient.
+ * @result: a #GAsyncResult.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Complete request started with snapd_client_install_stream_async().
+ * See snapd_client_install_stream_sync() for more information.
+ *
+ * Returns: %TRUE on success or %FALSE on error.
+ *
+ * Since: 1.9
+ */
+gboolean
+snapd_client_install_stream_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (SNAPD_IS_POST_SNAP_STREAM (result), FALSE);
+
+    return _snapd_request_propagate_error (SNAPD_REQUEST (result), error);
+}
+
+/**
+ * snapd_client_install_stream2_async:
+ * @client: a #SnapdClient.
+ * @flags: a set of #SnapdInstallFlags to control install options.
+ * @stream: a #GInputStream containing the snap file contents to install.
+ * @upload_progress_callback: (allow-none) (scope call): function to callback as the snap is sent to snapd.
+ * @upload_progress_callback_data: (closure): user data to pass to @upload_progress_callback.
+ * @progress_callback: (allow-none) (scope call): function to callback with progress.
+ * @progress_callback_data: (closure): user data to pass to @progress_callback.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
+ * @user_data: (closure): the data to pass to callback function.
+ *
+ * Asynchronously install a snap.
+ * See snapd_client_install_stream2_sync() for more information.
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_install_stream2_async (SnapdClient *self,
+                                    SnapdInstallFlags flags,
+                                    GInputStream *stream,
+                                    SnapdTransferProgressCallback upload_progress_callback, gpointer upload_progress_callback_data,
+                                    SnapdProgressCallback progress_callback, gpointer progress_callback_data,
+                                    GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
     g_return_if_fail (SNAPD_IS_CLIENT (self));
     g_return_if_fail (G_IS_INPUT_STREAM (stream));
 
-    g_autoptr(SnapdPostSnapStream) request = _snapd_post_snap_stream_new (progress_callback, progress_callback_data, cancellable, callback, user_data);
+    g_autoptr(SnapdPostSnapStream) request = _snapd_post_snap_stream_new (stream,
+                                                                          upload_progress_callback, upload_progress_callback_data,
+                                                                          progress_callback, progress_callback_data,
+                                                                          cancellable, callback, user_data);
     if ((flags & SNAPD_INSTALL_FLAGS_CLASSIC) != 0)
         _snapd_post_snap_stream_set_classic (request, TRUE);
     if ((flags & SNAPD_INSTALL_FLAGS_DANGEROUS) != 0)
@@ -2700,24 +5978,24 @@ snapd_client_install_stream_async (SnapdClient *self,
         _snapd_post_snap_stream_set_devmode (request, TRUE);
     if ((flags & SNAPD_INSTALL_FLAGS_JAILMODE) != 0)
         _snapd_post_snap_stream_set_jailmode (request, TRUE);
-    g_input_stream_read_bytes_async (stream, 65535, G_PRIORITY_DEFAULT, cancellable, stream_read_cb, install_stream_data_new (self, request, cancellable, stream));
+    send_request (self, SNAPD_REQUEST (request));
 }
 
 /**
- * snapd_client_install_stream_finish:
+ * snapd_client_install_stream2_finish:
  * @client: a #SnapdClient.
  * @result: a #GAsyncResult.
  * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
  *
- * Complete request started with snapd_client_install_stream_async().
- * See snapd_client_install_stream_sync() for more information.
+ * Complete request started with snapd_client_install_stream2_async().
+ * See snapd_client_install_stream2_sync() for more information.
  *
  * Returns: %TRUE on success or %FALSE on error.
  *
- * Since: 1.9
+ * Since: 1.59
  */
 gboolean
-snapd_client_install_stream_finish (SnapdClient *self, GAsyncResult *result, GError **error)
+snapd_client_install_stream2_finish (SnapdClient *self, GAsyncResult *result, GError **error)
 {
     g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
     g_return_val_if_fail (SNAPD_IS_POST_SNAP_STREAM (result), FALSE);
@@ -3905,6 +7183,72 @@ snapd_client_download_finish (SnapdClient *self, GAsyncResult *result, GError **
     return g_bytes_ref (_snapd_post_download_get_data (request));
 }
 
+/**
+ * snapd_client_download_to_stream_async:
+ * @client: a #SnapdClient.
+ * @name: name of snap to download.
+ * @channel: (allow-none): channel to download from.
+ * @revision: (allow-none): revision to download.
+ * @resume_token: (allow-none): token from a previous download to resume or %NULL.
+ * @offset: number of bytes already downloaded when resuming.
+ * @stream: a #GOutputStream to write the snap contents to.
+ * @progress_callback: (allow-none) (scope call): function to callback as the snap is received.
+ * @progress_callback_data: (closure): user data to pass to @progress_callback.
+ * @cancellable: (allow-none): a #GCancellable or %NULL.
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the request is satisfied.
+ * @user_data: (closure): the data to pass to callback function.
+ *
+ * Asynchronously download a snap to a stream.
+ * See snapd_client_download_to_stream_sync() for more information.
+ *
+ * Since: 1.59
+ */
+void
+snapd_client_download_to_stream_async (SnapdClient *self,
+                                       const gchar *name, const gchar *channel, const gchar *revision,
+                                       const gchar *resume_token, guint64 offset,
+                                       GOutputStream *stream,
+                                       SnapdTransferProgressCallback progress_callback, gpointer progress_callback_data,
+                                       GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+    g_return_if_fail (SNAPD_IS_CLIENT (self));
+    g_return_if_fail (name != NULL);
+    g_return_if_fail (G_IS_OUTPUT_STREAM (stream));
+
+    g_autoptr(SnapdPostDownload) request = _snapd_post_download_new (name, channel, revision, cancellable, callback, user_data);
+    _snapd_post_download_set_resume (request, resume_token, offset);
+    _snapd_post_download_set_output_stream (request, stream, progress_callback, progress_callback_data);
+    send_request (self, SNAPD_REQUEST (request));
+}
+
+/**
+ * snapd_client_download_to_stream_finish:
+ * @client: a #SnapdClient.
+ * @result: a #GAsyncResult.
+ * @resume_token: (out) (allow-none): location to store a token to resume this download or %NULL.
+ * @error: (allow-none): #GError location to store the error occurring, or %NULL to ignore.
+ *
+ * Complete request started with snapd_client_download_to_stream_async().
+ * See snapd_client_download_to_stream_sync() for more information.
+ *
+ * Returns: %TRUE on success or %FALSE on error.
+ *
+ * Since: 1.59
+ */
+gboolean
+snapd_client_download_to_stream_finish (SnapdClient *self, GAsyncResult *result, gchar **resume_token, GError **error)
+{
+    g_return_val_if_fail (SNAPD_IS_CLIENT (self), FALSE);
+    g_return_val_if_fail (SNAPD_IS_POST_DOWNLOAD (result), FALSE);
+
+    SnapdPostDownload *request = SNAPD_POST_DOWNLOAD (result);
+
+    if (resume_token)
+        *resume_token = g_strdup (_snapd_post_download_get_download_token (request));
+
+    return _snapd_request_propagate_error (SNAPD_REQUEST (request), error);
+}
+
 /**
  * snapd_client_new:
  *
@@ -3935,8 +7279,8 @@ snapd_client_new_from_socket (GSocket *socket)
 {
     SnapdClient *self = snapd_client_new ();
     SnapdClientPrivate *priv = snapd_client_get_instance_private (SNAPD_CLIENT (self));
-    priv->snapd_socket = g_object_ref (socket);
-    g_socket_set_blocking (priv->snapd_socket, FALSE);
+    g_socket_set_blocking (socket, FALSE);
+    g_ptr_array_add (priv->connections, connection_new (self, socket));
 
     return self;
 }
@@ -3947,16 +7291,29 @@ snapd_client_finalize (GObject *object)
     SnapdClientPrivate *priv = snapd_client_get_instance_private (SNAPD_CLIENT (object));
 
     g_mutex_clear (&priv->requests_mutex);
-    g_mutex_clear (&priv->buffer_mutex);
+    g_mutex_clear (&priv->maintenance_mutex);
     g_clear_pointer (&priv->socket_path, g_free);
     g_clear_pointer (&priv->user_agent, g_free);
     g_clear_object (&priv->auth_data);
+    g_queue_clear (&priv->send_queue);
     g_clear_pointer (&priv->requests, g_ptr_array_unref);
-    if (priv->snapd_socket != NULL)
-        g_socket_close (priv->snapd_socket, NULL);
-    g_clear_object (&priv->snapd_socket);
-    g_clear_pointer (&priv->buffer, g_byte_array_unref);
+    for (guint i = 0; i < priv->connections->len; i++)
+        connection_close (g_ptr_array_index (priv->connections, i));
+    g_clear_pointer (&priv->connections, g_ptr_array_unref);
     g_clear_object (&priv->maintenance);
+    g_clear_object (&priv->notices_request);
+    if (priv->notices_retry_source != NULL)
+        g_source_destroy (priv->notices_retry_source);
+    g_clear_pointer (&priv->notices_retry_source, g_source_unref);
+    g_clear_pointer (&priv->notices_after, g_free);
+    g_clear_pointer (&priv->change_watches, g_hash_table_unref);
+    if (priv->task_delta_callback_destroy_notify != NULL)
+        priv->task_delta_callback_destroy_notify (priv->task_delta_callback_data);
+    g_clear_pointer (&priv->icon_cache, _snapd_icon_cache_free);
+    g_clear_pointer (&priv->response_cache, _snapd_response_cache_free);
+    g_clear_pointer (&priv->icon_fetches, g_hash_table_unref);
+    if (priv->parse_pool != NULL)
+        g_thread_pool_free (g_steal_pointer (&priv->parse_pool), FALSE, TRUE);
 
     G_OBJECT_CLASS (snapd_client_parent_class)->finalize (object);
 }
@@ -3978,7 +7335,13 @@ snapd_client_init (SnapdClient *self)
     priv->user_agent = g_strdup ("snapd-glib/" VERSION);
     priv->allow_interaction = TRUE;
     priv->requests = g_ptr_array_new_with_free_func ((GDestroyNotify) request_data_unref);
-    priv->buffer = g_byte_array_new ();
+    priv->connections = g_ptr_array_new_with_free_func ((GDestroyNotify) connection_unref);
+    priv->change_watches = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) change_watch_free);
+    priv->max_connections = 1;
+    g_queue_init (&priv->send_queue);
+    priv->icon_cache = _snapd_icon_cache_new ();
+    priv->response_cache = _snapd_response_cache_new ();
+    priv->icon_fetches = g_hash_table_new (g_str_hash, g_str_equal);
     g_mutex_init (&priv->requests_mutex);
-    g_mutex_init (&priv->buffer_mutex);
+    g_mutex_init (&priv->maintenance_mutex);
 }
@@ -17,10 +17,13 @@
 #include <glib-object.h>
 #include <gio/gio.h>
 
+#include <snapd-glib/snapd-assertion.h>
 #include <snapd-glib/snapd-auth-data.h>
+#include <snapd-glib/snapd-connection-index.h>
 #include <snapd-glib/snapd-icon.h>
 #include <snapd-glib/snapd-maintenance.h>
 #include <snapd-glib/snapd-snap.h>
+#include <snapd-glib/snapd-snap-set.h>
 #include <snapd-glib/snapd-system-information.h>
 #include <snapd-glib/snapd-change.h>
 #include <snapd-glib/snapd-user-information.h>
@@ -207,6 +210,21 @@ typedef enum
     SNAPD_GET_INTERFACES_FLAGS_ONLY_CONNECTED = 1 << 3,
 } SnapdGetInterfacesFlags;
 
+/**
+ * SnapdGetAssertionsFlags:
+ * @SNAPD_GET_ASSERTIONS_FLAGS_NONE: No flags, default behaviour.
+ * @SNAPD_GET_ASSERTIONS_FLAGS_HEADERS_ONLY: Only return assertion headers, without the body or signature.
+ *
+ * Flags to control how assertions are returned.
+ *
+ * Since: 1.59
+ */
+typedef enum
+{
+    SNAPD_GET_ASSERTIONS_FLAGS_NONE         = 0,
+    SNAPD_GET_ASSERTIONS_FLAGS_HEADERS_ONLY = 1 << 0
+} SnapdGetAssertionsFlags;
+
 /**
  * SnapdProgressCallback:
  * @client: a #SnapdClient
@@ -227,6 +245,96 @@ typedef enum
  */
 typedef void (*SnapdProgressCallback) (SnapdClient *client, SnapdChange *change, gpointer deprecated, gpointer user_data);
 
+/**
+ * SnapdSnapCallback:
+ * @client: a #SnapdClient
+ * @snap: a #SnapdSnap that has been received
+ * @user_data: user data passed to the callback
+ *
+ * Signature for callback function used in
+ * snapd_client_get_snaps_stream_async() and
+ * snapd_client_find_stream_async().
+ *
+ * Since: 1.59
+ */
+typedef void (*SnapdSnapCallback) (SnapdClient *client, SnapdSnap *snap, gpointer user_data);
+
+/**
+ * SnapdAssertionCallback:
+ * @client: a #SnapdClient
+ * @assertion: a #SnapdAssertion that has been received
+ * @user_data: user data passed to the callback
+ *
+ * Signature for callback function used in
+ * snapd_client_get_assertions_stream_async().
+ *
+ * Since: 1.59
+ */
+typedef void (*SnapdAssertionCallback) (SnapdClient *client, SnapdAssertion *assertion, gpointer user_data);
+
+/**
+ * SnapdAssertionBatchCallback:
+ * @client: a #SnapdClient
+ * @batch: index of the batch, counting from zero in the order they were read
+ * @n_assertions: number of assertions in the batch
+ * @error: (allow-none): the error adding this batch or %NULL if it was added
+ * @user_data: user data passed to the callback
+ *
+ * Signature for callback function used in
+ * snapd_client_import_assertions_sync() and
+ * snapd_client_import_assertions_async().
+ *
+ * Since: 1.59
+ */
+typedef void (*SnapdAssertionBatchCallback) (SnapdClient *client, guint batch, guint n_assertions, GError *error, gpointer user_data);
+
+/**
+ * SnapdIconCallback:
+ * @client: a #SnapdClient
+ * @name: name of the snap the icon is for
+ * @icon: (allow-none): the #SnapdIcon received or %NULL on error
+ * @error: (allow-none): the error that occurred getting the icon or %NULL
+ * @user_data: user data passed to the callback
+ *
+ * Signature for callback function used in
+ * snapd_client_get_icons_sync() and
+ * snapd_client_get_icons_async().
+ *
+ * Since: 1.59
+ */
+typedef void (*SnapdIconCallback) (SnapdClient *client, const gchar *name, SnapdIcon *icon, GError *error, gpointer user_data);
+
+/**
+ * SnapdTaskDeltaCallback:
+ * @client: a #SnapdClient
+ * @change: a #SnapdChange describing the change in progress
+ * @tasks: (element-type SnapdTask): the tasks in @change that were added or changed since it was last reported
+ * @user_data: user data passed to the callback
+ *
+ * Signature for callback function used in
+ * snapd_client_set_task_delta_callback().
+ *
+ * Since: 1.59
+ */
+typedef void (*SnapdTaskDeltaCallback) (SnapdClient *client, SnapdChange *change, GPtrArray *tasks, gpointer user_data);
+
+/**
+ * SnapdTransferProgressCallback:
+ * @client: a #SnapdClient
+ * @n_bytes: the number of bytes transferred so far
+ * @total_bytes: the total number of bytes to transfer or 0 if not known
+ * @user_data: user data passed to the callback
+ *
+ * Signature for callback function used in
+ * snapd_client_install_stream2_sync(),
+ * snapd_client_install_stream2_async(),
+ * snapd_client_download_to_stream_sync() and
+ * snapd_client_download_to_stream_async().
+ *
+ * Since: 1.59
+ */
+typedef void (*SnapdTransferProgressCallback) (SnapdClient *client, guint64 n_bytes, guint64 total_bytes, gpointer user_data);
+
 SnapdClient            *snapd_client_new                           (void);
 
 SnapdClient            *snapd_client_new_from_socket               (GSocket              *socket);
@@ -259,6 +367,80 @@ void                    snapd_client_set_allow_interaction         (SnapdClient
 
 gboolean                snapd_client_get_allow_interaction         (SnapdClient          *client);
 
+void                    snapd_client_set_pipeline_depth            (SnapdClient          *client,
+                                                                    guint                 depth);
+
+guint                   snapd_client_get_pipeline_depth            (SnapdClient          *client);
+
+void                    snapd_client_set_max_queued_requests       (SnapdClient          *client,
+                                                                    guint                 max_queued_requests);
+
+guint                   snapd_client_get_max_queued_requests       (SnapdClient          *client);
+
+void                    snapd_client_set_max_connections           (SnapdClient          *client,
+                                                                    guint                 max_connections);
+
+guint                   snapd_client_get_max_connections           (SnapdClient          *client);
+
+void                    snapd_client_set_connection_idle_timeout   (SnapdClient          *client,
+                                                                    guint                 timeout);
+
+guint                   snapd_client_get_connection_idle_timeout   (SnapdClient          *client);
+
+void                    snapd_client_set_task_delta_callback       (SnapdClient          *client,
+                                                                    SnapdTaskDeltaCallback callback,
+                                                                    gpointer              user_data,
+                                                                    GDestroyNotify        destroy_notify);
+
+guint                   snapd_client_get_n_connections             (SnapdClient          *client);
+
+gboolean                snapd_client_get_connection_stats          (SnapdClient          *client,
+                                                                    guint                 index,
+                                                                    guint                *n_pending,
+                                                                    guint64              *n_requests,
+                                                                    guint64              *n_bytes_sent,
+                                                                    guint64              *n_bytes_received);
+
+void                    snapd_client_set_parse_in_thread           (SnapdClient          *client,
+                                                                    gboolean              parse_in_thread);
+
+gboolean                snapd_client_get_parse_in_thread           (SnapdClient          *client);
+
+void                    snapd_client_set_lazy_snaps                (SnapdClient          *client,
+                                                                    gboolean              lazy_snaps);
+
+gboolean                snapd_client_get_lazy_snaps                (SnapdClient          *client);
+
+gboolean                snapd_client_set_response_cache_ttl        (SnapdClient          *client,
+                                                                    const gchar          *path,
+                                                                    guint                 ttl);
+
+guint                   snapd_client_get_response_cache_ttl        (SnapdClient          *client,
+                                                                    const gchar          *path);
+
+void                    snapd_client_clear_response_cache          (SnapdClient          *client);
+
+void                    snapd_client_get_response_cache_stats      (SnapdClient          *client,
+                                                                    guint64              *n_hits,
+                                                                    guint64              *n_misses,
+                                                                    guint64              *n_revalidated);
+
+void                    snapd_client_set_icon_cache_size           (SnapdClient          *client,
+                                                                    guint64               max_size);
+
+guint64                 snapd_client_get_icon_cache_size           (SnapdClient          *client);
+
+void                    snapd_client_set_icon_cache_path           (SnapdClient          *client,
+                                                                    const gchar          *path);
+
+const gchar            *snapd_client_get_icon_cache_path           (SnapdClient          *client);
+
+void                    snapd_client_get_icon_cache_stats          (SnapdClient          *client,
+                                                                    guint64              *n_hits,
+                                                                    guint64              *n_misses,
+                                                                    guint                *n_entries,
+                                                                    guint64              *size);
+
 SnapdMaintenance       *snapd_client_get_maintenance               (SnapdClient          *client);
 
 SnapdAuthData          *snapd_client_login_sync                    (SnapdClient          *client,
@@ -359,6 +541,25 @@ SnapdChange            *snapd_client_abort_change_finish           (SnapdClient
                                                                     GAsyncResult         *result,
                                                                     GError              **error);
 
+SnapdChange            *snapd_client_watch_change_sync             (SnapdClient          *client,
+                                                                    const gchar          *id,
+                                                                    SnapdProgressCallback progress_callback,
+                                                                    gpointer              progress_callback_data,
+                                                                    GCancellable         *cancellable,
+                                                                    GError              **error);
+
+void                    snapd_client_watch_change_async            (SnapdClient          *client,
+                                                                    const gchar          *id,
+                                                                    SnapdProgressCallback progress_callback,
+                                                                    gpointer              progress_callback_data,
+                                                                    GCancellable         *cancellable,
+                                                                    GAsyncReadyCallback   callback,
+                                                                    gpointer              user_data);
+
+SnapdChange            *snapd_client_watch_change_finish           (SnapdClient          *client,
+                                                                    GAsyncResult         *result,
+                                                                    GError              **error);
+
 SnapdSystemInformation *snapd_client_get_system_information_sync   (SnapdClient          *client,
                                                                     GCancellable         *cancellable,
                                                                     GError              **error);
@@ -396,6 +597,33 @@ GPtrArray              *snapd_client_get_snaps_finish              (SnapdClient
                                                                     GAsyncResult         *result,
                                                                     GError              **error);
 
+void                    snapd_client_get_snaps_stream_async        (SnapdClient          *client,
+                                                                    SnapdGetSnapsFlags    flags,
+                                                                    GStrv                 names,
+                                                                    SnapdSnapCallback     snap_callback,
+                                                                    gpointer              snap_callback_data,
+                                                                    GCancellable         *cancellable,
+                                                                    GAsyncReadyCallback   callback,
+                                                                    gpointer              user_data);
+gboolean                snapd_client_get_snaps_stream_finish       (SnapdClient          *client,
+                                                                    GAsyncResult         *result,
+                                                                    GError              **error);
+
+gboolean                snapd_client_update_snap_set_sync          (SnapdClient          *client,
+                                                                    SnapdSnapSet         *snap_set,
+                                                                    SnapdGetSnapsFlags    flags,
+                                                                    GCancellable         *cancellable,
+                                                                    GError              **error);
+void                    snapd_client_update_snap_set_async         (SnapdClient          *client,
+                                                                    SnapdSnapSet         *snap_set,
+                                                                    SnapdGetSnapsFlags    flags,
+                                                                    GCancellable         *cancellable,
+                                                                    GAsyncReadyCallback   callback,
+                                                                    gpointer              user_data);
+gboolean                snapd_client_update_snap_set_finish        (SnapdClient          *client,
+                                                                    GAsyncResult         *result,
+                                                                    GError              **error);
+
 SnapdSnap              *snapd_client_list_one_sync                 (SnapdClient          *client,
                                                                     const gchar          *name,
                                                                     GCancellable         *cancellable,
@@ -493,6 +721,25 @@ SnapdIcon              *snapd_client_get_icon_finish               (SnapdClient
                                                                     GAsyncResult         *result,
                                                                     GError              **error);
 
+gboolean                snapd_client_get_icons_sync                (SnapdClient          *client,
+                                                                    GStrv                 names,
+                                                                    guint                 max_requests,
+                                                                    SnapdIconCallback     icon_callback,
+                                                                    gpointer              icon_callback_data,
+                                                                    GCancellable         *cancellable,
+                                                                    GError              **error);
+void                    snapd_client_get_icons_async               (SnapdClient          *client,
+                                                                    GStrv                 names,
+                                                                    guint                 max_requests,
+                                                                    SnapdIconCallback     icon_callback,
+                                                                    gpointer              icon_callback_data,
+                                                                    GCancellable         *cancellable,
+                                                                    GAsyncReadyCallback   callback,
+                                                                    gpointer              user_data);
+gboolean                snapd_client_get_icons_finish              (SnapdClient          *client,
+                                                                    GAsyncResult         *result,
+                                                                    GError              **error);
+
 GStrv                   snapd_client_get_assertions_sync           (SnapdClient          *client,
                                                                     const gchar          *type,
                                                                     GCancellable         *cancellable,
@@ -506,6 +753,36 @@ GStrv                   snapd_client_get_assertions_finish         (SnapdClient
                                                                     GAsyncResult         *result,
                                                                     GError              **error);
 
+GStrv                   snapd_client_get_assertions2_sync          (SnapdClient          *client,
+                                                                    const gchar          *type,
+                                                                    GHashTable           *filters,
+                                                                    SnapdGetAssertionsFlags flags,
+                                                                    GCancellable         *cancellable,
+                                                                    GError              **error);
+void                    snapd_client_get_assertions2_async         (SnapdClient          *client,
+                                                                    const gchar          *type,
+                                                                    GHashTable           *filters,
+                                                                    SnapdGetAssertionsFlags flags,
+                                                                    GCancellable         *cancellable,
+                                                                    GAsyncReadyCallback   callback,
+                                                                    gpointer              user_data);
+GStrv                   snapd_client_get_assertions2_finish        (SnapdClient          *client,
+                                                                    GAsyncResult         *result,
+                                                                    GError              **error);
+
+void                    snapd_client_get_assertions_stream_async   (SnapdClient          *client,
+                                                                    const gchar          *type,
+                                                                    GHashTable           *filters,
+                                                                    SnapdGetAssertionsFlags flags,
+                                                                    SnapdAssertionCallback assertion_callback,
+                                                                    gpointer              assertion_callback_data,
+                                                                    GCancellable         *cancellable,
+                                                                    GAsyncReadyCallback   callback,
+                                                                    gpointer              user_data);
+gboolean                snapd_client_get_assertions_stream_finish  (SnapdClient          *client,
+                                                                    GAsyncResult         *result,
+                                                                    GError              **error);
+
 gboolean                snapd_client_add_assertions_sync           (SnapdClient          *client,
                                                                     GStrv                 assertions,
                                                                     GCancellable         *cancellable,
@@ -519,6 +796,27 @@ gboolean                snapd_client_add_assertions_finish         (SnapdClient
                                                                     GAsyncResult         *result,
                                                                     GError              **error);
 
+gboolean                snapd_client_import_assertions_sync        (SnapdClient          *client,
+                                                                    GInputStream         *stream,
+                                                                    gsize                 max_batch_size,
+                                                                    guint                 max_requests,
+                                                                    SnapdAssertionBatchCallback batch_callback,
+                                                                    gpointer              batch_callback_data,
+                                                                    GCancellable         *cancellable,
+                                                                    GError              **error);
+void                    snapd_client_import_assertions_async       (SnapdClient          *client,
+                                                                    GInputStream         *stream,
+                                                                    gsize                 max_batch_size,
+                                                                    guint                 max_requests,
+                                                                    SnapdAssertionBatchCallback batch_callback,
+                                                                    gpointer              batch_callback_data,
+                                                                    GCancellable         *cancellable,
+                                                                    GAsyncReadyCallback   callback,
+                                                                    gpointer              user_data);
+gboolean                snapd_client_import_assertions_finish      (SnapdClient          *client,
+                                                                    GAsyncResult         *result,
+                                                                    GError              **error);
+
 gboolean                snapd_client_get_interfaces_sync           (SnapdClient          *client,
                                                                     GPtrArray           **plugs,
                                                                     GPtrArray           **slots,
@@ -593,6 +891,23 @@ gboolean                snapd_client_get_connections2_finish       (SnapdClient
                                                                     GPtrArray           **slots,
                                                                     GError              **error);
 
+SnapdConnectionIndex   *snapd_client_get_connection_index_sync     (SnapdClient          *client,
+                                                                    SnapdGetConnectionsFlags flags,
+                                                                    const gchar          *snap,
+                                                                    const gchar          *interface,
+                                                                    GCancellable         *cancellable,
+                                                                    GError              **error);
+void                    snapd_client_get_connection_index_async    (SnapdClient          *client,
+                                                                    SnapdGetConnectionsFlags flags,
+                                                                    const gchar          *snap,
+                                                                    const gchar          *interface,
+                                                                    GCancellable         *cancellable,
+                                                                    GAsyncReadyCallback   callback,
+                                                                    gpointer              user_data);
+SnapdConnectionIndex   *snapd_client_get_connection_index_finish   (SnapdClient          *client,
+                                                                    GAsyncResult         *result,
+                                                                    GError              **error);
+
 gboolean                snapd_client_connect_interface_sync        (SnapdClient          *client,
                                                                     const gchar          *plug_snap,
                                                                     const gchar          *plug_name,
@@ -675,6 +990,20 @@ GPtrArray              *snapd_client_find_section_finish           (SnapdClient
                                                                     gchar               **suggested_currency,
                                                                     GError              **error);
 
+void                    snapd_client_find_stream_async             (SnapdClient          *client,
+                                                                    SnapdFindFlags        flags,
+                                                                    const gchar          *section,
+                                                                    const gchar          *query,
+                                                                    SnapdSnapCallback     snap_callback,
+                                                                    gpointer              snap_callback_data,
+                                                                    GCancellable         *cancellable,
+                                                                    GAsyncReadyCallback   callback,
+                                                                    gpointer              user_data);
+gboolean                snapd_client_find_stream_finish            (SnapdClient          *client,
+                                                                    GAsyncResult         *result,
+                                                                    gchar               **suggested_currency,
+                                                                    GError              **error);
+
 GPtrArray              *snapd_client_find_refreshable_sync         (SnapdClient          *client,
                                                                     GCancellable         *cancellable,
                                                                     GError              **error);
@@ -747,6 +1076,29 @@ gboolean                snapd_client_install_stream_finish         (SnapdClient
                                                                     GAsyncResult         *result,
                                                                     GError              **error);
 
+gboolean                snapd_client_install_stream2_sync          (SnapdClient          *client,
+                                                                    SnapdInstallFlags     flags,
+                                                                    GInputStream         *stream,
+                                                                    SnapdTransferProgressCallback upload_progress_callback,
+                                                                    gpointer              upload_progress_callback_data,
+                                                                    SnapdProgressCallback progress_callback,
+                                                                    gpointer              progress_callback_data,
+                                                                    GCancellable         *cancellable,
+                                                                    GError              **error);
+void                    snapd_client_install_stream2_async         (SnapdClient          *client,
+                                                                    SnapdInstallFlags     flags,
+                                                                    GInputStream         *stream,
+                                                                    SnapdTransferProgressCallback upload_progress_callback,
+                                                                    gpointer              upload_progress_callback_data,
+                                                                    SnapdProgressCallback progress_callback,
+                                                                    gpointer              progress_callback_data,
+                                                                    GCancellable         *cancellable,
+                                                                    GAsyncReadyCallback   callback,
+                                                                    gpointer              user_data);
+gboolean                snapd_client_install_stream2_finish        (SnapdClient          *client,
+                                                                    GAsyncResult         *result,
+                                                                    GError              **error);
+
 gboolean                snapd_client_try_sync                      (SnapdClient          *client,
                                                                     const gchar          *path,
                                                                     SnapdProgressCallback progress_callback,
@@ -1124,6 +1476,35 @@ GBytes                 *snapd_client_download_finish               (SnapdClient
                                                                     GAsyncResult         *result,
                                                                     GError              **error);
 
+gboolean                snapd_client_download_to_stream_sync       (SnapdClient          *client,
+                                                                    const gchar          *name,
+                                                                    const gchar          *channel,
+                                                                    const gchar          *revision,
+                                                                    const gchar          *resume_token,
+                                                                    guint64               offset,
+                                                                    GOutputStream        *stream,
+                                                                    SnapdTransferProgressCallback progress_callback,
+                                                                    gpointer              progress_callback_data,
+                                                                    gchar               **resume_token_out,
+                                                                    GCancellable         *cancellable,
+                                                                    GError              **error);
+void                    snapd_client_download_to_stream_async      (SnapdClient          *client,
+                                                                    const gchar          *name,
+                                                                    const gchar          *channel,
+                                                                    const gchar          *revision,
+                                                                    const gchar          *resume_token,
+                                                                    guint64               offset,
+                                                                    GOutputStream        *stream,
+                                                                    SnapdTransferProgressCallback progress_callback,
+                                                                    gpointer              progress_callback_data,
+                                                                    GCancellable         *cancellable,
+                                                                    GAsyncReadyCallback   callback,
+                                                                    gpointer              user_data);
+gboolean                snapd_client_download_to_stream_finish     (SnapdClient          *client,
+                                                                    GAsyncResult         *result,
+                                                                    gchar               **resume_token,
+                                                                    GError              **error);
+
 G_END_DECLS
 
 #endif /* __SNAPD_CLIENT_H__ */
@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_CONNECTION_INDEX_PRIVATE_H__
+#define __SNAPD_CONNECTION_INDEX_PRIVATE_H__
+
+#include "snapd-connection-index.h"
+
+G_BEGIN_DECLS
+
+SnapdConnectionIndex *_snapd_connection_index_new (GPtrArray *established,
+                                                   GPtrArray *undesired,
+                                                   GPtrArray *plugs,
+                                                   GPtrArray *slots);
+
+G_END_DECLS
+
+#endif /* __SNAPD_CONNECTION_INDEX_PRIVATE_H__ */
@@ -0,0 +1,445 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#include "snapd-connection-index-private.h"
+
+#include "snapd-plug-ref.h"
+#include "snapd-slot-ref.h"
+
+/**
+ * SECTION:snapd-connection-index
+ * @short_description: Indexed interface connections
+ * @include: snapd-glib/snapd-glib.h
+ *
+ * A #SnapdConnectionIndex contains the plugs, slots and connections returned
+ * by snapd_client_get_connection_index_sync(). As well as the arrays returned
+ * by snapd_client_get_connections2_sync() it allows plugs, slots and
+ * connections to be looked up by snap, interface and name without searching
+ * the arrays.
+ */
+
+/**
+ * SnapdConnectionIndex:
+ *
+ * #SnapdConnectionIndex contains indexed interface connections.
+ *
+ * Since: 1.59
+ */
+
+struct _SnapdConnectionIndex
+{
+    GObject parent_instance;
+
+    GPtrArray *established;
+    GPtrArray *undesired;
+    GPtrArray *plugs;
+    GPtrArray *slots;
+
+    /* Plugs and slots keyed by "snap:name" */
+    GHashTable *plugs_by_name;
+    GHashTable *slots_by_name;
+
+    /* Arrays of plugs, slots and connections keyed by snap name, interface or "snap:name" */
+    GHashTable *plugs_by_snap;
+    GHashTable *slots_by_snap;
+    GHashTable *plugs_by_interface;
+    GHashTable *slots_by_interface;
+    GHashTable *connections_by_interface;
+    GHashTable *connections_by_plug;
+    GHashTable *connections_by_slot;
+
+    /* Returned when nothing matches a lookup */
+    GPtrArray *empty;
+};
+
+G_DEFINE_TYPE (SnapdConnectionIndex, snapd_connection_index, G_TYPE_OBJECT)
+
+static gchar *
+make_key (const gchar *snap, const gchar *name)
+{
+    return g_strdup_printf ("%s:%s", snap, name);
+}
+
+static GHashTable *
+multi_index_new (void)
+{
+    return g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+}
+
+/* Add @object to the array stored in @table under @key. The objects are owned by the main arrays */
+static void
+multi_index_add (GHashTable *table, gchar *key, gpointer object)
+{
+    GPtrArray *array = g_hash_table_lookup (table, key);
+    if (array == NULL) {
+        array = g_ptr_array_new ();
+        g_hash_table_insert (table, key, array);
+    }
+    else
+        g_free (key);
+    g_ptr_array_add (array, object);
+}
+
+static GPtrArray *
+multi_index_lookup (SnapdConnectionIndex *self, GHashTable *table, const gchar *key)
+{
+    GPtrArray *array = g_hash_table_lookup (table, key);
+    return array != NULL ? array : self->empty;
+}
+
+SnapdConnectionIndex *
+_snapd_connection_index_new (GPtrArray *established, GPtrArray *undesired, GPtrArray *plugs, GPtrArray *slots)
+{
+    SnapdConnectionIndex *self = g_object_new (SNAPD_TYPE_CONNECTION_INDEX, NULL);
+
+    self->established = g_ptr_array_ref (established);
+    self->undesired = g_ptr_array_ref (undesired);
+    self->plugs = g_ptr_array_ref (plugs);
+    self->slots = g_ptr_array_ref (slots);
+
+    for (guint i = 0; i < plugs->len; i++) {
+        SnapdPlug *plug = plugs->pdata[i];
+        const gchar *snap = snapd_plug_get_snap (plug);
+        const gchar *interface = snapd_plug_get_interface (plug);
+
+        g_hash_table_insert (self->plugs_by_name, make_key (snap, snapd_plug_get_name (plug)), plug);
+        multi_index_add (self->plugs_by_snap, g_strdup (snap), plug);
+        if (interface != NULL)
+            multi_index_add (self->plugs_by_interface, g_strdup (interface), plug);
+    }
+
+    for (guint i = 0; i < slots->len; i++) {
+        SnapdSlot *slot = slots->pdata[i];
+        const gchar *snap = snapd_slot_get_snap (slot);
+        const gchar *interface = snapd_slot_get_interface (slot);
+
+        g_hash_table_insert (self->slots_by_name, make_key (snap, snapd_slot_get_name (slot)), slot);
+        multi_index_add (self->slots_by_snap, g_strdup (snap), slot);
+        if (interface != NULL)
+            multi_index_add (self->slots_by_interface, g_strdup (interface), slot);
+    }
+
+    for (guint i = 0; i < established->len; i++) {
+        SnapdConnection *connection = established->pdata[i];
+        SnapdPlugRef *plug_ref = snapd_connection_get_plug (connection);
+        SnapdSlotRef *slot_ref = snapd_connection_get_slot (connection);
+        const gchar *interface = snapd_connection_get_interface (connection);
+
+        if (interface != NULL)
+            multi_index_add (self->connections_by_interface, g_strdup (interface), connection);
+        if (plug_ref != NULL)
+            multi_index_add (self->connections_by_plug, make_key (snapd_plug_ref_get_snap (plug_ref), snapd_plug_ref_get_plug (plug_ref)), connection);
+        if (slot_ref != NULL)
+            multi_index_add (self->connections_by_slot, make_key (snapd_slot_ref_get_snap (slot_ref), snapd_slot_ref_get_slot (slot_ref)), connection);
+    }
+
+    return self;
+}
+
+/**
+ * snapd_connection_index_get_established:
+ * @index: a #SnapdConnectionIndex.
+ *
+ * Get the established connections.
+ *
+ * Returns: (transfer none) (element-type SnapdConnection): an array of #SnapdConnection.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_connection_index_get_established (SnapdConnectionIndex *self)
+{
+    g_return_val_if_fail (SNAPD_IS_CONNECTION_INDEX (self), NULL);
+    return self->established;
+}
+
+/**
+ * snapd_connection_index_get_undesired:
+ * @index: a #SnapdConnectionIndex.
+ *
+ * Get the auto-connected connections that have been manually disconnected.
+ *
+ * Returns: (transfer none) (element-type SnapdConnection): an array of #SnapdConnection.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_connection_index_get_undesired (SnapdConnectionIndex *self)
+{
+    g_return_val_if_fail (SNAPD_IS_CONNECTION_INDEX (self), NULL);
+    return self->undesired;
+}
+
+/**
+ * snapd_connection_index_get_plugs:
+ * @index: a #SnapdConnectionIndex.
+ *
+ * Get all the plugs.
+ *
+ * Returns: (transfer none) (element-type SnapdPlug): an array of #SnapdPlug.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_connection_index_get_plugs (SnapdConnectionIndex *self)
+{
+    g_return_val_if_fail (SNAPD_IS_CONNECTION_INDEX (self), NULL);
+    return self->plugs;
+}
+
+/**
+ * snapd_connection_index_get_slots:
+ * @index: a #SnapdConnectionIndex.
+ *
+ * Get all the slots.
+ *
+ * Returns: (transfer none) (element-type SnapdSlot): an array of #SnapdSlot.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_connection_index_get_slots (SnapdConnectionIndex *self)
+{
+    g_return_val_if_fail (SNAPD_IS_CONNECTION_INDEX (self), NULL);
+    return self->slots;
+}
+
+/**
+ * snapd_connection_index_lookup_plug:
+ * @index: a #SnapdConnectionIndex.
+ * @snap: name of the snap the plug is in.
+ * @name: name of the plug.
+ *
+ * Find a plug.
+ *
+ * Returns: (transfer none) (allow-none): a #SnapdPlug or %NULL if not present.
+ *
+ * Since: 1.59
+ */
+SnapdPlug *
+snapd_connection_index_lookup_plug (SnapdConnectionIndex *self, const gchar *snap, const gchar *name)
+{
+    g_return_val_if_fail (SNAPD_IS_CONNECTION_INDEX (self), NULL);
+    g_return_val_if_fail (snap != NULL, NULL);
+    g_return_val_if_fail (name != NULL, NULL);
+
+    g_autofree gchar *key = make_key (snap, name);
+    return g_hash_table_lookup (self->plugs_by_name, key);
+}
+
+/**
+ * snapd_connection_index_lookup_slot:
+ * @index: a #SnapdConnectionIndex.
+ * @snap: name of the snap the slot is in.
+ * @name: name of the slot.
+ *
+ * Find a slot.
+ *
+ * Returns: (transfer none) (allow-none): a #SnapdSlot or %NULL if not present.
+ *
+ * Since: 1.59
+ */
+SnapdSlot *
+snapd_connection_index_lookup_slot (SnapdConnectionIndex *self, const gchar *snap, const gchar *name)
+{
+    g_return_val_if_fail (SNAPD_IS_CONNECTION_INDEX (self), NULL);
+    g_return_val_if_fail (snap != NULL, NULL);
+    g_return_val_if_fail (name != NULL, NULL);
+
+    g_autofree gchar *key = make_key (snap, name);
+    return g_hash_table_lookup (self->slots_by_name, key);
+}
+
+/**
+ * snapd_connection_index_get_snap_plugs:
+ * @index: a #SnapdConnectionIndex.
+ * @snap: name of a snap.
+ *
+ * Get the plugs in a snap.
+ *
+ * Returns: (transfer none) (element-type SnapdPlug): an array of #SnapdPlug.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_connection_index_get_snap_plugs (SnapdConnectionIndex *self, const gchar *snap)
+{
+    g_return_val_if_fail (SNAPD_IS_CONNECTION_INDEX (self), NULL);
+    g_return_val_if_fail (snap != NULL, NULL);
+    return multi_index_lookup (self, self->plugs_by_snap, snap);
+}
+
+/**
+ * snapd_connection_index_get_snap_slots:
+ * @index: a #SnapdConnectionIndex.
+ * @snap: name of a snap.
+ *
+ * Get the slots in a snap.
+ *
+ * Returns: (transfer none) (element-type SnapdSlot): an array of #SnapdSlot.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_connection_index_get_snap_slots (SnapdConnectionIndex *self, const gchar *snap)
+{
+    g_return_val_if_fail (SNAPD_IS_CONNECTION_INDEX (self), NULL);
+    g_return_val_if_fail (snap != NULL, NULL);
+    return multi_index_lookup (self, self->slots_by_snap, snap);
+}
+
+/**
+ * snapd_connection_index_get_interface_plugs:
+ * @index: a #SnapdConnectionIndex.
+ * @interface: name of an interface.
+ *
+ * Get the plugs that use an interface.
+ *
+ * Returns: (transfer none) (element-type SnapdPlug): an array of #SnapdPlug.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_connection_index_get_interface_plugs (SnapdConnectionIndex *self, const gchar *interface)
+{
+    g_return_val_if_fail (SNAPD_IS_CONNECTION_INDEX (self), NULL);
+    g_return_val_if_fail (interface != NULL, NULL);
+    return multi_index_lookup (self, self->plugs_by_interface, interface);
+}
+
+/**
+ * snapd_connection_index_get_interface_slots:
+ * @index: a #SnapdConnectionIndex.
+ * @interface: name of an interface.
+ *
+ * Get the slots that provide an interface. To find the slots a plug can be
+ * connected to, use the interface from snapd_plug_get_interface().
+ *
+ * Returns: (transfer none) (element-type SnapdSlot): an array of #SnapdSlot.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_connection_index_get_interface_slots (SnapdConnectionIndex *self, const gchar *interface)
+{
+    g_return_val_if_fail (SNAPD_IS_CONNECTION_INDEX (self), NULL);
+    g_return_val_if_fail (interface != NULL, NULL);
+    return multi_index_lookup (self, self->slots_by_interface, interface);
+}
+
+/**
+ * snapd_connection_index_get_interface_connections:
+ * @index: a #SnapdConnectionIndex.
+ * @interface: name of an interface.
+ *
+ * Get the established connections using an interface.
+ *
+ * Returns: (transfer none) (element-type SnapdConnection): an array of #SnapdConnection.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_connection_index_get_interface_connections (SnapdConnectionIndex *self, const gchar *interface)
+{
+    g_return_val_if_fail (SNAPD_IS_CONNECTION_INDEX (self), NULL);
+    g_return_val_if_fail (interface != NULL, NULL);
+    return multi_index_lookup (self, self->connections_by_interface, interface);
+}
+
+/**
+ * snapd_connection_index_get_plug_connections:
+ * @index: a #SnapdConnectionIndex.
+ * @snap: name of the snap the plug is in.
+ * @name: name of the plug.
+ *
+ * Get the established connections to a plug.
+ *
+ * Returns: (transfer none) (element-type SnapdConnection): an array of #SnapdConnection.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_connection_index_get_plug_connections (SnapdConnectionIndex *self, const gchar *snap, const gchar *name)
+{
+    g_return_val_if_fail (SNAPD_IS_CONNECTION_INDEX (self), NULL);
+    g_return_val_if_fail (snap != NULL, NULL);
+    g_return_val_if_fail (name != NULL, NULL);
+
+    g_autofree gchar *key = make_key (snap, name);
+    return multi_index_lookup (self, self->connections_by_plug, key);
+}
+
+/**
+ * snapd_connection_index_get_slot_connections:
+ * @index: a #SnapdConnectionIndex.
+ * @snap: name of the snap the slot is in.
+ * @name: name of the slot.
+ *
+ * Get the established connections to a slot.
+ *
+ * Returns: (transfer none) (element-type SnapdConnection): an array of #SnapdConnection.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_connection_index_get_slot_connections (SnapdConnectionIndex *self, const gchar *snap, const gchar *name)
+{
+    g_return_val_if_fail (SNAPD_IS_CONNECTION_INDEX (self), NULL);
+    g_return_val_if_fail (snap != NULL, NULL);
+    g_return_val_if_fail (name != NULL, NULL);
+
+    g_autofree gchar *key = make_key (snap, name);
+    return multi_index_lookup (self, self->connections_by_slot, key);
+}
+
+static void
+snapd_connection_index_finalize (GObject *object)
+{
+    SnapdConnectionIndex *self = SNAPD_CONNECTION_INDEX (object);
+
+    g_clear_pointer (&self->established, g_ptr_array_unref);
+    g_clear_pointer (&self->undesired, g_ptr_array_unref);
+    g_clear_pointer (&self->plugs, g_ptr_array_unref);
+    g_clear_pointer (&self->slots, g_ptr_array_unref);
+    g_clear_pointer (&self->plugs_by_name, g_hash_table_unref);
+    g_clear_pointer (&self->slots_by_name, g_hash_table_unref);
+    g_clear_pointer (&self->plugs_by_snap, g_hash_table_unref);
+    g_clear_pointer (&self->slots_by_snap, g_hash_table_unref);
+    g_clear_pointer (&self->plugs_by_interface, g_hash_table_unref);
+    g_clear_pointer (&self->slots_by_interface, g_hash_table_unref);
+    g_clear_pointer (&self->connections_by_interface, g_hash_table_unref);
+    g_clear_pointer (&self->connections_by_plug, g_hash_table_unref);
+    g_clear_pointer (&self->connections_by_slot, g_hash_table_unref);
+    g_clear_pointer (&self->empty, g_ptr_array_unref);
+
+    G_OBJECT_CLASS (snapd_connection_index_parent_class)->finalize (object);
+}
+
+static void
+snapd_connection_index_class_init (SnapdConnectionIndexClass *klass)
+{
+    GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+    gobject_class->finalize = snapd_connection_index_finalize;
+}
+
+static void
+snapd_connection_index_init (SnapdConnectionIndex *self)
+{
+    self->plugs_by_name = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    self->slots_by_name = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    self->plugs_by_snap = multi_index_new ();
+    self->slots_by_snap = multi_index_new ();
+    self->plugs_by_interface = multi_index_new ();
+    self->slots_by_interface = multi_index_new ();
+    self->connections_by_interface = multi_index_new ();
+    self->connections_by_plug = multi_index_new ();
+    self->connections_by_slot = multi_index_new ();
+    self->empty = g_ptr_array_new ();
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_CONNECTION_INDEX_H__
+#define __SNAPD_CONNECTION_INDEX_H__
+
+#if !defined(__SNAPD_GLIB_INSIDE__) && !defined(SNAPD_COMPILATION)
+#error "Only <snapd-glib/snapd-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <snapd-glib/snapd-connection.h>
+#include <snapd-glib/snapd-plug.h>
+#include <snapd-glib/snapd-slot.h>
+
+G_BEGIN_DECLS
+
+#define SNAPD_TYPE_CONNECTION_INDEX (snapd_connection_index_get_type ())
+
+G_DECLARE_FINAL_TYPE (SnapdConnectionIndex, snapd_connection_index, SNAPD, CONNECTION_INDEX, GObject)
+
+GPtrArray *snapd_connection_index_get_established           (SnapdConnectionIndex *index);
+
+GPtrArray *snapd_connection_index_get_undesired             (SnapdConnectionIndex *index);
+
+GPtrArray *snapd_connection_index_get_plugs                 (SnapdConnectionIndex *index);
+
+GPtrArray *snapd_connection_index_get_slots                 (SnapdConnectionIndex *index);
+
+SnapdPlug *snapd_connection_index_lookup_plug               (SnapdConnectionIndex *index,
+                                                             const gchar          *snap,
+                                                             const gchar          *name);
+
+SnapdSlot *snapd_connection_index_lookup_slot               (SnapdConnectionIndex *index,
+                                                             const gchar          *snap,
+                                                             const gchar          *name);
+
+GPtrArray *snapd_connection_index_get_snap_plugs            (SnapdConnectionIndex *index,
+                                                             const gchar          *snap);
+
+GPtrArray *snapd_connection_index_get_snap_slots            (SnapdConnectionIndex *index,
+                                                             const gchar          *snap);
+
+GPtrArray *snapd_connection_index_get_interface_plugs       (SnapdConnectionIndex *index,
+                                                             const gchar          *interface);
+
+GPtrArray *snapd_connection_index_get_interface_slots       (SnapdConnectionIndex *index,
+                                                             const gchar          *interface);
+
+GPtrArray *snapd_connection_index_get_interface_connections (SnapdConnectionIndex *index,
+                                                             const gchar          *interface);
+
+GPtrArray *snapd_connection_index_get_plug_connections      (SnapdConnectionIndex *index,
+                                                             const gchar          *snap,
+                                                             const gchar          *name);
+
+GPtrArray *snapd_connection_index_get_slot_connections      (SnapdConnectionIndex *index,
+                                                             const gchar          *snap,
+                                                             const gchar          *name);
+
+G_END_DECLS
+
+#endif /* __SNAPD_CONNECTION_INDEX_H__ */
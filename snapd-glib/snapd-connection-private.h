@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_CONNECTION_PRIVATE_H__
+#define __SNAPD_CONNECTION_PRIVATE_H__
+
+#include "snapd-connection.h"
+
+G_BEGIN_DECLS
+
+/* The connection takes ownership of all the values, @interface is a reference counted string */
+SnapdConnection *_snapd_connection_new (SnapdSlotRef        *slot,
+                                        SnapdPlugRef        *plug,
+                                        gchar               *interface,
+                                        gboolean             manual,
+                                        gboolean             gadget,
+                                        GHashTable          *slot_attributes,
+                                        GHashTable          *plug_attributes);
+
+G_END_DECLS
+
+#endif /* __SNAPD_CONNECTION_PRIVATE_H__ */
@@ -9,7 +9,8 @@
 
 #include <string.h>
 
-#include "snapd-connection.h"
+#include "snapd-connection-private.h"
+#include "snapd-string-pool.h"
 
 /**
  * SECTION: snapd-connection
@@ -61,6 +62,22 @@ enum
 
 G_DEFINE_TYPE (SnapdConnection, snapd_connection, G_TYPE_OBJECT)
 
+SnapdConnection *
+_snapd_connection_new (SnapdSlotRef *slot, SnapdPlugRef *plug, gchar *interface, gboolean manual, gboolean gadget, GHashTable *slot_attributes, GHashTable *plug_attributes)
+{
+    SnapdConnection *self = g_object_new (SNAPD_TYPE_CONNECTION, NULL);
+
+    self->slot = slot;
+    self->plug = plug;
+    self->interface = interface;
+    self->manual = manual;
+    self->gadget = gadget;
+    self->slot_attributes = slot_attributes;
+    self->plug_attributes = plug_attributes;
+
+    return self;
+}
+
 /**
  * snapd_connection_get_slot:
  * @connection: a #SnapdConnection.
@@ -337,8 +354,8 @@ snapd_connection_set_property (GObject *object, guint prop_id, const GValue *val
         g_set_object (&self->slot, g_value_get_object (value));
         break;
     case PROP_INTERFACE:
-        g_free (self->interface);
-        self->interface = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->interface);
+        self->interface = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_MANUAL:
         self->manual = g_value_get_boolean (value);
@@ -408,7 +425,7 @@ snapd_connection_finalize (GObject *object)
 
     g_clear_object (&self->slot);
     g_clear_object (&self->plug);
-    g_clear_pointer (&self->interface, g_free);
+    g_clear_pointer (&self->interface, _snapd_ref_string_release);
     g_clear_pointer (&self->slot_attributes, g_hash_table_unref);
     g_clear_pointer (&self->plug_attributes, g_hash_table_unref);
     g_clear_pointer (&self->name, g_free);
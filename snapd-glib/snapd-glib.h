@@ -19,6 +19,7 @@
 #include <snapd-glib/snapd-channel.h>
 #include <snapd-glib/snapd-client.h>
 #include <snapd-glib/snapd-connection.h>
+#include <snapd-glib/snapd-connection-index.h>
 #include <snapd-glib/snapd-enum-types.h>
 #include <snapd-glib/snapd-error.h>
 #include <snapd-glib/snapd-icon.h>
@@ -35,6 +36,7 @@
 #include <snapd-glib/snapd-slot.h>
 #include <snapd-glib/snapd-slot-ref.h>
 #include <snapd-glib/snapd-snap.h>
+#include <snapd-glib/snapd-snap-set.h>
 #include <snapd-glib/snapd-system-information.h>
 #include <snapd-glib/snapd-task.h>
 #include <snapd-glib/snapd-user-information.h>
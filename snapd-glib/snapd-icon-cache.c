@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "snapd-icon-cache.h"
+
+/* Cache of snap icons stored on disk.
+ * Each icon is stored in a file named "<name>@<revision>.icon" containing the MIME type on the first line followed by the icon data.
+ * The file modification time is updated when an icon is used, so the least recently used icons can be removed when the cache is full. */
+
+/* Longest MIME type accepted in a cache file */
+#define MAX_MIME_TYPE_LENGTH 255
+
+typedef struct
+{
+    gchar *filename;
+    gchar *name;
+    gchar *revision;
+    guint64 size;
+    gint64 last_used;
+    GList link;
+} CacheEntry;
+
+struct _SnapdIconCache
+{
+    GMutex mutex;
+
+    /* Directory to store icons in, or %NULL for the default */
+    gchar *path;
+    gchar *dir;
+
+    /* Maximum total size of cached icons (0 to disable caching) */
+    guint64 max_size;
+
+    /* Entries on disk, keyed by filename and ordered by most recently used */
+    gboolean loaded;
+    GHashTable *entries;
+    GQueue lru;
+    guint64 size;
+
+    /* Current revision of each snap, keyed by name */
+    GHashTable *revisions;
+
+    guint64 n_hits;
+    guint64 n_misses;
+};
+
+static void
+cache_entry_free (CacheEntry *entry)
+{
+    g_free (entry->filename);
+    g_free (entry->name);
+    g_free (entry->revision);
+    g_slice_free (CacheEntry, entry);
+}
+
+static gint
+compare_last_used (gconstpointer a, gconstpointer b)
+{
+    const CacheEntry *entry_a = *((CacheEntry **) a);
+    const CacheEntry *entry_b = *((CacheEntry **) b);
+
+    if (entry_a->last_used < entry_b->last_used)
+        return -1;
+    else if (entry_a->last_used > entry_b->last_used)
+        return 1;
+    else
+        return 0;
+}
+
+static gchar *
+make_filename (const gchar *name, const gchar *revision)
+{
+    g_autofree gchar *escaped_name = g_uri_escape_string (name, NULL, FALSE);
+    g_autofree gchar *escaped_revision = g_uri_escape_string (revision, NULL, FALSE);
+    return g_strdup_printf ("%s@%s.icon", escaped_name, escaped_revision);
+}
+
+static const gchar *
+get_dir_unlocked (SnapdIconCache *cache)
+{
+    if (cache->dir == NULL) {
+        if (cache->path != NULL)
+            cache->dir = g_strdup (cache->path);
+        else
+            cache->dir = g_build_filename (g_get_user_cache_dir (), "snapd-glib", "icons", NULL);
+    }
+
+    return cache->dir;
+}
+
+static void
+remove_entry_unlocked (SnapdIconCache *cache, CacheEntry *entry)
+{
+    g_autofree gchar *path = g_build_filename (get_dir_unlocked (cache), entry->filename, NULL);
+    g_unlink (path);
+
+    g_queue_unlink (&cache->lru, &entry->link);
+    cache->size -= entry->size;
+    g_hash_table_remove (cache->entries, entry->filename);
+}
+
+/* Remove the least recently used icons until the cache fits in the size limit */
+static void
+evict_unlocked (SnapdIconCache *cache)
+{
+    while (cache->size > cache->max_size && cache->lru.tail != NULL)
+        remove_entry_unlocked (cache, cache->lru.tail->data);
+}
+
+static void
+add_entry_unlocked (SnapdIconCache *cache, CacheEntry *entry)
+{
+    entry->link.data = entry;
+    g_queue_push_head_link (&cache->lru, &entry->link);
+    cache->size += entry->size;
+    g_hash_table_insert (cache->entries, entry->filename, entry);
+}
+
+/* Read the icons previously stored on disk */
+static void
+load_unlocked (SnapdIconCache *cache)
+{
+    if (cache->loaded)
+        return;
+    cache->loaded = TRUE;
+
+    const gchar *dir_path = get_dir_unlocked (cache);
+    g_autoptr(GDir) dir = g_dir_open (dir_path, 0, NULL);
+    if (dir == NULL)
+        return;
+
+    g_autoptr(GPtrArray) entries = g_ptr_array_new ();
+    const gchar *filename;
+    while ((filename = g_dir_read_name (dir)) != NULL) {
+        if (!g_str_has_suffix (filename, ".icon"))
+            continue;
+        const gchar *divider = strchr (filename, '@');
+        if (divider == NULL)
+            continue;
+
+        g_autofree gchar *path = g_build_filename (dir_path, filename, NULL);
+        GStatBuf stat_buf;
+        if (g_stat (path, &stat_buf) != 0)
+            continue;
+
+        g_autofree gchar *escaped_name = g_strndup (filename, divider - filename);
+        g_autofree gchar *escaped_revision = g_strndup (divider + 1, strlen (divider + 1) - strlen (".icon"));
+        CacheEntry *entry = g_slice_new0 (CacheEntry);
+        entry->filename = g_strdup (filename);
+        entry->name = g_uri_unescape_string (escaped_name, NULL);
+        entry->revision = g_uri_unescape_string (escaped_revision, NULL);
+        entry->size = stat_buf.st_size;
+        entry->last_used = stat_buf.st_mtime;
+        if (entry->name == NULL || entry->revision == NULL) {
+            cache_entry_free (entry);
+            continue;
+        }
+        g_ptr_array_add (entries, entry);
+    }
+
+    /* Add oldest first so the most recently used ends up at the front */
+    g_ptr_array_sort (entries, compare_last_used);
+    for (guint i = 0; i < entries->len; i++)
+        add_entry_unlocked (cache, g_ptr_array_index (entries, i));
+
+    evict_unlocked (cache);
+}
+
+static void
+reset_unlocked (SnapdIconCache *cache)
+{
+    g_hash_table_remove_all (cache->entries);
+    g_queue_init (&cache->lru);
+    cache->size = 0;
+    cache->loaded = FALSE;
+    g_clear_pointer (&cache->dir, g_free);
+}
+
+SnapdIconCache *
+_snapd_icon_cache_new (void)
+{
+    SnapdIconCache *cache = g_slice_new0 (SnapdIconCache);
+    g_mutex_init (&cache->mutex);
+    cache->entries = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) cache_entry_free);
+    g_queue_init (&cache->lru);
+    cache->revisions = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+    return cache;
+}
+
+void
+_snapd_icon_cache_set_path (SnapdIconCache *cache, const gchar *path)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&cache->mutex);
+
+    if (g_strcmp0 (path, cache->path) == 0)
+        return;
+
+    g_free (cache->path);
+    cache->path = g_strdup (path);
+    reset_unlocked (cache);
+}
+
+const gchar *
+_snapd_icon_cache_get_path (SnapdIconCache *cache)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&cache->mutex);
+    return get_dir_unlocked (cache);
+}
+
+void
+_snapd_icon_cache_set_max_size (SnapdIconCache *cache, guint64 max_size)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&cache->mutex);
+
+    /* Leave the icons on disk when disabling the cache */
+    cache->max_size = max_size;
+    if (cache->loaded && max_size > 0)
+        evict_unlocked (cache);
+}
+
+guint64
+_snapd_icon_cache_get_max_size (SnapdIconCache *cache)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&cache->mutex);
+    return cache->max_size;
+}
+
+gchar *
+_snapd_icon_cache_get_revision (SnapdIconCache *cache, const gchar *name)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&cache->mutex);
+
+    if (name == NULL)
+        return NULL;
+
+    return g_strdup (g_hash_table_lookup (cache->revisions, name));
+}
+
+/* Record the installed revision of a snap, removing icons from other revisions */
+void
+_snapd_icon_cache_set_revision (SnapdIconCache *cache, const gchar *name, const gchar *revision)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&cache->mutex);
+
+    if (name == NULL || revision == NULL)
+        return;
+    if (g_strcmp0 (g_hash_table_lookup (cache->revisions, name), revision) == 0)
+        return;
+    g_hash_table_insert (cache->revisions, g_strdup (name), g_strdup (revision));
+
+    if (cache->max_size == 0)
+        return;
+
+    load_unlocked (cache);
+    GList *link = cache->lru.head;
+    while (link != NULL) {
+        CacheEntry *entry = link->data;
+        link = link->next;
+        if (strcmp (entry->name, name) == 0 && strcmp (entry->revision, revision) != 0)
+            remove_entry_unlocked (cache, entry);
+    }
+}
+
+SnapdIcon *
+_snapd_icon_cache_lookup (SnapdIconCache *cache, const gchar *name, const gchar *revision)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&cache->mutex);
+
+    if (cache->max_size == 0 || name == NULL)
+        return NULL;
+
+    /* Can't use the cache until the installed revision is known */
+    if (revision == NULL) {
+        cache->n_misses++;
+        return NULL;
+    }
+
+    load_unlocked (cache);
+
+    g_autofree gchar *filename = make_filename (name, revision);
+    CacheEntry *entry = g_hash_table_lookup (cache->entries, filename);
+    if (entry == NULL) {
+        cache->n_misses++;
+        return NULL;
+    }
+
+    /* Map the icon rather than reading it, the data is only used if the icon is drawn */
+    g_autofree gchar *path = g_build_filename (get_dir_unlocked (cache), filename, NULL);
+    g_autoptr(GMappedFile) file = g_mapped_file_new (path, FALSE, NULL);
+    const gchar *contents = file != NULL ? g_mapped_file_get_contents (file) : NULL;
+    gsize length = file != NULL ? g_mapped_file_get_length (file) : 0;
+    const gchar *divider = contents != NULL ? memchr (contents, '\n', MIN (length, MAX_MIME_TYPE_LENGTH + 1)) : NULL;
+    if (divider == NULL) {
+        remove_entry_unlocked (cache, entry);
+        cache->n_misses++;
+        return NULL;
+    }
+
+    g_autofree gchar *mime_type = g_strndup (contents, divider - contents);
+    g_autoptr(GBytes) file_data = g_mapped_file_get_bytes (file);
+    gsize offset = divider - contents + 1;
+    g_autoptr(GBytes) data = g_bytes_new_from_bytes (file_data, offset, length - offset);
+
+    entry->last_used = g_get_real_time () / G_USEC_PER_SEC;
+    g_utime (path, NULL);
+    g_queue_unlink (&cache->lru, &entry->link);
+    g_queue_push_head_link (&cache->lru, &entry->link);
+    cache->n_hits++;
+
+    return g_object_new (SNAPD_TYPE_ICON,
+                         "mime-type", mime_type,
+                         "data", data,
+                         NULL);
+}
+
+void
+_snapd_icon_cache_insert (SnapdIconCache *cache, const gchar *name, const gchar *revision, SnapdIcon *icon)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&cache->mutex);
+
+    if (cache->max_size == 0 || name == NULL || revision == NULL)
+        return;
+
+    const gchar *mime_type = snapd_icon_get_mime_type (icon);
+    GBytes *data = snapd_icon_get_data (icon);
+    if (mime_type == NULL || strlen (mime_type) > MAX_MIME_TYPE_LENGTH || strchr (mime_type, '\n') != NULL || data == NULL)
+        return;
+
+    gsize data_length;
+    const guint8 *data_contents = g_bytes_get_data (data, &data_length);
+    guint64 size = strlen (mime_type) + 1 + data_length;
+    if (size > cache->max_size)
+        return;
+
+    load_unlocked (cache);
+
+    const gchar *dir = get_dir_unlocked (cache);
+    if (g_mkdir_with_parents (dir, 0700) != 0)
+        return;
+
+    g_autoptr(GByteArray) contents = g_byte_array_sized_new (size);
+    g_byte_array_append (contents, (const guint8 *) mime_type, strlen (mime_type));
+    g_byte_array_append (contents, (const guint8 *) "\n", 1);
+    g_byte_array_append (contents, data_contents, data_length);
+
+    g_autofree gchar *filename = make_filename (name, revision);
+    g_autofree gchar *path = g_build_filename (dir, filename, NULL);
+    if (!g_file_set_contents (path, (const gchar *) contents->data, contents->len, NULL))
+        return;
+
+    /* Replace any existing entry, the file has already been overwritten */
+    CacheEntry *entry = g_hash_table_lookup (cache->entries, filename);
+    if (entry != NULL) {
+        g_queue_unlink (&cache->lru, &entry->link);
+        cache->size -= entry->size;
+        g_hash_table_remove (cache->entries, filename);
+    }
+
+    entry = g_slice_new0 (CacheEntry);
+    entry->filename = g_steal_pointer (&filename);
+    entry->name = g_strdup (name);
+    entry->revision = g_strdup (revision);
+    entry->size = size;
+    entry->last_used = g_get_real_time () / G_USEC_PER_SEC;
+    add_entry_unlocked (cache, entry);
+
+    evict_unlocked (cache);
+}
+
+void
+_snapd_icon_cache_get_stats (SnapdIconCache *cache, guint64 *n_hits, guint64 *n_misses, guint *n_entries, guint64 *size)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&cache->mutex);
+
+    if (n_hits != NULL)
+        *n_hits = cache->n_hits;
+    if (n_misses != NULL)
+        *n_misses = cache->n_misses;
+    if (n_entries != NULL)
+        *n_entries = g_hash_table_size (cache->entries);
+    if (size != NULL)
+        *size = cache->size;
+}
+
+void
+_snapd_icon_cache_free (SnapdIconCache *cache)
+{
+    g_mutex_clear (&cache->mutex);
+    g_clear_pointer (&cache->path, g_free);
+    g_clear_pointer (&cache->dir, g_free);
+    g_hash_table_unref (cache->entries);
+    g_hash_table_unref (cache->revisions);
+    g_slice_free (SnapdIconCache, cache);
+}
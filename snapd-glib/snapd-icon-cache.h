@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_ICON_CACHE_H__
+#define __SNAPD_ICON_CACHE_H__
+
+#include "snapd-icon.h"
+
+G_BEGIN_DECLS
+
+typedef struct _SnapdIconCache SnapdIconCache;
+
+SnapdIconCache *_snapd_icon_cache_new            (void);
+
+void            _snapd_icon_cache_set_path       (SnapdIconCache *cache,
+                                                  const gchar    *path);
+
+const gchar    *_snapd_icon_cache_get_path       (SnapdIconCache *cache);
+
+void            _snapd_icon_cache_set_max_size   (SnapdIconCache *cache,
+                                                  guint64         max_size);
+
+guint64         _snapd_icon_cache_get_max_size   (SnapdIconCache *cache);
+
+gchar          *_snapd_icon_cache_get_revision   (SnapdIconCache *cache,
+                                                  const gchar    *name);
+
+void            _snapd_icon_cache_set_revision   (SnapdIconCache *cache,
+                                                  const gchar    *name,
+                                                  const gchar    *revision);
+
+SnapdIcon      *_snapd_icon_cache_lookup         (SnapdIconCache *cache,
+                                                  const gchar    *name,
+                                                  const gchar    *revision);
+
+void            _snapd_icon_cache_insert         (SnapdIconCache *cache,
+                                                  const gchar    *name,
+                                                  const gchar    *revision,
+                                                  SnapdIcon      *icon);
+
+void            _snapd_icon_cache_get_stats      (SnapdIconCache *cache,
+                                                  guint64        *n_hits,
+                                                  guint64        *n_misses,
+                                                  guint          *n_entries,
+                                                  guint64        *size);
+
+void            _snapd_icon_cache_free           (SnapdIconCache *cache);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SnapdIconCache, _snapd_icon_cache_free)
+
+G_END_DECLS
+
+#endif /* __SNAPD_ICON_CACHE_H__ */
@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2019 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_MARKDOWN_NODE_PRIVATE_H__
+#define __SNAPD_MARKDOWN_NODE_PRIVATE_H__
+
+#include "snapd-markdown-node.h"
+
+G_BEGIN_DECLS
+
+/* The node takes ownership of @text and @children */
+SnapdMarkdownNode *_snapd_markdown_node_new (SnapdMarkdownNodeType  node_type,
+                                             gchar                 *text,
+                                             GPtrArray             *children);
+
+G_END_DECLS
+
+#endif /* __SNAPD_MARKDOWN_NODE_PRIVATE_H__ */
@@ -9,7 +9,7 @@
 
 #include <ctype.h>
 
-#include "snapd-markdown-node.h"
+#include "snapd-markdown-node-private.h"
 #include "snapd-enum-types.h"
 
 /**
@@ -47,6 +47,18 @@ enum
 
 G_DEFINE_TYPE (SnapdMarkdownNode, snapd_markdown_node, G_TYPE_OBJECT)
 
+SnapdMarkdownNode *
+_snapd_markdown_node_new (SnapdMarkdownNodeType node_type, gchar *text, GPtrArray *children)
+{
+    SnapdMarkdownNode *self = g_object_new (SNAPD_TYPE_MARKDOWN_NODE, NULL);
+
+    self->node_type = node_type;
+    self->text = text;
+    self->children = children;
+
+    return self;
+}
+
 static void
 snapd_markdown_node_set_property (GObject *object, guint prop_id, const GValue *value, GParamSpec *pspec)
 {
@@ -11,7 +11,7 @@
 #include <string.h>
 
 #include "snapd-markdown-parser.h"
-#include "snapd-markdown-node.h"
+#include "snapd-markdown-node-private.h"
 
 /**
  * SECTION:snapd-markdown-parser
@@ -51,91 +51,116 @@ struct _SnapdMarkdownParser
 
 G_DEFINE_TYPE (SnapdMarkdownParser, snapd_markdown_parser, G_TYPE_OBJECT)
 
+/* A line being parsed, pointing into the original text. Lines inside list
+ * items point to the remainder of the line after the list indentation */
+typedef struct
+{
+    const gchar *text;
+    gsize length;
+} Line;
+
+typedef struct
+{
+    SnapdMarkdownParser *parser;
+
+    /* Lines of the text, followed by the lines of the list items being parsed */
+    GArray *lines;
+
+    /* Text of the block being parsed */
+    GString *block_text;
+
+    /* Text of the inline node being made */
+    GString *node_text;
+} ParseState;
+
+static void
+add_line (ParseState *state, const gchar *text, gsize length)
+{
+    /* Empty lines only occur after list markers and contain nothing to parse */
+    if (length == 0)
+        return;
+
+    Line line = { text, length };
+    g_array_append_val (state->lines, line);
+}
+
 static gboolean
-parse_empty_line (const gchar *line)
+parse_empty_line (const Line *line)
 {
-    for (int i = 0; line[i] != '\0'; i++)
-        if (!isspace (line[i]))
+    for (gsize i = 0; i < line->length; i++)
+        if (!isspace (line->text[i]))
             return FALSE;
     return TRUE;
 }
 
-static gboolean
-parse_paragraph (const gchar *line, gchar **text)
+static gsize
+parse_paragraph (const Line *line)
 {
-    int i = 0;
-    while (isspace (line[i]))
+    gsize i = 0;
+    while (i < line->length && isspace (line->text[i]))
         i++;
 
-    if (text != NULL)
-        *text = g_strdup (line + i);
-
-    return TRUE;
+    return i;
 }
 
 static gboolean
-parse_bullet_list_item (const gchar *line, int *offset, gchar *symbol, gchar **bullet_text)
+parse_bullet_list_item (const Line *line, gsize *offset, gchar *symbol, gsize *text_offset)
 {
-    int i = 0;
-    while (isspace (line[i]))
+    gsize i = 0;
+    while (i < line->length && isspace (line->text[i]))
         i++;
-    gchar symbol_ = line[i];
+    if (i >= line->length)
+        return FALSE;
+    gchar symbol_ = line->text[i];
     if (symbol_ != '-' && symbol_ != '+' && symbol_ != '*')
         return FALSE;
-    int marker_offset = i;
+    gsize marker_offset = i;
     i++;
-    if (line[i] == '\0')
+    if (i >= line->length)
         return FALSE;
 
-    if (!isspace (line[i]))
+    if (!isspace (line->text[i]))
         return FALSE;
     i++;
 
-    int offset_ = i;
-    while (isspace (line[offset_]))
+    gsize offset_ = i;
+    while (offset_ < line->length && isspace (line->text[offset_]))
         offset_++;
 
     /* Blank lines start one place after marker */
-    if (line[offset_] == '\0')
+    if (offset_ >= line->length)
        offset_ = marker_offset + 1;
 
     if (offset != NULL)
         *offset = offset_;
     if (symbol != NULL)
         *symbol = symbol_;
-    if (bullet_text != NULL)
-        *bullet_text = g_strdup (line + i);
+    if (text_offset != NULL)
+        *text_offset = i;
 
     return TRUE;
 }
 
 static gboolean
-parse_list_item_line (const gchar *line, int offset, gchar **text)
+parse_list_item_line (const Line *line, gsize offset)
 {
-    for (int i = 0; i < offset; i++) {
-        if (!isspace (line[i]))
+    if (offset > line->length)
+        return FALSE;
+    for (gsize i = 0; i < offset; i++) {
+        if (!isspace (line->text[i]))
             return FALSE;
     }
 
-    if (text != NULL)
-        *text = g_strdup (line + offset);
-
     return TRUE;
 }
 
 static gboolean
-parse_indented_code_block (const gchar *line, gchar **text)
+parse_indented_code_block (const Line *line)
 {
-    int space_count = 0;
-    while (line[space_count] == ' ')
+    gsize space_count = 0;
+    while (space_count < line->length && line->text[space_count] == ' ')
         space_count++;
-    if (space_count < 4)
-        return FALSE;
-
-    if (text != NULL)
-        *text = g_strdup (line + 4);
-
-    return TRUE;
+    return space_count >= 4;
 }
 
 static gboolean
@@ -145,16 +170,16 @@ is_punctuation_character (gchar c)
     // FIXME: Also support unicode categories Pc, Pd, Pe, Pf, Pi, Po, and Ps.
 }
 
+/* Backslash before punctuation, a backslash at the end of the text is kept */
 static gboolean
-is_left_flanking_delimiter_run (const gchar *text, int index)
+is_escape (const gchar *text)
 {
-    if (text[index] != '*' && text[index] != '_')
-        return FALSE;
-
-    int run_length = 1;
-    while (text[index + run_length] == text[index])
-        run_length++;
+    return text[0] == '\\' && text[1] != '\0' && is_punctuation_character (text[1]);
+}
 
+static gboolean
+is_left_flanking_delimiter_run (const gchar *text, int index, int run_length)
+{
     /* 1) Must not be followed by whitespace */
     if (text[index + run_length] == '\0')
         return FALSE;
@@ -175,15 +200,8 @@ is_left_flanking_delimiter_run (const gchar *text, int index)
 }
 
 static gboolean
-is_right_flanking_delimiter_run (const gchar *text, int index)
+is_right_flanking_delimiter_run (const gchar *text, int index, int run_length)
 {
-    if (text[index] != '*' && text[index] != '_')
-        return FALSE;
-
-    int run_length = 1;
-    while (text[index + run_length] == text[index])
-        run_length++;
-
     /* 1) Not preceeded by whitespace */
     if (index == 0 || isspace (text[index - 1]))
         return FALSE;
@@ -201,18 +219,18 @@ is_right_flanking_delimiter_run (const gchar *text, int index)
     return FALSE;
 }
 
-static gchar *
-strip_text (const gchar *text)
+static void
+strip_text (GString *stripped_text, const gchar *text, int length)
 {
-    g_autoptr(GString) stripped_text = g_string_new ("");
+    g_string_truncate (stripped_text, 0);
 
     /* Strip leading whitespace */
     int i = 0;
-    while (isspace (text[i]))
+    while (i < length && isspace (text[i]))
         i++;
 
     gboolean in_whitespace = FALSE;
-    while (text[i] != '\0') {
+    while (i < length) {
         if (isspace (text[i]))
             in_whitespace = TRUE;
         else {
@@ -223,10 +241,9 @@ strip_text (const gchar *text)
         }
         i++;
     }
-
-    return g_steal_pointer (&stripped_text->str);
 }
 
+/* Delimiter run that might become emphasis. Other nodes have a zero length */
 typedef struct
 {
     gchar character;
@@ -235,46 +252,22 @@ typedef struct
     gboolean can_close_emphasis;
 } EmphasisInfo;
 
-static EmphasisInfo *
-emphasis_info_new (void)
+static SnapdMarkdownNode *
+make_text_node (const gchar *text, gsize length)
 {
-    return g_new0 (EmphasisInfo, 1);
+    return _snapd_markdown_node_new (SNAPD_MARKDOWN_NODE_TYPE_TEXT, g_strndup (text, length), NULL);
 }
 
-static void
-emphasis_info_free (EmphasisInfo *info)
+static SnapdMarkdownNode *
+make_paragraph_text_node (ParseState *state, const gchar *text, int length)
 {
-    g_free (info);
-}
-
-G_DEFINE_AUTOPTR_CLEANUP_FUNC (EmphasisInfo, emphasis_info_free)
-
-SnapdMarkdownNode *
-make_text_node (const gchar *text, int length)
-{
-    if (length > 0) {
-        g_autofree gchar *subtext = g_strndup (text, length);
-        return g_object_new (SNAPD_TYPE_MARKDOWN_NODE,
-                             "node-type", SNAPD_MARKDOWN_NODE_TYPE_TEXT,
-                             "text", subtext,
-                             NULL);
-    }
-    else
-        return g_object_new (SNAPD_TYPE_MARKDOWN_NODE,
-                             "node-type", SNAPD_MARKDOWN_NODE_TYPE_TEXT,
-                             "text", text,
-                             NULL);
-}
-
-SnapdMarkdownNode *
-make_paragraph_text_node (SnapdMarkdownParser *self, const gchar *text, int length)
-{
-    if (self->preserve_whitespace)
+    if (state->parser->preserve_whitespace)
         return make_text_node (text, length);
 
-    g_autoptr(GString) result = g_string_new ("");
+    GString *result = state->node_text;
+    g_string_truncate (result, 0);
     gchar last_c = '\0';
-    for (int i = 0; text[i] != '\0' && (length == -1 || i < length); i++) {
+    for (int i = 0; i < length; i++) {
         gchar c = text[i];
         if (isspace (c)) {
             if (!isspace (last_c))
@@ -285,107 +278,98 @@ make_paragraph_text_node (SnapdMarkdownParser *self, const gchar *text, int leng
         last_c = c;
     }
 
-    return make_text_node (result->str, -1);
+    return make_text_node (result->str, result->len);
 }
 
-SnapdMarkdownNode *
-make_delimiter_node (EmphasisInfo *info)
+static SnapdMarkdownNode *
+make_delimiter_node (const EmphasisInfo *info)
 {
-    g_autofree gchar *text = g_malloc (info->length + 1);
-    for (int i = 0; i < info->length; i++)
-        text[i] = info->character;
+    gchar *text = g_malloc (info->length + 1);
+    memset (text, info->character, info->length);
     text[info->length] = '\0';
 
-    return g_object_new (SNAPD_TYPE_MARKDOWN_NODE,
-                         "node-type", SNAPD_MARKDOWN_NODE_TYPE_TEXT,
-                         "text", text,
-                         NULL);
+    return _snapd_markdown_node_new (SNAPD_MARKDOWN_NODE_TYPE_TEXT, text, NULL);
 }
 
-SnapdMarkdownNode *
-make_code_node (SnapdMarkdownNodeType type, const gchar *text)
+static SnapdMarkdownNode *
+make_code_node (SnapdMarkdownNodeType type, const gchar *text, gsize length)
 {
-    g_autoptr(GPtrArray) children = g_ptr_array_new_with_free_func (g_object_unref);
-    g_ptr_array_add (children, make_text_node (text, -1));
-    return g_object_new (SNAPD_TYPE_MARKDOWN_NODE,
-                         "node-type", type,
-                         "children", children,
-                         NULL);
+    GPtrArray *children = g_ptr_array_new_with_free_func (g_object_unref);
+    g_ptr_array_add (children, make_text_node (text, length));
+    return _snapd_markdown_node_new (type, NULL, children);
+}
+
+static void
+add_inline_node (GPtrArray *nodes, GArray *delimiters, SnapdMarkdownNode *node, const EmphasisInfo *info)
+{
+    EmphasisInfo empty_info = { 0 };
+    g_ptr_array_add (nodes, node);
+    if (info != NULL)
+        g_array_append_vals (delimiters, info, 1);
+    else
+        g_array_append_val (delimiters, empty_info);
 }
 
 static void
-find_emphasis (GPtrArray *nodes, GHashTable *emphasis_info)
+find_emphasis (GPtrArray *nodes, GArray *delimiters)
 {
     for (int end_index = 0; end_index < nodes->len; end_index++) {
-        SnapdMarkdownNode *end_node = g_ptr_array_index (nodes, end_index);
-        EmphasisInfo *end_info = g_hash_table_lookup (emphasis_info, end_node);
-        if (end_info == NULL || !end_info->can_close_emphasis)
+        EmphasisInfo end_info = g_array_index (delimiters, EmphasisInfo, end_index);
+        if (!end_info.can_close_emphasis)
             continue;
 
         /* Find a start emphasis that matches this end */
         int start_index;
-        SnapdMarkdownNode *start_node;
-        EmphasisInfo *start_info;
+        EmphasisInfo start_info;
         for (start_index = end_index - 1; start_index >= 0; start_index--) {
-            start_node = g_ptr_array_index (nodes, start_index);
-            start_info = g_hash_table_lookup (emphasis_info, start_node);
-            if (start_info != NULL && start_info->can_open_emphasis &&
-                start_info->character == end_info->character)
+            start_info = g_array_index (delimiters, EmphasisInfo, start_index);
+            if (start_info.can_open_emphasis && start_info.character == end_info.character)
                 break;
         }
         if (start_index < 0)
             continue;
 
         // FIXME: Can do if both a multiple of three
-        if ((start_info->can_open_emphasis && start_info->can_close_emphasis) ||
-            (end_info->can_open_emphasis && end_info->can_close_emphasis)) {
-            if ((start_info->length + end_info->length) % 3 == 0)
+        if ((start_info.can_open_emphasis && start_info.can_close_emphasis) ||
+            (end_info.can_open_emphasis && end_info.can_close_emphasis)) {
+            if ((start_info.length + end_info.length) % 3 == 0)
                 continue;
         }
 
-        g_assert (start_info->length > 0);
-        g_assert (end_info->length > 0);
+        g_assert (start_info.length > 0);
+        g_assert (end_info.length > 0);
 
         SnapdMarkdownNodeType node_type;
-        if (start_info->length > 1 && end_info->length > 1) {
+        if (start_info.length > 1 && end_info.length > 1) {
             node_type = SNAPD_MARKDOWN_NODE_TYPE_STRONG_EMPHASIS;
-            start_info->length -= 2;
-            end_info->length -= 2;
+            start_info.length -= 2;
+            end_info.length -= 2;
         }
         else {
             node_type = SNAPD_MARKDOWN_NODE_TYPE_EMPHASIS;
-            start_info->length--;
-            end_info->length--;
+            start_info.length--;
+            end_info.length--;
         }
 
         /* Replace nodes */
-        g_autoptr(GPtrArray) children = g_ptr_array_new_with_free_func (g_object_unref);
+        GPtrArray *children = g_ptr_array_new_with_free_func (g_object_unref);
         for (int i = start_index + 1; i < end_index; i++) {
             SnapdMarkdownNode *node = g_ptr_array_index (nodes, i);
             g_ptr_array_add (children, g_object_ref (node));
         }
         g_ptr_array_remove_range (nodes, start_index, end_index - start_index + 1);
-        g_ptr_array_insert (nodes, start_index,
-                            g_object_new (SNAPD_TYPE_MARKDOWN_NODE,
-                                          "node-type", node_type,
-                                          "children", children,
-                                          NULL));
-        g_hash_table_steal (emphasis_info, start_node);
-        g_hash_table_steal (emphasis_info, end_node);
-        if (end_info->length > 0) {
-            SnapdMarkdownNode *node = make_delimiter_node (end_info);
-            g_hash_table_insert (emphasis_info, node, end_info);
-            g_ptr_array_insert (nodes, start_index + 1, node);
+        g_array_remove_range (delimiters, start_index, end_index - start_index + 1);
+        EmphasisInfo empty_info = { 0 };
+        g_ptr_array_insert (nodes, start_index, _snapd_markdown_node_new (node_type, NULL, children));
+        g_array_insert_val (delimiters, start_index, empty_info);
+        if (end_info.length > 0) {
+            g_ptr_array_insert (nodes, start_index + 1, make_delimiter_node (&end_info));
+            g_array_insert_val (delimiters, start_index + 1, end_info);
         }
-        else
-            emphasis_info_free (end_info);
-        if (start_info->length > 0) {
-            SnapdMarkdownNode *node = make_delimiter_node (start_info);
-            g_hash_table_insert (emphasis_info, node, start_info);
-            g_ptr_array_insert (nodes, start_index, node);
+        if (start_info.length > 0) {
+            g_ptr_array_insert (nodes, start_index, make_delimiter_node (&start_info));
+            g_array_insert_val (delimiters, start_index, start_info);
         }
-        else
-            emphasis_info_free (start_info);
         end_index = start_index;
     }
 }
@@ -400,33 +384,33 @@ backtick_count (const gchar *text)
 }
 
 static void
-combine_text_nodes (GPtrArray *nodes)
+combine_text_nodes (ParseState *state, GPtrArray *nodes)
 {
     for (int i = 0; i < nodes->len; i++) {
         SnapdMarkdownNode *node = g_ptr_array_index (nodes, i);
 
         GPtrArray *children = snapd_markdown_node_get_children (node);
         if (children != NULL)
-            combine_text_nodes (children);
+            combine_text_nodes (state, children);
 
         if (snapd_markdown_node_get_node_type (node) != SNAPD_MARKDOWN_NODE_TYPE_TEXT)
             continue;
 
         int node_count = 1;
-        g_autoptr(GString) text = NULL;
+        GString *text = state->node_text;
         while (i + node_count < nodes->len) {
             SnapdMarkdownNode *n = g_ptr_array_index (nodes, i + node_count);
             if (snapd_markdown_node_get_node_type (n) != SNAPD_MARKDOWN_NODE_TYPE_TEXT)
                 break;
-            if (text == NULL)
-                text = g_string_new (snapd_markdown_node_get_text (node));
+            if (node_count == 1)
+                g_string_assign (text, snapd_markdown_node_get_text (node));
             g_string_append (text, snapd_markdown_node_get_text (n));
             node_count++;
         }
 
         if (node_count > 1) {
             g_ptr_array_remove_range (nodes, i, node_count);
-            g_ptr_array_insert (nodes, i, make_text_node (text->str, -1));
+            g_ptr_array_insert (nodes, i, make_text_node (text->str, text->len));
         }
     }
 }
@@ -459,7 +443,9 @@ static gboolean
 is_url (const gchar *text, int *length)
 {
     int prefix_length;
-    if (g_str_has_prefix (text, "http://"))
+    if (text[0] != 'h' && text[0] != 'm')
+        return FALSE;
+    else if (g_str_has_prefix (text, "http://"))
         prefix_length = 7;
     else if (g_str_has_prefix (text, "https://"))
         prefix_length = 8;
@@ -501,15 +487,12 @@ find_url (const gchar *text, int *url_length)
     return -1;
 }
 
-SnapdMarkdownNode *
+static SnapdMarkdownNode *
 make_url_node (const gchar *text, int length)
 {
-    g_autoptr(GPtrArray) children = g_ptr_array_new_with_free_func (g_object_unref);
+    GPtrArray *children = g_ptr_array_new_with_free_func (g_object_unref);
     g_ptr_array_add (children, make_text_node (text, length));
-    return g_object_new (SNAPD_TYPE_MARKDOWN_NODE,
-                         "node-type", SNAPD_MARKDOWN_NODE_TYPE_URL,
-                         "children", children,
-                         NULL);
+    return _snapd_markdown_node_new (SNAPD_MARKDOWN_NODE_TYPE_URL, NULL, children);
 }
 
 static void
@@ -532,7 +515,7 @@ extract_urls (GPtrArray *nodes)
         url_offset = find_url (text, &url_length);
         if (url_offset >= 0) {
             if (text[url_offset + url_length] != '\0')
-                g_ptr_array_insert (nodes, i + 1, make_text_node (text + url_offset + url_length, -1));
+                g_ptr_array_insert (nodes, i + 1, make_text_node (text + url_offset + url_length, strlen (text + url_offset + url_length)));
             g_ptr_array_insert (nodes, i + 1, make_url_node (text + url_offset, url_length));
             if (url_offset > 0)
                 g_ptr_array_insert (nodes, i + 1, make_text_node (text, url_offset));
@@ -542,11 +525,11 @@ extract_urls (GPtrArray *nodes)
 }
 
 static GPtrArray *
-markup_inline (SnapdMarkdownParser *self, const gchar *text)
+markup_inline (ParseState *state, const gchar *text)
 {
-    /* Split into nodes */
+    /* Split into nodes, with the emphasis information for each node */
     g_autoptr(GPtrArray) nodes = g_ptr_array_new_with_free_func (g_object_unref);
-    g_autoptr(GHashTable) emphasis_info = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) emphasis_info_free);
+    g_autoptr(GArray) delimiters = g_array_new (FALSE, FALSE, sizeof (EmphasisInfo));
     for (int i = 0; text[i] != '\0';) {
         int start = i;
 
@@ -564,13 +547,12 @@ markup_inline (SnapdMarkdownParser *self, const gchar *text)
                      end += s;
             }
             if (text[end] != '\0') {
-                 g_autofree gchar *code_text = g_strndup (text + start + size, end - start - size);
-                 g_autofree gchar *stripped_code_text = strip_text (code_text);
-                 g_ptr_array_add (nodes, make_code_node (SNAPD_MARKDOWN_NODE_TYPE_CODE_SPAN, stripped_code_text));
+                 strip_text (state->node_text, text + start + size, end - start - size);
+                 add_inline_node (nodes, delimiters, make_code_node (SNAPD_MARKDOWN_NODE_TYPE_CODE_SPAN, state->node_text->str, state->node_text->len), NULL);
                  i = end + size;
             }
             else {
-                 g_ptr_array_add (nodes, make_paragraph_text_node (self, text + start, size));
+                 add_inline_node (nodes, delimiters, make_paragraph_text_node (state, text + start, size), NULL);
                  i = start + size;
             }
 
@@ -578,8 +560,8 @@ markup_inline (SnapdMarkdownParser *self, const gchar *text)
         }
 
         /* Escaped characters */
-        if (text[start] == '\\' && is_punctuation_character (text[start + 1])) {
-             g_ptr_array_add (nodes, make_text_node (text + start + 1, 1));
+        if (is_escape (text + start)) {
+             add_inline_node (nodes, delimiters, make_text_node (text + start + 1, 1), NULL);
              i = start + 2;
              continue;
         }
@@ -589,23 +571,21 @@ markup_inline (SnapdMarkdownParser *self, const gchar *text)
             while (text[i] == text[start])
                 i++;
 
-            gboolean is_left_flanking = is_left_flanking_delimiter_run (text, start);
-            gboolean is_right_flanking = is_right_flanking_delimiter_run (text, start);
+            gboolean is_left_flanking = is_left_flanking_delimiter_run (text, start, i - start);
+            gboolean is_right_flanking = is_right_flanking_delimiter_run (text, start, i - start);
 
-            g_autoptr(EmphasisInfo) info = emphasis_info_new ();
-            info->character = text[start];
-            info->length = i - start;
+            EmphasisInfo info = { 0 };
+            info.character = text[start];
+            info.length = i - start;
             if (text[start] == '_') {
-                info->can_open_emphasis = is_left_flanking && (!is_right_flanking || (start > 0 && is_punctuation_character (text[start - 1])));
-                info->can_close_emphasis = is_right_flanking && (!is_left_flanking || is_punctuation_character (text[i]));
+                info.can_open_emphasis = is_left_flanking && (!is_right_flanking || (start > 0 && is_punctuation_character (text[start - 1])));
+                info.can_close_emphasis = is_right_flanking && (!is_left_flanking || is_punctuation_character (text[i]));
             }
             else if (text[start] == '*') {
-                info->can_open_emphasis = is_left_flanking;
-                info->can_close_emphasis = is_right_flanking;
+                info.can_open_emphasis = is_left_flanking;
+                info.can_close_emphasis = is_right_flanking;
             }
-            SnapdMarkdownNode *node = make_paragraph_text_node (self, text + start, i - start);
-            g_ptr_array_add (nodes, node);
-            g_hash_table_insert (emphasis_info, node, g_steal_pointer (&info));
+            add_inline_node (nodes, delimiters, make_paragraph_text_node (state, text + start, i - start), &info);
             continue;
         }
 
@@ -614,19 +594,19 @@ markup_inline (SnapdMarkdownParser *self, const gchar *text)
             if (text[i] == '*' || text[i] == '_' || text[i] == '`')
                 break;
 
-            if (text[i] == '\\' && is_punctuation_character (text[i + 1]))
+            if (is_escape (text + i))
                 break;
 
             i++;
         }
-        g_ptr_array_add (nodes, make_paragraph_text_node (self, text + start, i - start));
+        add_inline_node (nodes, delimiters, make_paragraph_text_node (state, text + start, i - start), NULL);
     }
 
     /* Convert nodes into emphasis */
-    find_emphasis (nodes, emphasis_info);
+    find_emphasis (nodes, delimiters);
 
     /* Combine sequential text nodes */
-    combine_text_nodes (nodes);
+    combine_text_nodes (state, nodes);
 
     /* Extract URLs */
     extract_urls (nodes);
@@ -634,189 +614,190 @@ markup_inline (SnapdMarkdownParser *self, const gchar *text)
     return g_steal_pointer (&nodes);
 }
 
+static SnapdMarkdownNode *
+make_list_item_node (ParseState *state, guint first_line);
+
+/* Parse the lines from @first_line to @last_line into blocks */
 static GPtrArray *
-markdown_to_markup (SnapdMarkdownParser *self, const gchar *text)
+parse_blocks (ParseState *state, guint first_line, guint last_line)
 {
-    /* Snap supports the following subset of CommonMark (https://commonmark.org/):
-     *
-     * Indented code blocks
-     * Paragraphs
-     * Blank lines
-     * Lists
-     * Backslash escapes
-     * Code spans
-     * Emphasis and strong emphasis
-     * Textual content
-     *
-     * In addition, links are automatically converted to hyperlinks.
-     */
-
-    /* 1. Split into lines */
-    g_autoptr(GPtrArray) line_array = g_ptr_array_new_with_free_func (g_free);
-    int line_start = 0;
-    for (int i = 0; text[i] != '\0'; i++) {
-        if (text[i] == '\n' || text[i] == '\r') {
-            if (text[i] == '\r' && text[i + 1] == '\n')
-                i++;
-            g_ptr_array_add (line_array, g_strndup (text + line_start, i - line_start + 1));
-            line_start = i + 1;
-        }
-    }
-    if (text[line_start] != '\0')
-        g_ptr_array_add (line_array, g_strdup (text + line_start));
-    g_ptr_array_add (line_array, NULL);
-    GStrv lines = (GStrv) line_array->pdata;
-
-    /* 2. Split lines into blocks (paragraphs, lists, code) */
-    int line_number = 0;
+    guint line_number = first_line;
     g_autoptr(GPtrArray) nodes = g_ptr_array_new_with_free_func (g_object_unref);
-    while (lines[line_number] != NULL) {
+    while (line_number < last_line) {
+        Line line = g_array_index (state->lines, Line, line_number);
+
         /* Skip empty lines */
-        if (parse_empty_line (lines[line_number])) {
+        if (parse_empty_line (&line)) {
             line_number++;
             continue;
         }
 
-        g_autofree gchar *block_text = NULL;
-        int bullet_offset = 0;
+        gsize bullet_offset = 0;
         gchar bullet_symbol;
-        g_autofree gchar *bullet_text = NULL;
+        gsize bullet_text_offset;
         /* Indented code blocks */
-        if (parse_indented_code_block (lines[line_number], &block_text)) {
-            g_autoptr(GString) code_text = g_string_new ("");
-            g_string_append (code_text, block_text);
+        if (parse_indented_code_block (&line)) {
+            GString *code_text = state->block_text;
+            g_string_truncate (code_text, 0);
+            g_string_append_len (code_text, line.text + 4, line.length - 4);
 
             while (TRUE) {
                 line_number++;
 
-                if (lines[line_number] == NULL)
+                if (line_number >= last_line)
                     break;
 
-                g_autofree gchar *text = NULL;
-                if (parse_indented_code_block (lines[line_number], &text)) {
-                    g_string_append (code_text, text);
-                }
-                else if (parse_empty_line (lines[line_number]))
+                line = g_array_index (state->lines, Line, line_number);
+                if (parse_indented_code_block (&line))
+                    g_string_append_len (code_text, line.text + 4, line.length - 4);
+                else if (parse_empty_line (&line))
                     g_string_append_c (code_text, '\n');
                 else
                     break;
             }
 
             /* Remove trailing empty lines */
-            while (g_str_has_suffix (code_text->str, "\n\n"))
+            while (code_text->len >= 2 && code_text->str[code_text->len - 1] == '\n' && code_text->str[code_text->len - 2] == '\n')
                 g_string_truncate (code_text, code_text->len - 1);
 
-            g_ptr_array_add (nodes, make_code_node (SNAPD_MARKDOWN_NODE_TYPE_CODE_BLOCK, code_text->str));
+            g_ptr_array_add (nodes, make_code_node (SNAPD_MARKDOWN_NODE_TYPE_CODE_BLOCK, code_text->str, code_text->len));
         }
-        /* Bullet lists */
-        else if (parse_bullet_list_item (lines[line_number], &bullet_offset, &bullet_symbol, &bullet_text)) {
-            g_autoptr(GPtrArray) list_items = g_ptr_array_new_with_free_func (g_object_unref);
-            g_autoptr(GString) list_data = g_string_new (bullet_text);
-            gboolean starts_with_empty_line = bullet_text[0] == '\0';
+        /* Bullet lists. The lines of each item are added after the existing
+         * lines and parsed in place so nested lists don't copy any text */
+        else if (parse_bullet_list_item (&line, &bullet_offset, &bullet_symbol, &bullet_text_offset)) {
+            GPtrArray *list_items = g_ptr_array_new_with_free_func (g_object_unref);
+            guint item_line = state->lines->len;
+            add_line (state, line.text + bullet_text_offset, line.length - bullet_text_offset);
+            gboolean starts_with_empty_line = bullet_text_offset == line.length;
             gboolean have_item = TRUE;
             while (TRUE) {
                 line_number++;
-                if (lines[line_number] == NULL)
+                if (line_number >= last_line)
                     break;
 
-                if (parse_empty_line (lines[line_number])) {
+                line = g_array_index (state->lines, Line, line_number);
+                if (parse_empty_line (&line)) {
                     if (starts_with_empty_line)
                         break;
-                    g_string_append (list_data, lines[line_number]);
+                    add_line (state, line.text, line.length);
                     have_item = TRUE;
                     continue;
                 }
                 starts_with_empty_line = FALSE;
-                g_autofree gchar *line_text = NULL;
-                if (parse_list_item_line (lines[line_number], bullet_offset, &line_text)) {
-                    g_string_append (list_data, line_text);
+                if (parse_list_item_line (&line, bullet_offset)) {
+                    add_line (state, line.text + bullet_offset, line.length - bullet_offset);
                     have_item = TRUE;
                     continue;
                 }
 
                 if (have_item) {
-                    g_autoptr(GPtrArray) children = markdown_to_markup (self, list_data->str);
-                    g_ptr_array_add (list_items, g_object_new (SNAPD_TYPE_MARKDOWN_NODE,
-                                                               "node-type", SNAPD_MARKDOWN_NODE_TYPE_LIST_ITEM,
-                                                               "children", children,
-                                                               NULL));
-                    g_string_assign (list_data, "");
+                    g_ptr_array_add (list_items, make_list_item_node (state, item_line));
                     have_item = FALSE;
                 }
 
                 // FIXME: Check matching offset
-                g_autofree gchar *text = NULL;
                 gchar symbol;
-                if (!parse_bullet_list_item (lines[line_number], &bullet_offset, &symbol, &text))
+                if (!parse_bullet_list_item (&line, &bullet_offset, &symbol, &bullet_text_offset))
                     break;
                 if (symbol != bullet_symbol)
                     break;
-                g_string_assign (list_data, text);
+                add_line (state, line.text + bullet_text_offset, line.length - bullet_text_offset);
                 have_item = TRUE;
             }
 
-            if (have_item) {
-                g_autoptr(GPtrArray) children = markdown_to_markup (self, list_data->str);
-                g_ptr_array_add (list_items, g_object_new (SNAPD_TYPE_MARKDOWN_NODE,
-                                                           "node-type", SNAPD_MARKDOWN_NODE_TYPE_LIST_ITEM,
-                                                           "children", children,
-                                                           NULL));
-            }
+            if (have_item)
+                g_ptr_array_add (list_items, make_list_item_node (state, item_line));
 
-            g_ptr_array_add (nodes, g_object_new (SNAPD_TYPE_MARKDOWN_NODE,
-                                                  "node-type", SNAPD_MARKDOWN_NODE_TYPE_UNORDERED_LIST,
-                                                  "children", list_items,
-                                                  NULL));
+            g_ptr_array_add (nodes, _snapd_markdown_node_new (SNAPD_MARKDOWN_NODE_TYPE_UNORDERED_LIST, NULL, list_items));
         }
         /* Paragraphs */
         else {
-            g_autoptr(GString) paragraph_text = g_string_new ("");
+            GString *paragraph_text = state->block_text;
+            g_string_truncate (paragraph_text, 0);
             while (TRUE) {
-                g_autofree gchar *text = NULL;
-                parse_paragraph (lines[line_number], &text);
-
-                g_string_append (paragraph_text, text);
+                gsize offset = parse_paragraph (&line);
+                g_string_append_len (paragraph_text, line.text + offset, line.length - offset);
 
                 line_number++;
 
                 /* Out of data */
-                if (lines[line_number] == NULL)
+                if (line_number >= last_line)
                     break;
 
                 /* Break on empty line */
-                if (parse_empty_line (lines[line_number]))
+                line = g_array_index (state->lines, Line, line_number);
+                if (parse_empty_line (&line))
                     break;
 
                 /* Break on non-empty list items */
-                g_autofree gchar *bullet_text = NULL;
-                if (parse_bullet_list_item (lines[line_number], NULL, NULL, &bullet_text)) {
-                    if (bullet_text[0] != '\0')
+                if (parse_bullet_list_item (&line, NULL, NULL, &bullet_text_offset)) {
+                    if (bullet_text_offset < line.length)
                         break;
                 }
             }
 
-            /* Strip leading and trailing whitespace */
-            int offset = 0;
-            while (isspace (paragraph_text->str[offset]))
-                offset++;
-            int length = paragraph_text->len;
+            /* Strip trailing whitespace, the first line has already had leading whitespace removed */
+            gsize length = paragraph_text->len;
             while (length > 0 && isspace (paragraph_text->str[length - 1]))
                 length--;
-            if (offset + length > paragraph_text->len)
-                length = 0;
-            g_autofree gchar *stripped_text = g_strndup (paragraph_text->str + offset, length);
-
-            g_autoptr(GPtrArray) children = markup_inline (self, stripped_text);
-            g_ptr_array_add (nodes, g_object_new (SNAPD_TYPE_MARKDOWN_NODE,
-                                                  "node-type", SNAPD_MARKDOWN_NODE_TYPE_PARAGRAPH,
-                                                  "children", children,
-                                                  NULL));
+            g_string_truncate (paragraph_text, length);
+
+            GPtrArray *children = markup_inline (state, paragraph_text->str);
+            g_ptr_array_add (nodes, _snapd_markdown_node_new (SNAPD_MARKDOWN_NODE_TYPE_PARAGRAPH, NULL, children));
         }
     }
 
     return g_steal_pointer (&nodes);
 }
 
+/* Make a list item from the lines added from @first_line and remove them */
+static SnapdMarkdownNode *
+make_list_item_node (ParseState *state, guint first_line)
+{
+    GPtrArray *children = parse_blocks (state, first_line, state->lines->len);
+    g_array_set_size (state->lines, first_line);
+    return _snapd_markdown_node_new (SNAPD_MARKDOWN_NODE_TYPE_LIST_ITEM, NULL, children);
+}
+
+static GPtrArray *
+markdown_to_markup (SnapdMarkdownParser *self, const gchar *text)
+{
+    /* Snap supports the following subset of CommonMark (https://commonmark.org/):
+     *
+     * Indented code blocks
+     * Paragraphs
+     * Blank lines
+     * Lists
+     * Backslash escapes
+     * Code spans
+     * Emphasis and strong emphasis
+     * Textual content
+     *
+     * In addition, links are automatically converted to hyperlinks.
+     */
+
+    g_autoptr(GArray) lines = g_array_new (FALSE, FALSE, sizeof (Line));
+    g_autoptr(GString) block_text = g_string_new (NULL);
+    g_autoptr(GString) node_text = g_string_new (NULL);
+    ParseState state = { self, lines, block_text, node_text };
+
+    /* 1. Split into lines */
+    gsize line_start = 0;
+    gsize i;
+    for (i = 0; text[i] != '\0'; i++) {
+        if (text[i] == '\n' || text[i] == '\r') {
+            if (text[i] == '\r' && text[i + 1] == '\n')
+                i++;
+            add_line (&state, text + line_start, i - line_start + 1);
+            line_start = i + 1;
+        }
+    }
+    add_line (&state, text + line_start, i - line_start);
+
+    /* 2. Split lines into blocks (paragraphs, lists, code) */
+    return parse_blocks (&state, 0, lines->len);
+}
+
 /**
  * snapd_markdown_parser_new:
  * @version: version supported by the client.
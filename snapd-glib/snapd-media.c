@@ -7,7 +7,8 @@
  * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
  */
 
-#include "snapd-media.h"
+#include "snapd-media-private.h"
+#include "snapd-string-pool.h"
 
 /**
  * SECTION: snapd-media
@@ -47,6 +48,19 @@ enum
 
 G_DEFINE_TYPE (SnapdMedia, snapd_media, G_TYPE_OBJECT)
 
+SnapdMedia *
+_snapd_media_new (gchar *type, gchar *url, guint width, guint height)
+{
+    SnapdMedia *self = g_object_new (SNAPD_TYPE_MEDIA, NULL);
+
+    self->type = type;
+    self->url = url;
+    self->width = width;
+    self->height = height;
+
+    return self;
+}
+
 SnapdMedia *
 snapd_media_new (void)
 {
@@ -128,8 +142,8 @@ snapd_media_set_property (GObject *object, guint prop_id, const GValue *value, G
 
     switch (prop_id) {
     case PROP_TYPE:
-        g_free (self->type);
-        self->type = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->type);
+        self->type = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_URL:
         g_free (self->url);
@@ -176,7 +190,7 @@ snapd_media_finalize (GObject *object)
 {
     SnapdMedia *self = SNAPD_MEDIA (object);
 
-    g_clear_pointer (&self->type, g_free);
+    g_clear_pointer (&self->type, _snapd_ref_string_release);
     g_clear_pointer (&self->url, g_free);
 
     G_OBJECT_CLASS (snapd_media_parent_class)->finalize (object);
@@ -0,0 +1,27 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_PLUG_PRIVATE_H__
+#define __SNAPD_PLUG_PRIVATE_H__
+
+#include "snapd-plug.h"
+
+G_BEGIN_DECLS
+
+/* The plug takes ownership of all the values, @snap and @interface are reference counted strings */
+SnapdPlug *_snapd_plug_new (gchar               *name,
+                            gchar               *snap,
+                            gchar               *interface,
+                            gchar               *label,
+                            GPtrArray           *connections,
+                            GHashTable          *attributes);
+
+G_END_DECLS
+
+#endif /* __SNAPD_PLUG_PRIVATE_H__ */
@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_PLUG_REF_PRIVATE_H__
+#define __SNAPD_PLUG_REF_PRIVATE_H__
+
+#include "snapd-plug-ref.h"
+
+G_BEGIN_DECLS
+
+/* The reference takes ownership of the strings, @snap is a reference counted string */
+SnapdPlugRef *_snapd_plug_ref_new (gchar               *plug,
+                                   gchar               *snap);
+
+G_END_DECLS
+
+#endif /* __SNAPD_PLUG_REF_PRIVATE_H__ */
@@ -9,7 +9,8 @@
 
 #include <string.h>
 
-#include "snapd-plug-ref.h"
+#include "snapd-plug-ref-private.h"
+#include "snapd-string-pool.h"
 
 /**
  * SECTION: snapd-plug-ref
@@ -44,6 +45,17 @@ enum
 
 G_DEFINE_TYPE (SnapdPlugRef, snapd_plug_ref, G_TYPE_OBJECT)
 
+SnapdPlugRef *
+_snapd_plug_ref_new (gchar *plug, gchar *snap)
+{
+    SnapdPlugRef *self = g_object_new (SNAPD_TYPE_PLUG_REF, NULL);
+
+    self->plug = plug;
+    self->snap = snap;
+
+    return self;
+}
+
 /**
  * snapd_plug_ref_get_plug:
  * @plug_ref: a #SnapdPlugRef.
@@ -89,8 +101,8 @@ snapd_plug_ref_set_property (GObject *object, guint prop_id, const GValue *value
         self->plug = g_strdup (g_value_get_string (value));
         break;
     case PROP_SNAP:
-        g_free (self->snap);
-        self->snap = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->snap);
+        self->snap = _snapd_ref_string_new (g_value_get_string (value));
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -122,7 +134,7 @@ snapd_plug_ref_finalize (GObject *object)
     SnapdPlugRef *self = SNAPD_PLUG_REF (object);
 
     g_clear_pointer (&self->plug, g_free);
-    g_clear_pointer (&self->snap, g_free);
+    g_clear_pointer (&self->snap, _snapd_ref_string_release);
 
     G_OBJECT_CLASS (snapd_plug_ref_parent_class)->finalize (object);
 }
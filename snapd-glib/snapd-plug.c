@@ -9,9 +9,10 @@
 
 #include <string.h>
 
-#include "snapd-plug.h"
+#include "snapd-plug-private.h"
 #include "snapd-connection.h"
 #include "snapd-slot-ref.h"
+#include "snapd-string-pool.h"
 
 /**
  * SECTION: snapd-plug
@@ -59,6 +60,21 @@ enum
 
 G_DEFINE_TYPE (SnapdPlug, snapd_plug, G_TYPE_OBJECT)
 
+SnapdPlug *
+_snapd_plug_new (gchar *name, gchar *snap, gchar *interface, gchar *label, GPtrArray *connections, GHashTable *attributes)
+{
+    SnapdPlug *self = g_object_new (SNAPD_TYPE_PLUG, NULL);
+
+    self->name = name;
+    self->snap = snap;
+    self->interface = interface;
+    self->label = label;
+    self->connections = connections;
+    self->attributes = attributes;
+
+    return self;
+}
+
 /**
  * snapd_plug_get_name:
  * @plug: a #SnapdPlug.
@@ -256,12 +272,12 @@ snapd_plug_set_property (GObject *object, guint prop_id, const GValue *value, GP
         self->name = g_strdup (g_value_get_string (value));
         break;
     case PROP_SNAP:
-        g_free (self->snap);
-        self->snap = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->snap);
+        self->snap = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_INTERFACE:
-        g_free (self->interface);
-        self->interface = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->interface);
+        self->interface = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_LABEL:
         g_free (self->label);
@@ -319,8 +335,8 @@ snapd_plug_finalize (GObject *object)
     SnapdPlug *self = SNAPD_PLUG (object);
 
     g_clear_pointer (&self->name, g_free);
-    g_clear_pointer (&self->snap, g_free);
-    g_clear_pointer (&self->interface, g_free);
+    g_clear_pointer (&self->snap, _snapd_ref_string_release);
+    g_clear_pointer (&self->interface, _snapd_ref_string_release);
     g_clear_pointer (&self->attributes, g_hash_table_unref);
     g_clear_pointer (&self->label, g_free);
     g_clear_pointer (&self->connections, g_ptr_array_unref);
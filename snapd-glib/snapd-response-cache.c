@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#include <string.h>
+
+#include "snapd-response-cache.h"
+
+/* Cache of responses to GET requests for information that changes rarely.
+ * Responses are kept for a time set for each path, and can be revalidated with snapd after that if it returned an ETag. */
+
+/* Paths that return the same response until the system is changed */
+static const gchar *cacheable_paths[] = {
+    "/v2/system-info",
+    "/v2/sections",
+    "/v2/interfaces",
+    "/v2/connections",
+    "/v2/aliases",
+    "/v2/snaps",
+    NULL
+};
+
+typedef struct
+{
+    guint status_code;
+    SoupMessageHeaders *headers;
+    GBytes *body;
+    gchar *etag;
+    gint64 expiry_time;
+} CacheEntry;
+
+struct _SnapdResponseCache
+{
+    GMutex mutex;
+
+    /* Number of seconds to keep responses for, keyed by path */
+    GHashTable *ttls;
+
+    /* Cached responses, keyed by request */
+    GHashTable *entries;
+
+    guint64 n_hits;
+    guint64 n_misses;
+    guint64 n_revalidated;
+};
+
+static void
+cache_entry_free (CacheEntry *entry)
+{
+    soup_message_headers_free (entry->headers);
+    g_bytes_unref (entry->body);
+    g_free (entry->etag);
+    g_slice_free (CacheEntry, entry);
+}
+
+static gboolean
+is_cacheable_path (const gchar *path)
+{
+    for (gsize i = 0; cacheable_paths[i] != NULL; i++)
+        if (strcmp (cacheable_paths[i], path) == 0)
+            return TRUE;
+
+    return FALSE;
+}
+
+/* Get the number of seconds to cache the response to @message, or 0 if not to be cached. Cache must be locked */
+static guint
+get_message_ttl (SnapdResponseCache *self, SoupMessage *message)
+{
+    if (strcmp (message->method, "GET") != 0)
+        return 0;
+
+    SoupURI *uri = soup_message_get_uri (message);
+    return GPOINTER_TO_UINT (g_hash_table_lookup (self->ttls, uri->path));
+}
+
+/* Requests only share a response if they ask for the same thing with the same authorization */
+static gchar *
+make_key (SoupMessage *message)
+{
+    SoupURI *uri = soup_message_get_uri (message);
+    const gchar *authorization = soup_message_headers_get_one (message->request_headers, "Authorization");
+    return g_strdup_printf ("%s?%s\n%s", uri->path, uri->query != NULL ? uri->query : "", authorization != NULL ? authorization : "");
+}
+
+static void
+copy_headers (SoupMessageHeaders *from, SoupMessageHeaders *to)
+{
+    soup_message_headers_clear (to);
+
+    SoupMessageHeadersIter iter;
+    soup_message_headers_iter_init (&iter, from);
+    const char *name, *value;
+    while (soup_message_headers_iter_next (&iter, &name, &value))
+        soup_message_headers_append (to, name, value);
+}
+
+/* Put a cached response into @message. Cache must be locked */
+static void
+restore_response (CacheEntry *entry, SoupMessage *message, GBytes **body)
+{
+    message->status_code = entry->status_code;
+    copy_headers (entry->headers, message->response_headers);
+    *body = g_bytes_ref (entry->body);
+}
+
+SnapdResponseCache *
+_snapd_response_cache_new (void)
+{
+    SnapdResponseCache *self = g_slice_new0 (SnapdResponseCache);
+
+    g_mutex_init (&self->mutex);
+    self->ttls = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    self->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) cache_entry_free);
+
+    return self;
+}
+
+/* Returns %FALSE if responses from @path can't be cached */
+gboolean
+_snapd_response_cache_set_ttl (SnapdResponseCache *self, const gchar *path, guint ttl)
+{
+    if (!is_cacheable_path (path))
+        return FALSE;
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
+
+    if (ttl > 0)
+        g_hash_table_insert (self->ttls, g_strdup (path), GUINT_TO_POINTER (ttl));
+    else
+        g_hash_table_remove (self->ttls, path);
+
+    /* Drop responses that were stored with a different time */
+    g_hash_table_remove_all (self->entries);
+
+    return TRUE;
+}
+
+guint
+_snapd_response_cache_get_ttl (SnapdResponseCache *self, const gchar *path)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
+    return GPOINTER_TO_UINT (g_hash_table_lookup (self->ttls, path));
+}
+
+/* Returns %TRUE and sets the response in @message if there is a current cached response.
+ * If the cached response has expired but can be revalidated @etag is set to the value to check with snapd */
+gboolean
+_snapd_response_cache_lookup (SnapdResponseCache *self, SoupMessage *message, GBytes **body, gchar **etag)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
+
+    if (get_message_ttl (self, message) == 0)
+        return FALSE;
+
+    g_autofree gchar *key = make_key (message);
+    CacheEntry *entry = g_hash_table_lookup (self->entries, key);
+    if (entry != NULL && g_get_monotonic_time () < entry->expiry_time) {
+        self->n_hits++;
+        restore_response (entry, message, body);
+        return TRUE;
+    }
+
+    self->n_misses++;
+    if (entry != NULL && entry->etag != NULL)
+        *etag = g_strdup (entry->etag);
+    else if (entry != NULL)
+        g_hash_table_remove (self->entries, key);
+
+    return FALSE;
+}
+
+/* Set the response in @message from the cache after snapd has reported it is unchanged */
+gboolean
+_snapd_response_cache_revalidate (SnapdResponseCache *self, SoupMessage *message, GBytes **body)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
+
+    guint ttl = get_message_ttl (self, message);
+    if (ttl == 0)
+        return FALSE;
+
+    g_autofree gchar *key = make_key (message);
+    CacheEntry *entry = g_hash_table_lookup (self->entries, key);
+    if (entry == NULL)
+        return FALSE;
+
+    self->n_revalidated++;
+    entry->expiry_time = g_get_monotonic_time () + (gint64) ttl * G_USEC_PER_SEC;
+    restore_response (entry, message, body);
+
+    return TRUE;
+}
+
+void
+_snapd_response_cache_insert (SnapdResponseCache *self, SoupMessage *message)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
+
+    guint ttl = get_message_ttl (self, message);
+    if (ttl == 0 || message->status_code != SOUP_STATUS_OK)
+        return;
+
+    CacheEntry *entry = g_slice_new0 (CacheEntry);
+    entry->status_code = message->status_code;
+    entry->headers = soup_message_headers_new (SOUP_MESSAGE_HEADERS_RESPONSE);
+    copy_headers (message->response_headers, entry->headers);
+    g_autoptr(SoupBuffer) buffer = soup_message_body_flatten (message->response_body);
+    entry->body = soup_buffer_get_as_bytes (buffer);
+    entry->etag = g_strdup (soup_message_headers_get_one (message->response_headers, "ETag"));
+    entry->expiry_time = g_get_monotonic_time () + (gint64) ttl * G_USEC_PER_SEC;
+    g_hash_table_insert (self->entries, make_key (message), entry);
+}
+
+/* Remove all cached responses, called when the system has been changed */
+void
+_snapd_response_cache_clear (SnapdResponseCache *self)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
+    g_hash_table_remove_all (self->entries);
+}
+
+void
+_snapd_response_cache_get_stats (SnapdResponseCache *self, guint64 *n_hits, guint64 *n_misses, guint64 *n_revalidated)
+{
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
+
+    if (n_hits != NULL)
+        *n_hits = self->n_hits;
+    if (n_misses != NULL)
+        *n_misses = self->n_misses;
+    if (n_revalidated != NULL)
+        *n_revalidated = self->n_revalidated;
+}
+
+void
+_snapd_response_cache_free (SnapdResponseCache *self)
+{
+    g_mutex_clear (&self->mutex);
+    g_clear_pointer (&self->ttls, g_hash_table_unref);
+    g_clear_pointer (&self->entries, g_hash_table_unref);
+    g_slice_free (SnapdResponseCache, self);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_RESPONSE_CACHE_H__
+#define __SNAPD_RESPONSE_CACHE_H__
+
+#include <libsoup/soup.h>
+
+G_BEGIN_DECLS
+
+typedef struct _SnapdResponseCache SnapdResponseCache;
+
+SnapdResponseCache *_snapd_response_cache_new         (void);
+
+gboolean            _snapd_response_cache_set_ttl     (SnapdResponseCache *cache,
+                                                       const gchar        *path,
+                                                       guint               ttl);
+
+guint               _snapd_response_cache_get_ttl     (SnapdResponseCache *cache,
+                                                       const gchar        *path);
+
+gboolean            _snapd_response_cache_lookup      (SnapdResponseCache *cache,
+                                                       SoupMessage        *message,
+                                                       GBytes            **body,
+                                                       gchar             **etag);
+
+gboolean            _snapd_response_cache_revalidate  (SnapdResponseCache *cache,
+                                                       SoupMessage        *message,
+                                                       GBytes            **body);
+
+void                _snapd_response_cache_insert      (SnapdResponseCache *cache,
+                                                       SoupMessage        *message);
+
+void                _snapd_response_cache_clear       (SnapdResponseCache *cache);
+
+void                _snapd_response_cache_get_stats   (SnapdResponseCache *cache,
+                                                       guint64            *n_hits,
+                                                       guint64            *n_misses,
+                                                       guint64            *n_revalidated);
+
+void                _snapd_response_cache_free        (SnapdResponseCache *cache);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SnapdResponseCache, _snapd_response_cache_free)
+
+G_END_DECLS
+
+#endif /* __SNAPD_RESPONSE_CACHE_H__ */
@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_SLOT_REF_PRIVATE_H__
+#define __SNAPD_SLOT_REF_PRIVATE_H__
+
+#include "snapd-slot-ref.h"
+
+G_BEGIN_DECLS
+
+/* The reference takes ownership of the strings, @snap is a reference counted string */
+SnapdSlotRef *_snapd_slot_ref_new (gchar               *slot,
+                                   gchar               *snap);
+
+G_END_DECLS
+
+#endif /* __SNAPD_SLOT_REF_PRIVATE_H__ */
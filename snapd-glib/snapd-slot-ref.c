@@ -9,7 +9,8 @@
 
 #include <string.h>
 
-#include "snapd-slot-ref.h"
+#include "snapd-slot-ref-private.h"
+#include "snapd-string-pool.h"
 
 /**
  * SECTION: snapd-slot-ref
@@ -44,6 +45,17 @@ enum
 
 G_DEFINE_TYPE (SnapdSlotRef, snapd_slot_ref, G_TYPE_OBJECT)
 
+SnapdSlotRef *
+_snapd_slot_ref_new (gchar *slot, gchar *snap)
+{
+    SnapdSlotRef *self = g_object_new (SNAPD_TYPE_SLOT_REF, NULL);
+
+    self->slot = slot;
+    self->snap = snap;
+
+    return self;
+}
+
 /**
  * snapd_slot_ref_get_slot:
  * @slot_ref: a #SnapdSlotRef.
@@ -89,8 +101,8 @@ snapd_slot_ref_set_property (GObject *object, guint prop_id, const GValue *value
         self->slot = g_strdup (g_value_get_string (value));
         break;
     case PROP_SNAP:
-        g_free (self->snap);
-        self->snap = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->snap);
+        self->snap = _snapd_ref_string_new (g_value_get_string (value));
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -122,7 +134,7 @@ snapd_slot_ref_finalize (GObject *object)
     SnapdSlotRef *self = SNAPD_SLOT_REF (object);
 
     g_clear_pointer (&self->slot, g_free);
-    g_clear_pointer (&self->snap, g_free);
+    g_clear_pointer (&self->snap, _snapd_ref_string_release);
 
     G_OBJECT_CLASS (snapd_slot_ref_parent_class)->finalize (object);
 }
@@ -9,9 +9,10 @@
 
 #include <string.h>
 
-#include "snapd-slot.h"
+#include "snapd-slot-private.h"
 #include "snapd-connection.h"
 #include "snapd-plug-ref.h"
+#include "snapd-string-pool.h"
 
 /**
  * SECTION: snapd-slot
@@ -59,6 +60,21 @@ enum
 
 G_DEFINE_TYPE (SnapdSlot, snapd_slot, G_TYPE_OBJECT)
 
+SnapdSlot *
+_snapd_slot_new (gchar *name, gchar *snap, gchar *interface, gchar *label, GPtrArray *connections, GHashTable *attributes)
+{
+    SnapdSlot *self = g_object_new (SNAPD_TYPE_SLOT, NULL);
+
+    self->name = name;
+    self->snap = snap;
+    self->interface = interface;
+    self->label = label;
+    self->connections = connections;
+    self->attributes = attributes;
+
+    return self;
+}
+
 /**
  * snapd_slot_get_name:
  * @slot: a #SnapdSlot.
@@ -256,12 +272,12 @@ snapd_slot_set_property (GObject *object, guint prop_id, const GValue *value, GP
         self->name = g_strdup (g_value_get_string (value));
         break;
     case PROP_SNAP:
-        g_free (self->snap);
-        self->snap = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->snap);
+        self->snap = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_INTERFACE:
-        g_free (self->interface);
-        self->interface = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->interface);
+        self->interface = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_LABEL:
         g_free (self->label);
@@ -319,8 +335,8 @@ snapd_slot_finalize (GObject *object)
     SnapdSlot *self = SNAPD_SLOT (object);
 
     g_clear_pointer (&self->name, g_free);
-    g_clear_pointer (&self->snap, g_free);
-    g_clear_pointer (&self->interface, g_free);
+    g_clear_pointer (&self->snap, _snapd_ref_string_release);
+    g_clear_pointer (&self->interface, _snapd_ref_string_release);
     g_clear_pointer (&self->attributes, g_hash_table_unref);
     g_clear_pointer (&self->label, g_free);
     g_clear_pointer (&self->connections, g_ptr_array_unref);
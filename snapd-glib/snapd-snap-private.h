@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_SNAP_PRIVATE_H__
+#define __SNAPD_SNAP_PRIVATE_H__
+
+#include "snapd-snap.h"
+
+G_BEGIN_DECLS
+
+/* The snap takes ownership of the strings, arrays and date.
+ * @base, @channel, @license, @publisher_display_name, @publisher_id, @publisher_username
+ * and @tracking_channel are reference counted strings */
+SnapdSnap *_snapd_snap_new (GPtrArray               *apps,
+                            gchar                   *base,
+                            gchar                   *broken,
+                            gchar                   *channel,
+                            GPtrArray               *channels,
+                            GStrv                    common_ids,
+                            SnapdConfinement         confinement,
+                            gchar                   *contact,
+                            gchar                   *description,
+                            gboolean                 devmode,
+                            gint64                   download_size,
+                            gchar                   *icon,
+                            gchar                   *id,
+                            GDateTime               *install_date,
+                            gint64                   installed_size,
+                            gboolean                 jailmode,
+                            gchar                   *license,
+                            GPtrArray               *media,
+                            gchar                   *mounted_from,
+                            gchar                   *name,
+                            GPtrArray               *prices,
+                            gboolean                 private,
+                            gchar                   *publisher_display_name,
+                            gchar                   *publisher_id,
+                            gchar                   *publisher_username,
+                            SnapdPublisherValidation publisher_validation,
+                            gchar                   *revision,
+                            GPtrArray               *screenshots,
+                            SnapdSnapStatus          status,
+                            gchar                   *summary,
+                            gchar                   *title,
+                            gchar                   *tracking_channel,
+                            GStrv                    tracks,
+                            gboolean                 trymode,
+                            SnapdSnapType            snap_type,
+                            gchar                   *version,
+                            gchar                   *website);
+
+/* Parses the members of a snap from data passed to _snapd_snap_set_deferred() */
+typedef gboolean (*SnapdSnapMaterializeFunc) (GBytes      *data,
+                                              const gchar *snap_name,
+                                              GPtrArray   *apps,
+                                              GPtrArray   *channels,
+                                              GPtrArray   *media,
+                                              GPtrArray   *prices);
+
+void       _snapd_snap_set_deferred (SnapdSnap               *snap,
+                                     GBytes                  *data,
+                                     SnapdSnapMaterializeFunc materialize);
+
+G_END_DECLS
+
+#endif /* __SNAPD_SNAP_PRIVATE_H__ */
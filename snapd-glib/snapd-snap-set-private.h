@@ -0,0 +1,26 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_SNAP_SET_PRIVATE_H__
+#define __SNAPD_SNAP_SET_PRIVATE_H__
+
+#include "snapd-snap-set.h"
+
+G_BEGIN_DECLS
+
+SnapdSnap *_snapd_snap_set_lookup_fingerprint (SnapdSnapSet *snap_set,
+                                               guint64       fingerprint);
+
+void       _snapd_snap_set_update             (SnapdSnapSet *snap_set,
+                                               GPtrArray    *snaps,
+                                               GArray       *fingerprints);
+
+G_END_DECLS
+
+#endif /* __SNAPD_SNAP_SET_PRIVATE_H__ */
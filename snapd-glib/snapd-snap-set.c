@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#include "snapd-snap-set-private.h"
+
+/**
+ * SECTION:snapd-snap-set
+ * @short_description: Installed snaps that can be updated cheaply
+ * @include: snapd-glib/snapd-glib.h
+ *
+ * A #SnapdSnapSet contains the installed snaps, indexed by name. It is updated
+ * using snapd_client_update_snap_set_sync() and reports what changed since the
+ * last update. Snaps that have not changed keep the same #SnapdSnap object and
+ * are not parsed again, so polling the installed snaps is cheap.
+ */
+
+/**
+ * SnapdSnapSet:
+ *
+ * #SnapdSnapSet contains a set of installed snaps.
+ *
+ * Since: 1.59
+ */
+
+typedef struct
+{
+    SnapdSnap *snap;
+    guint64 fingerprint;
+} SnapSetEntry;
+
+struct _SnapdSnapSet
+{
+    GObject parent_instance;
+
+    /* Snaps in the order snapd returned them */
+    GPtrArray *snaps;
+
+    /* Entries keyed by name and by the fingerprint of the data the snap was parsed from */
+    GPtrArray *entries;
+    GHashTable *entries_by_name;
+    GHashTable *entries_by_fingerprint;
+
+    /* Changes from the last update */
+    GPtrArray *added;
+    GPtrArray *removed;
+    GPtrArray *changed;
+    GHashTable *change_flags;
+    guint n_reused;
+};
+
+G_DEFINE_TYPE (SnapdSnapSet, snapd_snap_set, G_TYPE_OBJECT)
+
+static void
+snap_set_entry_free (SnapSetEntry *entry)
+{
+    g_object_unref (entry->snap);
+    g_slice_free (SnapSetEntry, entry);
+}
+
+/**
+ * snapd_snap_set_new:
+ *
+ * Create a new empty snap set.
+ *
+ * Returns: a new #SnapdSnapSet
+ *
+ * Since: 1.59
+ **/
+SnapdSnapSet *
+snapd_snap_set_new (void)
+{
+    return g_object_new (SNAPD_TYPE_SNAP_SET, NULL);
+}
+
+/**
+ * snapd_snap_set_get_snaps:
+ * @snap_set: a #SnapdSnapSet.
+ *
+ * Get the snaps in this set.
+ *
+ * Returns: (transfer none) (element-type SnapdSnap): an array of #SnapdSnap.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_snap_set_get_snaps (SnapdSnapSet *self)
+{
+    g_return_val_if_fail (SNAPD_IS_SNAP_SET (self), NULL);
+    return self->snaps;
+}
+
+/**
+ * snapd_snap_set_lookup:
+ * @snap_set: a #SnapdSnapSet.
+ * @name: name of the snap to find.
+ *
+ * Get the snap in this set with the given name.
+ *
+ * Returns: (transfer none) (allow-none): a #SnapdSnap or %NULL if not in the set.
+ *
+ * Since: 1.59
+ */
+SnapdSnap *
+snapd_snap_set_lookup (SnapdSnapSet *self, const gchar *name)
+{
+    g_return_val_if_fail (SNAPD_IS_SNAP_SET (self), NULL);
+    g_return_val_if_fail (name != NULL, NULL);
+
+    SnapSetEntry *entry = g_hash_table_lookup (self->entries_by_name, name);
+    return entry != NULL ? entry->snap : NULL;
+}
+
+/**
+ * snapd_snap_set_get_added:
+ * @snap_set: a #SnapdSnapSet.
+ *
+ * Get the snaps that were added when this set was last updated.
+ *
+ * Returns: (transfer none) (element-type SnapdSnap): an array of #SnapdSnap.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_snap_set_get_added (SnapdSnapSet *self)
+{
+    g_return_val_if_fail (SNAPD_IS_SNAP_SET (self), NULL);
+    return self->added;
+}
+
+/**
+ * snapd_snap_set_get_removed:
+ * @snap_set: a #SnapdSnapSet.
+ *
+ * Get the snaps that were removed when this set was last updated.
+ *
+ * Returns: (transfer none) (element-type SnapdSnap): an array of #SnapdSnap.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_snap_set_get_removed (SnapdSnapSet *self)
+{
+    g_return_val_if_fail (SNAPD_IS_SNAP_SET (self), NULL);
+    return self->removed;
+}
+
+/**
+ * snapd_snap_set_get_changed:
+ * @snap_set: a #SnapdSnapSet.
+ *
+ * Get the snaps that changed when this set was last updated. Use
+ * snapd_snap_set_get_change_flags() to find out what changed.
+ *
+ * Returns: (transfer none) (element-type SnapdSnap): an array of #SnapdSnap.
+ *
+ * Since: 1.59
+ */
+GPtrArray *
+snapd_snap_set_get_changed (SnapdSnapSet *self)
+{
+    g_return_val_if_fail (SNAPD_IS_SNAP_SET (self), NULL);
+    return self->changed;
+}
+
+/**
+ * snapd_snap_set_get_change_flags:
+ * @snap_set: a #SnapdSnapSet.
+ * @name: name of a snap.
+ *
+ * Get how a snap changed when this set was last updated.
+ *
+ * Returns: a set of #SnapdSnapSetChangeFlags.
+ *
+ * Since: 1.59
+ */
+SnapdSnapSetChangeFlags
+snapd_snap_set_get_change_flags (SnapdSnapSet *self, const gchar *name)
+{
+    g_return_val_if_fail (SNAPD_IS_SNAP_SET (self), SNAPD_SNAP_SET_CHANGE_FLAGS_NONE);
+    g_return_val_if_fail (name != NULL, SNAPD_SNAP_SET_CHANGE_FLAGS_NONE);
+    return GPOINTER_TO_UINT (g_hash_table_lookup (self->change_flags, name));
+}
+
+/**
+ * snapd_snap_set_get_n_reused:
+ * @snap_set: a #SnapdSnapSet.
+ *
+ * Get the number of snaps that were unchanged when this set was last updated,
+ * and so reused the existing #SnapdSnap object.
+ *
+ * Returns: a number of snaps.
+ *
+ * Since: 1.59
+ */
+guint
+snapd_snap_set_get_n_reused (SnapdSnapSet *self)
+{
+    g_return_val_if_fail (SNAPD_IS_SNAP_SET (self), 0);
+    return self->n_reused;
+}
+
+/* Get a snap that was parsed from data with the given fingerprint, so it can be reused without parsing it again */
+SnapdSnap *
+_snapd_snap_set_lookup_fingerprint (SnapdSnapSet *self, guint64 fingerprint)
+{
+    SnapSetEntry *entry = g_hash_table_lookup (self->entries_by_fingerprint, &fingerprint);
+    return entry != NULL ? entry->snap : NULL;
+}
+
+static SnapdSnapSetChangeFlags
+get_change_flags (SnapdSnap *old_snap, SnapdSnap *new_snap)
+{
+    SnapdSnapSetChangeFlags flags = SNAPD_SNAP_SET_CHANGE_FLAGS_NONE;
+
+    if (g_strcmp0 (snapd_snap_get_revision (old_snap), snapd_snap_get_revision (new_snap)) != 0)
+        flags |= SNAPD_SNAP_SET_CHANGE_FLAGS_REVISION;
+    if (g_strcmp0 (snapd_snap_get_tracking_channel (old_snap), snapd_snap_get_tracking_channel (new_snap)) != 0)
+        flags |= SNAPD_SNAP_SET_CHANGE_FLAGS_CHANNEL;
+    if (snapd_snap_get_status (old_snap) != snapd_snap_get_status (new_snap))
+        flags |= SNAPD_SNAP_SET_CHANGE_FLAGS_STATUS;
+    if (flags == SNAPD_SNAP_SET_CHANGE_FLAGS_NONE)
+        flags = SNAPD_SNAP_SET_CHANGE_FLAGS_OTHER;
+
+    return flags;
+}
+
+/* Replace the contents of the set with @snaps, which were parsed from data with @fingerprints.
+ * If @fingerprints is %NULL the snaps can't be reused by later updates */
+void
+_snapd_snap_set_update (SnapdSnapSet *self, GPtrArray *snaps, GArray *fingerprints)
+{
+    g_autoptr(GPtrArray) entries = g_ptr_array_new_with_free_func ((GDestroyNotify) snap_set_entry_free);
+    g_autoptr(GHashTable) entries_by_name = g_hash_table_new (g_str_hash, g_str_equal);
+    g_autoptr(GHashTable) entries_by_fingerprint = g_hash_table_new (g_int64_hash, g_int64_equal);
+
+    g_ptr_array_set_size (self->added, 0);
+    g_ptr_array_set_size (self->removed, 0);
+    g_ptr_array_set_size (self->changed, 0);
+    g_hash_table_remove_all (self->change_flags);
+    self->n_reused = 0;
+
+    for (guint i = 0; i < snaps->len; i++) {
+        SnapdSnap *snap = g_ptr_array_index (snaps, i);
+        const gchar *name = snapd_snap_get_name (snap);
+        if (name == NULL)
+            continue;
+
+        SnapSetEntry *entry = g_slice_new0 (SnapSetEntry);
+        entry->snap = g_object_ref (snap);
+        g_ptr_array_add (entries, entry);
+        g_hash_table_insert (entries_by_name, (gpointer) name, entry);
+        if (fingerprints != NULL) {
+            entry->fingerprint = g_array_index (fingerprints, guint64, i);
+            g_hash_table_insert (entries_by_fingerprint, &entry->fingerprint, entry);
+        }
+
+        SnapSetEntry *old_entry = g_hash_table_lookup (self->entries_by_name, name);
+        SnapdSnapSetChangeFlags flags;
+        if (old_entry == NULL) {
+            flags = SNAPD_SNAP_SET_CHANGE_FLAGS_ADDED;
+            g_ptr_array_add (self->added, g_object_ref (snap));
+        }
+        else if (fingerprints == NULL || old_entry->fingerprint != entry->fingerprint) {
+            flags = get_change_flags (old_entry->snap, snap);
+            g_ptr_array_add (self->changed, g_object_ref (snap));
+        }
+        else
+            flags = SNAPD_SNAP_SET_CHANGE_FLAGS_NONE;
+        if (flags != SNAPD_SNAP_SET_CHANGE_FLAGS_NONE)
+            g_hash_table_insert (self->change_flags, g_strdup (name), GUINT_TO_POINTER (flags));
+
+        if (old_entry != NULL && old_entry->snap == snap)
+            self->n_reused++;
+    }
+
+    for (guint i = 0; i < self->entries->len; i++) {
+        SnapSetEntry *old_entry = g_ptr_array_index (self->entries, i);
+        const gchar *name = snapd_snap_get_name (old_entry->snap);
+        if (g_hash_table_contains (entries_by_name, name))
+            continue;
+
+        g_ptr_array_add (self->removed, g_object_ref (old_entry->snap));
+        g_hash_table_insert (self->change_flags, g_strdup (name), GUINT_TO_POINTER (SNAPD_SNAP_SET_CHANGE_FLAGS_REMOVED));
+    }
+
+    g_ptr_array_unref (self->snaps);
+    self->snaps = g_ptr_array_ref (snaps);
+    g_ptr_array_unref (self->entries);
+    self->entries = g_steal_pointer (&entries);
+    g_hash_table_unref (self->entries_by_name);
+    self->entries_by_name = g_steal_pointer (&entries_by_name);
+    g_hash_table_unref (self->entries_by_fingerprint);
+    self->entries_by_fingerprint = g_steal_pointer (&entries_by_fingerprint);
+}
+
+static void
+snapd_snap_set_finalize (GObject *object)
+{
+    SnapdSnapSet *self = SNAPD_SNAP_SET (object);
+
+    g_clear_pointer (&self->snaps, g_ptr_array_unref);
+    g_clear_pointer (&self->entries_by_name, g_hash_table_unref);
+    g_clear_pointer (&self->entries_by_fingerprint, g_hash_table_unref);
+    g_clear_pointer (&self->entries, g_ptr_array_unref);
+    g_clear_pointer (&self->added, g_ptr_array_unref);
+    g_clear_pointer (&self->removed, g_ptr_array_unref);
+    g_clear_pointer (&self->changed, g_ptr_array_unref);
+    g_clear_pointer (&self->change_flags, g_hash_table_unref);
+
+    G_OBJECT_CLASS (snapd_snap_set_parent_class)->finalize (object);
+}
+
+static void
+snapd_snap_set_class_init (SnapdSnapSetClass *klass)
+{
+    GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+    gobject_class->finalize = snapd_snap_set_finalize;
+}
+
+static void
+snapd_snap_set_init (SnapdSnapSet *self)
+{
+    self->snaps = g_ptr_array_new_with_free_func (g_object_unref);
+    self->entries = g_ptr_array_new_with_free_func ((GDestroyNotify) snap_set_entry_free);
+    self->entries_by_name = g_hash_table_new (g_str_hash, g_str_equal);
+    self->entries_by_fingerprint = g_hash_table_new (g_int64_hash, g_int64_equal);
+    self->added = g_ptr_array_new_with_free_func (g_object_unref);
+    self->removed = g_ptr_array_new_with_free_func (g_object_unref);
+    self->changed = g_ptr_array_new_with_free_func (g_object_unref);
+    self->change_flags = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_SNAP_SET_H__
+#define __SNAPD_SNAP_SET_H__
+
+#if !defined(__SNAPD_GLIB_INSIDE__) && !defined(SNAPD_COMPILATION)
+#error "Only <snapd-glib/snapd-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <snapd-glib/snapd-snap.h>
+
+G_BEGIN_DECLS
+
+#define SNAPD_TYPE_SNAP_SET (snapd_snap_set_get_type ())
+
+G_DECLARE_FINAL_TYPE (SnapdSnapSet, snapd_snap_set, SNAPD, SNAP_SET, GObject)
+
+/**
+ * SnapdSnapSetChangeFlags:
+ * @SNAPD_SNAP_SET_CHANGE_FLAGS_NONE: The snap is unchanged.
+ * @SNAPD_SNAP_SET_CHANGE_FLAGS_ADDED: The snap was added.
+ * @SNAPD_SNAP_SET_CHANGE_FLAGS_REMOVED: The snap was removed.
+ * @SNAPD_SNAP_SET_CHANGE_FLAGS_REVISION: The revision of the snap changed.
+ * @SNAPD_SNAP_SET_CHANGE_FLAGS_CHANNEL: The channel the snap is tracking changed.
+ * @SNAPD_SNAP_SET_CHANGE_FLAGS_STATUS: The snap was enabled or disabled.
+ * @SNAPD_SNAP_SET_CHANGE_FLAGS_OTHER: Other information about the snap changed.
+ *
+ * How a snap changed when a #SnapdSnapSet was last updated.
+ *
+ * Since: 1.59
+ */
+typedef enum
+{
+    SNAPD_SNAP_SET_CHANGE_FLAGS_NONE     = 0,
+    SNAPD_SNAP_SET_CHANGE_FLAGS_ADDED    = 1 << 0,
+    SNAPD_SNAP_SET_CHANGE_FLAGS_REMOVED  = 1 << 1,
+    SNAPD_SNAP_SET_CHANGE_FLAGS_REVISION = 1 << 2,
+    SNAPD_SNAP_SET_CHANGE_FLAGS_CHANNEL  = 1 << 3,
+    SNAPD_SNAP_SET_CHANGE_FLAGS_STATUS   = 1 << 4,
+    SNAPD_SNAP_SET_CHANGE_FLAGS_OTHER    = 1 << 5
+} SnapdSnapSetChangeFlags;
+
+SnapdSnapSet           *snapd_snap_set_new              (void);
+
+GPtrArray              *snapd_snap_set_get_snaps        (SnapdSnapSet *snap_set);
+
+SnapdSnap              *snapd_snap_set_lookup           (SnapdSnapSet *snap_set,
+                                                         const gchar  *name);
+
+GPtrArray              *snapd_snap_set_get_added        (SnapdSnapSet *snap_set);
+
+GPtrArray              *snapd_snap_set_get_removed      (SnapdSnapSet *snap_set);
+
+GPtrArray              *snapd_snap_set_get_changed      (SnapdSnapSet *snap_set);
+
+SnapdSnapSetChangeFlags snapd_snap_set_get_change_flags (SnapdSnapSet *snap_set,
+                                                         const gchar  *name);
+
+guint                   snapd_snap_set_get_n_reused     (SnapdSnapSet *snap_set);
+
+G_END_DECLS
+
+#endif /* __SNAPD_SNAP_SET_H__ */
@@ -7,8 +7,9 @@
  * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
  */
 
-#include "snapd-snap.h"
+#include "snapd-snap-private.h"
 #include "snapd-enum-types.h"
+#include "snapd-string-pool.h"
 
 /**
  * SECTION:snapd-snap
@@ -69,6 +70,10 @@ struct _SnapdSnap
     SnapdSnapType snap_type;
     gchar *version;
     gchar *website;
+
+    /* Data to build apps, channels, media and prices from when first used */
+    GBytes *deferred_data;
+    SnapdSnapMaterializeFunc materialize;
 };
 
 enum
@@ -116,6 +121,97 @@ enum
 
 G_DEFINE_TYPE (SnapdSnap, snapd_snap, G_TYPE_OBJECT)
 
+SnapdSnap *
+_snapd_snap_new (GPtrArray *apps, gchar *base, gchar *broken, gchar *channel, GPtrArray *channels,
+                 GStrv common_ids, SnapdConfinement confinement, gchar *contact, gchar *description,
+                 gboolean devmode, gint64 download_size, gchar *icon, gchar *id,
+                 GDateTime *install_date, gint64 installed_size, gboolean jailmode, gchar *license,
+                 GPtrArray *media, gchar *mounted_from, gchar *name, GPtrArray *prices,
+                 gboolean private, gchar *publisher_display_name, gchar *publisher_id,
+                 gchar *publisher_username, SnapdPublisherValidation publisher_validation,
+                 gchar *revision, GPtrArray *screenshots, SnapdSnapStatus status, gchar *summary,
+                 gchar *title, gchar *tracking_channel, GStrv tracks, gboolean trymode,
+                 SnapdSnapType snap_type, gchar *version, gchar *website)
+{
+    SnapdSnap *self = g_object_new (SNAPD_TYPE_SNAP, NULL);
+
+    self->apps = apps;
+    self->base = base;
+    self->broken = broken;
+    self->channel = channel;
+    self->channels = channels;
+    self->common_ids = common_ids;
+    self->confinement = confinement;
+    self->contact = contact;
+    self->description = description;
+    self->devmode = devmode;
+    self->download_size = download_size;
+    self->icon = icon;
+    self->id = id;
+    self->install_date = install_date;
+    self->installed_size = installed_size;
+    self->jailmode = jailmode;
+    self->license = license;
+    self->media = media;
+    self->mounted_from = mounted_from;
+    self->name = name;
+    self->prices = prices;
+    self->private = private;
+    self->publisher_display_name = publisher_display_name;
+    self->publisher_id = publisher_id;
+    self->publisher_username = publisher_username;
+    self->publisher_validation = publisher_validation;
+    self->revision = revision;
+    self->screenshots = screenshots;
+    self->status = status;
+    self->summary = summary;
+    self->title = title;
+    self->tracking_channel = tracking_channel;
+    self->tracks = tracks;
+    self->trymode = trymode;
+    self->snap_type = snap_type;
+    self->version = version;
+    self->website = website;
+
+    return self;
+}
+
+/* Build the apps, channels, media and prices from @data when they are first used.
+ * The arrays must be empty */
+void
+_snapd_snap_set_deferred (SnapdSnap *self, GBytes *data, SnapdSnapMaterializeFunc materialize)
+{
+    g_clear_pointer (&self->deferred_data, g_bytes_unref);
+    self->deferred_data = g_bytes_ref (data);
+    self->materialize = materialize;
+}
+
+/* Build any members that were deferred when the snap was created */
+static void
+materialize_members (SnapdSnap *self)
+{
+    if (g_atomic_pointer_get (&self->deferred_data) == NULL)
+        return;
+
+    /* Snaps may be shared between threads */
+    static GMutex materialize_mutex;
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&materialize_mutex);
+    if (self->deferred_data == NULL)
+        return;
+
+    if (!self->materialize (self->deferred_data, self->name, self->apps, self->channels, self->media, self->prices)) {
+        g_warning ("Failed to parse details of snap %s", self->name);
+        g_ptr_array_set_size (self->apps, 0);
+        g_ptr_array_set_size (self->channels, 0);
+        g_ptr_array_set_size (self->media, 0);
+        g_ptr_array_set_size (self->prices, 0);
+    }
+
+    GBytes *data = self->deferred_data;
+    g_atomic_pointer_set (&self->deferred_data, NULL);
+    g_bytes_unref (data);
+}
+
 /**
  * snapd_snap_get_apps:
  * @snap: a #SnapdSnap.
@@ -130,6 +226,7 @@ GPtrArray *
 snapd_snap_get_apps (SnapdSnap *self)
 {
     g_return_val_if_fail (SNAPD_IS_SNAP (self), NULL);
+    materialize_members (self);
     return self->apps;
 }
 
@@ -198,6 +295,7 @@ GPtrArray *
 snapd_snap_get_channels (SnapdSnap *self)
 {
     g_return_val_if_fail (SNAPD_IS_SNAP (self), NULL);
+    materialize_members (self);
     return self->channels;
 }
 
@@ -239,6 +337,7 @@ snapd_snap_match_channel (SnapdSnap *self, const gchar *name)
                                               NULL);
     SnapdChannel *matched_channel = NULL;
     int matched_risk = -1;
+    materialize_members (self);
     for (guint i = 0; i < self->channels->len; i++) {
         SnapdChannel *channel = self->channels->pdata[i];
 
@@ -500,6 +599,7 @@ GPtrArray *
 snapd_snap_get_media (SnapdSnap *self)
 {
     g_return_val_if_fail (SNAPD_IS_SNAP (self), NULL);
+    materialize_members (self);
     return self->media;
 }
 
@@ -570,6 +670,7 @@ GPtrArray *
 snapd_snap_get_prices (SnapdSnap *self)
 {
     g_return_val_if_fail (SNAPD_IS_SNAP (self), NULL);
+    materialize_members (self);
     return self->prices;
 }
 
@@ -837,6 +938,9 @@ snapd_snap_set_property (GObject *object, guint prop_id, const GValue *value, GP
 {
     SnapdSnap *self = SNAPD_SNAP (object);
 
+    /* Array properties need the deferred members */
+    materialize_members (self);
+
     switch (prop_id) {
     case PROP_APPS:
         g_clear_pointer (&self->apps, g_ptr_array_unref);
@@ -844,16 +948,16 @@ snapd_snap_set_property (GObject *object, guint prop_id, const GValue *value, GP
             self->apps = g_ptr_array_ref (g_value_get_boxed (value));
         break;
     case PROP_BASE:
-        g_free (self->base);
-        self->base = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->base);
+        self->base = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_BROKEN:
         g_free (self->broken);
         self->broken = g_strdup (g_value_get_string (value));
         break;
     case PROP_CHANNEL:
-        g_free (self->channel);
-        self->channel = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->channel);
+        self->channel = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_CHANNELS:
         g_clear_pointer (&self->channels, g_ptr_array_unref);
@@ -918,17 +1022,17 @@ snapd_snap_set_property (GObject *object, guint prop_id, const GValue *value, GP
         self->private = g_value_get_boolean (value);
         break;
     case PROP_PUBLISHER_DISPLAY_NAME:
-        g_free (self->publisher_display_name);
-        self->publisher_display_name = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->publisher_display_name);
+        self->publisher_display_name = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_PUBLISHER_ID:
-        g_free (self->publisher_id);
-        self->publisher_id = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->publisher_id);
+        self->publisher_id = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_PUBLISHER_USERNAME:
     case PROP_DEVELOPER:
-        g_free (self->publisher_username);
-        self->publisher_username = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->publisher_username);
+        self->publisher_username = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_PUBLISHER_VALIDATION:
         self->publisher_validation = g_value_get_enum (value);
@@ -957,8 +1061,8 @@ snapd_snap_set_property (GObject *object, guint prop_id, const GValue *value, GP
         self->title = g_strdup (g_value_get_string (value));
         break;
     case PROP_TRACKING_CHANNEL:
-        g_free (self->tracking_channel);
-        self->tracking_channel = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->tracking_channel);
+        self->tracking_channel = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_TRACKS:
         g_strfreev (self->tracks);
@@ -972,8 +1076,8 @@ snapd_snap_set_property (GObject *object, guint prop_id, const GValue *value, GP
         self->version = g_strdup (g_value_get_string (value));
         break;
     case PROP_LICENSE:
-        g_free (self->license);
-        self->license = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->license);
+        self->license = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_COMMON_IDS:
         g_strfreev (self->common_ids);
@@ -994,6 +1098,9 @@ snapd_snap_get_property (GObject *object, guint prop_id, GValue *value, GParamSp
 {
     SnapdSnap *self = SNAPD_SNAP (object);
 
+    /* Array properties need the deferred members */
+    materialize_members (self);
+
     switch (prop_id) {
     case PROP_APPS:
         g_value_set_boxed (value, self->apps);
@@ -1118,10 +1225,11 @@ snapd_snap_finalize (GObject *object)
 {
     SnapdSnap *self = SNAPD_SNAP (object);
 
+    g_clear_pointer (&self->deferred_data, g_bytes_unref);
     g_clear_pointer (&self->apps, g_ptr_array_unref);
-    g_clear_pointer (&self->base, g_free);
+    g_clear_pointer (&self->base, _snapd_ref_string_release);
     g_clear_pointer (&self->broken, g_free);
-    g_clear_pointer (&self->channel, g_free);
+    g_clear_pointer (&self->channel, _snapd_ref_string_release);
     g_clear_pointer (&self->channels, g_ptr_array_unref);
     g_clear_pointer (&self->common_ids, g_strfreev);
     g_clear_pointer (&self->contact, g_free);
@@ -1130,18 +1238,18 @@ snapd_snap_finalize (GObject *object)
     g_clear_pointer (&self->id, g_free);
     g_clear_pointer (&self->install_date, g_date_time_unref);
     g_clear_pointer (&self->name, g_free);
-    g_clear_pointer (&self->license, g_free);
+    g_clear_pointer (&self->license, _snapd_ref_string_release);
     g_clear_pointer (&self->media, g_ptr_array_unref);
     g_clear_pointer (&self->mounted_from, g_free);
     g_clear_pointer (&self->prices, g_ptr_array_unref);
-    g_clear_pointer (&self->publisher_display_name, g_free);
-    g_clear_pointer (&self->publisher_id, g_free);
-    g_clear_pointer (&self->publisher_username, g_free);
+    g_clear_pointer (&self->publisher_display_name, _snapd_ref_string_release);
+    g_clear_pointer (&self->publisher_id, _snapd_ref_string_release);
+    g_clear_pointer (&self->publisher_username, _snapd_ref_string_release);
     g_clear_pointer (&self->revision, g_free);
     g_clear_pointer (&self->screenshots, g_ptr_array_unref);
     g_clear_pointer (&self->summary, g_free);
     g_clear_pointer (&self->title, g_free);
-    g_clear_pointer (&self->tracking_channel, g_free);
+    g_clear_pointer (&self->tracking_channel, _snapd_ref_string_release);
     g_clear_pointer (&self->tracks, g_strfreev);
     g_clear_pointer (&self->version, g_free);
     g_clear_pointer (&self->website, g_free);
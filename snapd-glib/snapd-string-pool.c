@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#include <string.h>
+
+#include "snapd-string-pool.h"
+
+/* Reference counted strings.
+ * The reference count is stored before the string data, so they can be used anywhere a normal string is.
+ * They must only be freed with _snapd_ref_string_release(). */
+
+typedef struct
+{
+    volatile gint ref_count;
+    gchar data[];
+} RefString;
+
+static RefString *
+get_ref_string (gchar *value)
+{
+    return (RefString *) (value - G_STRUCT_OFFSET (RefString, data));
+}
+
+gchar *
+_snapd_ref_string_new (const gchar *value)
+{
+    if (value == NULL)
+        return NULL;
+
+    gsize length = strlen (value);
+    RefString *s = g_malloc (sizeof (RefString) + length + 1);
+    s->ref_count = 1;
+    memcpy (s->data, value, length + 1);
+
+    return s->data;
+}
+
+gchar *
+_snapd_ref_string_acquire (gchar *value)
+{
+    if (value != NULL)
+        g_atomic_int_inc (&get_ref_string (value)->ref_count);
+    return value;
+}
+
+void
+_snapd_ref_string_release (gchar *value)
+{
+    if (value == NULL)
+        return;
+
+    RefString *s = get_ref_string (value);
+    if (g_atomic_int_dec_and_test (&s->ref_count))
+        g_free (s);
+}
+
+/* Pool of strings so that repeated values share the same memory.
+ * The pool holds a reference to every string in it, strings remain valid after the pool is freed. */
+struct _SnapdStringPool
+{
+    GHashTable *strings;
+};
+
+SnapdStringPool *
+_snapd_string_pool_new (void)
+{
+    SnapdStringPool *pool = g_slice_new0 (SnapdStringPool);
+    pool->strings = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) _snapd_ref_string_release);
+
+    return pool;
+}
+
+gchar *
+_snapd_string_pool_intern (SnapdStringPool *pool, const gchar *value)
+{
+    if (value == NULL)
+        return NULL;
+
+    /* No pool, so just make an unshared string */
+    if (pool == NULL)
+        return _snapd_ref_string_new (value);
+
+    gchar *s = g_hash_table_lookup (pool->strings, value);
+    if (s == NULL) {
+        s = _snapd_ref_string_new (value);
+        g_hash_table_insert (pool->strings, s, s);
+    }
+
+    return _snapd_ref_string_acquire (s);
+}
+
+void
+_snapd_string_pool_free (SnapdStringPool *pool)
+{
+    g_hash_table_unref (pool->strings);
+    g_slice_free (SnapdStringPool, pool);
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_STRING_POOL_H__
+#define __SNAPD_STRING_POOL_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+gchar           *_snapd_ref_string_new        (const gchar     *value);
+
+gchar           *_snapd_ref_string_acquire    (gchar           *value);
+
+void             _snapd_ref_string_release    (gchar           *value);
+
+typedef struct _SnapdStringPool SnapdStringPool;
+
+SnapdStringPool *_snapd_string_pool_new       (void);
+
+gchar           *_snapd_string_pool_intern    (SnapdStringPool *pool,
+                                               const gchar     *value);
+
+void             _snapd_string_pool_free      (SnapdStringPool *pool);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (SnapdStringPool, _snapd_string_pool_free)
+
+G_END_DECLS
+
+#endif /* __SNAPD_STRING_POOL_H__ */
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#ifndef __SNAPD_TASK_PRIVATE_H__
+#define __SNAPD_TASK_PRIVATE_H__
+
+#include "snapd-task.h"
+
+G_BEGIN_DECLS
+
+/* The task takes ownership of the strings and dates, @kind and @status are reference counted strings */
+SnapdTask *_snapd_task_new (gchar               *id,
+                            gchar               *kind,
+                            gchar               *summary,
+                            gchar               *status,
+                            gchar               *progress_label,
+                            gint64               progress_done,
+                            gint64               progress_total,
+                            GDateTime           *spawn_time,
+                            GDateTime           *ready_time);
+
+/* Fingerprints are 64 bit hashes of the fields of an object, used to check if it changed between polls */
+#define SNAPD_FINGERPRINT_INIT 14695981039346656037ULL
+
+guint64    _snapd_fingerprint_add_string    (guint64      fingerprint,
+                                             const gchar *value);
+
+guint64    _snapd_fingerprint_add_data      (guint64      fingerprint,
+                                             const gchar *data,
+                                             gsize        length);
+
+guint64    _snapd_fingerprint_add_int       (guint64      fingerprint,
+                                             gint64       value);
+
+guint64    _snapd_fingerprint_add_date_time (guint64      fingerprint,
+                                             GDateTime   *value);
+
+guint64    _snapd_task_get_fingerprint      (SnapdTask   *task);
+
+G_END_DECLS
+
+#endif /* __SNAPD_TASK_PRIVATE_H__ */
@@ -9,8 +9,9 @@
 
 #include <string.h>
 
-#include "snapd-task.h"
+#include "snapd-task-private.h"
 #include "snapd-change.h"
+#include "snapd-string-pool.h"
 
 /**
  * SECTION: snapd-task
@@ -41,6 +42,9 @@ struct _SnapdTask
     gint64 progress_total;
     GDateTime *spawn_time;
     GDateTime *ready_time;
+
+    /* Hash of all the above, so tasks can be compared quickly when polling */
+    guint64 fingerprint;
 };
 
 enum
@@ -60,6 +64,89 @@ enum
 
 G_DEFINE_TYPE (SnapdTask, snapd_task, G_TYPE_OBJECT)
 
+/* FNV-1a */
+#define FINGERPRINT_PRIME 1099511628211ULL
+
+guint64
+_snapd_fingerprint_add_string (guint64 fingerprint, const gchar *value)
+{
+    /* Distinguish NULL from "" and stop values running into each other */
+    if (value == NULL)
+        return (fingerprint ^ 0xFF) * FINGERPRINT_PRIME;
+    for (const guchar *c = (const guchar *) value; *c != '\0'; c++)
+        fingerprint = (fingerprint ^ *c) * FINGERPRINT_PRIME;
+    return (fingerprint ^ 0xFE) * FINGERPRINT_PRIME;
+}
+
+guint64
+_snapd_fingerprint_add_data (guint64 fingerprint, const gchar *data, gsize length)
+{
+    for (gsize i = 0; i < length; i++)
+        fingerprint = (fingerprint ^ (guchar) data[i]) * FINGERPRINT_PRIME;
+    return fingerprint;
+}
+
+guint64
+_snapd_fingerprint_add_int (guint64 fingerprint, gint64 value)
+{
+    guint64 v = (guint64) value;
+    for (int i = 0; i < 8; i++) {
+        fingerprint = (fingerprint ^ (v & 0xFF)) * FINGERPRINT_PRIME;
+        v >>= 8;
+    }
+    return fingerprint;
+}
+
+guint64
+_snapd_fingerprint_add_date_time (guint64 fingerprint, GDateTime *value)
+{
+    if (value == NULL)
+        return _snapd_fingerprint_add_int (fingerprint, G_MININT64);
+    fingerprint = _snapd_fingerprint_add_int (fingerprint, g_date_time_to_unix (value));
+    return _snapd_fingerprint_add_int (fingerprint, g_date_time_get_microsecond (value));
+}
+
+static void
+update_fingerprint (SnapdTask *self)
+{
+    guint64 fingerprint = SNAPD_FINGERPRINT_INIT;
+    fingerprint = _snapd_fingerprint_add_string (fingerprint, self->id);
+    fingerprint = _snapd_fingerprint_add_string (fingerprint, self->kind);
+    fingerprint = _snapd_fingerprint_add_string (fingerprint, self->summary);
+    fingerprint = _snapd_fingerprint_add_string (fingerprint, self->status);
+    fingerprint = _snapd_fingerprint_add_string (fingerprint, self->progress_label);
+    fingerprint = _snapd_fingerprint_add_int (fingerprint, self->progress_done);
+    fingerprint = _snapd_fingerprint_add_int (fingerprint, self->progress_total);
+    fingerprint = _snapd_fingerprint_add_date_time (fingerprint, self->spawn_time);
+    fingerprint = _snapd_fingerprint_add_date_time (fingerprint, self->ready_time);
+    self->fingerprint = fingerprint;
+}
+
+guint64
+_snapd_task_get_fingerprint (SnapdTask *self)
+{
+    return self->fingerprint;
+}
+
+SnapdTask *
+_snapd_task_new (gchar *id, gchar *kind, gchar *summary, gchar *status, gchar *progress_label, gint64 progress_done, gint64 progress_total, GDateTime *spawn_time, GDateTime *ready_time)
+{
+    SnapdTask *self = g_object_new (SNAPD_TYPE_TASK, NULL);
+
+    self->id = id;
+    self->kind = kind;
+    self->summary = summary;
+    self->status = status;
+    self->progress_label = progress_label;
+    self->progress_done = progress_done;
+    self->progress_total = progress_total;
+    self->spawn_time = spawn_time;
+    self->ready_time = ready_time;
+    update_fingerprint (self);
+
+    return self;
+}
+
 /**
  * snapd_task_get_id:
  * @task: a #SnapdTask.
@@ -282,16 +369,16 @@ snapd_task_set_property (GObject *object, guint prop_id, const GValue *value, GP
         self->id = g_strdup (g_value_get_string (value));
         break;
     case PROP_KIND:
-        g_free (self->kind);
-        self->kind = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->kind);
+        self->kind = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_SUMMARY:
         g_free (self->summary);
         self->summary = g_strdup (g_value_get_string (value));
         break;
     case PROP_STATUS:
-        g_free (self->status);
-        self->status = g_strdup (g_value_get_string (value));
+        _snapd_ref_string_release (self->status);
+        self->status = _snapd_ref_string_new (g_value_get_string (value));
         break;
     case PROP_READY:
         // Deprecated
@@ -364,15 +451,23 @@ snapd_task_get_property (GObject *object, guint prop_id, GValue *value, GParamSp
     }
 }
 
+static void
+snapd_task_constructed (GObject *object)
+{
+    update_fingerprint (SNAPD_TASK (object));
+
+    G_OBJECT_CLASS (snapd_task_parent_class)->constructed (object);
+}
+
 static void
 snapd_task_finalize (GObject *object)
 {
     SnapdTask *self = SNAPD_TASK (object);
 
     g_clear_pointer (&self->id, g_free);
-    g_clear_pointer (&self->kind, g_free);
+    g_clear_pointer (&self->kind, _snapd_ref_string_release);
     g_clear_pointer (&self->summary, g_free);
-    g_clear_pointer (&self->status, g_free);
+    g_clear_pointer (&self->status, _snapd_ref_string_release);
     g_clear_pointer (&self->progress_label, g_free);
     g_clear_pointer (&self->spawn_time, g_date_time_unref);
     g_clear_pointer (&self->ready_time, g_date_time_unref);
@@ -387,6 +482,7 @@ snapd_task_class_init (SnapdTaskClass *klass)
 
     gobject_class->set_property = snapd_task_set_property;
     gobject_class->get_property = snapd_task_get_property;
+    gobject_class->constructed = snapd_task_constructed;
     gobject_class->finalize = snapd_task_finalize;
 
     g_object_class_install_property (gobject_class,
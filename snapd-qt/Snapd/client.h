@@ -307,6 +307,28 @@ private:
     Q_DECLARE_PRIVATE(QSnapdGetIconRequest)
 };
 
+class QSnapdGetIconsRequestPrivate;
+class Q_DECL_EXPORT QSnapdGetIconsRequest : public QSnapdRequest
+{
+    Q_OBJECT
+
+public:
+    explicit QSnapdGetIconsRequest (const QStringList& names, uint maxRequests, void *snapd_client, QObject *parent = 0);
+    ~QSnapdGetIconsRequest ();
+    virtual void runSync ();
+    virtual void runAsync ();
+    Q_INVOKABLE QSnapdIcon *icon (const QString& name) const;
+    void handleResult (void *, void *);
+    void handleIcon (const QString& name, void *icon);
+
+Q_SIGNALS:
+    void iconReceived (const QString& name);
+
+private:
+    QScopedPointer<QSnapdGetIconsRequestPrivate> d_ptr;
+    Q_DECLARE_PRIVATE(QSnapdGetIconsRequest)
+};
+
 class QSnapdGetAssertionsRequestPrivate;
 class Q_DECL_EXPORT QSnapdGetAssertionsRequest : public QSnapdRequest
 {
@@ -363,6 +385,20 @@ public:
     Q_INVOKABLE QSnapdPlug *plug (int) const;
     Q_INVOKABLE int slotCount () const;
     Q_INVOKABLE QSnapdSlot *slot (int) const;
+    Q_INVOKABLE QSnapdPlug *findPlug (const QString &snap, const QString &name) const;
+    Q_INVOKABLE QSnapdSlot *findSlot (const QString &snap, const QString &name) const;
+    Q_INVOKABLE int snapPlugCount (const QString &snap) const;
+    Q_INVOKABLE QSnapdPlug *snapPlug (const QString &snap, int) const;
+    Q_INVOKABLE int snapSlotCount (const QString &snap) const;
+    Q_INVOKABLE QSnapdSlot *snapSlot (const QString &snap, int) const;
+    Q_INVOKABLE int interfacePlugCount (const QString &interface) const;
+    Q_INVOKABLE QSnapdPlug *interfacePlug (const QString &interface, int) const;
+    Q_INVOKABLE int interfaceSlotCount (const QString &interface) const;
+    Q_INVOKABLE QSnapdSlot *interfaceSlot (const QString &interface, int) const;
+    Q_INVOKABLE int plugConnectionCount (const QString &snap, const QString &name) const;
+    Q_INVOKABLE QSnapdConnection *plugConnection (const QString &snap, const QString &name, int) const;
+    Q_INVOKABLE int slotConnectionCount (const QString &snap, const QString &name) const;
+    Q_INVOKABLE QSnapdConnection *slotConnection (const QString &snap, const QString &name, int) const;
     void handleResult (void *, void *);
 
 private:
@@ -887,11 +923,17 @@ class Q_DECL_EXPORT QSnapdDownloadRequest : public QSnapdRequest
 
 public:
     explicit QSnapdDownloadRequest (const QString& name, const QString& channel, const QString& revision, void *snapd_client, QObject *parent = 0);
+    explicit QSnapdDownloadRequest (const QString& name, const QString& channel, const QString& revision, const QString& resumeToken, qint64 offset, QIODevice *ioDevice, void *snapd_client, QObject *parent = 0);
     ~QSnapdDownloadRequest ();
     virtual void runSync ();
     virtual void runAsync ();
     Q_INVOKABLE QByteArray data () const;
+    Q_INVOKABLE QString resumeToken () const;
     void handleResult (void *, void *);
+    void handleDownloadProgress (qint64, qint64);
+
+Q_SIGNALS:
+    void downloadProgress (qint64 bytesReceived, qint64 bytesTotal);
 
 private:
     QScopedPointer<QSnapdDownloadRequestPrivate> d_ptr;
@@ -984,6 +1026,25 @@ public:
     Q_INVOKABLE QString userAgent () const;
     Q_INVOKABLE void setAllowInteraction (bool allowInteraction);
     Q_INVOKABLE bool allowInteraction () const;
+    Q_INVOKABLE void setPipelineDepth (uint depth);
+    Q_INVOKABLE uint pipelineDepth () const;
+    Q_INVOKABLE void setMaxConnections (uint maxConnections);
+    Q_INVOKABLE uint maxConnections () const;
+    Q_INVOKABLE uint nConnections () const;
+    bool connectionStats (uint index, uint *nPending, quint64 *nRequests, quint64 *nBytesSent, quint64 *nBytesReceived) const;
+    Q_INVOKABLE void setConnectionIdleTimeout (uint timeout);
+    Q_INVOKABLE uint connectionIdleTimeout () const;
+    Q_INVOKABLE void setParseInThread (bool parseInThread);
+    Q_INVOKABLE bool parseInThread () const;
+    Q_INVOKABLE void setLazySnaps (bool lazySnaps);
+    Q_INVOKABLE bool lazySnaps () const;
+    Q_INVOKABLE bool setResponseCacheTtl (const QString &path, uint ttl);
+    Q_INVOKABLE uint responseCacheTtl (const QString &path) const;
+    Q_INVOKABLE void clearResponseCache ();
+    Q_INVOKABLE void setIconCacheSize (quint64 maxSize);
+    Q_INVOKABLE quint64 iconCacheSize () const;
+    Q_INVOKABLE void setIconCachePath (const QString &path);
+    Q_INVOKABLE QString iconCachePath () const;
     Q_INVOKABLE QSnapdMaintenance *maintenance () const;
     Q_INVOKABLE void setAuthData (QSnapdAuthData *authData);
     Q_INVOKABLE QSnapdAuthData *authData ();
@@ -1012,6 +1073,8 @@ public:
     Q_INVOKABLE QSnapdGetAppsRequest *getApps (const QStringList &snaps);
     Q_INVOKABLE QSnapdGetAppsRequest *getApps (const QString &snap);
     Q_INVOKABLE QSnapdGetIconRequest *getIcon (const QString &name);
+    Q_INVOKABLE QSnapdGetIconsRequest *getIcons (const QStringList &names);
+    Q_INVOKABLE QSnapdGetIconsRequest *getIcons (const QStringList &names, uint maxRequests);
     Q_INVOKABLE QSnapdGetAssertionsRequest *getAssertions (const QString &type);
     Q_INVOKABLE QSnapdAddAssertionsRequest *addAssertions (const QStringList &assertions);
     Q_INVOKABLE QSnapdGetConnectionsRequest *getConnections ();
@@ -1066,6 +1129,8 @@ public:
     Q_INVOKABLE QSnapdRunSnapCtlRequest *runSnapCtl (const QString contextId, const QStringList &args);
     Q_INVOKABLE QSnapdDownloadRequest *download (const QString &name);
     Q_INVOKABLE QSnapdDownloadRequest *download (const QString &name, const QString &channel, const QString &revision);
+    Q_INVOKABLE QSnapdDownloadRequest *download (const QString &name, const QString &channel, const QString &revision, QIODevice *ioDevice);
+    Q_INVOKABLE QSnapdDownloadRequest *download (const QString &name, const QString &channel, const QString &revision, const QString &resumeToken, qint64 offset, QIODevice *ioDevice);
 
 private:
     QScopedPointer<QSnapdClientPrivate> d_ptr;
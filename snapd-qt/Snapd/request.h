@@ -62,7 +62,8 @@ public:
         ChannelNotAvailable,
         NotASnap,
         DNSFailure,
-        OptionNotFound
+        OptionNotFound,
+        QueueFull
     };
     Q_ENUM(QSnapdError)
 
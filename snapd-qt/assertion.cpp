@@ -19,10 +19,9 @@ QSnapdAssertion::QSnapdAssertion (const QString& contents, QObject *parent) :
 
 QStringList QSnapdAssertion::headers () const
 {
-    g_auto(GStrv) headers = NULL;
     QStringList result;
 
-    headers = snapd_assertion_get_headers (SNAPD_ASSERTION (wrapped_object));
+    const gchar * const *headers = snapd_assertion_peek_headers (SNAPD_ASSERTION (wrapped_object));
     for (int i = 0; headers[i] != NULL; i++)
         result.append (headers[i]);
     return result;
@@ -30,18 +29,19 @@ QStringList QSnapdAssertion::headers () const
 
 QString QSnapdAssertion::header (const QString& name) const
 {
-    g_autofree gchar *header = snapd_assertion_get_header (SNAPD_ASSERTION (wrapped_object), name.toStdString ().c_str ());
-    return header;
+    return snapd_assertion_peek_header (SNAPD_ASSERTION (wrapped_object), name.toStdString ().c_str ());
 }
 
 QString QSnapdAssertion::body () const
 {
-    g_autofree gchar *body = snapd_assertion_get_body (SNAPD_ASSERTION (wrapped_object));
-    return body;
+    gsize length;
+    const gchar *body = snapd_assertion_peek_body (SNAPD_ASSERTION (wrapped_object), &length);
+    if (body == NULL)
+        return QString ();
+    return QString::fromUtf8 (body, length);
 }
 
 QString QSnapdAssertion::signature () const
 {
-    g_autofree gchar *signature = snapd_assertion_get_signature (SNAPD_ASSERTION (wrapped_object));
-    return signature;
+    return snapd_assertion_peek_signature (SNAPD_ASSERTION (wrapped_object));
 }
@@ -210,6 +210,21 @@ public:
     SnapdIcon *icon = NULL;
 };
 
+class QSnapdGetIconsRequestPrivate
+{
+public:
+    QSnapdGetIconsRequestPrivate (const QStringList& names, uint maxRequests) :
+        names(names), maxRequests(maxRequests) {}
+    ~QSnapdGetIconsRequestPrivate ()
+    {
+        for (SnapdIcon *icon : icons)
+            g_object_unref (icon);
+    }
+    QStringList names;
+    uint maxRequests;
+    QHash<QString, SnapdIcon*> icons;
+};
+
 class QSnapdGetAssertionsRequestPrivate
 {
 public:
@@ -247,10 +262,13 @@ public:
             g_ptr_array_unref (plugs);
         if (slots_ != NULL)
             g_ptr_array_unref (slots_);
+        if (index != NULL)
+            g_object_unref (index);
     }
     int flags;
     QString snap;
     QString interface;
+    SnapdConnectionIndex *index = NULL;
     GPtrArray *established = NULL;
     GPtrArray *undesired = NULL;
     GPtrArray *plugs = NULL;
@@ -582,14 +600,25 @@ class QSnapdDownloadRequestPrivate
 public:
     QSnapdDownloadRequestPrivate (const QString &name, const QString& channel, const QString& revision) :
         name (name), channel (channel), revision (revision) {}
+    QSnapdDownloadRequestPrivate (const QString &name, const QString& channel, const QString& revision, const QString& resumeToken, qint64 offset, QIODevice *ioDevice) :
+        name (name), channel (channel), revision (revision), resumeToken (resumeToken), offset (offset)
+    {
+        wrapper = (OutputStreamWrapper *) g_object_new (output_stream_wrapper_get_type (), NULL);
+        wrapper->ioDevice = ioDevice;
+    }
     ~QSnapdDownloadRequestPrivate ()
     {
         if (data != NULL)
             g_bytes_unref (data);
+        g_clear_object (&wrapper);
     }
     QString name;
     QString channel;
     QString revision;
+    QString resumeToken;
+    qint64 offset = 0;
+    OutputStreamWrapper *wrapper = NULL;
+    QString newResumeToken;
     GBytes *data = NULL;
 };
 
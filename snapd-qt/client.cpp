@@ -126,6 +126,132 @@ bool QSnapdClient::allowInteraction () const
     return snapd_client_get_allow_interaction (d->client);
 }
 
+void QSnapdClient::setPipelineDepth (uint depth)
+{
+    Q_D(QSnapdClient);
+    snapd_client_set_pipeline_depth (d->client, depth);
+}
+
+uint QSnapdClient::pipelineDepth () const
+{
+    Q_D(const QSnapdClient);
+    return snapd_client_get_pipeline_depth (d->client);
+}
+
+void QSnapdClient::setMaxConnections (uint maxConnections)
+{
+    Q_D(QSnapdClient);
+    snapd_client_set_max_connections (d->client, maxConnections);
+}
+
+uint QSnapdClient::maxConnections () const
+{
+    Q_D(const QSnapdClient);
+    return snapd_client_get_max_connections (d->client);
+}
+
+uint QSnapdClient::nConnections () const
+{
+    Q_D(const QSnapdClient);
+    return snapd_client_get_n_connections (d->client);
+}
+
+bool QSnapdClient::connectionStats (uint index, uint *nPending, quint64 *nRequests, quint64 *nBytesSent, quint64 *nBytesReceived) const
+{
+    Q_D(const QSnapdClient);
+    guint n_pending;
+    guint64 n_requests, n_bytes_sent, n_bytes_received;
+    if (!snapd_client_get_connection_stats (d->client, index, &n_pending, &n_requests, &n_bytes_sent, &n_bytes_received))
+        return false;
+    if (nPending != NULL)
+        *nPending = n_pending;
+    if (nRequests != NULL)
+        *nRequests = n_requests;
+    if (nBytesSent != NULL)
+        *nBytesSent = n_bytes_sent;
+    if (nBytesReceived != NULL)
+        *nBytesReceived = n_bytes_received;
+    return true;
+}
+
+void QSnapdClient::setConnectionIdleTimeout (uint timeout)
+{
+    Q_D(QSnapdClient);
+    snapd_client_set_connection_idle_timeout (d->client, timeout);
+}
+
+uint QSnapdClient::connectionIdleTimeout () const
+{
+    Q_D(const QSnapdClient);
+    return snapd_client_get_connection_idle_timeout (d->client);
+}
+
+void QSnapdClient::setParseInThread (bool parseInThread)
+{
+    Q_D(QSnapdClient);
+    snapd_client_set_parse_in_thread (d->client, parseInThread);
+}
+
+bool QSnapdClient::parseInThread () const
+{
+    Q_D(const QSnapdClient);
+    return snapd_client_get_parse_in_thread (d->client);
+}
+
+void QSnapdClient::setLazySnaps (bool lazySnaps)
+{
+    Q_D(QSnapdClient);
+    snapd_client_set_lazy_snaps (d->client, lazySnaps);
+}
+
+bool QSnapdClient::lazySnaps () const
+{
+    Q_D(const QSnapdClient);
+    return snapd_client_get_lazy_snaps (d->client);
+}
+
+bool QSnapdClient::setResponseCacheTtl (const QString &path, uint ttl)
+{
+    Q_D(QSnapdClient);
+    return snapd_client_set_response_cache_ttl (d->client, path.toStdString ().c_str (), ttl);
+}
+
+uint QSnapdClient::responseCacheTtl (const QString &path) const
+{
+    Q_D(const QSnapdClient);
+    return snapd_client_get_response_cache_ttl (d->client, path.toStdString ().c_str ());
+}
+
+void QSnapdClient::clearResponseCache ()
+{
+    Q_D(QSnapdClient);
+    snapd_client_clear_response_cache (d->client);
+}
+
+void QSnapdClient::setIconCacheSize (quint64 maxSize)
+{
+    Q_D(QSnapdClient);
+    snapd_client_set_icon_cache_size (d->client, maxSize);
+}
+
+quint64 QSnapdClient::iconCacheSize () const
+{
+    Q_D(const QSnapdClient);
+    return snapd_client_get_icon_cache_size (d->client);
+}
+
+void QSnapdClient::setIconCachePath (const QString &path)
+{
+    Q_D(QSnapdClient);
+    snapd_client_set_icon_cache_path (d->client, path.isNull () ? NULL : path.toStdString ().c_str ());
+}
+
+QString QSnapdClient::iconCachePath () const
+{
+    Q_D(const QSnapdClient);
+    return snapd_client_get_icon_cache_path (d->client);
+}
+
 QSnapdMaintenance *QSnapdClient::maintenance () const
 {
     Q_D(const QSnapdClient);
@@ -320,12 +446,27 @@ QSnapdGetAppsRequest *QSnapdClient::getApps ()
 QSnapdGetIconRequest::~QSnapdGetIconRequest ()
 {}
 
+QSnapdGetIconsRequest::~QSnapdGetIconsRequest ()
+{}
+
 QSnapdGetIconRequest *QSnapdClient::getIcon (const QString& name)
 {
     Q_D(QSnapdClient);
     return new QSnapdGetIconRequest (name, d->client);
 }
 
+QSnapdGetIconsRequest *QSnapdClient::getIcons (const QStringList& names)
+{
+    Q_D(QSnapdClient);
+    return new QSnapdGetIconsRequest (names, 0, d->client);
+}
+
+QSnapdGetIconsRequest *QSnapdClient::getIcons (const QStringList& names, uint maxRequests)
+{
+    Q_D(QSnapdClient);
+    return new QSnapdGetIconsRequest (names, maxRequests, d->client);
+}
+
 QSnapdGetAssertionsRequest::~QSnapdGetAssertionsRequest ()
 {}
 
@@ -743,6 +884,18 @@ QSnapdDownloadRequest *QSnapdClient::download (const QString& name, const QStrin
     return new QSnapdDownloadRequest (name, channel, revision, d->client);
 }
 
+QSnapdDownloadRequest *QSnapdClient::download (const QString& name, const QString& channel, const QString& revision, QIODevice *ioDevice)
+{
+    Q_D(QSnapdClient);
+    return new QSnapdDownloadRequest (name, channel, revision, NULL, 0, ioDevice, d->client);
+}
+
+QSnapdDownloadRequest *QSnapdClient::download (const QString& name, const QString& channel, const QString& revision, const QString& resumeToken, qint64 offset, QIODevice *ioDevice)
+{
+    Q_D(QSnapdClient);
+    return new QSnapdDownloadRequest (name, channel, revision, resumeToken, offset, ioDevice, d->client);
+}
+
 QSnapdConnectRequest::QSnapdConnectRequest (void *snapd_client, QObject *parent) :
     QSnapdRequest (snapd_client, parent),
     d_ptr (new QSnapdConnectRequestPrivate()) {}
@@ -1534,6 +1687,67 @@ QSnapdIcon *QSnapdGetIconRequest::icon () const
     return new QSnapdIcon (d->icon);
 }
 
+QSnapdGetIconsRequest::QSnapdGetIconsRequest (const QStringList& names, uint maxRequests, void *snapd_client, QObject *parent) :
+    QSnapdRequest (snapd_client, parent),
+    d_ptr (new QSnapdGetIconsRequestPrivate (names, maxRequests)) {}
+
+static void get_icons_icon_cb (SnapdClient *client, const gchar *name, SnapdIcon *icon, GError *error, gpointer data)
+{
+    QSnapdGetIconsRequest *request = static_cast<QSnapdGetIconsRequest*>(data);
+    if (icon != NULL)
+        request->handleIcon (name, icon);
+}
+
+void QSnapdGetIconsRequest::runSync ()
+{
+    Q_D(QSnapdGetIconsRequest);
+    g_autoptr(GError) error = NULL;
+    g_auto(GStrv) names = string_list_to_strv (d->names);
+    snapd_client_get_icons_sync (SNAPD_CLIENT (getClient ()), names, d->maxRequests, get_icons_icon_cb, this, G_CANCELLABLE (getCancellable ()), &error);
+    finish (error);
+}
+
+void QSnapdGetIconsRequest::handleResult (void *object, void *result)
+{
+    g_autoptr(GError) error = NULL;
+
+    snapd_client_get_icons_finish (SNAPD_CLIENT (object), G_ASYNC_RESULT (result), &error);
+
+    finish (error);
+}
+
+void QSnapdGetIconsRequest::handleIcon (const QString& name, void *icon)
+{
+    Q_D(QSnapdGetIconsRequest);
+    SnapdIcon *old_icon = d->icons.value (name);
+    if (old_icon != NULL)
+        g_object_unref (old_icon);
+    d->icons.insert (name, SNAPD_ICON (g_object_ref (icon)));
+    emit iconReceived (name);
+}
+
+static void get_icons_ready_cb (GObject *object, GAsyncResult *result, gpointer data)
+{
+    QSnapdGetIconsRequest *request = static_cast<QSnapdGetIconsRequest*>(data);
+    request->handleResult (object, result);
+}
+
+void QSnapdGetIconsRequest::runAsync ()
+{
+    Q_D(QSnapdGetIconsRequest);
+    g_auto(GStrv) names = string_list_to_strv (d->names);
+    snapd_client_get_icons_async (SNAPD_CLIENT (getClient ()), names, d->maxRequests, get_icons_icon_cb, this, G_CANCELLABLE (getCancellable ()), get_icons_ready_cb, (gpointer) this);
+}
+
+QSnapdIcon *QSnapdGetIconsRequest::icon (const QString& name) const
+{
+    Q_D(const QSnapdGetIconsRequest);
+    SnapdIcon *icon = d->icons.value (name);
+    if (icon == NULL)
+        return NULL;
+    return new QSnapdIcon (icon);
+}
+
 QSnapdGetAssertionsRequest::QSnapdGetAssertionsRequest (const QString& type, void *snapd_client, QObject *parent) :
     QSnapdRequest (snapd_client, parent),
     d_ptr (new QSnapdGetAssertionsRequestPrivate (type)) {}
@@ -1632,29 +1846,35 @@ QSnapdGetConnectionsRequest::QSnapdGetConnectionsRequest (int flags, const QStri
     QSnapdRequest (snapd_client, parent),
     d_ptr (new QSnapdGetConnectionsRequestPrivate (flags, snap, interface)) {}
 
+static void set_connection_index (QSnapdGetConnectionsRequestPrivate *d, SnapdConnectionIndex *index)
+{
+    if (index == NULL)
+        return;
+
+    d->index = index;
+    d->established = g_ptr_array_ref (snapd_connection_index_get_established (index));
+    d->undesired = g_ptr_array_ref (snapd_connection_index_get_undesired (index));
+    d->plugs = g_ptr_array_ref (snapd_connection_index_get_plugs (index));
+    d->slots_ = g_ptr_array_ref (snapd_connection_index_get_slots (index));
+}
+
 void QSnapdGetConnectionsRequest::runSync ()
 {
     Q_D(QSnapdGetConnectionsRequest);
     g_autoptr(GError) error = NULL;
-    snapd_client_get_connections2_sync (SNAPD_CLIENT (getClient ()), convertGetConnectionsFlags (d->flags), d->snap.isNull () ? NULL : d->snap.toStdString ().c_str (), d->interface.isNull () ? NULL : d->interface.toStdString ().c_str (), &d->established, &d->undesired, &d->plugs, &d->slots_, G_CANCELLABLE (getCancellable ()), &error);
+    SnapdConnectionIndex *index = snapd_client_get_connection_index_sync (SNAPD_CLIENT (getClient ()), convertGetConnectionsFlags (d->flags), d->snap.isNull () ? NULL : d->snap.toStdString ().c_str (), d->interface.isNull () ? NULL : d->interface.toStdString ().c_str (), G_CANCELLABLE (getCancellable ()), &error);
+    set_connection_index (d, index);
     finish (error);
 }
 
 void QSnapdGetConnectionsRequest::handleResult (void *object, void *result)
 {
-    g_autoptr(GPtrArray) established = NULL;
-    g_autoptr(GPtrArray) undesired = NULL;
-    g_autoptr(GPtrArray) plugs = NULL;
-    g_autoptr(GPtrArray) slots_ = NULL;
     g_autoptr(GError) error = NULL;
 
-    snapd_client_get_connections2_finish (SNAPD_CLIENT (object), G_ASYNC_RESULT (result), &established, &undesired, &plugs, &slots_, &error);
+    SnapdConnectionIndex *index = snapd_client_get_connection_index_finish (SNAPD_CLIENT (object), G_ASYNC_RESULT (result), &error);
 
     Q_D(QSnapdGetConnectionsRequest);
-    d->established = (GPtrArray*) g_steal_pointer (&established);
-    d->undesired = (GPtrArray*) g_steal_pointer (&undesired);
-    d->plugs = (GPtrArray*) g_steal_pointer (&plugs);
-    d->slots_ = (GPtrArray*) g_steal_pointer (&slots_);
+    set_connection_index (d, index);
     finish (error);
 }
 
@@ -1667,7 +1887,7 @@ static void get_connections_ready_cb (GObject *object, GAsyncResult *result, gpo
 void QSnapdGetConnectionsRequest::runAsync ()
 {
     Q_D(QSnapdGetConnectionsRequest);
-    snapd_client_get_connections2_async (SNAPD_CLIENT (getClient ()), convertGetConnectionsFlags (d->flags), d->snap.isNull () ? NULL : d->snap.toStdString ().c_str (), d->interface.isNull () ? NULL : d->interface.toStdString ().c_str (), G_CANCELLABLE (getCancellable ()), get_connections_ready_cb, (gpointer) this);
+    snapd_client_get_connection_index_async (SNAPD_CLIENT (getClient ()), convertGetConnectionsFlags (d->flags), d->snap.isNull () ? NULL : d->snap.toStdString ().c_str (), d->interface.isNull () ? NULL : d->interface.toStdString ().c_str (), G_CANCELLABLE (getCancellable ()), get_connections_ready_cb, (gpointer) this);
 }
 
 int QSnapdGetConnectionsRequest::establishedCount () const
@@ -1726,6 +1946,126 @@ QSnapdSlot *QSnapdGetConnectionsRequest::slot (int n) const
     return new QSnapdSlot (d->slots_->pdata[n]);
 }
 
+QSnapdPlug *QSnapdGetConnectionsRequest::findPlug (const QString &snap, const QString &name) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    if (d->index == NULL)
+        return NULL;
+    SnapdPlug *plug = snapd_connection_index_lookup_plug (d->index, snap.toStdString ().c_str (), name.toStdString ().c_str ());
+    return plug != NULL ? new QSnapdPlug (plug) : NULL;
+}
+
+QSnapdSlot *QSnapdGetConnectionsRequest::findSlot (const QString &snap, const QString &name) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    if (d->index == NULL)
+        return NULL;
+    SnapdSlot *slot = snapd_connection_index_lookup_slot (d->index, snap.toStdString ().c_str (), name.toStdString ().c_str ());
+    return slot != NULL ? new QSnapdSlot (slot) : NULL;
+}
+
+int QSnapdGetConnectionsRequest::snapPlugCount (const QString &snap) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    return d->index != NULL ? snapd_connection_index_get_snap_plugs (d->index, snap.toStdString ().c_str ())->len : 0;
+}
+
+QSnapdPlug *QSnapdGetConnectionsRequest::snapPlug (const QString &snap, int n) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    if (d->index == NULL)
+        return NULL;
+    GPtrArray *plugs = snapd_connection_index_get_snap_plugs (d->index, snap.toStdString ().c_str ());
+    if (n < 0 || (guint) n >= plugs->len)
+        return NULL;
+    return new QSnapdPlug (plugs->pdata[n]);
+}
+
+int QSnapdGetConnectionsRequest::snapSlotCount (const QString &snap) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    return d->index != NULL ? snapd_connection_index_get_snap_slots (d->index, snap.toStdString ().c_str ())->len : 0;
+}
+
+QSnapdSlot *QSnapdGetConnectionsRequest::snapSlot (const QString &snap, int n) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    if (d->index == NULL)
+        return NULL;
+    GPtrArray *slots_ = snapd_connection_index_get_snap_slots (d->index, snap.toStdString ().c_str ());
+    if (n < 0 || (guint) n >= slots_->len)
+        return NULL;
+    return new QSnapdSlot (slots_->pdata[n]);
+}
+
+int QSnapdGetConnectionsRequest::interfacePlugCount (const QString &interface) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    return d->index != NULL ? snapd_connection_index_get_interface_plugs (d->index, interface.toStdString ().c_str ())->len : 0;
+}
+
+QSnapdPlug *QSnapdGetConnectionsRequest::interfacePlug (const QString &interface, int n) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    if (d->index == NULL)
+        return NULL;
+    GPtrArray *plugs = snapd_connection_index_get_interface_plugs (d->index, interface.toStdString ().c_str ());
+    if (n < 0 || (guint) n >= plugs->len)
+        return NULL;
+    return new QSnapdPlug (plugs->pdata[n]);
+}
+
+int QSnapdGetConnectionsRequest::interfaceSlotCount (const QString &interface) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    return d->index != NULL ? snapd_connection_index_get_interface_slots (d->index, interface.toStdString ().c_str ())->len : 0;
+}
+
+QSnapdSlot *QSnapdGetConnectionsRequest::interfaceSlot (const QString &interface, int n) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    if (d->index == NULL)
+        return NULL;
+    GPtrArray *slots_ = snapd_connection_index_get_interface_slots (d->index, interface.toStdString ().c_str ());
+    if (n < 0 || (guint) n >= slots_->len)
+        return NULL;
+    return new QSnapdSlot (slots_->pdata[n]);
+}
+
+int QSnapdGetConnectionsRequest::plugConnectionCount (const QString &snap, const QString &name) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    return d->index != NULL ? snapd_connection_index_get_plug_connections (d->index, snap.toStdString ().c_str (), name.toStdString ().c_str ())->len : 0;
+}
+
+QSnapdConnection *QSnapdGetConnectionsRequest::plugConnection (const QString &snap, const QString &name, int n) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    if (d->index == NULL)
+        return NULL;
+    GPtrArray *connections = snapd_connection_index_get_plug_connections (d->index, snap.toStdString ().c_str (), name.toStdString ().c_str ());
+    if (n < 0 || (guint) n >= connections->len)
+        return NULL;
+    return new QSnapdConnection (connections->pdata[n]);
+}
+
+int QSnapdGetConnectionsRequest::slotConnectionCount (const QString &snap, const QString &name) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    return d->index != NULL ? snapd_connection_index_get_slot_connections (d->index, snap.toStdString ().c_str (), name.toStdString ().c_str ())->len : 0;
+}
+
+QSnapdConnection *QSnapdGetConnectionsRequest::slotConnection (const QString &snap, const QString &name, int n) const
+{
+    Q_D(const QSnapdGetConnectionsRequest);
+    if (d->index == NULL)
+        return NULL;
+    GPtrArray *connections = snapd_connection_index_get_slot_connections (d->index, snap.toStdString ().c_str (), name.toStdString ().c_str ());
+    if (n < 0 || (guint) n >= connections->len)
+        return NULL;
+    return new QSnapdConnection (connections->pdata[n]);
+}
+
 QSnapdGetInterfacesRequest::QSnapdGetInterfacesRequest (void *snapd_client, QObject *parent) :
     QSnapdRequest (snapd_client, parent),
     d_ptr (new QSnapdGetInterfacesRequestPrivate ()) {}
@@ -3128,16 +3468,42 @@ QSnapdDownloadRequest::QSnapdDownloadRequest (const QString& name, const QString
     QSnapdRequest (snapd_client, parent),
     d_ptr (new QSnapdDownloadRequestPrivate (name, channel, revision)) {}
 
+QSnapdDownloadRequest::QSnapdDownloadRequest (const QString& name, const QString &channel, const QString &revision, const QString &resumeToken, qint64 offset, QIODevice *ioDevice, void *snapd_client, QObject *parent) :
+    QSnapdRequest (snapd_client, parent),
+    d_ptr (new QSnapdDownloadRequestPrivate (name, channel, revision, resumeToken, offset, ioDevice)) {}
+
+static void download_progress_cb (SnapdClient *client, guint64 n_bytes, guint64 total_bytes, gpointer data)
+{
+    QSnapdDownloadRequest *request = static_cast<QSnapdDownloadRequest*>(data);
+    request->handleDownloadProgress (n_bytes, total_bytes);
+}
+
 void QSnapdDownloadRequest::runSync ()
 {
     Q_D(QSnapdDownloadRequest);
     g_autoptr(GError) error = NULL;
 
-    d->data = snapd_client_download_sync (SNAPD_CLIENT (getClient ()),
-                                          d->name.toStdString ().c_str (),
-                                          d->channel.isNull () ? NULL : d->channel.toStdString ().c_str (),
-                                          d->revision.isNull () ? NULL : d->revision.toStdString ().c_str (),
-                                          G_CANCELLABLE (getCancellable ()), &error);
+    if (d->wrapper != NULL) {
+        g_autofree gchar *resume_token = NULL;
+        snapd_client_download_to_stream_sync (SNAPD_CLIENT (getClient ()),
+                                              d->name.toStdString ().c_str (),
+                                              d->channel.isNull () ? NULL : d->channel.toStdString ().c_str (),
+                                              d->revision.isNull () ? NULL : d->revision.toStdString ().c_str (),
+                                              d->resumeToken.isNull () ? NULL : d->resumeToken.toStdString ().c_str (),
+                                              d->offset,
+                                              G_OUTPUT_STREAM (d->wrapper),
+                                              download_progress_cb, this,
+                                              &resume_token,
+                                              G_CANCELLABLE (getCancellable ()), &error);
+        d->newResumeToken = resume_token;
+    }
+    else {
+        d->data = snapd_client_download_sync (SNAPD_CLIENT (getClient ()),
+                                              d->name.toStdString ().c_str (),
+                                              d->channel.isNull () ? NULL : d->channel.toStdString ().c_str (),
+                                              d->revision.isNull () ? NULL : d->revision.toStdString ().c_str (),
+                                              G_CANCELLABLE (getCancellable ()), &error);
+    }
     finish (error);
 }
 
@@ -3146,11 +3512,22 @@ void QSnapdDownloadRequest::handleResult (void *object, void *result)
     g_autoptr(GError) error = NULL;
     Q_D(QSnapdDownloadRequest);
 
-    d->data = snapd_client_download_finish (SNAPD_CLIENT (object), G_ASYNC_RESULT (result), &error);
+    if (d->wrapper != NULL) {
+        g_autofree gchar *resume_token = NULL;
+        snapd_client_download_to_stream_finish (SNAPD_CLIENT (object), G_ASYNC_RESULT (result), &resume_token, &error);
+        d->newResumeToken = resume_token;
+    }
+    else
+        d->data = snapd_client_download_finish (SNAPD_CLIENT (object), G_ASYNC_RESULT (result), &error);
 
     finish (error);
 }
 
+void QSnapdDownloadRequest::handleDownloadProgress (qint64 bytesReceived, qint64 bytesTotal)
+{
+    emit downloadProgress (bytesReceived, bytesTotal);
+}
+
 static void download_ready_cb (GObject *object, GAsyncResult *result, gpointer data)
 {
     QSnapdDownloadRequest *request = static_cast<QSnapdDownloadRequest*>(data);
@@ -3161,16 +3538,35 @@ void QSnapdDownloadRequest::runAsync ()
 {
     Q_D(QSnapdDownloadRequest);
 
-    snapd_client_download_async (SNAPD_CLIENT (getClient ()),
-                                 d->name.toStdString ().c_str (),
-                                 d->channel.isNull () ? NULL : d->channel.toStdString ().c_str (),
-                                 d->revision.isNull () ? NULL : d->revision.toStdString ().c_str (),
-                                 G_CANCELLABLE (getCancellable ()), download_ready_cb, (gpointer) this);
+    if (d->wrapper != NULL)
+        snapd_client_download_to_stream_async (SNAPD_CLIENT (getClient ()),
+                                               d->name.toStdString ().c_str (),
+                                               d->channel.isNull () ? NULL : d->channel.toStdString ().c_str (),
+                                               d->revision.isNull () ? NULL : d->revision.toStdString ().c_str (),
+                                               d->resumeToken.isNull () ? NULL : d->resumeToken.toStdString ().c_str (),
+                                               d->offset,
+                                               G_OUTPUT_STREAM (d->wrapper),
+                                               download_progress_cb, this,
+                                               G_CANCELLABLE (getCancellable ()), download_ready_cb, (gpointer) this);
+    else
+        snapd_client_download_async (SNAPD_CLIENT (getClient ()),
+                                     d->name.toStdString ().c_str (),
+                                     d->channel.isNull () ? NULL : d->channel.toStdString ().c_str (),
+                                     d->revision.isNull () ? NULL : d->revision.toStdString ().c_str (),
+                                     G_CANCELLABLE (getCancellable ()), download_ready_cb, (gpointer) this);
+}
+
+QString QSnapdDownloadRequest::resumeToken () const
+{
+    Q_D(const QSnapdDownloadRequest);
+    return d->newResumeToken;
 }
 
 QByteArray QSnapdDownloadRequest::data () const
 {
     Q_D(const QSnapdDownloadRequest);
+    if (d->data == NULL)
+        return QByteArray ();
     gsize length;
     gchar *raw_data = (gchar *) g_bytes_get_data (d->data, &length);
     return QByteArray::fromRawData (raw_data, length);
@@ -27,6 +27,7 @@ void SnapdQmlPlugin::registerTypes(const char *uri)
     qmlRegisterUncreatableType<QSnapdListRequest>(uri, 1, 0, "SnapdListRequest", "Can't create");
     qmlRegisterUncreatableType<QSnapdListOneRequest>(uri, 1, 0, "SnapdListOneRequest", "Can't create");
     qmlRegisterUncreatableType<QSnapdGetIconRequest>(uri, 1, 0, "SnapdGetIconRequest", "Can't create");
+    qmlRegisterUncreatableType<QSnapdGetIconsRequest>(uri, 1, 0, "SnapdGetIconsRequest", "Can't create");
     qmlRegisterUncreatableType<QSnapdGetInterfacesRequest>(uri, 1, 0, "SnapdGetInterfacesRequest", "Can't create");
     qmlRegisterUncreatableType<QSnapdConnectInterfaceRequest>(uri, 1, 0, "SnapdConnectInterfaceRequest", "Can't create");
     qmlRegisterUncreatableType<QSnapdDisconnectInterfaceRequest>(uri, 1, 0, "SnapdDisconnectInterfaceRequest", "Can't create");
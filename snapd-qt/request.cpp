@@ -166,6 +166,9 @@ void QSnapdRequest::finish (void *error)
             case SNAPD_ERROR_OPTION_NOT_FOUND:
                 d->error = QSnapdRequest::QSnapdError::OptionNotFound;
                 break;
+            case SNAPD_ERROR_QUEUE_FULL:
+                d->error = QSnapdRequest::QSnapdError::QueueFull;
+                break;
             default:
                 /* This indicates we should add a new entry here... */
                 d->error = QSnapdRequest::QSnapdError::UnknownError;
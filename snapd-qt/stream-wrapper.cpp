@@ -55,3 +55,37 @@ stream_wrapper_class_init (StreamWrapperClass *klass)
     input_stream_class->read_fn = stream_wrapper_read_fn;
     input_stream_class->close_fn = stream_wrapper_close_fn;
 }
+
+G_DEFINE_TYPE (OutputStreamWrapper, output_stream_wrapper, G_TYPE_OUTPUT_STREAM)
+
+static gssize
+output_stream_wrapper_write_fn (GOutputStream *stream, const void *buffer, gsize count, GCancellable *cancellable, GError **error)
+{
+    OutputStreamWrapper *wrapper = SNAPD_OUTPUT_STREAM_WRAPPER (stream);
+    qint64 nWritten;
+
+    if (wrapper->ioDevice == NULL) {
+        g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_CLOSED, "Device has been destroyed");
+        return -1;
+    }
+
+    nWritten = wrapper->ioDevice->write ((const char *) buffer, count);
+    if (nWritten >= 0)
+        return nWritten;
+
+    g_set_error_literal (error, G_FILE_ERROR, G_FILE_ERROR_FAILED, wrapper->ioDevice->errorString ().toStdString ().c_str ());
+    return -1;
+}
+
+static void
+output_stream_wrapper_init (OutputStreamWrapper *wrapper)
+{
+}
+
+static void
+output_stream_wrapper_class_init (OutputStreamWrapperClass *klass)
+{
+    GOutputStreamClass *output_stream_class = G_OUTPUT_STREAM_CLASS (klass);
+
+    output_stream_class->write_fn = output_stream_wrapper_write_fn;
+}
@@ -31,6 +31,19 @@ struct _StreamWrapperClass
     GInputStreamClass parent_class;
 };
 
+G_DECLARE_FINAL_TYPE (OutputStreamWrapper, output_stream_wrapper, SNAPD, OUTPUT_STREAM_WRAPPER, GOutputStream)
+
+struct _OutputStreamWrapper
+{
+    GOutputStream parent_instance;
+    QPointer<QIODevice> ioDevice;
+};
+
+struct _OutputStreamWrapperClass
+{
+    GOutputStreamClass parent_class;
+};
+
 G_END_DECLS
 
 #endif
@@ -0,0 +1,416 @@
+/*
+ * Copyright (C) 2017 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#include <string.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#if __GLIBC_PREREQ(2, 33)
+#define HAVE_MALLINFO2 1
+#endif
+#endif
+#include <snapd-glib/snapd-glib.h>
+
+#include "mock-snapd.h"
+#include "snapd-json.h"
+
+/* Number of synchronous calls each thread makes */
+#define N_SYNC_CALLS 1000
+
+/* Number of descriptions parsed, as when showing a large set of search results */
+#define N_MARKDOWN_DESCRIPTIONS 2000
+
+/* Number of snaps returned, as when searching the store */
+#define N_SNAPS 2000
+
+/* Number of assertions read, as when listing the assertions of a large system */
+#define N_ASSERTIONS 50000
+
+static gpointer
+sync_thread_cb (gpointer user_data)
+{
+    SnapdClient *client = user_data;
+
+    for (int i = 0; i < N_SYNC_CALLS; i++) {
+        g_autoptr(GError) error = NULL;
+        g_autoptr(SnapdSystemInformation) info = snapd_client_get_system_information_sync (client, NULL, &error);
+        g_assert_no_error (error);
+        g_assert_nonnull (info);
+    }
+
+    return NULL;
+}
+
+static void
+benchmark_sync_threads (gconstpointer user_data)
+{
+    guint n_threads = GPOINTER_TO_UINT (user_data);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+    snapd_client_set_max_connections (client, 0);
+
+    g_autoptr(GPtrArray) threads = g_ptr_array_new ();
+    g_test_timer_start ();
+    for (guint i = 0; i < n_threads; i++)
+        g_ptr_array_add (threads, g_thread_new ("sync-thread", sync_thread_cb, client));
+    for (guint i = 0; i < threads->len; i++)
+        g_thread_join (g_ptr_array_index (threads, i));
+    gdouble elapsed = g_test_timer_elapsed ();
+
+    g_test_maximized_result (n_threads * N_SYNC_CALLS / elapsed,
+                             "%u threads: %.0f synchronous calls/s", n_threads, n_threads * N_SYNC_CALLS / elapsed);
+}
+
+static const gchar *markdown_description =
+    "This snap provides a *fast* and __simple__ way to run `example` on your system.\n"
+    "See https://example.com/docs for more details.\n"
+    "\n"
+    "Features:\n"
+    "- Runs on **all** supported architectures\n"
+    "  - including armhf and arm64\n"
+    "    - and s390x, when installed with `--classic`\n"
+    "- Automatic updates\n"
+    "\n"
+    "    $ example --help\n"
+    "    $ example run\n"
+    "\n"
+    "Report bugs at https://bugs.example.com/ or contact mailto:dev@example.com.\n";
+
+static const gchar *markdown_nested_list =
+    "- 1\n"
+    "  - 2\n"
+    "    - 3\n"
+    "      - 4\n"
+    "        - 5\n"
+    "          - 6\n"
+    "            - 7\n"
+    "              - 8\n"
+    "                - 9\n"
+    "                  - 10\n"
+    "                    - 11\n"
+    "                      - 12\n"
+    "                        - 13\n"
+    "                          - 14\n"
+    "                            - 15\n"
+    "                              - 16\n";
+
+static void
+benchmark_markdown (gconstpointer user_data)
+{
+    const gchar *text = user_data;
+
+    g_autoptr(SnapdMarkdownParser) parser = snapd_markdown_parser_new (SNAPD_MARKDOWN_VERSION_0);
+
+    g_test_timer_start ();
+    for (int i = 0; i < N_MARKDOWN_DESCRIPTIONS; i++) {
+        g_autoptr(GPtrArray) nodes = snapd_markdown_parser_parse (parser, text);
+        g_assert_cmpint (nodes->len, >, 0);
+    }
+    gdouble elapsed = g_test_timer_elapsed ();
+
+    gdouble n_bytes = (gdouble) N_MARKDOWN_DESCRIPTIONS * strlen (text);
+    g_test_maximized_result (n_bytes / elapsed,
+                             "%.0f descriptions/s (%.1f MB/s)", N_MARKDOWN_DESCRIPTIONS / elapsed, n_bytes / elapsed / 1000000);
+}
+
+static void
+benchmark_find_json (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    for (int i = 0; i < N_SNAPS; i++) {
+        g_autofree gchar *name = g_strdup_printf ("snap%d", i);
+        MockSnap *s = mock_snapd_add_store_snap (snapd, name);
+        mock_snap_set_title (s, "Title with \"quotes\" and \u00e9");
+        mock_snap_set_summary (s, "SUMMARY");
+        mock_snap_set_description (s, "A long description\nover several lines\n\twith tabs and escaped characters /\\");
+        mock_snap_set_contact (s, "CONTACT");
+        mock_snap_set_website (s, "WEBSITE");
+        mock_snap_set_license (s, "GPL-3.0");
+        mock_snap_set_download_size (s, 1024 * i);
+        mock_snap_set_publisher_display_name (s, "PUBLISHER-DISPLAY-NAME");
+        mock_snap_add_price (s, 1.25, "NZD");
+        mock_snap_add_media (s, "icon", "icon.png", 128, 128);
+        mock_snap_add_media (s, "screenshot", "screenshot.png", 1024, 768);
+        mock_track_add_channel (mock_snap_add_track (s, "latest"), "stable", NULL);
+        mock_snap_add_app (s, "app");
+    }
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_test_timer_start ();
+    g_autoptr(GPtrArray) snaps = snapd_client_find_sync (client, SNAPD_FIND_FLAGS_NONE, "snap", NULL, NULL, &error);
+    gdouble elapsed = g_test_timer_elapsed ();
+    g_assert_no_error (error);
+    g_assert_cmpint (snaps->len, ==, N_SNAPS);
+
+    g_test_minimized_result (elapsed, "%.3fs to find %u snaps", elapsed, snaps->len);
+}
+
+/* Make a find response with the same snaps as benchmark_find_json () */
+static GString *
+make_find_response (void)
+{
+    GString *response = g_string_new ("{\"type\":\"sync\",\"status-code\":200,\"status\":\"OK\",\"result\":[");
+    for (int i = 0; i < N_SNAPS; i++) {
+        if (i != 0)
+            g_string_append_c (response, ',');
+        g_string_append_printf (response,
+                                "{\"apps\":[{\"name\":\"app\",\"snap\":\"snap%d\"}],"
+                                "\"channels\":{\"latest/stable\":{\"channel\":\"stable\",\"confinement\":\"strict\",\"epoch\":\"0\",\"revision\":\"REVISION\",\"size\":65535,\"version\":\"VERSION\"}},"
+                                "\"confinement\":\"strict\",\"contact\":\"CONTACT\",\"description\":\"A long description\\nover several lines\\n\\twith tabs and escaped characters /\\\\\","
+                                "\"developer\":\"PUBLISHER-USERNAME\",\"devmode\":false,\"download-size\":%d,\"id\":\"ID\",\"jailmode\":false,\"license\":\"GPL-3.0\","
+                                "\"media\":[{\"type\":\"icon\",\"url\":\"icon.png\",\"width\":128,\"height\":128},{\"type\":\"screenshot\",\"url\":\"screenshot.png\",\"width\":1024,\"height\":768}],"
+                                "\"name\":\"snap%d\",\"prices\":{\"NZD\":1.25},\"private\":false,"
+                                "\"publisher\":{\"display-name\":\"PUBLISHER-DISPLAY-NAME\",\"id\":\"PUBLISHER-ID\",\"username\":\"PUBLISHER-USERNAME\",\"validation\":\"unproven\"},"
+                                "\"resource\":\"/v2/snaps/snap%d\",\"revision\":\"REVISION\",\"status\":\"available\",\"summary\":\"SUMMARY\","
+                                "\"title\":\"Title with \\\"quotes\\\" and \\u00e9\",\"tracks\":[\"latest\"],\"type\":\"app\",\"version\":\"VERSION\",\"website\":\"WEBSITE\"}",
+                                i, 1024 * i, i, i);
+    }
+    g_string_append (response, "],\"sources\":[\"store\"],\"suggested-currency\":\"NZD\"}");
+
+    return response;
+}
+
+typedef struct
+{
+    SnapdJsonParser parser;
+    SnapdStringPool *pool;
+    GPtrArray *snaps;
+} ParseSnapsData;
+
+static gboolean
+parse_snap_cb (const gchar *data, gsize length, gpointer user_data, GError **error)
+{
+    ParseSnapsData *d = user_data;
+
+    SnapdSnap *snap = _snapd_json_parse_snap_data (data, length, d->pool, FALSE, d->parser, error);
+    if (snap == NULL)
+        return FALSE;
+    g_ptr_array_add (d->snaps, snap);
+
+    return TRUE;
+}
+
+static gdouble
+time_parse_snaps (GString *response, SnapdJsonParser parser)
+{
+    g_autoptr(SnapdStringPool) pool = _snapd_string_pool_new ();
+    g_autoptr(GPtrArray) snaps = g_ptr_array_new_with_free_func (g_object_unref);
+    ParseSnapsData data = { parser, pool, snaps };
+
+    g_test_timer_start ();
+    g_autoptr(SnapdJsonStream) stream = _snapd_json_stream_new ("result", parse_snap_cb, &data);
+    g_autoptr(GError) error = NULL;
+    g_assert_true (_snapd_json_stream_feed (stream, response->str, response->len, &error));
+    gdouble elapsed = g_test_timer_elapsed ();
+    g_assert_no_error (error);
+    g_assert_cmpint (snaps->len, ==, N_SNAPS);
+
+    return elapsed;
+}
+
+static void
+benchmark_find_parsers (void)
+{
+    g_autoptr(GString) response = make_find_response ();
+
+    gdouble json_glib_time = time_parse_snaps (response, SNAPD_JSON_PARSER_JSON_GLIB);
+    gdouble tokenizer_time = time_parse_snaps (response, SNAPD_JSON_PARSER_TOKENIZER);
+
+    g_test_message ("json-glib parsed %d snaps in %.3fs", N_SNAPS, json_glib_time);
+    g_test_message ("Tokenizer parsed %d snaps in %.3fs", N_SNAPS, tokenizer_time);
+    g_test_minimized_result (tokenizer_time, "%.3fs to parse %d snaps (json-glib %.3fs)", tokenizer_time, N_SNAPS, json_glib_time);
+}
+
+static GPtrArray *
+measure_snaps (SnapdClient *client, gboolean find, gdouble *elapsed, gsize *allocated)
+{
+#ifdef HAVE_MALLINFO2
+    gsize start = mallinfo2 ().uordblks;
+#endif
+    g_test_timer_start ();
+    g_autoptr(GError) error = NULL;
+    g_autoptr(GPtrArray) snaps = NULL;
+    if (find)
+        snaps = snapd_client_find_sync (client, SNAPD_FIND_FLAGS_NONE, "snap", NULL, NULL, &error);
+    else
+        snaps = snapd_client_get_snaps_sync (client, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, NULL, &error);
+    *elapsed = g_test_timer_elapsed ();
+    g_assert_no_error (error);
+    g_assert_nonnull (snaps);
+#ifdef HAVE_MALLINFO2
+    gsize end = mallinfo2 ().uordblks;
+    *allocated = end > start ? end - start : 0;
+#else
+    *allocated = 0;
+#endif
+
+    return g_steal_pointer (&snaps);
+}
+
+#ifdef HAVE_MALLINFO2
+/* Get the heap used by the snaps in @response, the pool is freed after parsing as in the library */
+static gsize
+measure_parsed_snaps (GString *response, gboolean use_pool, GPtrArray *snaps)
+{
+    gsize start = mallinfo2 ().uordblks;
+    {
+        g_autoptr(SnapdStringPool) pool = use_pool ? _snapd_string_pool_new () : NULL;
+        ParseSnapsData data = { SNAPD_JSON_PARSER_TOKENIZER, pool, snaps };
+        g_autoptr(SnapdJsonStream) stream = _snapd_json_stream_new ("result", parse_snap_cb, &data);
+        g_autoptr(GError) error = NULL;
+        g_assert_true (_snapd_json_stream_feed (stream, response->str, response->len, &error));
+        g_assert_no_error (error);
+    }
+    gsize end = mallinfo2 ().uordblks;
+    g_assert_cmpint (snaps->len, ==, N_SNAPS);
+
+    return end > start ? end - start : 0;
+}
+#endif
+
+static void
+benchmark_find_memory (void)
+{
+#ifdef HAVE_MALLINFO2
+    g_autoptr(GString) response = make_find_response ();
+
+    g_autoptr(GPtrArray) unpooled_snaps = g_ptr_array_new_with_free_func (g_object_unref);
+    gdouble unpooled_size = (gdouble) measure_parsed_snaps (response, FALSE, unpooled_snaps) / N_SNAPS;
+    g_autoptr(GPtrArray) pooled_snaps = g_ptr_array_new_with_free_func (g_object_unref);
+    gdouble pooled_size = (gdouble) measure_parsed_snaps (response, TRUE, pooled_snaps) / N_SNAPS;
+
+    g_test_message ("Without string pool: %.0f bytes per snap", unpooled_size);
+    g_test_message ("With string pool: %.0f bytes per snap", pooled_size);
+    g_test_minimized_result (pooled_size, "%.0f bytes per snap (%.0f without string pool)", pooled_size, unpooled_size);
+#else
+    g_test_skip ("Heap statistics not available");
+#endif
+}
+
+static void
+benchmark_lazy_snaps (gconstpointer user_data)
+{
+    gboolean find = GPOINTER_TO_INT (user_data);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    for (int i = 0; i < N_SNAPS; i++) {
+        g_autofree gchar *name = g_strdup_printf ("snap%d", i);
+        MockSnap *s = find ? mock_snapd_add_store_snap (snapd, name) : mock_snapd_add_snap (snapd, name);
+        mock_snap_set_summary (s, "SUMMARY");
+        mock_snap_set_description (s, "DESCRIPTION");
+        mock_snap_add_price (s, 1.25, "NZD");
+        mock_snap_add_media (s, "icon", "icon.png", 128, 128);
+        mock_snap_add_media (s, "screenshot", "screenshot.png", 1024, 768);
+        MockTrack *t = mock_snap_add_track (s, "latest");
+        mock_track_add_channel (t, "stable", NULL);
+        mock_track_add_channel (t, "beta", NULL);
+        mock_snap_add_app (s, "app1");
+        mock_snap_add_app (s, "app2");
+    }
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    /* Warm up the connection so its buffers aren't counted */
+    gdouble elapsed;
+    gsize allocated;
+    g_autoptr(GPtrArray) warm_snaps = measure_snaps (client, find, &elapsed, &allocated);
+    g_clear_pointer (&warm_snaps, g_ptr_array_unref);
+
+    gdouble eager_time;
+    gsize eager_size;
+    g_autoptr(GPtrArray) eager_snaps = measure_snaps (client, find, &eager_time, &eager_size);
+    g_clear_pointer (&eager_snaps, g_ptr_array_unref);
+
+    snapd_client_set_lazy_snaps (client, TRUE);
+    gdouble lazy_time;
+    gsize lazy_size;
+    g_autoptr(GPtrArray) lazy_snaps = measure_snaps (client, find, &lazy_time, &lazy_size);
+    g_assert_cmpint (lazy_snaps->len, ==, N_SNAPS);
+
+    /* Using the details costs the same as parsing them up front */
+    g_test_timer_start ();
+    for (guint i = 0; i < lazy_snaps->len; i++)
+        g_assert_cmpint (snapd_snap_get_apps (lazy_snaps->pdata[i])->len, ==, 2);
+    gdouble materialize_time = g_test_timer_elapsed ();
+
+    g_test_message ("eager %.3fs, %zu bytes; lazy %.3fs, %zu bytes, %.3fs to use details",
+                    eager_time, eager_size, lazy_time, lazy_size, materialize_time);
+    g_test_minimized_result (lazy_time, "%.3fs to parse %u snaps lazily", lazy_time, lazy_snaps->len);
+}
+
+static void
+benchmark_assertion_headers (void)
+{
+    g_autoptr(GPtrArray) contents = g_ptr_array_new_with_free_func (g_free);
+    for (int i = 0; i < N_ASSERTIONS; i++) {
+        g_autoptr(GString) content = g_string_new ("type: snap-revision\n"
+                                                   "authority-id: canonical\n");
+        for (int j = 0; j < 15; j++)
+            g_string_append_printf (content, "header%d: value%d-%d\n", j, j, i);
+        g_string_append (content, "body-length: 4\n"
+                                  "sign-key-sha3-384: KEY\n"
+                                  "\n"
+                                  "BODY\n"
+                                  "\n"
+                                  "SIGNATURE");
+        g_ptr_array_add (contents, g_string_free (g_steal_pointer (&content), FALSE));
+    }
+
+    g_test_timer_start ();
+    gsize total_length = 0;
+    for (guint i = 0; i < contents->len; i++) {
+        g_autoptr(SnapdAssertion) assertion = snapd_assertion_new (contents->pdata[i]);
+        for (int j = 0; j < 15; j++) {
+            g_autofree gchar *name = g_strdup_printf ("header%d", j);
+            const gchar *value = snapd_assertion_peek_header (assertion, name);
+            g_assert_nonnull (value);
+            total_length += strlen (value);
+        }
+        g_assert_cmpstr (snapd_assertion_peek_body (assertion, NULL), ==, "BODY");
+        g_assert_cmpstr (snapd_assertion_peek_signature (assertion), ==, "SIGNATURE");
+    }
+    gdouble elapsed = g_test_timer_elapsed ();
+    g_assert_cmpint (total_length, >, 0);
+
+    g_test_maximized_result (contents->len / elapsed, "%.0f assertions/s reading 15 headers", contents->len / elapsed);
+}
+
+int
+main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_data_func ("/sync/threads-1", GUINT_TO_POINTER (1), benchmark_sync_threads);
+    g_test_add_data_func ("/sync/threads-4", GUINT_TO_POINTER (4), benchmark_sync_threads);
+    g_test_add_data_func ("/sync/threads-16", GUINT_TO_POINTER (16), benchmark_sync_threads);
+    g_test_add_data_func ("/markdown/description", markdown_description, benchmark_markdown);
+    g_test_add_data_func ("/markdown/nested-list", markdown_nested_list, benchmark_markdown);
+    g_test_add_func ("/find/json", benchmark_find_json);
+    g_test_add_func ("/find/parsers", benchmark_find_parsers);
+    g_test_add_func ("/find/memory", benchmark_find_memory);
+    g_test_add_data_func ("/lazy-snaps/get-snaps", GINT_TO_POINTER (FALSE), benchmark_lazy_snaps);
+    g_test_add_data_func ("/lazy-snaps/find", GINT_TO_POINTER (TRUE), benchmark_lazy_snaps);
+    g_test_add_func ("/assertions/headers", benchmark_assertion_headers);
+
+    return g_test_run ();
+}
@@ -35,6 +35,7 @@ struct _MockSnapd
     gchar *dir_path;
     gchar *socket_path;
     gboolean close_on_request;
+    guint response_delay;
     gboolean decline_auth;
     GList *accounts;
     GList *users;
@@ -65,6 +66,9 @@ struct _MockSnapd
     gchar *spawn_time;
     gchar *ready_time;
     SoupMessageHeaders *last_request_headers;
+    GHashTable *request_counts;
+    guint n_held_requests;
+    guint max_held_requests;
 };
 
 G_DEFINE_TYPE (MockSnapd, mock_snapd, G_TYPE_OBJECT)
@@ -114,6 +118,7 @@ struct _MockChange
     int task_index;
     GList *tasks;
     JsonNode *data;
+    gboolean added_by_test;
 };
 
 struct _MockChannel
@@ -405,6 +410,16 @@ mock_snapd_set_close_on_request (MockSnapd *self, gboolean close_on_request)
     self->close_on_request = close_on_request;
 }
 
+/* Hold each response for @delay milliseconds before sending it */
+void
+mock_snapd_set_response_delay (MockSnapd *self, guint delay)
+{
+    g_return_if_fail (MOCK_IS_SNAPD (self));
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
+    self->response_delay = delay;
+}
+
 void
 mock_snapd_set_decline_auth (MockSnapd *self, gboolean decline_auth)
 {
@@ -736,7 +751,10 @@ mock_snapd_add_change (MockSnapd *self)
 
     g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
 
-    return add_change (self);
+    MockChange *change = add_change (self);
+    change->added_by_test = TRUE;
+
+    return change;
 }
 
 MockTask *
@@ -1773,6 +1791,27 @@ mock_snapd_get_last_allow_interaction (MockSnapd *self)
     return soup_message_headers_get_one (self->last_request_headers, "X-Allow-Interaction");
 }
 
+guint
+mock_snapd_get_n_requests (MockSnapd *self, const gchar *path)
+{
+    g_return_val_if_fail (MOCK_IS_SNAPD (self), 0);
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
+
+    return GPOINTER_TO_UINT (g_hash_table_lookup (self->request_counts, path));
+}
+
+/* Get the most requests that have been received and not responded to at the same time */
+guint
+mock_snapd_get_max_held_requests (MockSnapd *self)
+{
+    g_return_val_if_fail (MOCK_IS_SNAPD (self), 0);
+
+    g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&self->mutex);
+
+    return self->max_held_requests;
+}
+
 static MockChange *
 get_change (MockSnapd *self, const gchar *id)
 {
@@ -3074,30 +3113,101 @@ handle_icon (MockSnapd *self, SoupMessage *message, const gchar *path)
                        g_bytes_get_size (snap->icon_data));
 }
 
+static gboolean
+assertion_has_header (const gchar *assertion, const gchar *name, const gchar *value)
+{
+    g_autofree gchar *header = g_strdup_printf ("%s: %s\n", name, value);
+
+    /* Check each line until the end of the headers */
+    const gchar *line = assertion;
+    while (line != NULL && *line != '\n' && *line != '\0') {
+        if (g_str_has_prefix (line, header))
+            return TRUE;
+        line = strchr (line, '\n');
+        if (line != NULL)
+            line++;
+    }
+
+    return FALSE;
+}
+
+static gboolean
+filter_assertion (const gchar *assertion, GHashTable *query)
+{
+    if (query == NULL)
+        return TRUE;
+
+    GHashTableIter iter;
+    gpointer name, value;
+    g_hash_table_iter_init (&iter, query);
+    while (g_hash_table_iter_next (&iter, &name, &value)) {
+        if (strcmp (name, "json") == 0)
+            continue;
+        if (!assertion_has_header (assertion, name, value))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
 static void
-handle_assertions (MockSnapd *self, SoupMessage *message, const gchar *type)
+add_assertion_headers (JsonBuilder *builder, const gchar *assertion)
+{
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "headers");
+    json_builder_begin_object (builder);
+    g_auto(GStrv) lines = g_strsplit (assertion, "\n", -1);
+    for (int i = 0; lines[i] != NULL && lines[i][0] != '\0'; i++) {
+        const gchar *divider = strstr (lines[i], ": ");
+        if (lines[i][0] == ' ' || divider == NULL)
+            continue;
+        g_autofree gchar *name = g_strndup (lines[i], divider - lines[i]);
+        json_builder_set_member_name (builder, name);
+        json_builder_add_string_value (builder, divider + 2);
+    }
+    json_builder_end_object (builder);
+    json_builder_end_object (builder);
+}
+
+static void
+handle_assertions (MockSnapd *self, SoupMessage *message, const gchar *type, GHashTable *query)
 {
     if (strcmp (message->method, "GET") == 0) {
         g_autoptr(GString) response_content = g_string_new (NULL);
+        g_autoptr(JsonBuilder) builder = json_builder_new ();
+        gboolean headers_only = query != NULL && g_strcmp0 (g_hash_table_lookup (query, "json"), "headers") == 0;
         g_autofree gchar *type_header = g_strdup_printf ("type: %s\n", type);
         int count = 0;
+        json_builder_begin_array (builder);
         for (GList *link = self->assertions; link; link = link->next) {
             const gchar *assertion = link->data;
 
             if (!g_str_has_prefix (assertion, type_header))
                 continue;
+            if (!filter_assertion (assertion, query))
+                continue;
 
             count++;
+            if (headers_only) {
+                add_assertion_headers (builder, assertion);
+                continue;
+            }
             if (count != 1)
                 g_string_append (response_content, "\n\n");
             g_string_append (response_content, assertion);
         }
+        json_builder_end_array (builder);
 
         if (count == 0) {
             send_error_bad_request (self, message, "invalid assert type", NULL);
             return;
         }
 
+        if (headers_only) {
+            send_sync_response (self, message, 200, json_builder_get_root (builder), NULL);
+            return;
+        }
+
         // FIXME: X-Ubuntu-Assertions-Count header
         send_response (message, 200, "application/x.ubuntu.assertion; bundle=y", (guint8*) response_content->str, response_content->len);
     }
@@ -3812,38 +3922,6 @@ change_relates_to_snap (MockChange *change, const gchar *snap_name)
     return FALSE;
 }
 
-static void
-handle_changes (MockSnapd *self, SoupMessage *message, GHashTable *query)
-{
-    if (strcmp (message->method, "GET") != 0) {
-        send_error_method_not_allowed (self, message, "method not allowed");
-        return;
-    }
-
-    const gchar *select_param = g_hash_table_lookup (query, "select");
-    if (select_param == NULL)
-        select_param = "in-progress";
-    const gchar *for_param = g_hash_table_lookup (query, "for");
-
-    g_autoptr(JsonBuilder) builder = json_builder_new ();
-    json_builder_begin_array (builder);
-    for (GList *link = self->changes; link; link = link->next) {
-        MockChange *change = link->data;
-
-        if (g_strcmp0 (select_param, "in-progress") == 0 && change_get_ready (change))
-            continue;
-        if (g_strcmp0 (select_param, "ready") == 0 && !change_get_ready (change))
-            continue;
-        if (for_param != NULL && !change_relates_to_snap (change, for_param))
-            continue;
-
-        json_builder_add_value (builder, make_change_node (change));
-    }
-    json_builder_end_array (builder);
-
-    send_sync_response (self, message, 200, json_builder_get_root (builder), NULL);
-}
-
 static void
 mock_task_complete (MockSnapd *self, MockTask *task)
 {
@@ -3882,6 +3960,42 @@ mock_change_progress (MockSnapd *self, MockChange *change)
     }
 }
 
+static void
+handle_changes (MockSnapd *self, SoupMessage *message, GHashTable *query)
+{
+    if (strcmp (message->method, "GET") != 0) {
+        send_error_method_not_allowed (self, message, "method not allowed");
+        return;
+    }
+
+    const gchar *select_param = g_hash_table_lookup (query, "select");
+    if (select_param == NULL)
+        select_param = "in-progress";
+    const gchar *for_param = g_hash_table_lookup (query, "for");
+
+    g_autoptr(JsonBuilder) builder = json_builder_new ();
+    json_builder_begin_array (builder);
+    for (GList *link = self->changes; link; link = link->next) {
+        MockChange *change = link->data;
+
+        /* Changes started by requests progress each time they are checked */
+        if (g_strcmp0 (select_param, "in-progress") == 0 && !change->added_by_test)
+            mock_change_progress (self, change);
+
+        if (g_strcmp0 (select_param, "in-progress") == 0 && change_get_ready (change))
+            continue;
+        if (g_strcmp0 (select_param, "ready") == 0 && !change_get_ready (change))
+            continue;
+        if (for_param != NULL && !change_relates_to_snap (change, for_param))
+            continue;
+
+        json_builder_add_value (builder, make_change_node (change));
+    }
+    json_builder_end_array (builder);
+
+    send_sync_response (self, message, 200, json_builder_get_root (builder), NULL);
+}
+
 static void
 handle_change (MockSnapd *self, SoupMessage *message, const gchar *change_id)
 {
@@ -4512,9 +4626,58 @@ handle_download (MockSnapd *self, SoupMessage *message)
     if (revision != NULL)
         g_string_append_printf (contents, ":revision=%s", revision);
 
+    /* Downloads can be resumed by passing back the token and the range still required */
+    g_autofree gchar *download_token = g_strdup_printf ("TOKEN:%s", snap_name);
+    soup_message_headers_replace (message->response_headers, "Snap-Download-Token", download_token);
+    const gchar *resume_token = NULL;
+    if (json_object_has_member (o, "resume-token"))
+        resume_token = json_object_get_string_member (o, "resume-token");
+    SoupRange *ranges = NULL;
+    int n_ranges;
+    if (resume_token != NULL && soup_message_headers_get_ranges (message->request_headers, contents->len, &ranges, &n_ranges)) {
+        goffset start = ranges[0].start, end = ranges[0].end;
+        soup_message_headers_free_ranges (message->request_headers, ranges);
+        if (strcmp (resume_token, download_token) != 0) {
+            send_error_bad_request (self, message, "invalid resume token", NULL);
+            return;
+        }
+        soup_message_headers_set_content_range (message->response_headers, start, end, contents->len);
+        send_response (message, 206, "application/octet-stream", (const guint8 *) contents->str + start, end - start + 1);
+        return;
+    }
+
     send_response (message, 200, "application/octet-stream", (const guint8 *) contents->str, contents->len);
 }
 
+typedef struct
+{
+    MockSnapd *snapd;
+    SoupServer *server;
+    SoupMessage *message;
+} HeldResponse;
+
+static void
+held_response_free (HeldResponse *held)
+{
+    g_object_unref (held->server);
+    g_object_unref (held->message);
+    g_slice_free (HeldResponse, held);
+}
+
+static gboolean
+release_response_cb (gpointer user_data)
+{
+    HeldResponse *held = user_data;
+
+    {
+        g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&held->snapd->mutex);
+        held->snapd->n_held_requests--;
+    }
+    soup_server_unpause_message (held->server, held->message);
+
+    return G_SOURCE_REMOVE;
+}
+
 static void
 handle_request (SoupServer        *server,
                 SoupMessage       *message,
@@ -4538,6 +4701,24 @@ handle_request (SoupServer        *server,
     g_clear_pointer (&self->last_request_headers, soup_message_headers_free);
     self->last_request_headers = g_boxed_copy (SOUP_TYPE_MESSAGE_HEADERS, message->request_headers);
 
+    guint n_requests = GPOINTER_TO_UINT (g_hash_table_lookup (self->request_counts, path));
+    g_hash_table_insert (self->request_counts, g_strdup (path), GUINT_TO_POINTER (n_requests + 1));
+
+    self->n_held_requests++;
+    self->max_held_requests = MAX (self->max_held_requests, self->n_held_requests);
+    if (self->response_delay > 0) {
+        HeldResponse *held = g_slice_new0 (HeldResponse);
+        held->snapd = self;
+        held->server = g_object_ref (server);
+        held->message = g_object_ref (message);
+        soup_server_pause_message (server, message);
+        g_autoptr(GSource) source = g_timeout_source_new (self->response_delay);
+        g_source_set_callback (source, release_response_cb, held, (GDestroyNotify) held_response_free);
+        g_source_attach (source, self->context);
+    }
+    else
+        self->n_held_requests--;
+
     if (strcmp (path, "/v2/system-info") == 0)
         handle_system_info (self, message);
     else if (strcmp (path, "/v2/login") == 0)
@@ -4559,9 +4740,9 @@ handle_request (SoupServer        *server,
     else if (g_str_has_prefix (path, "/v2/icons/"))
         handle_icon (self, message, path + strlen ("/v2/icons/"));
     else if (strcmp (path, "/v2/assertions") == 0)
-        handle_assertions (self, message, NULL);
+        handle_assertions (self, message, NULL, query);
     else if (g_str_has_prefix (path, "/v2/assertions/"))
-        handle_assertions (self, message, path + strlen ("/v2/assertions/"));
+        handle_assertions (self, message, path + strlen ("/v2/assertions/"), query);
     else if (strcmp (path, "/v2/interfaces") == 0)
         handle_interfaces (self, message, query);
     else if (strcmp (path, "/v2/connections") == 0)
@@ -4652,6 +4833,7 @@ mock_snapd_finalize (GObject *object)
     g_clear_pointer (&self->spawn_time, g_free);
     g_clear_pointer (&self->ready_time, g_free);
     g_clear_pointer (&self->last_request_headers, soup_message_headers_free);
+    g_clear_pointer (&self->request_counts, g_hash_table_unref);
     g_clear_pointer (&self->context, g_main_context_unref);
     g_clear_pointer (&self->loop, g_main_loop_unref);
 
@@ -4788,6 +4970,7 @@ mock_snapd_init (MockSnapd *self)
     g_cond_init (&self->condition);
 
     self->sandbox_features = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+    self->request_counts = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
     g_autoptr(GError) error = NULL;
     self->dir_path = g_dir_make_tmp ("mock-snapd-XXXXXX", &error);
     if (self->dir_path == NULL)
@@ -48,6 +48,9 @@ const gchar    *mock_snapd_get_socket_path        (MockSnapd     *snapd);
 void            mock_snapd_set_close_on_request   (MockSnapd     *snapd,
                                                    gboolean       close_on_request);
 
+void            mock_snapd_set_response_delay     (MockSnapd     *snapd,
+                                                   guint          delay);
+
 void            mock_snapd_set_decline_auth       (MockSnapd     *snapd,
                                                    gboolean       decline_auth);
 
@@ -444,6 +447,11 @@ const gchar    *mock_snapd_get_last_accept_language (MockSnapd     *snapd);
 
 const gchar    *mock_snapd_get_last_allow_interaction (MockSnapd *snapd);
 
+guint           mock_snapd_get_n_requests         (MockSnapd     *snapd,
+                                                   const gchar   *path);
+
+guint           mock_snapd_get_max_held_requests  (MockSnapd     *snapd);
+
 G_END_DECLS
 
 #endif /* __MOCK_SNAPD_H__ */
@@ -8,6 +8,8 @@
  */
 
 #include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
 #include <snapd-glib/snapd-glib.h>
 
 #include "mock-snapd.h"
@@ -274,6 +276,418 @@ test_allow_interaction (void)
     g_assert_cmpstr (mock_snapd_get_last_allow_interaction (snapd), ==, NULL);
 }
 
+static void
+pipeline_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    AsyncData *data = user_data;
+
+    g_autoptr(GError) error = NULL;
+    g_autoptr(SnapdSystemInformation) info = snapd_client_get_system_information_finish (SNAPD_CLIENT (object), result, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (info);
+    g_assert_cmpstr (snapd_system_information_get_version (info), ==, "VERSION");
+
+    data->counter--;
+    if (data->counter == 0) {
+        g_main_loop_quit (data->loop);
+        async_data_free (data);
+    }
+}
+
+static void
+test_pipeline_depth (void)
+{
+    g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    /* By default, there is no limit */
+    g_assert_cmpint (snapd_client_get_pipeline_depth (client), ==, 0);
+
+    snapd_client_set_pipeline_depth (client, 2);
+    g_assert_cmpint (snapd_client_get_pipeline_depth (client), ==, 2);
+
+    /* Hold the responses so requests build up */
+    mock_snapd_set_response_delay (snapd, 10);
+
+    /* Queue more requests than fit in the pipeline, only the first are sent */
+    AsyncData *data = async_data_new (loop, snapd);
+    data->counter = 10;
+    for (int i = 0; i < 10; i++)
+        snapd_client_get_system_information_async (client, NULL, pipeline_cb, data);
+    guint n_pending;
+    g_assert_true (snapd_client_get_connection_stats (client, 0, &n_pending, NULL, NULL, NULL));
+    g_assert_cmpint (n_pending, ==, 2);
+
+    /* They should all complete, without snapd having more than the pipeline depth outstanding */
+    g_main_loop_run (loop);
+    g_assert_cmpint (mock_snapd_get_max_held_requests (snapd), <=, 2);
+}
+
+typedef struct
+{
+    GMainLoop *loop;
+    int counter;
+    int n_completed;
+    int n_refused;
+} QueueData;
+
+static void
+queue_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    QueueData *data = user_data;
+
+    g_autoptr(GError) error = NULL;
+    g_autoptr(SnapdSystemInformation) info = snapd_client_get_system_information_finish (SNAPD_CLIENT (object), result, &error);
+    if (g_error_matches (error, SNAPD_ERROR, SNAPD_ERROR_QUEUE_FULL))
+        data->n_refused++;
+    else {
+        g_assert_no_error (error);
+        g_assert_nonnull (info);
+        data->n_completed++;
+    }
+
+    data->counter--;
+    if (data->counter == 0)
+        g_main_loop_quit (data->loop);
+}
+
+static void
+test_pipeline_max_queued (void)
+{
+    g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    /* By default, there is no limit */
+    g_assert_cmpint (snapd_client_get_max_queued_requests (client), ==, 0);
+
+    snapd_client_set_pipeline_depth (client, 1);
+    snapd_client_set_max_queued_requests (client, 3);
+    g_assert_cmpint (snapd_client_get_max_queued_requests (client), ==, 3);
+
+    /* One request is sent, three are queued and the rest are refused */
+    QueueData data = { loop, 10, 0, 0 };
+    for (int i = 0; i < 10; i++)
+        snapd_client_get_system_information_async (client, NULL, queue_cb, &data);
+    g_main_loop_run (loop);
+    g_assert_cmpint (data.n_completed, ==, 4);
+    g_assert_cmpint (data.n_refused, ==, 6);
+
+    /* Once the queue has emptied requests are accepted again */
+    g_autoptr(SnapdSystemInformation) info = snapd_client_get_system_information_sync (client, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (info);
+}
+
+static void
+test_connection_pool (void)
+{
+    g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    /* By default, there is one connection that is kept open */
+    g_assert_cmpint (snapd_client_get_max_connections (client), ==, 1);
+    g_assert_cmpint (snapd_client_get_connection_idle_timeout (client), ==, 0);
+    g_assert_cmpint (snapd_client_get_n_connections (client), ==, 0);
+
+    snapd_client_set_max_connections (client, 4);
+    g_assert_cmpint (snapd_client_get_max_connections (client), ==, 4);
+    snapd_client_set_connection_idle_timeout (client, 60);
+    g_assert_cmpint (snapd_client_get_connection_idle_timeout (client), ==, 60);
+    snapd_client_set_pipeline_depth (client, 1);
+
+    /* Requests are spread across the connections */
+    AsyncData *data = async_data_new (loop, snapd);
+    data->counter = 8;
+    for (int i = 0; i < 8; i++)
+        snapd_client_get_system_information_async (client, NULL, pipeline_cb, data);
+    g_main_loop_run (loop);
+
+    g_assert_cmpint (snapd_client_get_n_connections (client), ==, 4);
+    guint64 total_requests = 0;
+    for (guint i = 0; i < snapd_client_get_n_connections (client); i++) {
+        guint n_pending;
+        guint64 n_requests, n_bytes_sent, n_bytes_received;
+        g_assert_true (snapd_client_get_connection_stats (client, i, &n_pending, &n_requests, &n_bytes_sent, &n_bytes_received));
+        g_assert_cmpint (n_pending, ==, 0);
+        g_assert_cmpint (n_requests, >, 0);
+        g_assert_cmpint (n_bytes_sent, >, 0);
+        g_assert_cmpint (n_bytes_received, >, 0);
+        total_requests += n_requests;
+    }
+    g_assert_cmpint (total_requests, ==, 8);
+    g_assert_false (snapd_client_get_connection_stats (client, 4, NULL, NULL, NULL, NULL));
+}
+
+static gpointer
+sync_thread_cb (gpointer user_data)
+{
+    SnapdClient *client = user_data;
+
+    for (int i = 0; i < 10; i++) {
+        g_autoptr(GError) error = NULL;
+        g_autoptr(SnapdSystemInformation) info = snapd_client_get_system_information_sync (client, NULL, &error);
+        g_assert_no_error (error);
+        g_assert_nonnull (info);
+        g_assert_cmpstr (snapd_system_information_get_version (info), ==, "VERSION");
+    }
+
+    return NULL;
+}
+
+static void
+test_connection_pool_sync_threads (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+    snapd_client_set_max_connections (client, 0);
+    g_assert_cmpint (snapd_client_get_max_connections (client), ==, 0);
+
+    /* Synchronous calls can be made from many threads at once, each thread using its own connection */
+    GThread *threads[4];
+    for (int i = 0; i < 4; i++)
+        threads[i] = g_thread_new ("sync-thread", sync_thread_cb, client);
+    for (int i = 0; i < 4; i++)
+        g_thread_join (threads[i]);
+
+    g_assert_cmpint (snapd_client_get_n_connections (client), <=, 4);
+    guint64 total_requests = 0;
+    for (guint i = 0; i < snapd_client_get_n_connections (client); i++) {
+        guint64 n_requests;
+        g_assert_true (snapd_client_get_connection_stats (client, i, NULL, &n_requests, NULL, NULL));
+        total_requests += n_requests;
+    }
+    g_assert_cmpint (total_requests, ==, 40);
+}
+
+static void
+parse_in_thread_find_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    AsyncData *data = user_data;
+
+    /* Results are returned in the main thread in the order they were requested */
+    g_assert_true (g_main_context_is_owner (g_main_context_default ()));
+    g_assert_cmpint (data->counter, ==, 2);
+
+    g_autoptr(GError) error = NULL;
+    g_autoptr(GPtrArray) snaps = snapd_client_find_finish (SNAPD_CLIENT (object), result, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (snaps);
+    g_assert_cmpint (snaps->len, ==, 2);
+    g_assert_cmpstr (snapd_snap_get_name (snaps->pdata[0]), ==, "carrot1");
+    g_assert_cmpstr (snapd_snap_get_name (snaps->pdata[1]), ==, "carrot2");
+
+    data->counter--;
+}
+
+static void
+parse_in_thread_system_information_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    AsyncData *data = user_data;
+
+    g_assert_true (g_main_context_is_owner (g_main_context_default ()));
+    g_assert_cmpint (data->counter, ==, 1);
+
+    g_autoptr(GError) error = NULL;
+    g_autoptr(SnapdSystemInformation) info = snapd_client_get_system_information_finish (SNAPD_CLIENT (object), result, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (info);
+
+    g_main_loop_quit (data->loop);
+    async_data_free (data);
+}
+
+static void
+test_parse_in_thread (void)
+{
+    g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    mock_snapd_add_store_snap (snapd, "apple");
+    mock_snapd_add_store_snap (snapd, "carrot1");
+    mock_snapd_add_store_snap (snapd, "carrot2");
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_assert_false (snapd_client_get_parse_in_thread (client));
+    snapd_client_set_parse_in_thread (client, TRUE);
+    g_assert_true (snapd_client_get_parse_in_thread (client));
+
+    AsyncData *data = async_data_new (loop, snapd);
+    data->counter = 2;
+    snapd_client_find_async (client, SNAPD_FIND_FLAGS_NONE, "carrot", NULL, parse_in_thread_find_cb, data);
+    snapd_client_get_system_information_async (client, NULL, parse_in_thread_system_information_cb, data);
+    g_main_loop_run (loop);
+
+    /* Synchronous calls are parsed in the thread too */
+    g_autoptr(SnapdSystemInformation) info = snapd_client_get_system_information_sync (client, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (info);
+
+    snapd_client_set_parse_in_thread (client, FALSE);
+    g_assert_false (snapd_client_get_parse_in_thread (client));
+}
+
+static void
+test_lazy_snaps (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    MockSnap *s = mock_snapd_add_snap (snapd, "snap");
+    mock_snap_add_app (s, "app");
+    s = mock_snapd_add_store_snap (snapd, "carrot");
+    mock_track_add_channel (mock_snap_add_track (s, "latest"), "stable", NULL);
+    mock_snap_add_price (s, 1.25, "NZD");
+    mock_snap_add_media (s, "screenshot", "screenshot.png", 1024, 1024);
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_assert_false (snapd_client_get_lazy_snaps (client));
+    snapd_client_set_lazy_snaps (client, TRUE);
+    g_assert_true (snapd_client_get_lazy_snaps (client));
+
+    g_autoptr(GPtrArray) snaps = snapd_client_get_snaps_sync (client, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_cmpint (snaps->len, ==, 1);
+    SnapdSnap *snap = snaps->pdata[0];
+    g_assert_cmpstr (snapd_snap_get_name (snap), ==, "snap");
+    GPtrArray *apps = snapd_snap_get_apps (snap);
+    g_assert_cmpint (apps->len, ==, 1);
+    g_assert_cmpstr (snapd_app_get_name (apps->pdata[0]), ==, "app");
+    g_assert_cmpstr (snapd_app_get_snap (apps->pdata[0]), ==, "snap");
+    g_assert_true (snapd_snap_get_apps (snap) == apps);
+
+    g_autoptr(GPtrArray) found = snapd_client_find_sync (client, SNAPD_FIND_FLAGS_NONE, "carrot", NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_cmpint (found->len, ==, 1);
+    snap = found->pdata[0];
+    g_assert_cmpstr (snapd_snap_get_name (snap), ==, "carrot");
+
+    /* Properties use the deferred members too */
+    g_autoptr(GPtrArray) prices = NULL;
+    g_object_get (snap, "prices", &prices, NULL);
+    g_assert_cmpint (prices->len, ==, 1);
+    g_assert_cmpfloat (snapd_price_get_amount (prices->pdata[0]), ==, 1.25);
+    g_assert_cmpstr (snapd_price_get_currency (prices->pdata[0]), ==, "NZD");
+    GPtrArray *media = snapd_snap_get_media (snap);
+    g_assert_cmpint (media->len, ==, 1);
+    g_assert_cmpstr (snapd_media_get_url (media->pdata[0]), ==, "screenshot.png");
+    g_assert_cmpint (snapd_media_get_width (media->pdata[0]), ==, 1024);
+    GPtrArray *channels = snapd_snap_get_channels (snap);
+    g_assert_cmpint (channels->len, ==, 1);
+    g_assert_cmpstr (snapd_channel_get_name (channels->pdata[0]), ==, "stable");
+    g_assert_nonnull (snapd_snap_match_channel (snap, "stable"));
+    g_assert_cmpint (snapd_snap_get_apps (snap)->len, ==, 0);
+}
+
+static void
+test_response_cache (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    mock_snapd_add_snap (snapd, "snap1");
+    mock_snapd_add_store_snap (snapd, "snap2");
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    /* Only endpoints that don't change the system can be cached */
+    g_assert_cmpint (snapd_client_get_response_cache_ttl (client, "/v2/snaps"), ==, 0);
+    g_assert_true (snapd_client_set_response_cache_ttl (client, "/v2/snaps", 60));
+    g_assert_cmpint (snapd_client_get_response_cache_ttl (client, "/v2/snaps"), ==, 60);
+    g_assert_false (snapd_client_set_response_cache_ttl (client, "/v2/changes", 60));
+
+    /* Second request is answered from the cache */
+    for (int i = 0; i < 2; i++) {
+        g_autoptr(GPtrArray) snaps = snapd_client_get_snaps_sync (client, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, NULL, &error);
+        g_assert_no_error (error);
+        g_assert_nonnull (snaps);
+        g_assert_cmpint (snaps->len, ==, 1);
+        g_assert_cmpstr (snapd_snap_get_name (snaps->pdata[0]), ==, "snap1");
+    }
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/snaps"), ==, 1);
+    guint64 n_hits, n_misses, n_revalidated;
+    snapd_client_get_response_cache_stats (client, &n_hits, &n_misses, &n_revalidated);
+    g_assert_cmpint (n_hits, ==, 1);
+    g_assert_cmpint (n_misses, ==, 1);
+    g_assert_cmpint (n_revalidated, ==, 0);
+
+    /* Changing the system drops cached responses */
+    gboolean result = snapd_client_install2_sync (client, SNAPD_INSTALL_FLAGS_NONE, "snap2", NULL, NULL, NULL, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_true (result);
+    g_autoptr(GPtrArray) snaps = snapd_client_get_snaps_sync (client, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (snaps);
+    g_assert_cmpint (snaps->len, ==, 2);
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/snaps"), ==, 2);
+
+    snapd_client_clear_response_cache (client);
+    g_autoptr(GPtrArray) snaps2 = snapd_client_get_snaps_sync (client, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/snaps"), ==, 3);
+}
+
+static void
+test_response_cache_cancel (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    mock_snapd_add_snap (snapd, "snap1");
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+    g_assert_true (snapd_client_set_response_cache_ttl (client, "/v2/snaps", 60));
+
+    g_autoptr(GPtrArray) snaps = snapd_client_get_snaps_sync (client, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (snaps);
+
+    /* Cancelling applies to responses from the cache too */
+    g_autoptr(GCancellable) cancellable = g_cancellable_new ();
+    g_cancellable_cancel (cancellable);
+    g_autoptr(GPtrArray) cached_snaps = snapd_client_get_snaps_sync (client, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, cancellable, &error);
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_assert_null (cached_snaps);
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/snaps"), ==, 1);
+}
+
 static void
 test_maintenance_none (void)
 {
@@ -1335,12 +1749,130 @@ test_abort_change_async (void)
 }
 
 static void
-test_list_sync (void)
+watch_change_progress_cb (SnapdClient *client, SnapdChange *change, gpointer deprecated, gpointer user_data)
 {
-    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
-    mock_snapd_add_snap (snapd, "snap1");
-    mock_snapd_add_snap (snapd, "snap2");
-    mock_snapd_add_snap (snapd, "snap3");
+    int *progress_done = user_data;
+
+    g_assert_cmpstr (snapd_change_get_id (change), ==, "1");
+    (*progress_done)++;
+}
+
+static void
+watch_change_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    AsyncData *data = user_data;
+
+    g_autoptr(GError) error = NULL;
+    g_autoptr(SnapdChange) change = snapd_client_watch_change_finish (SNAPD_CLIENT (object), result, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (change);
+    g_assert_cmpstr (snapd_change_get_id (change), ==, "1");
+    g_assert_true (snapd_change_get_ready (change));
+    g_assert_cmpstr (snapd_change_get_status (change), ==, "Done");
+
+    data->counter--;
+    if (data->counter == 0) {
+        g_main_loop_quit (data->loop);
+        async_data_free (data);
+    }
+}
+
+static void
+test_watch_change_async (void)
+{
+    g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    MockChange *c = mock_snapd_add_change (snapd);
+    MockTask *t = mock_change_add_task (c, "foo");
+    mock_task_set_progress (t, 0, 5);
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    AsyncData *data = async_data_new (loop, snapd);
+    data->counter = 2;
+    int progress_done1 = 0, progress_done2 = 0;
+    snapd_client_watch_change_async (client, "1", watch_change_progress_cb, &progress_done1, NULL, watch_change_cb, data);
+    snapd_client_watch_change_async (client, "1", watch_change_progress_cb, &progress_done2, NULL, watch_change_cb, data);
+    g_main_loop_run (loop);
+
+    /* Both requests see progress, but each step is only checked once */
+    g_assert_cmpint (progress_done1, >, 0);
+    g_assert_cmpint (progress_done2, >, 0);
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/changes/1"), ==, 5);
+}
+
+typedef struct
+{
+    int n_updates;
+    guint n_tasks_first;
+    guint n_tasks_max;
+} TaskDeltaData;
+
+static void
+task_delta_cb (SnapdClient *client, SnapdChange *change, GPtrArray *tasks, gpointer user_data)
+{
+    TaskDeltaData *data = user_data;
+
+    g_assert_cmpint (tasks->len, >, 0);
+    GPtrArray *change_tasks = snapd_change_get_tasks (change);
+    for (guint i = 0; i < tasks->len; i++) {
+        gboolean found = FALSE;
+        for (guint j = 0; j < change_tasks->len; j++)
+            if (change_tasks->pdata[j] == tasks->pdata[i])
+                found = TRUE;
+        g_assert_true (found);
+    }
+
+    if (data->n_updates == 0)
+        data->n_tasks_first = tasks->len;
+    else
+        data->n_tasks_max = MAX (data->n_tasks_max, tasks->len);
+    data->n_updates++;
+}
+
+static void
+test_watch_change_task_delta (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    MockChange *c = mock_snapd_add_change (snapd);
+    for (int i = 0; i < 3; i++) {
+        MockTask *t = mock_change_add_task (c, "foo");
+        mock_task_set_progress (t, 0, 2);
+    }
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    TaskDeltaData data = { 0 };
+    snapd_client_set_task_delta_callback (client, task_delta_cb, &data, NULL);
+    g_autoptr(SnapdChange) change = snapd_client_watch_change_sync (client, "1", NULL, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (change);
+    g_assert_true (snapd_change_get_ready (change));
+
+    /* All tasks are new the first time, after that only one task progresses each poll */
+    g_assert_cmpint (data.n_updates, ==, 6);
+    g_assert_cmpint (data.n_tasks_first, ==, 3);
+    g_assert_cmpint (data.n_tasks_max, ==, 1);
+}
+
+static void
+test_list_sync (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    mock_snapd_add_snap (snapd, "snap1");
+    mock_snapd_add_snap (snapd, "snap2");
+    mock_snapd_add_snap (snapd, "snap3");
 
     g_autoptr(GError) error = NULL;
     g_assert_true (mock_snapd_start (snapd, &error));
@@ -1464,6 +1996,118 @@ test_get_snaps_async (void)
     g_main_loop_run (loop);
 }
 
+typedef struct
+{
+    GMainLoop *loop;
+    GPtrArray *snaps;
+} StreamSnapsData;
+
+static void
+stream_snap_cb (SnapdClient *client, SnapdSnap *snap, gpointer user_data)
+{
+    StreamSnapsData *data = user_data;
+    g_ptr_array_add (data->snaps, g_object_ref (snap));
+}
+
+static void
+get_snaps_stream_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    StreamSnapsData *data = user_data;
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (snapd_client_get_snaps_stream_finish (SNAPD_CLIENT (object), result, &error));
+    g_assert_no_error (error);
+    g_assert_cmpint (data->snaps->len, ==, 3);
+    g_assert_cmpstr (snapd_snap_get_name (data->snaps->pdata[0]), ==, "snap1");
+    g_assert_cmpstr (snapd_snap_get_name (data->snaps->pdata[1]), ==, "snap2");
+    g_assert_cmpstr (snapd_snap_get_name (data->snaps->pdata[2]), ==, "snap3");
+
+    g_main_loop_quit (data->loop);
+}
+
+static void
+test_update_snap_set (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    MockSnap *s1 = mock_snapd_add_snap (snapd, "snap1");
+    mock_snapd_add_snap (snapd, "snap2");
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_autoptr(SnapdSnapSet) snap_set = snapd_snap_set_new ();
+    g_assert_cmpint (snapd_snap_set_get_snaps (snap_set)->len, ==, 0);
+
+    /* All snaps are new the first time */
+    g_assert_true (snapd_client_update_snap_set_sync (client, snap_set, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, &error));
+    g_assert_no_error (error);
+    g_assert_cmpint (snapd_snap_set_get_snaps (snap_set)->len, ==, 2);
+    g_assert_cmpint (snapd_snap_set_get_added (snap_set)->len, ==, 2);
+    g_assert_cmpint (snapd_snap_set_get_removed (snap_set)->len, ==, 0);
+    g_assert_cmpint (snapd_snap_set_get_changed (snap_set)->len, ==, 0);
+    g_assert_cmpint (snapd_snap_set_get_change_flags (snap_set, "snap1"), ==, SNAPD_SNAP_SET_CHANGE_FLAGS_ADDED);
+    g_assert_cmpint (snapd_snap_set_get_n_reused (snap_set), ==, 0);
+    SnapdSnap *snap1 = snapd_snap_set_lookup (snap_set, "snap1");
+    g_assert_nonnull (snap1);
+    g_assert_cmpstr (snapd_snap_get_name (snap1), ==, "snap1");
+    SnapdSnap *snap2 = snapd_snap_set_lookup (snap_set, "snap2");
+    g_assert_nonnull (snap2);
+    g_assert_null (snapd_snap_set_lookup (snap_set, "snap3"));
+
+    /* Unchanged snaps are reused */
+    g_assert_true (snapd_client_update_snap_set_sync (client, snap_set, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, &error));
+    g_assert_no_error (error);
+    g_assert_cmpint (snapd_snap_set_get_added (snap_set)->len, ==, 0);
+    g_assert_cmpint (snapd_snap_set_get_removed (snap_set)->len, ==, 0);
+    g_assert_cmpint (snapd_snap_set_get_changed (snap_set)->len, ==, 0);
+    g_assert_cmpint (snapd_snap_set_get_n_reused (snap_set), ==, 2);
+    g_assert_true (snapd_snap_set_lookup (snap_set, "snap1") == snap1);
+    g_assert_true (snapd_snap_set_lookup (snap_set, "snap2") == snap2);
+
+    /* Changes are reported */
+    mock_snap_set_revision (s1, "1000");
+    g_assert_true (snapd_client_remove2_sync (client, SNAPD_REMOVE_FLAGS_NONE, "snap2", NULL, NULL, NULL, &error));
+    g_assert_no_error (error);
+    g_assert_true (snapd_client_update_snap_set_sync (client, snap_set, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, &error));
+    g_assert_no_error (error);
+    g_assert_cmpint (snapd_snap_set_get_snaps (snap_set)->len, ==, 1);
+    g_assert_cmpint (snapd_snap_set_get_added (snap_set)->len, ==, 0);
+    g_assert_cmpint (snapd_snap_set_get_removed (snap_set)->len, ==, 1);
+    g_assert_cmpstr (snapd_snap_get_name (snapd_snap_set_get_removed (snap_set)->pdata[0]), ==, "snap2");
+    g_assert_cmpint (snapd_snap_set_get_change_flags (snap_set, "snap2"), ==, SNAPD_SNAP_SET_CHANGE_FLAGS_REMOVED);
+    g_assert_cmpint (snapd_snap_set_get_changed (snap_set)->len, ==, 1);
+    g_assert_cmpint (snapd_snap_set_get_change_flags (snap_set, "snap1") & SNAPD_SNAP_SET_CHANGE_FLAGS_REVISION, !=, 0);
+    g_assert_cmpstr (snapd_snap_get_revision (snapd_snap_set_lookup (snap_set, "snap1")), ==, "1000");
+    g_assert_null (snapd_snap_set_lookup (snap_set, "snap2"));
+}
+
+static void
+test_get_snaps_stream (void)
+{
+    g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    MockSnap *s = mock_snapd_add_snap (snapd, "snap1");
+    mock_snap_set_status (s, "installed");
+    mock_snapd_add_snap (snapd, "snap1");
+    mock_snapd_add_snap (snapd, "snap2");
+    mock_snapd_add_snap (snapd, "snap3");
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_autoptr(GPtrArray) snaps = g_ptr_array_new_with_free_func (g_object_unref);
+    StreamSnapsData data = { loop, snaps };
+    snapd_client_get_snaps_stream_async (client, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, stream_snap_cb, &data, NULL, get_snaps_stream_cb, &data);
+    g_main_loop_run (loop);
+}
+
 static void
 test_get_snaps_filter (void)
 {
@@ -2533,6 +3177,238 @@ test_icon_not_installed (void)
     g_assert_null (icon);
 }
 
+typedef struct
+{
+    GMainLoop *loop;
+    int n_icons;
+    int n_errors;
+    int n_complete;
+} GetIconsData;
+
+static void
+get_icons_icon_cb (SnapdClient *client, const gchar *name, SnapdIcon *icon, GError *error, gpointer user_data)
+{
+    GetIconsData *data = user_data;
+
+    if (strcmp (name, "missing") == 0) {
+        g_assert_error (error, SNAPD_ERROR, SNAPD_ERROR_NOT_FOUND);
+        g_assert_null (icon);
+        data->n_errors++;
+        return;
+    }
+
+    g_assert_no_error (error);
+    g_assert_nonnull (icon);
+    g_assert_cmpstr (snapd_icon_get_mime_type (icon), ==, "image/png");
+    GBytes *icon_data = snapd_icon_get_data (icon);
+    g_assert_cmpmem (g_bytes_get_data (icon_data, NULL), g_bytes_get_size (icon_data), "ICON-DATA", 9);
+    data->n_icons++;
+}
+
+static void
+test_get_icons_sync (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    g_autoptr(GBytes) icon_data = g_bytes_new ("ICON-DATA", 9);
+    for (int i = 1; i <= 5; i++) {
+        g_autofree gchar *name = g_strdup_printf ("snap%d", i);
+        MockSnap *s = mock_snapd_add_snap (snapd, name);
+        mock_snap_set_icon_data (s, "image/png", icon_data);
+    }
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_auto(GStrv) names = g_strsplit ("snap1;snap2;snap3;snap2;missing;snap4;snap5", ";", -1);
+    GetIconsData data = { 0 };
+    gboolean result = snapd_client_get_icons_sync (client, names, 2, get_icons_icon_cb, &data, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_true (result);
+    g_assert_cmpint (data.n_icons, ==, 5);
+    g_assert_cmpint (data.n_errors, ==, 1);
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/icons/snap2/icon"), ==, 1);
+}
+
+static void
+get_icons_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    GetIconsData *data = user_data;
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (snapd_client_get_icons_finish (SNAPD_CLIENT (object), result, &error));
+    g_assert_no_error (error);
+
+    data->n_complete++;
+    if (data->n_complete == 2)
+        g_main_loop_quit (data->loop);
+}
+
+static void
+test_get_icons_shared (void)
+{
+    g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    g_autoptr(GBytes) icon_data = g_bytes_new ("ICON-DATA", 9);
+    for (int i = 1; i <= 3; i++) {
+        g_autofree gchar *name = g_strdup_printf ("snap%d", i);
+        MockSnap *s = mock_snapd_add_snap (snapd, name);
+        mock_snap_set_icon_data (s, "image/png", icon_data);
+    }
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    /* Both calls get all the icons, but each icon is only requested once */
+    g_auto(GStrv) names = g_strsplit ("snap1;snap2;snap3", ";", -1);
+    GetIconsData data = { 0 };
+    data.loop = loop;
+    snapd_client_get_icons_async (client, names, 0, get_icons_icon_cb, &data, NULL, get_icons_cb, &data);
+    snapd_client_get_icons_async (client, names, 0, get_icons_icon_cb, &data, NULL, get_icons_cb, &data);
+    g_main_loop_run (loop);
+
+    g_assert_cmpint (data.n_icons, ==, 6);
+    for (int i = 1; i <= 3; i++) {
+        g_autofree gchar *path = g_strdup_printf ("/v2/icons/snap%d/icon", i);
+        g_assert_cmpint (mock_snapd_get_n_requests (snapd, path), ==, 1);
+    }
+}
+
+static void
+remove_icon_cache (const gchar *path)
+{
+    g_autoptr(GDir) dir = g_dir_open (path, 0, NULL);
+    const gchar *filename;
+    while (dir != NULL && (filename = g_dir_read_name (dir)) != NULL) {
+        g_autofree gchar *file_path = g_build_filename (path, filename, NULL);
+        g_unlink (file_path);
+    }
+    g_rmdir (path);
+}
+
+static void
+test_icon_cache (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    MockSnap *s = mock_snapd_add_snap (snapd, "snap");
+    mock_snap_set_revision (s, "1");
+    g_autoptr(GBytes) icon_data = g_bytes_new ("ICON-DATA", 9);
+    mock_snap_set_icon_data (s, "image/png", icon_data);
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autofree gchar *cache_path = g_dir_make_tmp ("snapd-glib-test-XXXXXX", &error);
+    g_assert_no_error (error);
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+    snapd_client_set_icon_cache_path (client, cache_path);
+    snapd_client_set_icon_cache_size (client, 1024 * 1024);
+
+    /* Revision not known, so not cached */
+    g_autoptr(SnapdIcon) icon1 = snapd_client_get_icon_sync (client, "snap", NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (icon1);
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/icons/snap/icon"), ==, 1);
+
+    /* Icon stored once revision is known, then used from the cache */
+    g_autoptr(GPtrArray) snaps = snapd_client_get_snaps_sync (client, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_autoptr(SnapdIcon) icon2 = snapd_client_get_icon_sync (client, "snap", NULL, &error);
+    g_assert_no_error (error);
+    g_autoptr(SnapdIcon) icon3 = snapd_client_get_icon_sync (client, "snap", NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (icon3);
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/icons/snap/icon"), ==, 2);
+    g_assert_cmpstr (snapd_icon_get_mime_type (icon3), ==, "image/png");
+    GBytes *data = snapd_icon_get_data (icon3);
+    g_assert_cmpmem (g_bytes_get_data (data, NULL), g_bytes_get_size (data), "ICON-DATA", 9);
+    guint64 n_hits, n_misses, size;
+    guint n_entries;
+    snapd_client_get_icon_cache_stats (client, &n_hits, &n_misses, &n_entries, &size);
+    g_assert_cmpint (n_hits, ==, 1);
+    g_assert_cmpint (n_misses, ==, 2);
+    g_assert_cmpint (n_entries, ==, 1);
+    g_assert_cmpint (size, ==, 19);
+
+    /* Cache is used by a new client */
+    g_autoptr(SnapdClient) client2 = snapd_client_new ();
+    snapd_client_set_socket_path (client2, mock_snapd_get_socket_path (snapd));
+    snapd_client_set_icon_cache_path (client2, cache_path);
+    snapd_client_set_icon_cache_size (client2, 1024 * 1024);
+    g_autoptr(GPtrArray) snaps2 = snapd_client_get_snaps_sync (client2, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_autoptr(SnapdIcon) icon4 = snapd_client_get_icon_sync (client2, "snap", NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (icon4);
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/icons/snap/icon"), ==, 2);
+
+    /* Refreshed snap invalidates the icon */
+    mock_snap_set_revision (s, "2");
+    g_autoptr(GPtrArray) snaps3 = snapd_client_get_snaps_sync (client2, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, NULL, &error);
+    g_assert_no_error (error);
+    snapd_client_get_icon_cache_stats (client2, NULL, NULL, &n_entries, NULL);
+    g_assert_cmpint (n_entries, ==, 0);
+    g_autoptr(SnapdIcon) icon5 = snapd_client_get_icon_sync (client2, "snap", NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (icon5);
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/icons/snap/icon"), ==, 3);
+
+    remove_icon_cache (cache_path);
+}
+
+static void
+test_icon_cache_evict (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    g_autoptr(GBytes) icon_data = g_bytes_new ("ICON-DATA", 9);
+    MockSnap *s = mock_snapd_add_snap (snapd, "snap1");
+    mock_snap_set_icon_data (s, "image/png", icon_data);
+    s = mock_snapd_add_snap (snapd, "snap2");
+    mock_snap_set_icon_data (s, "image/png", icon_data);
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autofree gchar *cache_path = g_dir_make_tmp ("snapd-glib-test-XXXXXX", &error);
+    g_assert_no_error (error);
+
+    /* Only room for one icon */
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+    snapd_client_set_icon_cache_path (client, cache_path);
+    snapd_client_set_icon_cache_size (client, 30);
+
+    g_autoptr(GPtrArray) snaps = snapd_client_get_snaps_sync (client, SNAPD_GET_SNAPS_FLAGS_NONE, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_autoptr(SnapdIcon) icon1 = snapd_client_get_icon_sync (client, "snap1", NULL, &error);
+    g_assert_no_error (error);
+    g_autoptr(SnapdIcon) icon2 = snapd_client_get_icon_sync (client, "snap2", NULL, &error);
+    g_assert_no_error (error);
+    guint n_entries;
+    guint64 size;
+    snapd_client_get_icon_cache_stats (client, NULL, NULL, &n_entries, &size);
+    g_assert_cmpint (n_entries, ==, 1);
+    g_assert_cmpint (size, ==, 19);
+
+    /* Oldest icon was removed */
+    g_autoptr(SnapdIcon) icon3 = snapd_client_get_icon_sync (client, "snap1", NULL, &error);
+    g_assert_no_error (error);
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/icons/snap1/icon"), ==, 2);
+    g_autoptr(SnapdIcon) icon4 = snapd_client_get_icon_sync (client, "snap1", NULL, &error);
+    g_assert_no_error (error);
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/icons/snap1/icon"), ==, 2);
+
+    remove_icon_cache (cache_path);
+}
+
 static void
 test_icon_large (void)
 {
@@ -2665,6 +3541,154 @@ test_get_assertions_multiple (void)
                                         "SIGNATURE3");
 }
 
+static void
+test_get_assertions_filter (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    mock_snapd_add_assertion (snapd,
+                              "type: account\n"
+                              "account-id: A\n"
+                              "\n"
+                              "SIGNATURE1");
+    mock_snapd_add_assertion (snapd,
+                              "type: account\n"
+                              "account-id: B\n"
+                              "body-length: 4\n"
+                              "\n"
+                              "BODY\n"
+                              "\n"
+                              "SIGNATURE2");
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_autoptr(GHashTable) filters = g_hash_table_new (g_str_hash, g_str_equal);
+    g_hash_table_insert (filters, "account-id", "B");
+    g_auto(GStrv) assertions = snapd_client_get_assertions2_sync (client, "account", filters, SNAPD_GET_ASSERTIONS_FLAGS_NONE, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (assertions);
+    g_assert_cmpint (g_strv_length (assertions), ==, 1);
+    g_assert_cmpstr (assertions[0], ==, "type: account\n"
+                                        "account-id: B\n"
+                                        "body-length: 4\n"
+                                        "\n"
+                                        "BODY\n"
+                                        "\n"
+                                        "SIGNATURE2");
+}
+
+static void
+test_get_assertions_headers_only (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    mock_snapd_add_assertion (snapd,
+                              "type: account\n"
+                              "account-id: A\n"
+                              "\n"
+                              "SIGNATURE1");
+    mock_snapd_add_assertion (snapd,
+                              "type: account\n"
+                              "account-id: B\n"
+                              "body-length: 4\n"
+                              "\n"
+                              "BODY\n"
+                              "\n"
+                              "SIGNATURE2");
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_autoptr(GHashTable) filters = g_hash_table_new (g_str_hash, g_str_equal);
+    g_hash_table_insert (filters, "account-id", "B");
+    g_auto(GStrv) assertions = snapd_client_get_assertions2_sync (client, "account", filters, SNAPD_GET_ASSERTIONS_FLAGS_HEADERS_ONLY, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (assertions);
+    g_assert_cmpint (g_strv_length (assertions), ==, 1);
+    g_autoptr(SnapdAssertion) assertion = snapd_assertion_new (assertions[0]);
+    g_assert_cmpstr (snapd_assertion_peek_header (assertion, "type"), ==, "account");
+    g_assert_cmpstr (snapd_assertion_peek_header (assertion, "account-id"), ==, "B");
+    g_assert_null (snapd_assertion_peek_body (assertion, NULL));
+    g_assert_cmpstr (snapd_assertion_peek_signature (assertion), ==, "");
+}
+
+typedef struct
+{
+    GMainLoop *loop;
+    GPtrArray *assertions;
+} StreamAssertionsData;
+
+static void
+stream_assertion_cb (SnapdClient *client, SnapdAssertion *assertion, gpointer user_data)
+{
+    StreamAssertionsData *data = user_data;
+    g_ptr_array_add (data->assertions, g_object_ref (assertion));
+}
+
+static void
+get_assertions_stream_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    StreamAssertionsData *data = user_data;
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (snapd_client_get_assertions_stream_finish (SNAPD_CLIENT (object), result, &error));
+    g_assert_no_error (error);
+    g_assert_cmpint (data->assertions->len, ==, 3);
+    g_assert_cmpstr (snapd_assertion_peek_signature (data->assertions->pdata[0]), ==, "SIGNATURE1");
+    g_assert_cmpstr (snapd_assertion_peek_body (data->assertions->pdata[1], NULL), ==, "BODY\n\nBODY");
+    g_assert_cmpstr (snapd_assertion_peek_signature (data->assertions->pdata[1]), ==, "SIGNATURE2");
+    g_assert_cmpstr (snapd_assertion_peek_signature (data->assertions->pdata[2]), ==, "SIGNATURE3");
+    g_autofree gchar *content = NULL;
+    g_object_get (data->assertions->pdata[1], "content", &content, NULL);
+    g_assert_cmpstr (content, ==, "type: account\n"
+                                  "body-length: 10\n"
+                                  "\n"
+                                  "BODY\n\nBODY\n"
+                                  "\n"
+                                  "SIGNATURE2");
+
+    g_main_loop_quit (data->loop);
+}
+
+static void
+test_get_assertions_stream (void)
+{
+    g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    mock_snapd_add_assertion (snapd,
+                              "type: account\n"
+                              "\n"
+                              "SIGNATURE1\n"
+                              "\n"
+                              "type: account\n"
+                              "body-length: 10\n"
+                              "\n"
+                              "BODY\n\nBODY\n"
+                              "\n"
+                              "SIGNATURE2\n"
+                              "\n"
+                              "type: account\n"
+                              "\n"
+                              "SIGNATURE3");
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_autoptr(GPtrArray) assertions = g_ptr_array_new_with_free_func (g_object_unref);
+    StreamAssertionsData data = { loop, assertions };
+    snapd_client_get_assertions_stream_async (client, "account", NULL, SNAPD_GET_ASSERTIONS_FLAGS_NONE, stream_assertion_cb, &data, NULL, get_assertions_stream_cb, &data);
+    g_main_loop_run (loop);
+}
+
 static void
 test_get_assertions_invalid (void)
 {
@@ -2705,6 +3729,92 @@ test_add_assertions_sync (void)
     g_assert_cmpstr (mock_snapd_get_assertions (snapd)->data, == , "type: account\n\nSIGNATURE");
 }
 
+typedef struct
+{
+    guint n_batches;
+    guint n_assertions;
+    guint batch_mask;
+} ImportAssertionsData;
+
+static void
+import_assertions_batch_cb (SnapdClient *client, guint batch, guint n_assertions, GError *error, gpointer user_data)
+{
+    ImportAssertionsData *data = user_data;
+
+    g_assert_no_error (error);
+    g_assert_cmpint (batch, <, 32);
+    g_assert_cmpint (data->batch_mask & (1 << batch), ==, 0);
+    data->batch_mask |= 1 << batch;
+    data->n_batches++;
+    data->n_assertions += n_assertions;
+}
+
+static void
+test_import_assertions (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    const gchar *content = "type: account\n"
+                           "\n"
+                           "SIGNATURE1\n"
+                           "\n"
+                           "type: account\n"
+                           "body-length: 4\n"
+                           "\n"
+                           "BODY\n"
+                           "\n"
+                           "SIGNATURE2\n"
+                           "\n"
+                           "type: account\n"
+                           "\n"
+                           "SIGNATURE3";
+
+    /* Small batches send each assertion separately */
+    g_autoptr(GInputStream) stream = g_memory_input_stream_new_from_data (content, -1, NULL);
+    ImportAssertionsData data = { 0 };
+    g_assert_true (snapd_client_import_assertions_sync (client, stream, 10, 2, import_assertions_batch_cb, &data, NULL, &error));
+    g_assert_no_error (error);
+    g_assert_cmpint (data.n_batches, ==, 3);
+    g_assert_cmpint (data.n_assertions, ==, 3);
+    g_assert_cmpint (data.batch_mask, ==, 0x7);
+    g_assert_cmpint (g_list_length (mock_snapd_get_assertions (snapd)), ==, 3);
+
+    /* Default batch size sends them together */
+    g_autoptr(GInputStream) stream2 = g_memory_input_stream_new_from_data (content, -1, NULL);
+    ImportAssertionsData data2 = { 0 };
+    g_assert_true (snapd_client_import_assertions_sync (client, stream2, 0, 0, import_assertions_batch_cb, &data2, NULL, &error));
+    g_assert_no_error (error);
+    g_assert_cmpint (data2.n_batches, ==, 1);
+    g_assert_cmpint (data2.n_assertions, ==, 3);
+    g_assert_cmpint (g_list_length (mock_snapd_get_assertions (snapd)), ==, 4);
+    g_assert_cmpstr (g_list_last (mock_snapd_get_assertions (snapd))->data, ==, content);
+}
+
+static void
+test_import_assertions_cancel (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_autoptr(GInputStream) stream = g_memory_input_stream_new_from_data ("type: account\n\nSIGNATURE", -1, NULL);
+    g_autoptr(GCancellable) cancellable = g_cancellable_new ();
+    g_cancellable_cancel (cancellable);
+    g_assert_false (snapd_client_import_assertions_sync (client, stream, 0, 0, NULL, NULL, cancellable, &error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_assert_null (mock_snapd_get_assertions (snapd));
+}
+
 static void
 test_assertions_sync (void)
 {
@@ -2753,6 +3863,66 @@ test_assertions_body (void)
     g_assert_cmpstr (signature, ==, "SIGNATURE");
 }
 
+static void
+test_assertions_peek (void)
+{
+    const gchar *content = "type: account\n"
+                           "account-id-extra: extra\n"
+                           "account-id: id\n"
+                           "multi-line: line1\n"
+                           " line2\n"
+                           "type: duplicate\n"
+                           "body-length: 4\n"
+                           "\n"
+                           "BODY\n"
+                           "\n"
+                           "SIGNATURE";
+    g_autoptr(SnapdAssertion) assertion = snapd_assertion_new (content);
+    const gchar * const *headers = snapd_assertion_peek_headers (assertion);
+    g_assert_cmpint (g_strv_length ((GStrv) headers), ==, 6);
+    g_assert_cmpstr (headers[0], ==, "type");
+    g_assert_cmpstr (headers[1], ==, "account-id-extra");
+    g_assert_cmpstr (headers[2], ==, "account-id");
+    g_assert_cmpstr (headers[3], ==, "multi-line");
+    g_assert_cmpstr (headers[4], ==, "type");
+    g_assert_cmpstr (headers[5], ==, "body-length");
+    g_assert_cmpstr (snapd_assertion_peek_header (assertion, "type"), ==, "account");
+    g_assert_cmpstr (snapd_assertion_peek_header (assertion, "account-id"), ==, "id");
+    g_assert_cmpstr (snapd_assertion_peek_header (assertion, "account-id-extra"), ==, "extra");
+    g_assert_cmpstr (snapd_assertion_peek_header (assertion, "multi-line"), ==, "line1\n line2");
+    g_assert_null (snapd_assertion_peek_header (assertion, "account"));
+    g_autofree gchar *account = snapd_assertion_get_header (assertion, "account");
+    g_assert_null (account);
+    gsize body_length;
+    const gchar *body = snapd_assertion_peek_body (assertion, &body_length);
+    g_assert_cmpint (body_length, ==, 4);
+    g_assert_cmpstr (body, ==, "BODY");
+    g_assert_cmpstr (snapd_assertion_peek_signature (assertion), ==, "SIGNATURE");
+
+    /* Content is unchanged by indexing */
+    g_autofree gchar *assertion_content = NULL;
+    g_object_get (assertion, "content", &assertion_content, NULL);
+    g_assert_cmpstr (assertion_content, ==, content);
+}
+
+static void
+test_assertions_no_body (void)
+{
+    g_autoptr(SnapdAssertion) assertion = snapd_assertion_new ("type: account\n"
+                                                               "\n"
+                                                               "SIGNATURE");
+    gsize body_length = 99;
+    g_assert_null (snapd_assertion_peek_body (assertion, &body_length));
+    g_assert_cmpint (body_length, ==, 0);
+    g_assert_cmpstr (snapd_assertion_peek_signature (assertion), ==, "SIGNATURE");
+
+    g_autoptr(SnapdAssertion) empty = snapd_assertion_new ("");
+    g_assert_cmpint (g_strv_length ((GStrv) snapd_assertion_peek_headers (empty)), ==, 0);
+    g_assert_null (snapd_assertion_peek_header (empty, "type"));
+    g_assert_null (snapd_assertion_peek_body (empty, NULL));
+    g_assert_cmpstr (snapd_assertion_peek_signature (empty), ==, "");
+}
+
 static void
 setup_get_connections (MockSnapd *snapd)
 {
@@ -3178,6 +4348,56 @@ check_names_match (GStrv names, guint names_length, const gchar *expected)
         g_assert_cmpstr (sorted_names[i], ==, sorted_expected_names[i]);
 }
 
+static void
+test_get_connection_index_sync (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    setup_get_connections (snapd);
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_autoptr(SnapdConnectionIndex) index = snapd_client_get_connection_index_sync (client, SNAPD_GET_CONNECTIONS_FLAGS_SELECT_ALL, NULL, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (index);
+    check_get_connections_result (snapd_connection_index_get_established (index),
+                                  snapd_connection_index_get_undesired (index),
+                                  snapd_connection_index_get_plugs (index),
+                                  snapd_connection_index_get_slots (index),
+                                  TRUE);
+
+    SnapdPlug *plug = snapd_connection_index_lookup_plug (index, "snap2", "manual-plug");
+    g_assert_nonnull (plug);
+    g_assert_cmpstr (snapd_plug_get_name (plug), ==, "manual-plug");
+    g_assert_null (snapd_connection_index_lookup_plug (index, "snap1", "manual-plug"));
+    SnapdSlot *slot = snapd_connection_index_lookup_slot (index, "snap1", "slot2");
+    g_assert_nonnull (slot);
+    g_assert_cmpstr (snapd_slot_get_name (slot), ==, "slot2");
+    g_assert_null (snapd_connection_index_lookup_slot (index, "snap1", "slot3"));
+
+    g_assert_cmpint (snapd_connection_index_get_snap_plugs (index, "snap2")->len, ==, 4);
+    g_assert_cmpint (snapd_connection_index_get_snap_plugs (index, "snap1")->len, ==, 0);
+    g_assert_cmpint (snapd_connection_index_get_snap_slots (index, "snap1")->len, ==, 2);
+    g_assert_cmpint (snapd_connection_index_get_snap_slots (index, "snap2")->len, ==, 0);
+
+    /* Slots that a plug can connect to */
+    GPtrArray *candidates = snapd_connection_index_get_interface_slots (index, snapd_plug_get_interface (plug));
+    g_assert_cmpint (candidates->len, ==, 2);
+    g_assert_cmpint (snapd_connection_index_get_interface_plugs (index, "interface")->len, ==, 4);
+    g_assert_cmpint (snapd_connection_index_get_interface_plugs (index, "no-such-interface")->len, ==, 0);
+    g_assert_cmpint (snapd_connection_index_get_interface_connections (index, "interface")->len, ==, 3);
+
+    GPtrArray *connections = snapd_connection_index_get_plug_connections (index, "snap2", "manual-plug");
+    g_assert_cmpint (connections->len, ==, 1);
+    g_assert_true (snapd_connection_get_manual (connections->pdata[0]));
+    g_assert_cmpint (snapd_connection_index_get_plug_connections (index, "snap2", "undesired-plug")->len, ==, 0);
+    g_assert_cmpint (snapd_connection_index_get_slot_connections (index, "snap1", "slot1")->len, ==, 3);
+    g_assert_cmpint (snapd_connection_index_get_slot_connections (index, "snap1", "slot2")->len, ==, 0);
+}
+
 static void
 test_get_connections_attributes (void)
 {
@@ -4260,6 +5480,111 @@ test_find_bad_query (void)
     g_assert_null (snaps);
 }
 
+static void
+find_stream_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    StreamSnapsData *data = user_data;
+
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *suggested_currency = NULL;
+    g_assert_true (snapd_client_find_stream_finish (SNAPD_CLIENT (object), result, &suggested_currency, &error));
+    g_assert_no_error (error);
+    g_assert_cmpstr (suggested_currency, ==, "NZD");
+    g_assert_cmpint (data->snaps->len, ==, 2);
+    g_assert_cmpstr (snapd_snap_get_name (data->snaps->pdata[0]), ==, "carrot1");
+    g_assert_cmpstr (snapd_snap_get_name (data->snaps->pdata[1]), ==, "carrot2");
+    g_assert_cmpstr (snapd_snap_get_description (data->snaps->pdata[1]), ==, "DESCRIPTION \"with quotes\" [and brackets]");
+
+    g_main_loop_quit (data->loop);
+}
+
+static void
+test_find_shared_strings (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    for (int i = 0; i < 2; i++) {
+        g_autofree gchar *name = g_strdup_printf ("snap%d", i);
+        MockSnap *s = mock_snapd_add_store_snap (snapd, name);
+        mock_snap_set_license (s, "GPL-3.0");
+        mock_snap_set_publisher_id (s, "PUBLISHER-ID");
+    }
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_autoptr(GPtrArray) snaps = snapd_client_find_sync (client, SNAPD_FIND_FLAGS_NONE, "snap", NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (snaps);
+    g_assert_cmpint (snaps->len, ==, 2);
+
+    /* Repeated values share memory */
+    SnapdSnap *snap0 = snaps->pdata[0], *snap1 = snaps->pdata[1];
+    g_assert_cmpstr (snapd_snap_get_publisher_id (snap0), ==, "PUBLISHER-ID");
+    g_assert_true (snapd_snap_get_publisher_id (snap0) == snapd_snap_get_publisher_id (snap1));
+    g_assert_cmpstr (snapd_snap_get_license (snap0), ==, "GPL-3.0");
+    g_assert_true (snapd_snap_get_license (snap0) == snapd_snap_get_license (snap1));
+}
+
+static void
+test_find_stream (void)
+{
+    g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    mock_snapd_set_suggested_currency (snapd, "NZD");
+    mock_snapd_add_store_snap (snapd, "apple");
+    mock_snapd_add_store_snap (snapd, "carrot1");
+    MockSnap *s = mock_snapd_add_store_snap (snapd, "carrot2");
+    mock_snap_set_description (s, "DESCRIPTION \"with quotes\" [and brackets]");
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_autoptr(GPtrArray) snaps = g_ptr_array_new_with_free_func (g_object_unref);
+    StreamSnapsData data = { loop, snaps };
+    snapd_client_find_stream_async (client, SNAPD_FIND_FLAGS_NONE, NULL, "carrot", stream_snap_cb, &data, NULL, find_stream_cb, &data);
+    g_main_loop_run (loop);
+}
+
+static void
+find_stream_bad_query_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    StreamSnapsData *data = user_data;
+
+    g_autoptr(GError) error = NULL;
+    g_assert_false (snapd_client_find_stream_finish (SNAPD_CLIENT (object), result, NULL, &error));
+    g_assert_error (error, SNAPD_ERROR, SNAPD_ERROR_BAD_QUERY);
+    g_assert_cmpint (data->snaps->len, ==, 0);
+
+    g_main_loop_quit (data->loop);
+}
+
+static void
+test_find_stream_bad_query (void)
+{
+    g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    // '?' is not allowed in queries
+    g_autoptr(GPtrArray) snaps = g_ptr_array_new_with_free_func (g_object_unref);
+    StreamSnapsData data = { loop, snaps };
+    snapd_client_find_stream_async (client, SNAPD_FIND_FLAGS_NONE, NULL, "snap?", stream_snap_cb, &data, NULL, find_stream_bad_query_cb, &data);
+    g_main_loop_run (loop);
+}
+
 static void
 test_find_network_timeout (void)
 {
@@ -5009,6 +6334,57 @@ test_install_async_multiple (void)
     g_main_loop_run (loop);
 }
 
+static void
+check_install_async_multiple_poll (gboolean set_max_connections, guint max_connections)
+{
+    g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    mock_snapd_add_store_snap (snapd, "snap1");
+    mock_snapd_add_store_snap (snapd, "snap2");
+    mock_snapd_add_store_snap (snapd, "snap3");
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+    if (set_max_connections)
+        snapd_client_set_max_connections (client, max_connections);
+
+    AsyncData *data = async_data_new (loop, snapd);
+    data->counter = 3;
+    snapd_client_install2_async (client, SNAPD_INSTALL_FLAGS_NONE, "snap1", NULL, NULL, NULL, NULL, NULL, install_multiple_cb, data);
+    snapd_client_install2_async (client, SNAPD_INSTALL_FLAGS_NONE, "snap2", NULL, NULL, NULL, NULL, NULL, install_multiple_cb, data);
+    snapd_client_install2_async (client, SNAPD_INSTALL_FLAGS_NONE, "snap3", NULL, NULL, NULL, NULL, NULL, install_multiple_cb, data);
+    g_main_loop_run (loop);
+
+    /* Changes are polled together */
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/changes"), >, 0);
+
+    /* Notices aren't supported, so only tried once */
+    g_assert_cmpint (mock_snapd_get_n_requests (snapd, "/v2/notices"), ==, 1);
+}
+
+static void
+test_install_async_multiple_poll (void)
+{
+    /* Notices are requested with the default settings, on a connection not counted in max-connections */
+    check_install_async_multiple_poll (FALSE, 0);
+}
+
+static void
+test_install_async_multiple_poll_connections (void)
+{
+    check_install_async_multiple_poll (TRUE, 2);
+}
+
+static void
+test_install_async_multiple_poll_thread_connections (void)
+{
+    check_install_async_multiple_poll (TRUE, 0);
+}
+
 static void
 install_failure_cb (GObject *object, GAsyncResult *result, gpointer user_data)
 {
@@ -5712,6 +7088,89 @@ test_install_stream_progress (void)
     g_assert_cmpint (install_stream_progress_data.progress_done, >, 0);
 }
 
+typedef struct
+{
+    int n_calls;
+    guint64 n_bytes;
+    guint64 total_bytes;
+} UploadProgressData;
+
+static void
+upload_progress_cb (SnapdClient *client, guint64 n_bytes, guint64 total_bytes, gpointer user_data)
+{
+    UploadProgressData *data = user_data;
+
+    g_assert_cmpint (n_bytes, >=, data->n_bytes);
+    data->n_calls++;
+    data->n_bytes = n_bytes;
+    data->total_bytes = total_bytes;
+}
+
+static void
+test_install_stream_upload_progress (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    /* Length is not known, so sent in chunks */
+    g_autoptr(GInputStream) stream = g_memory_input_stream_new_from_data ("SNAP", 4, NULL);
+    UploadProgressData upload_progress_data = { 0 };
+    gboolean result = snapd_client_install_stream2_sync (client, SNAPD_INSTALL_FLAGS_NONE, stream, upload_progress_cb, &upload_progress_data, NULL, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_true (result);
+    MockSnap *snap = mock_snapd_find_snap (snapd, "sideload");
+    g_assert_nonnull (snap);
+    g_assert_cmpstr (mock_snap_get_data (snap), ==, "SNAP");
+    g_assert_cmpint (upload_progress_data.n_calls, >, 0);
+    g_assert_cmpint (upload_progress_data.n_bytes, ==, 4);
+    g_assert_cmpint (upload_progress_data.total_bytes, ==, 0);
+}
+
+static void
+test_install_stream_file (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    /* Larger than the socket buffer so it has to be sent in multiple writes */
+    gsize snap_length = 1024 * 1024;
+    g_autofree gchar *snap_data = g_malloc (snap_length + 1);
+    for (gsize i = 0; i < snap_length; i++)
+        snap_data[i] = 'a' + i % 26;
+    snap_data[snap_length] = '\0';
+    g_autofree gchar *path = NULL;
+    int fd = g_file_open_tmp ("snapd-glib-test-XXXXXX.snap", &path, &error);
+    g_assert_no_error (error);
+    close (fd);
+    g_assert_true (g_file_set_contents (path, snap_data, snap_length, &error));
+    g_assert_no_error (error);
+
+    /* Length is known, so sent directly from the file */
+    g_autoptr(GFile) file = g_file_new_for_path (path);
+    g_autoptr(GFileInputStream) stream = g_file_read (file, NULL, &error);
+    g_assert_no_error (error);
+    UploadProgressData upload_progress_data = { 0 };
+    gboolean result = snapd_client_install_stream2_sync (client, SNAPD_INSTALL_FLAGS_NONE, G_INPUT_STREAM (stream), upload_progress_cb, &upload_progress_data, NULL, NULL, NULL, &error);
+    g_unlink (path);
+    g_assert_no_error (error);
+    g_assert_true (result);
+    MockSnap *snap = mock_snapd_find_snap (snapd, "sideload");
+    g_assert_nonnull (snap);
+    g_assert_cmpstr (mock_snap_get_data (snap), ==, snap_data);
+    g_assert_cmpint (upload_progress_data.n_bytes, ==, snap_length);
+    g_assert_cmpint (upload_progress_data.total_bytes, ==, snap_length);
+}
+
 static void
 test_install_stream_classic (void)
 {
@@ -7735,6 +9194,118 @@ test_download_channel_revision (void)
     g_assert_cmpmem (g_bytes_get_data (snap_data, NULL), g_bytes_get_size (snap_data), "SNAP:name=test:channel=CHANNEL:revision=REVISION", 48);
 }
 
+static void
+download_progress_cb (SnapdClient *client, guint64 n_bytes, guint64 total_bytes, gpointer user_data)
+{
+    guint64 *last_n_bytes = user_data;
+
+    g_assert_cmpint (n_bytes, >, *last_n_bytes);
+    g_assert_cmpint (n_bytes, <=, total_bytes);
+    *last_n_bytes = n_bytes;
+}
+
+static void
+test_download_to_stream_sync (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_autoptr(GOutputStream) stream = g_memory_output_stream_new_resizable ();
+    guint64 n_bytes = 0;
+    g_autofree gchar *resume_token = NULL;
+    gboolean result = snapd_client_download_to_stream_sync (client, "test", "CHANNEL", "REVISION", NULL, 0, stream, download_progress_cb, &n_bytes, &resume_token, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_true (result);
+    g_assert_cmpint (n_bytes, ==, 48);
+    g_assert_cmpstr (resume_token, ==, "TOKEN:test");
+
+    GMemoryOutputStream *memory_stream = G_MEMORY_OUTPUT_STREAM (stream);
+    g_assert_cmpmem (g_memory_output_stream_get_data (memory_stream), g_memory_output_stream_get_data_size (memory_stream), "SNAP:name=test:channel=CHANNEL:revision=REVISION", 48);
+}
+
+static void
+download_to_stream_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+    g_autoptr(AsyncData) data = user_data;
+
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *resume_token = NULL;
+    gboolean r = snapd_client_download_to_stream_finish (SNAPD_CLIENT (object), result, &resume_token, &error);
+    g_assert_no_error (error);
+    g_assert_true (r);
+    g_assert_cmpstr (resume_token, ==, "TOKEN:test");
+
+    g_main_loop_quit (data->loop);
+}
+
+static void
+test_download_to_stream_async (void)
+{
+    g_autoptr(GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_autoptr(GOutputStream) stream = g_memory_output_stream_new_resizable ();
+    snapd_client_download_to_stream_async (client, "test", NULL, NULL, NULL, 0, stream, NULL, NULL, NULL, download_to_stream_cb, async_data_new (loop, snapd));
+    g_main_loop_run (loop);
+
+    GMemoryOutputStream *memory_stream = G_MEMORY_OUTPUT_STREAM (stream);
+    g_assert_cmpmem (g_memory_output_stream_get_data (memory_stream), g_memory_output_stream_get_data_size (memory_stream), "SNAP:name=test", 14);
+}
+
+static void
+test_download_to_stream_resume (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    /* Continue after the first five bytes ("SNAP:") were received */
+    g_autoptr(GOutputStream) stream = g_memory_output_stream_new_resizable ();
+    g_assert_true (g_output_stream_write_all (stream, "SNAP:", 5, NULL, NULL, &error));
+    guint64 n_bytes = 5;
+    gboolean result = snapd_client_download_to_stream_sync (client, "test", NULL, NULL, "TOKEN:test", 5, stream, download_progress_cb, &n_bytes, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_true (result);
+    g_assert_cmpint (n_bytes, ==, 14);
+
+    GMemoryOutputStream *memory_stream = G_MEMORY_OUTPUT_STREAM (stream);
+    g_assert_cmpmem (g_memory_output_stream_get_data (memory_stream), g_memory_output_stream_get_data_size (memory_stream), "SNAP:name=test", 14);
+}
+
+static void
+test_download_to_stream_invalid_token (void)
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+
+    g_autoptr(GError) error = NULL;
+    g_assert_true (mock_snapd_start (snapd, &error));
+
+    g_autoptr(SnapdClient) client = snapd_client_new ();
+    snapd_client_set_socket_path (client, mock_snapd_get_socket_path (snapd));
+
+    g_autoptr(GOutputStream) stream = g_memory_output_stream_new_resizable ();
+    gboolean result = snapd_client_download_to_stream_sync (client, "test", NULL, NULL, "TOKEN:other", 5, stream, NULL, NULL, NULL, NULL, &error);
+    g_assert_error (error, SNAPD_ERROR, SNAPD_ERROR_BAD_REQUEST);
+    g_assert_false (result);
+    g_assert_cmpint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (stream)), ==, 0);
+}
+
 static void
 test_stress (void)
 {
@@ -7771,6 +9342,14 @@ main (int argc, char **argv)
     g_test_add_func ("/accept-language/basic", test_accept_language);
     g_test_add_func ("/accept-language/empty", test_accept_language_empty);
     g_test_add_func ("/allow-interaction/basic", test_allow_interaction);
+    g_test_add_func ("/pipeline/depth", test_pipeline_depth);
+    g_test_add_func ("/pipeline/max-queued", test_pipeline_max_queued);
+    g_test_add_func ("/connection-pool/basic", test_connection_pool);
+    g_test_add_func ("/connection-pool/sync-threads", test_connection_pool_sync_threads);
+    g_test_add_func ("/parse-in-thread/basic", test_parse_in_thread);
+    g_test_add_func ("/lazy-snaps/basic", test_lazy_snaps);
+    g_test_add_func ("/response-cache/basic", test_response_cache);
+    g_test_add_func ("/response-cache/cancel", test_response_cache_cancel);
     g_test_add_func ("/maintenance/none", test_maintenance_none);
     g_test_add_func ("/maintenance/daemon-restart", test_maintenance_daemon_restart);
     g_test_add_func ("/maintenance/system-restart", test_maintenance_system_restart);
@@ -7803,11 +9382,15 @@ main (int argc, char **argv)
     g_test_add_func ("/get-change/async", test_get_change_async);
     g_test_add_func ("/abort-change/sync", test_abort_change_sync);
     g_test_add_func ("/abort-change/async", test_abort_change_async);
+    g_test_add_func ("/watch-change/async", test_watch_change_async);
+    g_test_add_func ("/watch-change/task-delta", test_watch_change_task_delta);
     g_test_add_func ("/list/sync", test_list_sync);
     g_test_add_func ("/list/async", test_list_async);
     g_test_add_func ("/get-snaps/sync", test_get_snaps_sync);
     g_test_add_func ("/get-snaps/async", test_get_snaps_async);
     g_test_add_func ("/get-snaps/filter", test_get_snaps_filter);
+    g_test_add_func ("/get-snaps/stream", test_get_snaps_stream);
+    g_test_add_func ("/update-snap-set/basic", test_update_snap_set);
     g_test_add_func ("/list-one/sync", test_list_one_sync);
     g_test_add_func ("/list-one/async", test_list_one_async);
     g_test_add_func ("/get-snap/sync", test_get_snap_sync);
@@ -7838,16 +9421,27 @@ main (int argc, char **argv)
     g_test_add_func ("/icon/async", test_icon_async);
     g_test_add_func ("/icon/not-installed", test_icon_not_installed);
     g_test_add_func ("/icon/large", test_icon_large);
+    g_test_add_func ("/icon-cache/basic", test_icon_cache);
+    g_test_add_func ("/icon-cache/evict", test_icon_cache_evict);
+    g_test_add_func ("/get-icons/sync", test_get_icons_sync);
+    g_test_add_func ("/get-icons/shared", test_get_icons_shared);
     g_test_add_func ("/get-assertions/sync", test_get_assertions_sync);
     //g_test_add_func ("/get-assertions/async", test_get_assertions_async);
     g_test_add_func ("/get-assertions/body", test_get_assertions_body);
     g_test_add_func ("/get-assertions/multiple", test_get_assertions_multiple);
+    g_test_add_func ("/get-assertions/filter", test_get_assertions_filter);
+    g_test_add_func ("/get-assertions/headers-only", test_get_assertions_headers_only);
+    g_test_add_func ("/get-assertions/stream", test_get_assertions_stream);
     g_test_add_func ("/get-assertions/invalid", test_get_assertions_invalid);
     g_test_add_func ("/add-assertions/sync", test_add_assertions_sync);
+    g_test_add_func ("/import-assertions/basic", test_import_assertions);
+    g_test_add_func ("/import-assertions/cancel", test_import_assertions_cancel);
     //g_test_add_func ("/add-assertions/async", test_add_assertions_async);
     g_test_add_func ("/assertions/sync", test_assertions_sync);
     //g_test_add_func ("/assertions/async", test_assertions_async);
     g_test_add_func ("/assertions/body", test_assertions_body);
+    g_test_add_func ("/assertions/peek", test_assertions_peek);
+    g_test_add_func ("/assertions/no-body", test_assertions_no_body);
     g_test_add_func ("/get-connections/sync", test_get_connections_sync);
     g_test_add_func ("/get-connections/async", test_get_connections_async);
     g_test_add_func ("/get-connections/empty", test_get_connections_empty);
@@ -7855,6 +9449,7 @@ main (int argc, char **argv)
     g_test_add_func ("/get-connections/filter-snap", test_get_connections_filter_snap);
     g_test_add_func ("/get-connections/filter-interface", test_get_connections_filter_interface);
     g_test_add_func ("/get-connections/attributes", test_get_connections_attributes);
+    g_test_add_func ("/get-connections/index", test_get_connection_index_sync);
     g_test_add_func ("/get-interfaces/sync", test_get_interfaces_sync);
     g_test_add_func ("/get-interfaces/async", test_get_interfaces_async);
     g_test_add_func ("/get-interfaces/no-snaps", test_get_interfaces_no_snaps);
@@ -7893,6 +9488,9 @@ main (int argc, char **argv)
     g_test_add_func ("/find/scope-narrow", test_find_scope_narrow);
     g_test_add_func ("/find/scope-wide", test_find_scope_wide);
     g_test_add_func ("/find/common-id", test_find_common_id);
+    g_test_add_func ("/find/shared-strings", test_find_shared_strings);
+    g_test_add_func ("/find/stream", test_find_stream);
+    g_test_add_func ("/find/stream-bad-query", test_find_stream_bad_query);
     g_test_add_func ("/find-refreshable/sync", test_find_refreshable_sync);
     g_test_add_func ("/find-refreshable/async", test_find_refreshable_async);
     g_test_add_func ("/find-refreshable/no-updates", test_find_refreshable_no_updates);
@@ -7900,6 +9498,9 @@ main (int argc, char **argv)
     g_test_add_func ("/install/sync-multiple", test_install_sync_multiple);
     g_test_add_func ("/install/async", test_install_async);
     g_test_add_func ("/install/async-multiple", test_install_async_multiple);
+    g_test_add_func ("/install/async-multiple-poll", test_install_async_multiple_poll);
+    g_test_add_func ("/install/async-multiple-poll-connections", test_install_async_multiple_poll_connections);
+    g_test_add_func ("/install/async-multiple-poll-thread-connections", test_install_async_multiple_poll_thread_connections);
     g_test_add_func ("/install/async-failure", test_install_async_failure);
     g_test_add_func ("/install/async-cancel", test_install_async_cancel);
     g_test_add_func ("/install/async-multiple-cancel-first", test_install_async_multiple_cancel_first);
@@ -7924,6 +9525,8 @@ main (int argc, char **argv)
     g_test_add_func ("/install-stream/sync", test_install_stream_sync);
     g_test_add_func ("/install-stream/async", test_install_stream_async);
     g_test_add_func ("/install-stream/progress", test_install_stream_progress);
+    g_test_add_func ("/install-stream/upload-progress", test_install_stream_upload_progress);
+    g_test_add_func ("/install-stream/file", test_install_stream_file);
     g_test_add_func ("/install-stream/classic", test_install_stream_classic);
     g_test_add_func ("/install-stream/dangerous", test_install_stream_dangerous);
     g_test_add_func ("/install-stream/devmode", test_install_stream_devmode);
@@ -8001,6 +9604,10 @@ main (int argc, char **argv)
     g_test_add_func ("/download/sync", test_download_sync);
     g_test_add_func ("/download/async", test_download_async);
     g_test_add_func ("/download/channel-revision", test_download_channel_revision);
+    g_test_add_func ("/download-to-stream/sync", test_download_to_stream_sync);
+    g_test_add_func ("/download-to-stream/async", test_download_to_stream_async);
+    g_test_add_func ("/download-to-stream/resume", test_download_to_stream_resume);
+    g_test_add_func ("/download-to-stream/invalid-token", test_download_to_stream_invalid_token);
     g_test_add_func ("/stress/basic", test_stress);
 
     return g_test_run ();
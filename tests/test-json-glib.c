@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2026 Canonical Ltd.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 2 or version 3 of the License.
+ * See http://www.gnu.org/copyleft/lgpl.html the full text of the license.
+ */
+
+#include <string.h>
+#include <snapd-glib/snapd-glib.h>
+
+#include "snapd-json.h"
+
+static SnapdSnap *
+parse_snap (const gchar *data, SnapdJsonParser parser, gboolean defer_members)
+{
+    g_autoptr(SnapdStringPool) pool = _snapd_string_pool_new ();
+    g_autoptr(GError) error = NULL;
+    SnapdSnap *snap = _snapd_json_parse_snap_data (data, strlen (data), pool, defer_members, parser, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (snap);
+
+    return snap;
+}
+
+static void
+assert_date_times_equal (GDateTime *a, GDateTime *b)
+{
+    if (a == NULL || b == NULL)
+        g_assert_true (a == b);
+    else
+        g_assert_true (g_date_time_equal (a, b));
+}
+
+static void
+assert_strvs_equal (GStrv a, GStrv b)
+{
+    g_assert_cmpint (g_strv_length (a), ==, g_strv_length (b));
+    for (int i = 0; a[i] != NULL; i++)
+        g_assert_cmpstr (a[i], ==, b[i]);
+}
+
+static void
+assert_snaps_equal (SnapdSnap *a, SnapdSnap *b)
+{
+    GPtrArray *apps_a = snapd_snap_get_apps (a), *apps_b = snapd_snap_get_apps (b);
+    g_assert_cmpint (apps_a->len, ==, apps_b->len);
+    for (guint i = 0; i < apps_a->len; i++) {
+        SnapdApp *app_a = apps_a->pdata[i], *app_b = apps_b->pdata[i];
+        g_assert_cmpstr (snapd_app_get_name (app_a), ==, snapd_app_get_name (app_b));
+        g_assert_cmpstr (snapd_app_get_snap (app_a), ==, snapd_app_get_snap (app_b));
+        g_assert_cmpstr (snapd_app_get_common_id (app_a), ==, snapd_app_get_common_id (app_b));
+        g_assert_cmpint (snapd_app_get_daemon_type (app_a), ==, snapd_app_get_daemon_type (app_b));
+        g_assert_cmpstr (snapd_app_get_desktop_file (app_a), ==, snapd_app_get_desktop_file (app_b));
+        g_assert_cmpint (snapd_app_get_enabled (app_a), ==, snapd_app_get_enabled (app_b));
+        g_assert_cmpint (snapd_app_get_active (app_a), ==, snapd_app_get_active (app_b));
+    }
+    g_assert_cmpstr (snapd_snap_get_base (a), ==, snapd_snap_get_base (b));
+    g_assert_cmpstr (snapd_snap_get_broken (a), ==, snapd_snap_get_broken (b));
+    g_assert_cmpstr (snapd_snap_get_channel (a), ==, snapd_snap_get_channel (b));
+    GPtrArray *channels_a = snapd_snap_get_channels (a), *channels_b = snapd_snap_get_channels (b);
+    g_assert_cmpint (channels_a->len, ==, channels_b->len);
+    for (guint i = 0; i < channels_a->len; i++) {
+        SnapdChannel *channel_a = channels_a->pdata[i], *channel_b = channels_b->pdata[i];
+        g_assert_cmpstr (snapd_channel_get_name (channel_a), ==, snapd_channel_get_name (channel_b));
+        g_assert_cmpint (snapd_channel_get_confinement (channel_a), ==, snapd_channel_get_confinement (channel_b));
+        g_assert_cmpstr (snapd_channel_get_epoch (channel_a), ==, snapd_channel_get_epoch (channel_b));
+        assert_date_times_equal (snapd_channel_get_released_at (channel_a), snapd_channel_get_released_at (channel_b));
+        g_assert_cmpstr (snapd_channel_get_revision (channel_a), ==, snapd_channel_get_revision (channel_b));
+        g_assert_cmpint (snapd_channel_get_size (channel_a), ==, snapd_channel_get_size (channel_b));
+        g_assert_cmpstr (snapd_channel_get_version (channel_a), ==, snapd_channel_get_version (channel_b));
+    }
+    assert_strvs_equal (snapd_snap_get_common_ids (a), snapd_snap_get_common_ids (b));
+    g_assert_cmpint (snapd_snap_get_confinement (a), ==, snapd_snap_get_confinement (b));
+    g_assert_cmpstr (snapd_snap_get_contact (a), ==, snapd_snap_get_contact (b));
+    g_assert_cmpstr (snapd_snap_get_description (a), ==, snapd_snap_get_description (b));
+    g_assert_cmpint (snapd_snap_get_devmode (a), ==, snapd_snap_get_devmode (b));
+    g_assert_cmpint (snapd_snap_get_download_size (a), ==, snapd_snap_get_download_size (b));
+    g_assert_cmpstr (snapd_snap_get_icon (a), ==, snapd_snap_get_icon (b));
+    g_assert_cmpstr (snapd_snap_get_id (a), ==, snapd_snap_get_id (b));
+    assert_date_times_equal (snapd_snap_get_install_date (a), snapd_snap_get_install_date (b));
+    g_assert_cmpint (snapd_snap_get_installed_size (a), ==, snapd_snap_get_installed_size (b));
+    g_assert_cmpint (snapd_snap_get_jailmode (a), ==, snapd_snap_get_jailmode (b));
+    g_assert_cmpstr (snapd_snap_get_license (a), ==, snapd_snap_get_license (b));
+    GPtrArray *media_a = snapd_snap_get_media (a), *media_b = snapd_snap_get_media (b);
+    g_assert_cmpint (media_a->len, ==, media_b->len);
+    for (guint i = 0; i < media_a->len; i++) {
+        SnapdMedia *m_a = media_a->pdata[i], *m_b = media_b->pdata[i];
+        g_assert_cmpstr (snapd_media_get_media_type (m_a), ==, snapd_media_get_media_type (m_b));
+        g_assert_cmpstr (snapd_media_get_url (m_a), ==, snapd_media_get_url (m_b));
+        g_assert_cmpint (snapd_media_get_width (m_a), ==, snapd_media_get_width (m_b));
+        g_assert_cmpint (snapd_media_get_height (m_a), ==, snapd_media_get_height (m_b));
+    }
+    g_assert_cmpstr (snapd_snap_get_mounted_from (a), ==, snapd_snap_get_mounted_from (b));
+    g_assert_cmpstr (snapd_snap_get_name (a), ==, snapd_snap_get_name (b));
+    GPtrArray *prices_a = snapd_snap_get_prices (a), *prices_b = snapd_snap_get_prices (b);
+    g_assert_cmpint (prices_a->len, ==, prices_b->len);
+    for (guint i = 0; i < prices_a->len; i++) {
+        SnapdPrice *p_a = prices_a->pdata[i], *p_b = prices_b->pdata[i];
+        g_assert_cmpfloat (snapd_price_get_amount (p_a), ==, snapd_price_get_amount (p_b));
+        g_assert_cmpstr (snapd_price_get_currency (p_a), ==, snapd_price_get_currency (p_b));
+    }
+    g_assert_cmpint (snapd_snap_get_private (a), ==, snapd_snap_get_private (b));
+    g_assert_cmpstr (snapd_snap_get_publisher_display_name (a), ==, snapd_snap_get_publisher_display_name (b));
+    g_assert_cmpstr (snapd_snap_get_publisher_id (a), ==, snapd_snap_get_publisher_id (b));
+    g_assert_cmpstr (snapd_snap_get_publisher_username (a), ==, snapd_snap_get_publisher_username (b));
+    g_assert_cmpint (snapd_snap_get_publisher_validation (a), ==, snapd_snap_get_publisher_validation (b));
+    g_assert_cmpstr (snapd_snap_get_revision (a), ==, snapd_snap_get_revision (b));
+    g_assert_cmpint (snapd_snap_get_snap_type (a), ==, snapd_snap_get_snap_type (b));
+    g_assert_cmpint (snapd_snap_get_status (a), ==, snapd_snap_get_status (b));
+    g_assert_cmpstr (snapd_snap_get_summary (a), ==, snapd_snap_get_summary (b));
+    g_assert_cmpstr (snapd_snap_get_title (a), ==, snapd_snap_get_title (b));
+    g_assert_cmpstr (snapd_snap_get_tracking_channel (a), ==, snapd_snap_get_tracking_channel (b));
+    assert_strvs_equal (snapd_snap_get_tracks (a), snapd_snap_get_tracks (b));
+    g_assert_cmpint (snapd_snap_get_trymode (a), ==, snapd_snap_get_trymode (b));
+    g_assert_cmpstr (snapd_snap_get_version (a), ==, snapd_snap_get_version (b));
+    g_assert_cmpstr (snapd_snap_get_website (a), ==, snapd_snap_get_website (b));
+}
+
+static void
+check_parsers_match (const gchar *data)
+{
+    g_autoptr(SnapdSnap) expected = parse_snap (data, SNAPD_JSON_PARSER_JSON_GLIB, FALSE);
+    g_autoptr(SnapdSnap) snap = parse_snap (data, SNAPD_JSON_PARSER_TOKENIZER, FALSE);
+    assert_snaps_equal (snap, expected);
+    g_autoptr(SnapdSnap) deferred_snap = parse_snap (data, SNAPD_JSON_PARSER_TOKENIZER, TRUE);
+    assert_snaps_equal (deferred_snap, expected);
+}
+
+static void
+test_json_snap_empty (void)
+{
+    check_parsers_match ("{}");
+}
+
+static void
+test_json_snap_installed (void)
+{
+    check_parsers_match ("{\"id\":\"ID\",\"name\":\"snap\",\"title\":\"TITLE\",\"summary\":\"SUMMARY\","
+                         "\"description\":\"DESCRIPTION\",\"icon\":\"/icon\",\"installed-size\":1024,"
+                         "\"install-date\":\"2017-01-02T11:23:58Z\",\"status\":\"active\",\"type\":\"app\","
+                         "\"base\":\"core20\",\"version\":\"1.0\",\"channel\":\"stable\",\"tracking-channel\":\"latest/stable\","
+                         "\"revision\":\"1\",\"confinement\":\"classic\",\"devmode\":true,\"jailmode\":true,\"trymode\":true,"
+                         "\"private\":true,\"broken\":\"BROKEN\",\"mounted-from\":\"MOUNTED-FROM\",\"license\":\"GPL-3.0\","
+                         "\"contact\":\"CONTACT\",\"website\":\"WEBSITE\",\"common-ids\":[\"ID1\",\"ID2\"],"
+                         "\"publisher\":{\"id\":\"PUBLISHER-ID\",\"username\":\"PUBLISHER-USERNAME\",\"display-name\":\"PUBLISHER-DISPLAY-NAME\",\"validation\":\"verified\"},"
+                         "\"developer\":\"PUBLISHER-USERNAME\","
+                         "\"apps\":[{\"snap\":\"snap\",\"name\":\"app\",\"common-id\":\"ID1\",\"daemon\":\"simple\",\"desktop-file\":\"/app.desktop\",\"enabled\":true,\"active\":true},"
+                         "{\"name\":\"app2\",\"daemon\":\"unknown-daemon\"}]}");
+}
+
+static void
+test_json_snap_store (void)
+{
+    check_parsers_match ("{\"id\":\"ID\",\"name\":\"snap\",\"download-size\":65535,\"status\":\"available\",\"type\":\"app\","
+                         "\"tracks\":[\"latest\",\"insider\"],"
+                         "\"media\":[{\"type\":\"icon\",\"url\":\"icon.png\",\"width\":128,\"height\":128},{\"type\":\"screenshot\",\"url\":\"screenshot.png\"}],"
+                         "\"prices\":{\"NZD\":1.25,\"USD\":0.75},"
+                         "\"channels\":{\"latest/stable\":{\"revision\":\"1\",\"version\":\"1.0\",\"channel\":\"stable\",\"epoch\":\"0\","
+                         "\"confinement\":\"strict\",\"size\":65535,\"released-at\":\"2018-01-19T13:14:15Z\"},"
+                         "\"insider/edge\":{\"revision\":\"2\",\"channel\":\"insider/edge\",\"confinement\":\"devmode\"}}}");
+}
+
+static void
+test_json_snap_escapes (void)
+{
+    check_parsers_match ("{\"name\":\"snap\",\"title\":\"Title with \\\"quotes\\\" and \\u00e9\","
+                         "\"description\":\"A long description\\nover several lines\\n\\twith tabs and escaped characters \\/\\\\\","
+                         "\"summary\":\"\\ud83d\\ude00 \\b\\f\\r\",\"publisher\":{\"display-name\":\"Caf\xc3\xa9\"}}");
+}
+
+static void
+test_json_snap_unexpected (void)
+{
+    /* Unknown members, nulls and values of the wrong type */
+    check_parsers_match ("{\"name\":\"snap\",\"unknown\":{\"nested\":[1,2.5e3,{\"a\":null}],\"b\":true},"
+                         "\"title\":null,\"download-size\":\"large\",\"devmode\":\"yes\",\"apps\":{},\"channels\":[],"
+                         "\"media\":null,\"prices\":\"free\",\"tracks\":null,\"common-ids\":[]}");
+
+    /* Numbers in different forms */
+    check_parsers_match ("{\"name\":\"snap\",\"installed-size\":-0,\"download-size\":1e3,"
+                         "\"prices\":{\"NZD\":1,\"USD\":-2.5E-1}}");
+
+    /* Whitespace everywhere it is allowed */
+    check_parsers_match (" { \"name\" : \"snap\" ,\n\t\"apps\" : [ { \"name\" : \"app\" } ] ,\r\n\"tracks\" : [ \"latest\" ] } ");
+}
+
+int
+main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/json/snap/empty", test_json_snap_empty);
+    g_test_add_func ("/json/snap/installed", test_json_snap_installed);
+    g_test_add_func ("/json/snap/store", test_json_snap_store);
+    g_test_add_func ("/json/snap/escapes", test_json_snap_escapes);
+    g_test_add_func ("/json/snap/unexpected", test_json_snap_unexpected);
+
+    return g_test_run ();
+}
@@ -317,6 +317,16 @@ test_markdown_lists (void)
     g_assert_cmpstr (example287, ==, "<ul>\n<li>\n<p>a</p>\n<ul>\n<li>b</li>\n<li>c</li>\n</ul>\n</li>\n<li>\n<p>d</p>\n<ul>\n<li>e</li>\n<li>f</li>\n</ul>\n</li>\n</ul>\n");
 }
 
+static void
+test_markdown_nested_lists (void)
+{
+    g_autofree gchar *nested = parse ("- a\n  - b\n    - c\n\n      d\n  - e\n- f\n");
+    g_assert_cmpstr (nested, ==, "<ul>\n<li>\n<p>a</p>\n<ul>\n<li>\n<p>b</p>\n<ul>\n<li>\n<p>c</p>\n<p>d</p>\n</li>\n</ul>\n</li>\n<li>e</li>\n</ul>\n</li>\n<li>f</li>\n</ul>\n");
+
+    g_autofree gchar *crlf = parse ("- a\r\n  - b\r\n- c\r\n");
+    g_assert_cmpstr (crlf, ==, "<ul>\n<li>\n<p>a</p>\n<ul>\n<li>b</li>\n</ul>\n</li>\n<li>c</li>\n</ul>\n");
+}
+
 static void
 test_markdown_inlines (void)
 {
@@ -337,6 +347,9 @@ test_markdown_inlines (void)
 
     g_autofree gchar *example295 = parse ("    \\[\\]\n");
     g_assert_cmpstr (example295, ==, "<pre><code>\\[\\]\n</code></pre>\n");
+
+    g_autofree gchar *trailing_backslash = parse ("foo\\");
+    g_assert_cmpstr (trailing_backslash, ==, "<p>foo\\</p>\n");
 }
 
 static void
@@ -892,6 +905,7 @@ main (int argc, char **argv)
     g_test_add_func ("/markdown/paragraphs", test_markdown_paragraphs);
     g_test_add_func ("/markdown/list-items", test_markdown_list_items);
     g_test_add_func ("/markdown/lists", test_markdown_lists);
+    g_test_add_func ("/markdown/nested-lists", test_markdown_nested_lists);
     g_test_add_func ("/markdown/inlines", test_markdown_inlines);
     g_test_add_func ("/markdown/code-spans", test_markdown_code_spans);
     g_test_add_func ("/markdown/emphasis", test_markdown_emphasis);
@@ -178,6 +178,33 @@ test_allow_interaction ()
     g_assert_cmpstr (mock_snapd_get_last_allow_interaction (snapd), ==, NULL);
 }
 
+static void
+test_connection_pool ()
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    g_assert_true (mock_snapd_start (snapd, NULL));
+
+    QSnapdClient client;
+    client.setSocketPath (mock_snapd_get_socket_path (snapd));
+
+    g_assert_cmpint (client.maxConnections (), ==, 1);
+    g_assert_cmpint (client.nConnections (), ==, 0);
+
+    QScopedPointer<QSnapdGetSystemInformationRequest> infoRequest (client.getSystemInformation ());
+    infoRequest->runSync ();
+    g_assert_cmpint (infoRequest->error (), ==, QSnapdRequest::NoError);
+
+    g_assert_cmpint (client.nConnections (), ==, 1);
+    uint nPending;
+    quint64 nRequests, nBytesSent, nBytesReceived;
+    g_assert_true (client.connectionStats (0, &nPending, &nRequests, &nBytesSent, &nBytesReceived));
+    g_assert_cmpint (nPending, ==, 0);
+    g_assert_cmpint (nRequests, ==, 1);
+    g_assert_cmpint (nBytesSent, >, 0);
+    g_assert_cmpint (nBytesReceived, >, 0);
+    g_assert_false (client.connectionStats (1, NULL, NULL, NULL, NULL));
+}
+
 static void
 test_maintenance_none ()
 {
@@ -2339,6 +2366,36 @@ test_icon_large ()
     g_assert_cmpmem (data.data (), data.size (), icon_buffer, icon_buffer_length);
 }
 
+static void
+test_get_icons_sync ()
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    g_autoptr(GBytes) icon_data = g_bytes_new ("ICON-DATA", 9);
+    MockSnap *s = mock_snapd_add_snap (snapd, "snap1");
+    mock_snap_set_icon_data (s, "image/png", icon_data);
+    s = mock_snapd_add_snap (snapd, "snap2");
+    mock_snap_set_icon_data (s, "image/png", icon_data);
+    g_assert_true (mock_snapd_start (snapd, NULL));
+
+    QSnapdClient client;
+    client.setSocketPath (mock_snapd_get_socket_path (snapd));
+
+    QStringList names;
+    names << "snap1" << "snap2" << "missing";
+    QScopedPointer<QSnapdGetIconsRequest> getIconsRequest (client.getIcons (names, 1));
+    int iconCount = 0;
+    QObject::connect (getIconsRequest.data (), &QSnapdGetIconsRequest::iconReceived,
+                      [&iconCount] (const QString&) { iconCount++; });
+    getIconsRequest->runSync ();
+    g_assert_cmpint (getIconsRequest->error (), ==, QSnapdRequest::NoError);
+    g_assert_cmpint (iconCount, ==, 2);
+    QScopedPointer<QSnapdIcon> icon (getIconsRequest->icon ("snap2"));
+    g_assert_true (icon->mimeType () == "image/png");
+    QByteArray data = icon->data ();
+    g_assert_cmpmem (data.data (), data.size (), "ICON-DATA", 9);
+    g_assert_null (getIconsRequest->icon ("missing"));
+}
+
 static void
 test_get_assertions_sync ()
 {
@@ -2851,6 +2908,45 @@ check_names_match (QStringList names, QStringList &expected_names)
         g_assert_true (sorted_names[i] == sorted_expected_names[i]);
 }
 
+static void
+test_get_connections_index ()
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    setup_get_connections (snapd);
+    g_assert_true (mock_snapd_start (snapd, NULL));
+
+    QSnapdClient client;
+    client.setSocketPath (mock_snapd_get_socket_path (snapd));
+
+    QScopedPointer<QSnapdGetConnectionsRequest> getConnectionsRequest (client.getConnections (QSnapdClient::SelectAll));
+    getConnectionsRequest->runSync ();
+    g_assert_cmpint (getConnectionsRequest->error (), ==, QSnapdRequest::NoError);
+
+    QScopedPointer<QSnapdPlug> plug (getConnectionsRequest->findPlug ("snap2", "manual-plug"));
+    g_assert_false (plug.isNull ());
+    g_assert_true (plug->name () == "manual-plug");
+    QScopedPointer<QSnapdPlug> missingPlug (getConnectionsRequest->findPlug ("snap1", "manual-plug"));
+    g_assert_true (missingPlug.isNull ());
+    QScopedPointer<QSnapdSlot> slot (getConnectionsRequest->findSlot ("snap1", "slot2"));
+    g_assert_false (slot.isNull ());
+    g_assert_true (slot->name () == "slot2");
+
+    g_assert_cmpint (getConnectionsRequest->snapPlugCount ("snap2"), ==, 4);
+    g_assert_cmpint (getConnectionsRequest->snapPlugCount ("snap1"), ==, 0);
+    g_assert_cmpint (getConnectionsRequest->snapSlotCount ("snap1"), ==, 2);
+    QScopedPointer<QSnapdSlot> snapSlot (getConnectionsRequest->snapSlot ("snap1", 1));
+    g_assert_true (snapSlot->name () == "slot2");
+    g_assert_cmpint (getConnectionsRequest->interfacePlugCount ("interface"), ==, 4);
+    g_assert_cmpint (getConnectionsRequest->interfaceSlotCount (plug->interface ()), ==, 2);
+    g_assert_cmpint (getConnectionsRequest->interfaceSlotCount ("no-such-interface"), ==, 0);
+
+    g_assert_cmpint (getConnectionsRequest->plugConnectionCount ("snap2", "manual-plug"), ==, 1);
+    QScopedPointer<QSnapdConnection> connection (getConnectionsRequest->plugConnection ("snap2", "manual-plug", 0));
+    g_assert_true (connection->manual ());
+    g_assert_cmpint (getConnectionsRequest->slotConnectionCount ("snap1", "slot1"), ==, 3);
+    g_assert_cmpint (getConnectionsRequest->slotConnectionCount ("snap1", "slot2"), ==, 0);
+}
+
 static void
 test_get_connections_attributes ()
 {
@@ -6817,6 +6913,49 @@ test_download_channel_revision ()
     g_assert_cmpmem (data.data (), data.size (), "SNAP:name=test:channel=CHANNEL:revision=REVISION", 48);
 }
 
+static void
+test_download_to_device ()
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    g_assert_true (mock_snapd_start (snapd, NULL));
+
+    QSnapdClient client;
+    client.setSocketPath (mock_snapd_get_socket_path (snapd));
+
+    QBuffer buffer;
+    buffer.open (QBuffer::ReadWrite);
+    QScopedPointer<QSnapdDownloadRequest> downloadRequest (client.download ("test", "CHANNEL", "REVISION", &buffer));
+    qint64 bytesReceived = 0;
+    QObject::connect (downloadRequest.data (), &QSnapdDownloadRequest::downloadProgress,
+                      [&bytesReceived] (qint64 received, qint64 total) {
+                          g_assert_cmpint (received, <=, total);
+                          bytesReceived = received;
+                      });
+    downloadRequest->runSync ();
+    g_assert_cmpint (downloadRequest->error (), ==, QSnapdRequest::NoError);
+    g_assert_cmpint (bytesReceived, ==, 48);
+    g_assert_true (downloadRequest->resumeToken () == "TOKEN:test");
+    g_assert_cmpmem (buffer.data ().data (), buffer.data ().size (), "SNAP:name=test:channel=CHANNEL:revision=REVISION", 48);
+}
+
+static void
+test_download_to_device_resume ()
+{
+    g_autoptr(MockSnapd) snapd = mock_snapd_new ();
+    g_assert_true (mock_snapd_start (snapd, NULL));
+
+    QSnapdClient client;
+    client.setSocketPath (mock_snapd_get_socket_path (snapd));
+
+    QBuffer buffer;
+    buffer.open (QBuffer::ReadWrite);
+    buffer.write ("SNAP:");
+    QScopedPointer<QSnapdDownloadRequest> downloadRequest (client.download ("test", NULL, NULL, "TOKEN:test", 5, &buffer));
+    downloadRequest->runSync ();
+    g_assert_cmpint (downloadRequest->error (), ==, QSnapdRequest::NoError);
+    g_assert_cmpmem (buffer.data ().data (), buffer.data ().size (), "SNAP:name=test", 14);
+}
+
 static void
 test_stress ()
 {
@@ -6851,6 +6990,7 @@ main (int argc, char **argv)
     g_test_add_func ("/accept-language/basic", test_accept_language);
     g_test_add_func ("/accept-language/empty", test_accept_language_empty);
     g_test_add_func ("/allow-interaction/basic", test_allow_interaction);
+    g_test_add_func ("/connection-pool/basic", test_connection_pool);
     g_test_add_func ("/maintenance/none", test_maintenance_none);
     g_test_add_func ("/maintenance/daemon-restart", test_maintenance_daemon_restart);
     g_test_add_func ("/maintenance/system-restart", test_maintenance_system_restart);
@@ -6917,6 +7057,7 @@ main (int argc, char **argv)
     g_test_add_func ("/icon/async", test_icon_async);
     g_test_add_func ("/icon/not-installed", test_icon_not_installed);
     g_test_add_func ("/icon/large", test_icon_large);
+    g_test_add_func ("/get-icons/sync", test_get_icons_sync);
     g_test_add_func ("/get-assertions/sync", test_get_assertions_sync);
     //g_test_add_func ("/get-assertions/async", test_get_assertions_async);
     g_test_add_func ("/get-assertions/body", test_get_assertions_body);
@@ -6934,6 +7075,7 @@ main (int argc, char **argv)
     g_test_add_func ("/get-connections/filter-snap", test_get_connections_filter_snap);
     g_test_add_func ("/get-connections/filter-interface", test_get_connections_filter_interface);
     g_test_add_func ("/get-connections/attributes", test_get_connections_attributes);
+    g_test_add_func ("/get-connections/index", test_get_connections_index);
     g_test_add_func ("/get-interfaces/sync", test_get_interfaces_sync);
     g_test_add_func ("/get-interfaces/async", test_get_interfaces_async);
     g_test_add_func ("/get-interfaces/no-snaps", test_get_interfaces_no_snaps);
@@ -7080,6 +7222,8 @@ main (int argc, char **argv)
     g_test_add_func ("/download/sync", test_download_sync);
     g_test_add_func ("/download/async", test_download_async);
     g_test_add_func ("/download/channel-revision", test_download_channel_revision);
+    g_test_add_func ("/download-to-device/sync", test_download_to_device);
+    g_test_add_func ("/download-to-device/resume", test_download_to_device_resume);
     g_test_add_func ("/stress/basic", test_stress);
 
     return g_test_run ();